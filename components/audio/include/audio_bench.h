@@ -0,0 +1,68 @@
+#ifndef AUDIO_BENCH_H
+#define AUDIO_BENCH_H
+
+#include <stdint.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Pipeline stages measured by the bench
+ */
+typedef enum {
+    AUDIO_BENCH_STAGE_CAPTURE = 0,  // Mic device read (file-backed)
+    AUDIO_BENCH_STAGE_ENCODE,       // PCM -> Opus (or G.711)
+    AUDIO_BENCH_STAGE_DECODE,       // Opus (or G.711) -> PCM
+    AUDIO_BENCH_STAGE_RENDER,       // Speaker device write (file-backed)
+    AUDIO_BENCH_STAGE_MAX,
+} audio_bench_stage_t;
+
+typedef struct {
+    uint32_t frames;
+    uint64_t wall_us;       // Total wall time spent in the stage
+    uint32_t max_us;        // Worst single frame
+    uint64_t cpu_us;        // Run time charged to the bench task (wall time if run-time stats are off)
+    uint32_t allocs;        // Heap allocations made while the stage ran
+    uint32_t alloc_bytes;
+} audio_bench_stage_stats_t;
+
+typedef struct {
+    uint32_t files;
+    uint64_t audio_ms;              // Corpus duration pushed through the pipeline
+    uint32_t encoded_bytes;
+    uint32_t setup_allocs;          // Allocations made opening devices and codecs
+    int32_t heap_delta;             // Free heap after - before, should be ~0
+    audio_bench_stage_stats_t stages[AUDIO_BENCH_STAGE_MAX];
+} audio_bench_result_t;
+
+typedef struct {
+    const char *corpus_dir;         // Directory of PCM WAV files (speech corpus)
+    const char *output_dir;         // Rendered WAVs go here as <name>.out.wav, NULL to discard
+    int bitrate;                    // Opus bitrate in bps (unused by G.711)
+} audio_bench_cfg_t;
+
+/**
+ * @brief Run every WAV in the corpus through capture -> encode -> decode -> render
+ *
+ * Uses WAV-file-backed codec devices, so it needs neither the board codec nor a
+ * WebRTC session and runs faster than real time.
+ *
+ * @param cfg Bench configuration
+ * @param result Aggregated results over all files
+ * @return ESP_OK if at least one file was processed
+ */
+esp_err_t audio_bench_run(const audio_bench_cfg_t *cfg, audio_bench_result_t *result);
+
+/**
+ * @brief Print a per-stage report
+ * @param result Results from audio_bench_run()
+ */
+void audio_bench_print_result(const audio_bench_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_BENCH_H
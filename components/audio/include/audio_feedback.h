@@ -18,6 +18,18 @@ typedef enum {
     AUDIO_FEEDBACK_ERROR           /**< Error sound */
 } audio_feedback_type_t;
 
+/**
+ * @brief Cue priorities
+ *
+ * A cue preempts the one playing only if its priority is strictly higher; otherwise
+ * it waits in the queue and is chained gaplessly after the current cue.
+ */
+typedef enum {
+    AUDIO_FEEDBACK_PRIO_LOW = 0,    /**< UI ticks, dropped first when the queue is full */
+    AUDIO_FEEDBACK_PRIO_NORMAL,     /**< Status sounds */
+    AUDIO_FEEDBACK_PRIO_HIGH,       /**< Errors, preempt anything lower */
+} audio_feedback_priority_t;
+
 /**
  * @brief Audio feedback completion callback
  */
@@ -54,7 +66,30 @@ esp_err_t audio_feedback_play(audio_feedback_type_t type, audio_feedback_callbac
 esp_err_t audio_feedback_play_wav(const char *filename, audio_feedback_wav_callback_t callback);
 
 /**
- * @brief Stop current audio feedback
+ * @brief Queue a WAV file with an explicit priority
+ * 
+ * Duplicates of a cue that is already queued (or just started) are coalesced.
+ * 
+ * @param filename Path to WAV file
+ * @param priority Cue priority
+ * @param callback Optional callback when playback completes (success=false if preempted/dropped)
+ * @return ESP_OK on success
+ */
+esp_err_t audio_feedback_play_wav_priority(const char *filename, audio_feedback_priority_t priority,
+                                           audio_feedback_wav_callback_t callback);
+
+/**
+ * @brief Decode a WAV file into memory so later plays are a constant-time enqueue
+ * 
+ * Files larger than CONFIG_AG_AUDIO_FEEDBACK_MAX_CLIP_KB stay on flash and are streamed.
+ * 
+ * @param filename Path to WAV file
+ * @return ESP_OK on success
+ */
+esp_err_t audio_feedback_preload(const char *filename);
+
+/**
+ * @brief Stop current audio feedback and drop everything queued
  * 
  * @return ESP_OK on success
  */
@@ -0,0 +1,73 @@
+#ifndef AUDIO_METRICS_H
+#define AUDIO_METRICS_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_capture.h"
+#include "av_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Level of one 20 ms block
+ */
+typedef struct {
+    float rms_dbfs;
+    float peak_dbfs;
+    uint32_t clipped;           // Samples at full scale in this block
+} audio_level_block_t;
+
+/**
+ * @brief Running level statistics for one direction
+ */
+typedef struct {
+    audio_level_block_t last;   // Most recent complete block
+    float peak_hold_dbfs;       // Highest block peak since reset
+    uint32_t blocks;
+    uint32_t clipped_samples;
+    uint32_t clipped_blocks;    // Blocks with at least one clipped sample
+} audio_level_stats_t;
+
+typedef struct {
+    audio_level_stats_t mic;
+    audio_level_stats_t speaker;
+    uint32_t render_underruns;  // Render starved mid-stream (gap shorter than an idle pause)
+    int32_t render_queue_ms;    // Audio handed to the codec but not yet played
+    int32_t render_queue_min_ms;
+    float cpu_percent;          // Share of one core spent computing these metrics
+} audio_metrics_t;
+
+/**
+ * @brief Measure every frame the capture source produces
+ *
+ * Hooks the source's read_frame(); must be called once per source.
+ * @param src Capture audio source
+ */
+void audio_metrics_attach_source(esp_capture_audio_src_if_t *src);
+
+/**
+ * @brief Wrap an audio render so everything it plays is measured
+ * @param render Render to wrap (e.g. from av_render_alloc_i2s_render)
+ * @return Wrapping render, or the original one if metrics are disabled or allocation fails
+ */
+audio_render_handle_t audio_metrics_wrap_render(audio_render_handle_t render);
+
+/**
+ * @brief Get a consistent snapshot of the audio metrics
+ * @param metrics Output snapshot
+ */
+void audio_metrics_get(audio_metrics_t *metrics);
+
+/**
+ * @brief Reset counters, peak hold and the CPU cost measurement
+ */
+void audio_metrics_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_METRICS_H
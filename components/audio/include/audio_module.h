@@ -24,6 +24,9 @@ esp_err_t audio_module_init(audio_event_callback_t callback);
 
 /**
  * @brief Start audio system
+ *
+ * Builds the capture and player systems on the first call only; they are reused
+ * by every later WebRTC session. Calling it while running is a no-op.
  * @return ESP_OK on success
  */
 esp_err_t audio_module_start(void);
@@ -0,0 +1,103 @@
+#ifndef AUDIO_PREROLL_H
+#define AUDIO_PREROLL_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_capture.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Microphone pre-roll
+ *
+ * Between audio start and the moment the WebRTC capture takes over the microphone,
+ * mic audio is kept in a PSRAM ring (24 kHz mono PCM16, the Realtime API input
+ * format). Once the data channel opens, the buffered speech is pushed to the
+ * server faster than real time so words spoken during connection setup are not lost.
+ */
+
+/**
+ * @brief Pre-roll chunk consumer
+ * @param pcm 24 kHz mono PCM16 samples
+ * @param size Size in bytes
+ * @param ctx User context
+ * @return ESP_OK to continue, anything else aborts the flush
+ */
+typedef esp_err_t (*audio_preroll_sink_t)(const uint8_t *pcm, uint32_t size, void *ctx);
+
+/**
+ * @brief Session-start timeline, all times in ms since boot (0 = not reached)
+ */
+typedef struct {
+    bool enabled;
+    uint32_t buffered_ms;       // Audio currently held in the ring
+    uint32_t overwritten_ms;    // Oldest audio lost because the ring wrapped
+    uint32_t start_ms;          // Pre-roll started recording
+    uint32_t speech_ms;         // Local energy detector first heard speech
+    uint32_t handoff_ms;        // Pre-roll released the microphone (capture start or flush)
+    uint32_t flush_ms;          // Buffered speech sent to the server
+    uint32_t flushed_audio_ms;  // Duration of the audio that was sent
+    uint32_t heard_ms;          // Server first committed user audio
+} audio_preroll_stats_t;
+
+/**
+ * @brief Start recording into the pre-roll ring
+ *
+ * No-op when disabled in Kconfig or already recording.
+ * @return ESP_OK on success
+ */
+esp_err_t audio_preroll_start(void);
+
+/**
+ * @brief Hand the microphone over to the capture system when it starts
+ *
+ * Hooks the source's start() so the pre-roll stops reading and closes the codec
+ * right before the capture opens it. If the pre-roll cannot release the codec
+ * in time, start() fails instead of opening it a second time.
+ * @param src Capture audio source
+ */
+void audio_preroll_attach_source(esp_capture_audio_src_if_t *src);
+
+/**
+ * @brief Check whether the ring holds speech worth sending
+ * @return true if speech was detected since the pre-roll started
+ */
+bool audio_preroll_has_speech(void);
+
+/**
+ * @brief Drain buffered speech through a sink, then empty the ring
+ *
+ * Stops recording first if the capture has not taken the microphone yet. Starts
+ * shortly before the detected speech onset; silence before it is dropped. The
+ * sink is called without the ring lock held.
+ * @param sink Chunk consumer
+ * @param ctx User context
+ * @return ESP_OK on success, ESP_ERR_NOT_FOUND if there is no speech to send,
+ *         ESP_ERR_TIMEOUT if recording did not stop
+ */
+esp_err_t audio_preroll_flush(audio_preroll_sink_t sink, void *ctx);
+
+/**
+ * @brief Drop everything buffered
+ */
+void audio_preroll_discard(void);
+
+/**
+ * @brief Record that the server committed user audio (first call only)
+ */
+void audio_preroll_note_heard(void);
+
+/**
+ * @brief Get pre-roll statistics and session-start timeline
+ * @param stats Output statistics
+ */
+void audio_preroll_get_stats(audio_preroll_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_PREROLL_H
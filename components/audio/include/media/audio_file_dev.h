@@ -0,0 +1,75 @@
+#ifndef AUDIO_FILE_DEV_H
+#define AUDIO_FILE_DEV_H
+
+#include <stdbool.h>
+#include <esp_err.h>
+#include "esp_codec_dev.h"
+#include "audio_wav.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief WAV-file-backed codec device
+ *
+ * Stand-in for the board codec handles returned by get_record_handle() and
+ * get_playback_handle(). The mic variant serves PCM from a WAV file, the speaker
+ * variant records everything written to it into a WAV file. Both are regular
+ * esp_codec_dev handles, so esp_capture / av_render cannot tell the difference.
+ */
+typedef struct audio_file_dev audio_file_dev_t;
+
+typedef struct {
+    const char *path;       // WAV file to read (mic) or create (speaker, "" discards the output)
+    bool realtime;          // Pace reads/writes to the wall clock like an I2S device
+    bool loop;              // Mic only: rewind at end of file instead of returning silence
+} audio_file_dev_cfg_t;
+
+/**
+ * @brief Create a mic device that reads PCM from a WAV file
+ * @param cfg Device configuration
+ * @return Device, or NULL if the file cannot be opened or parsed
+ */
+audio_file_dev_t *audio_file_dev_open_mic(const audio_file_dev_cfg_t *cfg);
+
+/**
+ * @brief Create a speaker device that writes PCM into a WAV file
+ * @param cfg Device configuration
+ * @return Device, or NULL if the file cannot be created
+ */
+audio_file_dev_t *audio_file_dev_open_speaker(const audio_file_dev_cfg_t *cfg);
+
+/**
+ * @brief Get the esp_codec_dev handle backed by this file
+ * @param dev File device
+ * @return Codec device handle
+ */
+esp_codec_dev_handle_t audio_file_dev_get_handle(audio_file_dev_t *dev);
+
+/**
+ * @brief Get the PCM layout of the backing file
+ * @param dev File device
+ * @param info Output layout (speaker: format negotiated so far and bytes written)
+ * @return ESP_OK on success
+ */
+esp_err_t audio_file_dev_get_info(audio_file_dev_t *dev, audio_wav_info_t *info);
+
+/**
+ * @brief Check whether a non-looping mic has served the whole file
+ * @param dev File device
+ * @return true once the last PCM byte has been read
+ */
+bool audio_file_dev_at_eof(audio_file_dev_t *dev);
+
+/**
+ * @brief Close the device, finalize the WAV header (speaker) and free resources
+ * @param dev File device
+ */
+void audio_file_dev_close(audio_file_dev_t *dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_FILE_DEV_H
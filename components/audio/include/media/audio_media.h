@@ -4,6 +4,7 @@
 #include "esp_capture.h"
 #include "esp_capture_sink.h"
 #include "av_render.h"
+#include "esp_codec_dev.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -20,6 +21,22 @@ typedef struct {
     av_render_handle_t    player;
 } audio_player_system_t;
 
+/**
+ * @brief Codec device feeding the capture system
+ *
+ * The board microphone, or the WAV-backed mic when CONFIG_AG_AUDIO_FILE_DEVICES is set.
+ * @return Record handle, NULL if unavailable
+ */
+esp_codec_dev_handle_t audio_media_get_record_handle(void);
+
+/**
+ * @brief Codec device driven by the player system
+ *
+ * The board speaker, or the WAV-recording speaker when CONFIG_AG_AUDIO_FILE_DEVICES is set.
+ * @return Playback handle, NULL if unavailable
+ */
+esp_codec_dev_handle_t audio_media_get_playback_handle(void);
+
 #ifdef __cplusplus
 }
 #endif
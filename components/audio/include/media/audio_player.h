@@ -2,12 +2,36 @@
 #define AUDIO_PLAYER_H
 
 #include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include "audio_media.h"
+#include "sdkconfig.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Format av_render hands to the audio render; the G.711 profile stays at the
+// decoder rate and the render bridge upsamples to 24 kHz stereo
+#ifdef CONFIG_AG_WEBRTC_AUDIO_G711
+#define AUDIO_PLAYER_FRAME_RATE         8000
+#define AUDIO_PLAYER_FRAME_CHANNELS     1
+#else
+#define AUDIO_PLAYER_FRAME_RATE         24000
+#define AUDIO_PLAYER_FRAME_CHANNELS     2
+#endif
+
+/**
+ * @brief PCM clip held in memory (e.g. a pre-loaded feedback sound)
+ */
+typedef struct {
+    uint8_t *data;
+    uint32_t size;
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint8_t bits_per_sample;
+} audio_pcm_clip_t;
+
 /**
  * @brief Build audio player system
  * @param player_sys Pointer to player system structure to initialize
@@ -37,6 +61,51 @@ esp_err_t audio_player_reset(audio_player_system_t *player_sys);
  */
 esp_err_t audio_player_play_wav(audio_player_system_t *player_sys, const char *filename);
 
+/**
+ * @brief Add a raw PCM stream to the player
+ * @param player_sys Pointer to player system
+ * @param sample_rate Sample rate in Hz
+ * @param channels Channel count
+ * @param bits_per_sample Bits per sample
+ * @return ESP_OK on success
+ */
+esp_err_t audio_player_open_pcm_stream(audio_player_system_t *player_sys, uint32_t sample_rate,
+                                      uint8_t channels, uint8_t bits_per_sample);
+
+/**
+ * @brief Queue PCM data on the open stream (retries briefly while the render FIFO is full)
+ * @param player_sys Pointer to player system
+ * @param data PCM data
+ * @param size Size in bytes
+ * @param pts Presentation timestamp in ms
+ * @return ESP_OK on success
+ */
+esp_err_t audio_player_write_pcm(audio_player_system_t *player_sys, const uint8_t *data,
+                                 uint32_t size, uint32_t pts);
+
+/**
+ * @brief Finish the PCM stream and reset the player
+ * @param player_sys Pointer to player system
+ * @param send_eos Send end-of-stream first (false when aborting playback)
+ * @return ESP_OK on success
+ */
+esp_err_t audio_player_close_pcm_stream(audio_player_system_t *player_sys, bool send_eos);
+
+/**
+ * @brief Load a WAV file's PCM payload into memory (PSRAM preferred)
+ * @param filename Path to WAV file
+ * @param max_size Refuse payloads larger than this many bytes (0 = no limit)
+ * @param clip Output clip, release with audio_player_free_clip()
+ * @return ESP_OK on success, ESP_ERR_INVALID_SIZE if over max_size
+ */
+esp_err_t audio_player_load_wav(const char *filename, uint32_t max_size, audio_pcm_clip_t *clip);
+
+/**
+ * @brief Free a clip loaded with audio_player_load_wav()
+ * @param clip Clip to free
+ */
+void audio_player_free_clip(audio_pcm_clip_t *clip);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,27 @@
+#ifndef AUDIO_RENDER_BRIDGE_H
+#define AUDIO_RENDER_BRIDGE_H
+
+#include "av_render.h"
+#include "audio_render.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Wrap a render so 8 kHz PCM16 is played at 24 kHz stereo
+ *
+ * Used by the G.711 profile: av_render stays at the 8 kHz decoder rate and this
+ * bridge does the fixed x3 upsample and mono-to-stereo copy on the way to I2S, so
+ * the speaker path keeps its 24 kHz configuration without av_render's generic
+ * rate converter. Other formats are passed through unchanged.
+ * @param render Render to wrap
+ * @return Wrapping render, or the original one if allocation fails
+ */
+audio_render_handle_t audio_render_bridge_wrap(audio_render_handle_t render);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_RENDER_BRIDGE_H
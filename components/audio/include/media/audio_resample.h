@@ -0,0 +1,47 @@
+#ifndef AUDIO_RESAMPLE_H
+#define AUDIO_RESAMPLE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Fixed-ratio x3 upsampler for PCM16 (8 kHz -> 24 kHz)
+ *
+ * Linear interpolation between consecutive input samples, integer only. The last
+ * input sample of each channel is carried across calls so frame boundaries are
+ * seamless. Mono input can be written out as stereo in the same pass. Plain C so
+ * it also builds on the host.
+ */
+typedef struct {
+    int16_t last[2];            // Previous input sample per channel
+    uint8_t in_channels;        // 1 or 2
+    uint8_t out_channels;       // >= in_channels, 1 or 2
+} audio_resample_x3_t;
+
+/**
+ * @brief Reset the upsampler
+ * @param rs Upsampler state
+ * @param in_channels Input channel count (1 or 2)
+ * @param out_channels Output channel count (1 or 2, mono is duplicated)
+ */
+void audio_resample_x3_init(audio_resample_x3_t *rs, uint8_t in_channels, uint8_t out_channels);
+
+/**
+ * @brief Upsample interleaved PCM16 by three
+ * @param rs Upsampler state
+ * @param in Input samples, interleaved
+ * @param frames Input frames (samples per channel)
+ * @param out Output buffer, room for frames * 3 * out_channels samples
+ * @return Output frames written (frames * 3)
+ */
+size_t audio_resample_x3_process(audio_resample_x3_t *rs, const int16_t *in, size_t frames, int16_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_RESAMPLE_H
@@ -0,0 +1,51 @@
+#ifndef AUDIO_WAV_H
+#define AUDIO_WAV_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief PCM layout of a WAV file
+ */
+typedef struct {
+    uint32_t sample_rate;
+    uint16_t channels;
+    uint16_t bits_per_sample;
+    uint32_t data_size;     // Bytes of PCM payload (clamped to the real file length)
+    long     data_offset;   // File offset of the first PCM byte
+} audio_wav_info_t;
+
+/**
+ * @brief Parse the RIFF/fmt/data headers and leave the file positioned at the PCM data
+ *
+ * Unknown chunks between "fmt " and "data" are skipped. Streamed WAVs that carry a
+ * placeholder data size (0xFFFFFFFF) are clamped to the actual file length.
+ *
+ * @param f    File opened in "rb" mode
+ * @param info Output PCM layout
+ * @return ESP_OK on success, ESP_ERR_INVALID_ARG / ESP_ERR_NOT_SUPPORTED on bad input
+ */
+esp_err_t audio_wav_read_header(FILE *f, audio_wav_info_t *info);
+
+/**
+ * @brief Write a 44-byte canonical PCM WAV header
+ *
+ * Call once before writing PCM (with data_size 0) and again after the last write
+ * to patch the sizes in place.
+ *
+ * @param f    File opened in "wb" / "r+b" mode
+ * @param info PCM layout and data size
+ * @return ESP_OK on success
+ */
+esp_err_t audio_wav_write_header(FILE *f, const audio_wav_info_t *info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_WAV_H
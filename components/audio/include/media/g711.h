@@ -0,0 +1,55 @@
+#ifndef G711_H
+#define G711_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Table/bit-scan G.711 codec (ITU-T G.711, bit-exact with the reference)
+ *
+ * Decode is a 256-entry lookup per byte. Encode finds the segment with a single
+ * count-leading-zeros instead of the reference segment search loop. No state,
+ * no allocation, safe to call from any task. Plain C so it also builds on the host.
+ */
+
+/**
+ * @brief Encode linear PCM16 to A-law
+ * @param pcm Input samples
+ * @param out Output bytes, one per sample
+ * @param samples Number of samples
+ */
+void g711_alaw_encode(const int16_t *pcm, uint8_t *out, size_t samples);
+
+/**
+ * @brief Decode A-law to linear PCM16
+ * @param in Input bytes
+ * @param pcm Output samples, one per byte
+ * @param samples Number of samples
+ */
+void g711_alaw_decode(const uint8_t *in, int16_t *pcm, size_t samples);
+
+/**
+ * @brief Encode linear PCM16 to mu-law
+ * @param pcm Input samples
+ * @param out Output bytes, one per sample
+ * @param samples Number of samples
+ */
+void g711_ulaw_encode(const int16_t *pcm, uint8_t *out, size_t samples);
+
+/**
+ * @brief Decode mu-law to linear PCM16
+ * @param in Input bytes
+ * @param pcm Output samples, one per byte
+ * @param samples Number of samples
+ */
+void g711_ulaw_decode(const uint8_t *in, int16_t *pcm, size_t samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // G711_H
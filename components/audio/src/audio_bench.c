@@ -0,0 +1,404 @@
+/*
+ * Audio Pipeline Bench
+ * Pushes a WAV speech corpus through capture -> encode -> decode -> render
+ * using WAV-file-backed codec devices and reports per-stage cost. The codec is
+ * Opus, or the table G.711 codec when the low-power audio profile is selected.
+ */
+
+#include "sdkconfig.h"
+
+#ifdef CONFIG_AG_AUDIO_BENCH_ENABLE
+
+#include "audio_bench.h"
+#include <esp_log.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <dirent.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_codec_dev.h"
+#ifndef CONFIG_AG_WEBRTC_AUDIO_G711
+#include "esp_audio_enc.h"
+#include "esp_audio_dec.h"
+#include "esp_opus_enc.h"
+#include "esp_opus_dec.h"
+#include "esp_audio_enc_default.h"
+#include "esp_audio_dec_default.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "media/audio_file_dev.h"
+#include "media/g711.h"
+#include "memory_manager.h"
+
+static const char *TAG = "audio_bench";
+
+#define BENCH_FRAME_MS      20
+#define BENCH_PATH_MAX      96
+
+#if defined(CONFIG_AG_WEBRTC_AUDIO_CODEC_G711U)
+#define BENCH_CODEC_NAME    "G.711u"
+#define bench_g711_encode   g711_ulaw_encode
+#define bench_g711_decode   g711_ulaw_decode
+#elif defined(CONFIG_AG_WEBRTC_AUDIO_CODEC_G711A)
+#define BENCH_CODEC_NAME    "G.711a"
+#define bench_g711_encode   g711_alaw_encode
+#define bench_g711_decode   g711_alaw_decode
+#else
+#define BENCH_CODEC_NAME    "Opus"
+#endif
+
+static const char *stage_names[AUDIO_BENCH_STAGE_MAX] = {
+    "capture", "encode", "decode", "render",
+};
+
+// Per-stage probe: wall clock, task run time and heap counters at stage entry
+typedef struct {
+    int64_t wall;
+    uint32_t cpu;
+    mem_heap_counters_t heap;
+} bench_probe_t;
+
+// Run-time counter ticks are esp_timer microseconds; 32-bit, so only deltas are meaningful
+static uint32_t bench_task_cpu_us(int64_t wall_fallback)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    return (uint32_t)ulTaskGetRunTimeCounter(xTaskGetCurrentTaskHandle());
+#else
+    return (uint32_t)wall_fallback;
+#endif
+}
+
+static inline void bench_probe_begin(bench_probe_t *p)
+{
+    memory_manager_get_heap_counters(&p->heap);
+    p->wall = esp_timer_get_time();
+    p->cpu = bench_task_cpu_us(p->wall);
+}
+
+static inline void bench_probe_end(const bench_probe_t *p, audio_bench_stage_stats_t *st)
+{
+    int64_t wall = esp_timer_get_time();
+    uint32_t cpu = bench_task_cpu_us(wall);
+    mem_heap_counters_t heap;
+    memory_manager_get_heap_counters(&heap);
+
+    uint32_t us = (uint32_t)(wall - p->wall);
+    st->frames++;
+    st->wall_us += us;
+    st->cpu_us += (uint32_t)(cpu - p->cpu);
+    if (us > st->max_us) {
+        st->max_us = us;
+    }
+    st->allocs += heap.allocs - p->heap.allocs;
+    st->alloc_bytes += heap.alloc_bytes - p->heap.alloc_bytes;
+}
+
+static bool bench_is_corpus_file(const char *name)
+{
+    size_t len = strlen(name);
+    if (len < 5 || strcasecmp(name + len - 4, ".wav") != 0) {
+        return false;
+    }
+    // Skip our own rendered output
+    return !(len >= 8 && strcasecmp(name + len - 8, ".out.wav") == 0);
+}
+
+#ifndef CONFIG_AG_WEBRTC_AUDIO_G711
+static esp_err_t bench_open_codecs(const audio_wav_info_t *info, int bitrate,
+                                   esp_audio_enc_handle_t *enc, esp_audio_dec_handle_t *dec)
+{
+    esp_opus_enc_config_t opus_enc_cfg = ESP_OPUS_ENC_CONFIG_DEFAULT();
+    opus_enc_cfg.sample_rate = info->sample_rate;
+    opus_enc_cfg.channel = info->channels;
+    opus_enc_cfg.bits_per_sample = info->bits_per_sample;
+    opus_enc_cfg.bitrate = bitrate;
+    opus_enc_cfg.frame_duration = ESP_OPUS_ENC_FRAME_DURATION_20_MS;
+    opus_enc_cfg.application_mode = ESP_OPUS_ENC_APPLICATION_VOIP;
+
+    esp_audio_enc_config_t enc_cfg = {
+        .type = ESP_AUDIO_TYPE_OPUS,
+        .cfg = &opus_enc_cfg,
+        .cfg_sz = sizeof(opus_enc_cfg),
+    };
+    if (esp_audio_enc_open(&enc_cfg, enc) != ESP_AUDIO_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to open Opus encoder (%"PRIu32"Hz, %u ch)",
+                 info->sample_rate, info->channels);
+        return ESP_FAIL;
+    }
+
+    esp_opus_dec_cfg_t opus_dec_cfg = ESP_OPUS_DEC_CONFIG_DEFAULT();
+    opus_dec_cfg.sample_rate = info->sample_rate;
+    opus_dec_cfg.channel = info->channels;
+
+    esp_audio_dec_cfg_t dec_cfg = {
+        .type = ESP_AUDIO_TYPE_OPUS,
+        .cfg = &opus_dec_cfg,
+        .cfg_sz = sizeof(opus_dec_cfg),
+    };
+    if (esp_audio_dec_open(&dec_cfg, dec) != ESP_AUDIO_ERR_OK) {
+        ESP_LOGE(TAG, "Failed to open Opus decoder");
+        esp_audio_enc_close(*enc);
+        *enc = NULL;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+#endif
+
+static esp_err_t bench_run_file(const char *in_path, const char *out_path, int bitrate,
+                                audio_bench_result_t *result)
+{
+    esp_err_t ret = ESP_FAIL;
+#ifndef CONFIG_AG_WEBRTC_AUDIO_G711
+    esp_audio_enc_handle_t enc = NULL;
+    esp_audio_dec_handle_t dec = NULL;
+#endif
+    uint8_t *pcm = NULL, *packet = NULL, *decoded = NULL;
+    mem_heap_counters_t setup_start, setup_end;
+
+    memory_manager_get_heap_counters(&setup_start);
+
+    audio_file_dev_cfg_t mic_cfg = { .path = in_path };
+    audio_file_dev_cfg_t spk_cfg = { .path = out_path ? out_path : "" };
+    audio_file_dev_t *mic = audio_file_dev_open_mic(&mic_cfg);
+    audio_file_dev_t *spk = audio_file_dev_open_speaker(&spk_cfg);
+    if (!mic || !spk) {
+        goto cleanup;
+    }
+
+    audio_wav_info_t info;
+    audio_file_dev_get_info(mic, &info);
+    if (info.bits_per_sample != 16 || info.channels == 0 || info.channels > 2) {
+        ESP_LOGW(TAG, "Skipping %s: need 16-bit mono/stereo PCM", in_path);
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    esp_codec_dev_sample_info_t fs = {
+        .sample_rate = info.sample_rate,
+        .channel = info.channels,
+        .bits_per_sample = info.bits_per_sample,
+    };
+    if (esp_codec_dev_open(audio_file_dev_get_handle(mic), &fs) != ESP_CODEC_DEV_OK ||
+        esp_codec_dev_open(audio_file_dev_get_handle(spk), &fs) != ESP_CODEC_DEV_OK) {
+        ESP_LOGE(TAG, "Failed to open file devices for %s", in_path);
+        goto cleanup;
+    }
+
+#ifdef CONFIG_AG_WEBRTC_AUDIO_G711
+    // Table codec: stateless, one code byte per sample
+    (void)bitrate;
+    int pcm_size = info.sample_rate * info.channels * sizeof(int16_t) * BENCH_FRAME_MS / 1000;
+    int out_size = pcm_size / sizeof(int16_t);
+    int decoded_size = pcm_size;
+#else
+    if (bench_open_codecs(&info, bitrate, &enc, &dec) != ESP_OK) {
+        ret = ESP_ERR_NOT_SUPPORTED;
+        goto cleanup;
+    }
+
+    int in_size = 0, out_size = 0;
+    esp_audio_enc_get_frame_size(enc, &in_size, &out_size);
+    int pcm_size = in_size;
+    int decoded_size = pcm_size * 2;  // Grown on ESP_AUDIO_ERR_BUFF_NOT_ENOUGH
+#endif
+    pcm = mem_alloc(pcm_size, MEM_POLICY_PREFER_PSRAM, "bench_pcm");
+    packet = mem_alloc(out_size, MEM_POLICY_PREFER_PSRAM, "bench_pkt");
+    decoded = mem_alloc(decoded_size, MEM_POLICY_PREFER_PSRAM, "bench_dec");
+    if (!pcm || !packet || !decoded) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    memory_manager_get_heap_counters(&setup_end);
+    result->setup_allocs += setup_end.allocs - setup_start.allocs;
+
+    uint32_t frames = 0;
+    bench_probe_t probe;
+    audio_bench_stage_stats_t *stages = result->stages;
+
+    while (!audio_file_dev_at_eof(mic)) {
+        bench_probe_begin(&probe);
+        esp_codec_dev_read(audio_file_dev_get_handle(mic), pcm, pcm_size);
+        bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_CAPTURE]);
+
+#ifdef CONFIG_AG_WEBRTC_AUDIO_G711
+        uint32_t samples = pcm_size / sizeof(int16_t);
+        bench_probe_begin(&probe);
+        bench_g711_encode((const int16_t *)pcm, packet, samples);
+        bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_ENCODE]);
+        result->encoded_bytes += samples;
+
+        bench_probe_begin(&probe);
+        bench_g711_decode(packet, (int16_t *)decoded, samples);
+        bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_DECODE]);
+        uint32_t decoded_bytes = pcm_size;
+#else
+        esp_audio_enc_in_frame_t enc_in = { .buffer = pcm, .len = pcm_size };
+        esp_audio_enc_out_frame_t enc_out = { .buffer = packet, .len = out_size };
+        bench_probe_begin(&probe);
+        int err = esp_audio_enc_process(enc, &enc_in, &enc_out);
+        bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_ENCODE]);
+        if (err != ESP_AUDIO_ERR_OK) {
+            ESP_LOGE(TAG, "Encode failed at frame %"PRIu32": %d", frames, err);
+            goto cleanup;
+        }
+        result->encoded_bytes += enc_out.encoded_bytes;
+
+        esp_audio_dec_in_raw_t raw = { .buffer = packet, .len = enc_out.encoded_bytes };
+        esp_audio_dec_out_frame_t dec_out = { .buffer = decoded, .len = decoded_size };
+        bench_probe_begin(&probe);
+        err = esp_audio_dec_process(dec, &raw, &dec_out);
+        bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_DECODE]);
+        if (err == ESP_AUDIO_ERR_BUFF_NOT_ENOUGH) {
+            // Only happens once; do not count the retry as a second frame
+            uint8_t *bigger = mem_realloc(decoded, dec_out.needed_size, MEM_POLICY_PREFER_PSRAM, "bench_dec");
+            if (!bigger) {
+                ret = ESP_ERR_NO_MEM;
+                goto cleanup;
+            }
+            decoded = bigger;
+            decoded_size = dec_out.needed_size;
+            dec_out.buffer = decoded;
+            dec_out.len = decoded_size;
+            raw.consumed = 0;
+            stages[AUDIO_BENCH_STAGE_DECODE].frames--;
+            bench_probe_begin(&probe);
+            err = esp_audio_dec_process(dec, &raw, &dec_out);
+            bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_DECODE]);
+        }
+        if (err != ESP_AUDIO_ERR_OK) {
+            ESP_LOGE(TAG, "Decode failed at frame %"PRIu32": %d", frames, err);
+            goto cleanup;
+        }
+        uint32_t decoded_bytes = dec_out.decoded_size;
+#endif
+
+        bench_probe_begin(&probe);
+        esp_codec_dev_write(audio_file_dev_get_handle(spk), decoded, decoded_bytes);
+        bench_probe_end(&probe, &stages[AUDIO_BENCH_STAGE_RENDER]);
+
+        frames++;
+    }
+
+    result->files++;
+    result->audio_ms += (uint64_t)frames * BENCH_FRAME_MS;
+    ESP_LOGI(TAG, "%s: %"PRIu32" frames", in_path, frames);
+    ret = ESP_OK;
+
+cleanup:
+#ifndef CONFIG_AG_WEBRTC_AUDIO_G711
+    if (enc) {
+        esp_audio_enc_close(enc);
+    }
+    if (dec) {
+        esp_audio_dec_close(dec);
+    }
+#endif
+    mem_free(pcm);
+    mem_free(packet);
+    mem_free(decoded);
+    audio_file_dev_close(mic);
+    audio_file_dev_close(spk);
+    return ret;
+}
+
+esp_err_t audio_bench_run(const audio_bench_cfg_t *cfg, audio_bench_result_t *result)
+{
+    if (!cfg || !cfg->corpus_dir || !result) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(result, 0, sizeof(*result));
+
+#ifndef CONFIG_AG_WEBRTC_AUDIO_G711
+    // Harmless if audio_module already registered them
+    esp_audio_enc_register_default();
+    esp_audio_dec_register_default();
+#endif
+
+    DIR *dir = opendir(cfg->corpus_dir);
+    if (!dir) {
+        ESP_LOGE(TAG, "Cannot open corpus directory %s", cfg->corpus_dir);
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    ESP_LOGI(TAG, "Running pipeline bench on %s (%s, %d bps)", cfg->corpus_dir, BENCH_CODEC_NAME, cfg->bitrate);
+    uint32_t heap_before = esp_get_free_heap_size();
+
+    struct dirent *entry;
+    char in_path[BENCH_PATH_MAX];
+    char out_path[BENCH_PATH_MAX];
+    while ((entry = readdir(dir)) != NULL) {
+        if (!bench_is_corpus_file(entry->d_name)) {
+            continue;
+        }
+        int in_len = snprintf(in_path, sizeof(in_path), "%s/%s", cfg->corpus_dir, entry->d_name);
+        int out_len = 0;
+        if (cfg->output_dir) {
+            size_t base_len = strlen(entry->d_name) - 4;
+            out_len = snprintf(out_path, sizeof(out_path), "%s/%.*s.out.wav",
+                               cfg->output_dir, (int)base_len, entry->d_name);
+        }
+        if (in_len >= (int)sizeof(in_path) || out_len >= (int)sizeof(out_path)) {
+            ESP_LOGW(TAG, "Skipping %s: path longer than %d bytes", entry->d_name, BENCH_PATH_MAX - 1);
+            continue;
+        }
+        bench_run_file(in_path, cfg->output_dir ? out_path : NULL, cfg->bitrate, result);
+    }
+    closedir(dir);
+
+    result->heap_delta = (int32_t)esp_get_free_heap_size() - (int32_t)heap_before;
+
+    if (result->files == 0) {
+        ESP_LOGW(TAG, "No usable WAV files in %s", cfg->corpus_dir);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+void audio_bench_print_result(const audio_bench_result_t *result)
+{
+    if (!result || result->files == 0) {
+        printf("No bench results\n");
+        return;
+    }
+
+    bool heap_hooks = memory_manager_get_heap_counters(NULL);
+    uint64_t total_cpu_us = 0;
+    for (int i = 0; i < AUDIO_BENCH_STAGE_MAX; i++) {
+        total_cpu_us += result->stages[i].cpu_us;
+    }
+
+    printf("========== Audio Pipeline Bench ==========\n");
+    printf("Files: %"PRIu32" | Audio: %.1f s | %s: %.1f kbps avg\n",
+           result->files, result->audio_ms / 1000.0, BENCH_CODEC_NAME,
+           result->audio_ms ? result->encoded_bytes * 8.0 / result->audio_ms : 0.0);
+    printf("%-8s | %7s | %8s | %7s | %8s | %6s | %s\n",
+           "Stage", "Frames", "Avg us", "Max us", "CPU %", "Allocs", "Bytes/frame");
+    for (int i = 0; i < AUDIO_BENCH_STAGE_MAX; i++) {
+        const audio_bench_stage_stats_t *st = &result->stages[i];
+        uint32_t frames = st->frames ? st->frames : 1;
+        // CPU % of one core needed to keep up with real time
+        double cpu_pct = result->audio_ms ? st->cpu_us / (result->audio_ms * 10.0) : 0.0;
+        if (heap_hooks) {
+            printf("%-8s | %7"PRIu32" | %8"PRIu64" | %7"PRIu32" | %7.2f%% | %6"PRIu32" | %"PRIu32"\n",
+                   stage_names[i], st->frames, st->wall_us / frames, st->max_us, cpu_pct,
+                   st->allocs, st->alloc_bytes / frames);
+        } else {
+            printf("%-8s | %7"PRIu32" | %8"PRIu64" | %7"PRIu32" | %7.2f%% | %6s | %s\n",
+                   stage_names[i], st->frames, st->wall_us / frames, st->max_us, cpu_pct, "n/a", "n/a");
+        }
+    }
+    printf("Total CPU: %.2f%% of one core (%.1fx real time)\n",
+           result->audio_ms ? total_cpu_us / (result->audio_ms * 10.0) : 0.0,
+           total_cpu_us ? result->audio_ms * 1000.0 / total_cpu_us : 0.0);
+    printf("Setup allocations: %"PRIu32" | Heap delta: %"PRId32" bytes\n",
+           result->setup_allocs, result->heap_delta);
+    printf("==========================================\n");
+}
+
+#endif // CONFIG_AG_AUDIO_BENCH_ENABLE
@@ -1,10 +1,19 @@
 #include "audio_commands.h"
 #include "audio_module.h"
+#include "audio_preroll.h"
+#include "audio_metrics.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include <esp_console.h>
 #include <esp_log.h>
 #include <argtable3/argtable3.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include "sdkconfig.h"
+#ifdef CONFIG_AG_AUDIO_BENCH_ENABLE
+#include "audio_bench.h"
+#endif
 static const char *TAG = "audio_cmd";
 
 // Audio start command
@@ -43,6 +52,16 @@ static int cmd_audio_status(int argc, char **argv)
     printf("Audio System Status:\n");
     printf("  Ready: %s\n", audio_module_is_ready() ? "Yes" : "No");
     printf("  Volume: %d%%\n", audio_module_get_volume());
+
+    audio_preroll_stats_t preroll;
+    audio_preroll_get_stats(&preroll);
+    if (preroll.enabled) {
+        printf("  Pre-roll (ms since boot): start %" PRIu32 ", speech %" PRIu32 ", handoff %" PRIu32
+               ", flush %" PRIu32 ", heard %" PRIu32 "\n",
+               preroll.start_ms, preroll.speech_ms, preroll.handoff_ms, preroll.flush_ms, preroll.heard_ms);
+        printf("  Pre-roll audio: %" PRIu32 " ms buffered, %" PRIu32 " ms sent, %" PRIu32 " ms overwritten\n",
+               preroll.buffered_ms, preroll.flushed_audio_ms, preroll.overwritten_ms);
+    }
     
     return 0;
 }
@@ -91,6 +110,88 @@ static int cmd_audio_test(int argc, char **argv)
     return 0;
 }
 
+// Audio stats command arguments
+static struct {
+    struct arg_int *count;
+    struct arg_lit *reset;
+    struct arg_end *end;
+} audio_stats_args;
+
+// Audio stats command
+static int cmd_audio_stats(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&audio_stats_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, audio_stats_args.end, argv[0]);
+        return 1;
+    }
+    
+    if (audio_stats_args.reset->count) {
+        audio_metrics_reset();
+        printf("Audio metrics reset\n");
+        return 0;
+    }
+    
+    int count = audio_stats_args.count->count ? audio_stats_args.count->ival[0] : 10;
+    printf("       mic rms/peak dBFS  clip |   spk rms/peak dBFS  clip | queue ms  underruns | cpu\n");
+    for (int i = 0; i < count; i++) {
+        if (i > 0) {
+            vTaskDelay(pdMS_TO_TICKS(500));
+        }
+        audio_metrics_t m;
+        audio_metrics_get(&m);
+        printf("  %8.1f / %6.1f %6" PRIu32 " | %8.1f / %6.1f %6" PRIu32 " | %4" PRId32 " (%3" PRId32 ") %9" PRIu32 " | %.2f%%\n",
+               m.mic.last.rms_dbfs, m.mic.last.peak_dbfs, m.mic.clipped_samples,
+               m.speaker.last.rms_dbfs, m.speaker.last.peak_dbfs, m.speaker.clipped_samples,
+               m.render_queue_ms, m.render_queue_min_ms, m.render_underruns, m.cpu_percent);
+    }
+    
+    audio_metrics_t m;
+    audio_metrics_get(&m);
+    printf("Peak hold: mic %.1f dBFS, speaker %.1f dBFS; clipped blocks: mic %" PRIu32 "/%" PRIu32 ", speaker %" PRIu32 "/%" PRIu32 "\n",
+           m.mic.peak_hold_dbfs, m.speaker.peak_hold_dbfs,
+           m.mic.clipped_blocks, m.mic.blocks, m.speaker.clipped_blocks, m.speaker.blocks);
+    return 0;
+}
+
+#ifdef CONFIG_AG_AUDIO_BENCH_ENABLE
+// Audio bench command arguments
+static struct {
+    struct arg_str *corpus;
+    struct arg_str *output;
+    struct arg_int *bitrate;
+    struct arg_end *end;
+} audio_bench_args;
+
+// Audio bench command
+static int cmd_audio_bench(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&audio_bench_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, audio_bench_args.end, argv[0]);
+        return 1;
+    }
+    
+    audio_bench_cfg_t cfg = {
+        .corpus_dir = audio_bench_args.corpus->count ? audio_bench_args.corpus->sval[0] : CONFIG_AG_AUDIO_BENCH_CORPUS_DIR,
+        .output_dir = audio_bench_args.output->count ? audio_bench_args.output->sval[0] : NULL,
+        .bitrate = audio_bench_args.bitrate->count ? audio_bench_args.bitrate->ival[0] : CONFIG_AG_AUDIO_BENCH_OPUS_BITRATE,
+    };
+    
+    printf("Running audio pipeline bench on %s...\n", cfg.corpus_dir);
+    
+    audio_bench_result_t result;
+    esp_err_t ret = audio_bench_run(&cfg, &result);
+    if (ret != ESP_OK) {
+        printf("Audio bench failed: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    
+    audio_bench_print_result(&result);
+    return 0;
+}
+#endif
+
 esp_err_t audio_register_commands(void)
 {
     // Audio start command
@@ -142,6 +243,37 @@ esp_err_t audio_register_commands(void)
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&audio_test_cmd));
     
+    // Audio stats command
+    audio_stats_args.count = arg_int0("n", "count", "<n>", "Number of updates, 500 ms apart (default 10)");
+    audio_stats_args.reset = arg_lit0("r", "reset", "Reset counters and peak hold");
+    audio_stats_args.end = arg_end(2);
+    
+    const esp_console_cmd_t audio_stats_cmd = {
+        .command = "audio_stats",
+        .help = "Show live mic/speaker levels, clipping, render underruns and metrics CPU cost",
+        .hint = NULL,
+        .func = &cmd_audio_stats,
+        .argtable = &audio_stats_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&audio_stats_cmd));
+    
+#ifdef CONFIG_AG_AUDIO_BENCH_ENABLE
+    // Audio bench command
+    audio_bench_args.corpus = arg_str0("d", "dir", "<dir>", "Corpus directory of PCM WAV files");
+    audio_bench_args.output = arg_str0("o", "out", "<dir>", "Keep rendered WAVs in this directory");
+    audio_bench_args.bitrate = arg_int0("b", "bitrate", "<bps>", "Opus bitrate");
+    audio_bench_args.end = arg_end(3);
+    
+    const esp_console_cmd_t audio_bench_cmd = {
+        .command = "audio_bench",
+        .help = "Benchmark capture/encode/decode/render on a WAV corpus",
+        .hint = NULL,
+        .func = &cmd_audio_bench,
+        .argtable = &audio_bench_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&audio_bench_cmd));
+#endif
+    
     ESP_LOGI(TAG, "Audio commands registered");
     return ESP_OK;
 }
\ No newline at end of file
@@ -2,38 +2,230 @@
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
-#include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "esp_timer.h"
 #include "esp_spiffs.h"
 #include "media/audio_player.h"
+#include "media/audio_wav.h"
 #include "media/audio_media.h"
 #include "webrtc_module.h"
 #include "memory_manager.h"
+#include "sdkconfig.h"
 #include <inttypes.h>
 #include <string.h>
+#include <math.h>
 
 static const char *TAG = "audio_feedback";
 
-// Forward declarations
-static void audio_feedback_playback_task(void *pvParameters);
+#define FEEDBACK_MAX_CUES       8
+#define FEEDBACK_QUEUE_LEN      CONFIG_AG_AUDIO_FEEDBACK_QUEUE_LEN
+#define FEEDBACK_COALESCE_US    (CONFIG_AG_AUDIO_FEEDBACK_COALESCE_MS * 1000LL)
+#define FEEDBACK_MAX_CLIP_BYTES (CONFIG_AG_AUDIO_FEEDBACK_MAX_CLIP_KB * 1024)
+#define FEEDBACK_CHUNK_MS       20
+#define FEEDBACK_LEAD_CHUNKS    3      // Chunks pushed ahead of real time to ride over scheduling jitter
+#define FEEDBACK_TONE_RATE      24000
+
+#define SYSTEM_READY_WAV        "/spiffs/sounds/starting.wav"
+
+// A playable sound: pre-loaded PCM, or a file too large to preload (streamed)
+typedef struct {
+    char name[48];
+    audio_pcm_clip_t clip;
+    bool streamed;
+} feedback_cue_t;
+
+typedef struct {
+    feedback_cue_t *cue;
+    audio_feedback_priority_t priority;
+    uint32_t seq;                               // FIFO order within a priority
+    bool typed;
+    audio_feedback_type_t type;
+    audio_feedback_callback_t type_callback;
+    audio_feedback_wav_callback_t wav_callback;
+} feedback_request_t;
+
+// Open player stream, kept across cues of the same format for gapless chaining
+typedef struct {
+    bool open;
+    uint32_t sample_rate;
+    uint8_t channels;
+    uint8_t bits_per_sample;
+    uint32_t pts;
+} feedback_stream_t;
+
+typedef struct {
+    float freq_hz;      // 0 = silence
+    uint16_t ms;
+} tone_segment_t;
 
 // Module state
 static struct {
     bool initialized;
     bool is_playing;
-    audio_feedback_callback_t current_callback;
-    audio_feedback_wav_callback_t current_wav_callback;
-    char *current_filename;
     uint8_t volume;
-    
+
     // Audio player system
     audio_player_system_t player_sys;
-    
-    // Async playback task
-    TaskHandle_t playback_task_handle;
+
+    // Persistent playback worker
+    TaskHandle_t worker_handle;
+    SemaphoreHandle_t lock;
+
+    // Pre-loaded cues (append-only, entries never move)
+    feedback_cue_t cues[FEEDBACK_MAX_CUES];
+    int cue_count;
+    feedback_cue_t *type_cues[AUDIO_FEEDBACK_ERROR + 1];
+
+    // Pending requests and the one being played
+    feedback_request_t queue[FEEDBACK_QUEUE_LEN];
+    int queue_count;
+    uint32_t next_seq;
+    feedback_request_t current;
+    bool current_active;
+    int64_t current_start_us;
+    volatile bool preempt;
+    volatile bool stop_requested;
+
+    // Statistics
+    uint32_t played;
+    uint32_t preempted;
+    uint32_t coalesced;
+    uint32_t dropped;
 } feedback_state = {0};
 
+static const audio_feedback_priority_t type_priority[AUDIO_FEEDBACK_ERROR + 1] = {
+    [AUDIO_FEEDBACK_TOUCH_START] = AUDIO_FEEDBACK_PRIO_LOW,
+    [AUDIO_FEEDBACK_TOUCH_CONFIRM] = AUDIO_FEEDBACK_PRIO_LOW,
+    [AUDIO_FEEDBACK_SYSTEM_READY] = AUDIO_FEEDBACK_PRIO_NORMAL,
+    [AUDIO_FEEDBACK_ERROR] = AUDIO_FEEDBACK_PRIO_HIGH,
+};
+
+static void feedback_worker_task(void *pvParameters);
+
+// Must be called with the lock held
+static feedback_cue_t *feedback_find_cue(const char *name)
+{
+    for (int i = 0; i < feedback_state.cue_count; i++) {
+        if (strcmp(feedback_state.cues[i].name, name) == 0) {
+            return &feedback_state.cues[i];
+        }
+    }
+    return NULL;
+}
+
+// Takes ownership of clip; returns the existing entry if the name is already known
+static feedback_cue_t *feedback_add_cue(const char *name, audio_pcm_clip_t *clip, bool streamed)
+{
+    xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+    feedback_cue_t *cue = feedback_find_cue(name);
+    if (cue == NULL && feedback_state.cue_count < FEEDBACK_MAX_CUES) {
+        cue = &feedback_state.cues[feedback_state.cue_count];
+        strncpy(cue->name, name, sizeof(cue->name) - 1);
+        if (clip) {
+            cue->clip = *clip;
+            clip->data = NULL;
+        }
+        cue->streamed = streamed;
+        feedback_state.cue_count++;
+    }
+    xSemaphoreGive(feedback_state.lock);
+
+    if (clip && clip->data) {
+        // Lost a race with another loader, or the table is full
+        audio_player_free_clip(clip);
+    }
+    if (cue == NULL) {
+        ESP_LOGE(TAG, "Cue table full (%d), cannot add %s", FEEDBACK_MAX_CUES, name);
+    }
+    return cue;
+}
+
+static feedback_cue_t *feedback_load_cue(const char *filename)
+{
+    xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+    feedback_cue_t *cue = feedback_find_cue(filename);
+    xSemaphoreGive(feedback_state.lock);
+    if (cue) {
+        return cue;
+    }
+
+    if (strlen(filename) >= sizeof(cue->name)) {
+        ESP_LOGE(TAG, "Cue path too long: %s", filename);
+        return NULL;
+    }
+
+    audio_pcm_clip_t clip;
+    esp_err_t ret = audio_player_load_wav(filename, FEEDBACK_MAX_CLIP_BYTES, &clip);
+    if (ret == ESP_OK) {
+        return feedback_add_cue(filename, &clip, false);
+    }
+    if (ret == ESP_ERR_INVALID_SIZE || ret == ESP_ERR_NO_MEM) {
+        // Still playable, just not from RAM
+        ESP_LOGW(TAG, "%s will be streamed from flash", filename);
+        return feedback_add_cue(filename, NULL, true);
+    }
+    return NULL;
+}
+
+// Synthesize a short mono sine cue with 5 ms fades so segment edges do not click
+static feedback_cue_t *feedback_make_tone(const char *name, const tone_segment_t *segs, int seg_count)
+{
+    uint32_t samples = 0;
+    for (int i = 0; i < seg_count; i++) {
+        samples += FEEDBACK_TONE_RATE * segs[i].ms / 1000;
+    }
+
+    audio_pcm_clip_t clip = {
+        .size = samples * sizeof(int16_t),
+        .sample_rate = FEEDBACK_TONE_RATE,
+        .channels = 1,
+        .bits_per_sample = 16,
+    };
+    clip.data = mem_alloc(clip.size, MEM_POLICY_PREFER_PSRAM, "fb_tone");
+    if (!clip.data) {
+        return NULL;
+    }
+
+    int16_t *pcm = (int16_t *)clip.data;
+    const uint32_t fade = FEEDBACK_TONE_RATE * 5 / 1000;
+    for (int i = 0; i < seg_count; i++) {
+        uint32_t n = FEEDBACK_TONE_RATE * segs[i].ms / 1000;
+        float step = 2.0f * (float)M_PI * segs[i].freq_hz / FEEDBACK_TONE_RATE;
+        for (uint32_t k = 0; k < n; k++) {
+            float gain = 1.0f;
+            if (k < fade) {
+                gain = (float)k / fade;
+            } else if (n - k < fade) {
+                gain = (float)(n - k) / fade;
+            }
+            *pcm++ = segs[i].freq_hz > 0 ? (int16_t)(9000.0f * gain * sinf(step * k)) : 0;
+        }
+    }
+
+    return feedback_add_cue(name, &clip, false);
+}
+
+static void feedback_build_type_cues(void)
+{
+    static const tone_segment_t touch_start[] = { {1200, 60} };
+    static const tone_segment_t touch_confirm[] = { {880, 60}, {1320, 80} };
+    static const tone_segment_t system_ready[] = { {660, 90}, {990, 120} };
+    static const tone_segment_t error[] = { {330, 150}, {0, 50}, {330, 150} };
+
+    feedback_state.type_cues[AUDIO_FEEDBACK_TOUCH_START] =
+        feedback_make_tone("tone:touch_start", touch_start, 1);
+    feedback_state.type_cues[AUDIO_FEEDBACK_TOUCH_CONFIRM] =
+        feedback_make_tone("tone:touch_confirm", touch_confirm, 2);
+    feedback_state.type_cues[AUDIO_FEEDBACK_ERROR] =
+        feedback_make_tone("tone:error", error, 3);
 
+    // Prefer the recorded startup sound, fall back to a tone
+    feedback_state.type_cues[AUDIO_FEEDBACK_SYSTEM_READY] = feedback_load_cue(SYSTEM_READY_WAV);
+    if (feedback_state.type_cues[AUDIO_FEEDBACK_SYSTEM_READY] == NULL) {
+        feedback_state.type_cues[AUDIO_FEEDBACK_SYSTEM_READY] =
+            feedback_make_tone("tone:system_ready", system_ready, 2);
+    }
+}
 
 esp_err_t audio_feedback_init(void)
 {
@@ -41,9 +233,9 @@ esp_err_t audio_feedback_init(void)
         ESP_LOGD(TAG, "Audio feedback already initialized");
         return ESP_OK;
     }
-    
+
     ESP_LOGI(TAG, "Initializing audio feedback system");
-    
+
     // Initialize SPIFFS
     esp_vfs_spiffs_conf_t conf = {
         .base_path = "/spiffs",
@@ -51,13 +243,13 @@ esp_err_t audio_feedback_init(void)
         .max_files = 5,
         .format_if_mount_failed = true
     };
-    
+
     esp_err_t ret = esp_vfs_spiffs_register(&conf);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to initialize SPIFFS (%s)", esp_err_to_name(ret));
         return ret;
     }
-    
+
     // Initialize audio player system
     ret = audio_player_build_system(&feedback_state.player_sys);
     if (ret != ESP_OK) {
@@ -65,101 +257,387 @@ esp_err_t audio_feedback_init(void)
         esp_vfs_spiffs_unregister(NULL);
         return ret;
     }
-    
-    
+
+    feedback_state.lock = xSemaphoreCreateMutex();
+    if (!feedback_state.lock) {
+        ESP_LOGE(TAG, "Failed to create feedback lock");
+        esp_vfs_spiffs_unregister(NULL);
+        return ESP_ERR_NO_MEM;
+    }
+
+    feedback_build_type_cues();
+
+    // One persistent worker serves the whole queue (pinned to Core 0 for audio)
+    BaseType_t task_ret = xTaskCreatePinnedToCore(
+        feedback_worker_task,
+        "audio_feedback",
+        4096,
+        NULL,
+        5,
+        &feedback_state.worker_handle,
+        0
+    );
+    if (task_ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create feedback worker");
+        vSemaphoreDelete(feedback_state.lock);
+        feedback_state.lock = NULL;
+        esp_vfs_spiffs_unregister(NULL);
+        return ESP_FAIL;
+    }
+
     feedback_state.initialized = true;
     feedback_state.is_playing = false;
     feedback_state.volume = 80; // Default volume
-    
-    ESP_LOGI(TAG, "Audio feedback system initialized successfully");
+
+    ESP_LOGI(TAG, "Audio feedback system initialized successfully (%d cues pre-loaded)",
+             feedback_state.cue_count);
     return ESP_OK;
 }
 
+static void feedback_complete(const feedback_request_t *req, bool success)
+{
+    if (req->typed && req->type_callback) {
+        req->type_callback(req->type, success);
+    } else if (!req->typed && req->wav_callback) {
+        req->wav_callback(req->cue->name, success);
+    }
+}
 
-// Asynchronous WAV playback task
-static void audio_feedback_playback_task(void *pvParameters)
+// Pop the highest-priority, oldest request. Must be called with the lock held.
+static bool feedback_queue_pop_locked(feedback_request_t *out)
 {
-    char *filename = (char *)pvParameters;
-    
-    ESP_LOGI(TAG, "Async playback task started for: %s", filename);
-    
-    bool webrtc_was_active = webrtc_module_is_connected();
-    if (webrtc_was_active) {
-        ESP_LOGI(TAG, "WebRTC is active - ensuring audio is paused for feedback playback");
-        webrtc_module_pause_audio(); // This will ensure audio resources are released
+    if (feedback_state.queue_count == 0) {
+        return false;
     }
-    
-    // Play the audio file
-    esp_err_t ret = audio_player_play_wav(&feedback_state.player_sys, filename);
-    
-    // Always resume WebRTC audio if it was active (enables first-time activation)
-    if (webrtc_was_active) {
-        ESP_LOGI(TAG, "Resuming/enabling WebRTC audio after feedback playback");
-        webrtc_module_resume_audio(); // This will enable audio for the first time if needed
+    int best = 0;
+    for (int i = 1; i < feedback_state.queue_count; i++) {
+        const feedback_request_t *a = &feedback_state.queue[i];
+        const feedback_request_t *b = &feedback_state.queue[best];
+        if (a->priority > b->priority || (a->priority == b->priority && a->seq < b->seq)) {
+            best = i;
+        }
     }
-    
-    // Update state and call callback
-    feedback_state.is_playing = false;
-    if (feedback_state.current_wav_callback) {
-        feedback_state.current_wav_callback(filename, ret == ESP_OK);
+    *out = feedback_state.queue[best];
+    feedback_state.queue[best] = feedback_state.queue[--feedback_state.queue_count];
+    return true;
+}
+
+static bool feedback_next(feedback_request_t *out)
+{
+    xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+    bool found = !feedback_state.stop_requested && feedback_queue_pop_locked(out);
+    feedback_state.current_active = found;
+    if (found) {
+        // Set with the pop so is_playing never sees an empty queue and an idle worker
+        feedback_state.is_playing = true;
+        feedback_state.current = *out;
+        feedback_state.current_start_us = esp_timer_get_time();
+        feedback_state.preempt = false;
     }
-    
-    // Clean up
-    mem_free(filename);
-    feedback_state.playback_task_handle = NULL;
-    vTaskDelete(NULL);
+    xSemaphoreGive(feedback_state.lock);
+    return found;
 }
 
-esp_err_t audio_feedback_play_wav(const char *filename, audio_feedback_wav_callback_t callback)
+static esp_err_t feedback_enqueue(feedback_request_t *req)
+{
+    feedback_request_t evicted;
+    bool have_evicted = false;
+    bool coalesced = false;
+    esp_err_t ret = ESP_OK;
+
+    xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+
+    // Coalesce with the cue that just started playing
+    if (feedback_state.current_active && feedback_state.current.cue == req->cue &&
+        esp_timer_get_time() - feedback_state.current_start_us < FEEDBACK_COALESCE_US) {
+        coalesced = true;
+    }
+
+    // Coalesce with an identical pending cue, keeping the higher priority
+    for (int i = 0; !coalesced && i < feedback_state.queue_count; i++) {
+        feedback_request_t *pending = &feedback_state.queue[i];
+        if (pending->cue == req->cue) {
+            if (req->priority > pending->priority) {
+                pending->priority = req->priority;
+            }
+            if (!pending->type_callback && !pending->wav_callback) {
+                pending->typed = req->typed;
+                pending->type = req->type;
+                pending->type_callback = req->type_callback;
+                pending->wav_callback = req->wav_callback;
+            }
+            coalesced = true;
+        }
+    }
+
+    if (coalesced) {
+        feedback_state.coalesced++;
+    } else {
+        if (feedback_state.queue_count == FEEDBACK_QUEUE_LEN) {
+            // Full: evict the lowest-priority, newest entry if the new cue outranks it
+            int victim = 0;
+            for (int i = 1; i < feedback_state.queue_count; i++) {
+                const feedback_request_t *a = &feedback_state.queue[i];
+                const feedback_request_t *b = &feedback_state.queue[victim];
+                if (a->priority < b->priority || (a->priority == b->priority && a->seq > b->seq)) {
+                    victim = i;
+                }
+            }
+            if (feedback_state.queue[victim].priority < req->priority) {
+                evicted = feedback_state.queue[victim];
+                have_evicted = true;
+                feedback_state.queue[victim] = feedback_state.queue[--feedback_state.queue_count];
+            }
+            feedback_state.dropped++;
+        }
+
+        if (feedback_state.queue_count < FEEDBACK_QUEUE_LEN) {
+            req->seq = feedback_state.next_seq++;
+            feedback_state.queue[feedback_state.queue_count++] = *req;
+            feedback_state.stop_requested = false;
+            if (feedback_state.current_active && req->priority > feedback_state.current.priority) {
+                feedback_state.preempt = true;
+            }
+        } else {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+
+    xSemaphoreGive(feedback_state.lock);
+
+    if (have_evicted) {
+        ESP_LOGW(TAG, "Queue full, dropped %s", evicted.cue->name);
+        feedback_complete(&evicted, false);
+    }
+    if (ret == ESP_OK && !coalesced) {
+        xTaskNotifyGive(feedback_state.worker_handle);
+    } else if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Queue full, rejected %s", req->cue->name);
+    }
+    return ret;
+}
+
+static bool feedback_interrupted(void)
+{
+    return feedback_state.preempt || feedback_state.stop_requested;
+}
+
+static esp_err_t feedback_stream_prepare(feedback_stream_t *stream, uint32_t sample_rate,
+                                         uint8_t channels, uint8_t bits_per_sample)
+{
+    if (stream->open && stream->sample_rate == sample_rate &&
+        stream->channels == channels && stream->bits_per_sample == bits_per_sample) {
+        return ESP_OK;  // Same format: chain without a gap
+    }
+    if (stream->open) {
+        audio_player_close_pcm_stream(&feedback_state.player_sys, true);
+        stream->open = false;
+    }
+    esp_err_t ret = audio_player_open_pcm_stream(&feedback_state.player_sys, sample_rate,
+                                                 channels, bits_per_sample);
+    if (ret == ESP_OK) {
+        stream->open = true;
+        stream->sample_rate = sample_rate;
+        stream->channels = channels;
+        stream->bits_per_sample = bits_per_sample;
+        stream->pts = 0;
+    }
+    return ret;
+}
+
+// Push one chunk, pacing to real time once the lead is established
+static bool feedback_stream_write(feedback_stream_t *stream, const uint8_t *data, uint32_t size,
+                                  uint32_t *chunks, TickType_t *last_wake)
+{
+    if (audio_player_write_pcm(&feedback_state.player_sys, data, size, stream->pts) != ESP_OK) {
+        return false;
+    }
+    uint32_t bytes_per_second = stream->sample_rate * stream->channels * (stream->bits_per_sample / 8);
+    stream->pts += (size * 1000) / bytes_per_second;
+
+    if (++(*chunks) == FEEDBACK_LEAD_CHUNKS) {
+        *last_wake = xTaskGetTickCount();
+    } else if (*chunks > FEEDBACK_LEAD_CHUNKS) {
+        xTaskDelayUntil(last_wake, pdMS_TO_TICKS(FEEDBACK_CHUNK_MS));
+    }
+    return true;
+}
+
+static bool feedback_play_cue(const feedback_cue_t *cue, feedback_stream_t *stream,
+                              uint32_t *chunks, TickType_t *last_wake)
+{
+    if (!cue->streamed) {
+        const audio_pcm_clip_t *clip = &cue->clip;
+        if (feedback_stream_prepare(stream, clip->sample_rate, clip->channels, clip->bits_per_sample) != ESP_OK) {
+            return false;
+        }
+        uint32_t chunk_size = clip->sample_rate * clip->channels * (clip->bits_per_sample / 8) *
+                              FEEDBACK_CHUNK_MS / 1000;
+        for (uint32_t off = 0; off < clip->size; off += chunk_size) {
+            if (feedback_interrupted()) {
+                return false;
+            }
+            uint32_t n = (clip->size - off) < chunk_size ? (clip->size - off) : chunk_size;
+            if (!feedback_stream_write(stream, clip->data + off, n, chunks, last_wake)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Large file: stream from flash through a small internal buffer
+    FILE *f = fopen(cue->name, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", cue->name);
+        return false;
+    }
+    bool ok = false;
+    uint8_t *chunk_buffer = NULL;
+    audio_wav_info_t wav;
+    if (audio_wav_read_header(f, &wav) != ESP_OK ||
+        feedback_stream_prepare(stream, wav.sample_rate, wav.channels, wav.bits_per_sample) != ESP_OK) {
+        goto done;
+    }
+    uint32_t chunk_size = wav.sample_rate * wav.channels * (wav.bits_per_sample / 8) * FEEDBACK_CHUNK_MS / 1000;
+    chunk_buffer = mem_alloc(chunk_size, MEM_POLICY_REQUIRE_INTERNAL, "fb_chunk");
+    if (!chunk_buffer) {
+        goto done;
+    }
+    uint32_t remaining = wav.data_size;
+    while (remaining > 0) {
+        if (feedback_interrupted()) {
+            goto done;
+        }
+        size_t n = fread(chunk_buffer, 1, remaining < chunk_size ? remaining : chunk_size, f);
+        if (n == 0) {
+            break;
+        }
+        if (!feedback_stream_write(stream, chunk_buffer, n, chunks, last_wake)) {
+            goto done;
+        }
+        remaining -= n;
+    }
+    ok = true;
+done:
+    mem_free(chunk_buffer);
+    fclose(f);
+    return ok;
+}
+
+// Persistent playback worker: drains the queue, chaining cues back to back
+static void feedback_worker_task(void *pvParameters)
+{
+    feedback_request_t req;
+
+    while (1) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        if (!feedback_next(&req)) {
+            continue;
+        }
+
+        bool webrtc_was_active = webrtc_module_is_connected();
+        if (webrtc_was_active) {
+            ESP_LOGI(TAG, "WebRTC is active - pausing audio for feedback playback");
+            webrtc_module_pause_audio();
+        }
+
+        feedback_stream_t stream = {0};
+        uint32_t chunks = 0;
+        TickType_t last_wake = 0;
+        do {
+            ESP_LOGI(TAG, "Playing cue %s (prio %d)", req.cue->name, req.priority);
+            bool ok = feedback_play_cue(req.cue, &stream, &chunks, &last_wake);
+            if (!ok && stream.open) {
+                // Cut buffered audio so the preempting cue starts immediately
+                audio_player_close_pcm_stream(&feedback_state.player_sys, false);
+                stream.open = false;
+                chunks = 0;
+                feedback_state.preempted++;
+            } else if (ok) {
+                feedback_state.played++;
+            }
+            feedback_complete(&req, ok);
+        } while (feedback_next(&req));
+
+        if (stream.open) {
+            audio_player_close_pcm_stream(&feedback_state.player_sys, true);
+        }
+
+        // Always resume WebRTC audio if it was active (enables first-time activation)
+        if (webrtc_was_active) {
+            ESP_LOGI(TAG, "Resuming WebRTC audio after feedback playback");
+            webrtc_module_resume_audio();
+        }
+        xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+        feedback_state.is_playing = false;
+        xSemaphoreGive(feedback_state.lock);
+    }
+}
+
+esp_err_t audio_feedback_play(audio_feedback_type_t type, audio_feedback_callback_t callback)
 {
     if (!feedback_state.initialized) {
         ESP_LOGE(TAG, "Audio feedback not initialized");
         return ESP_ERR_INVALID_STATE;
     }
-    
+
+    if (type > AUDIO_FEEDBACK_ERROR || feedback_state.type_cues[type] == NULL) {
+        ESP_LOGE(TAG, "No cue for feedback type %d", type);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    feedback_request_t req = {
+        .cue = feedback_state.type_cues[type],
+        .priority = type_priority[type],
+        .typed = true,
+        .type = type,
+        .type_callback = callback,
+    };
+    return feedback_enqueue(&req);
+}
+
+esp_err_t audio_feedback_play_wav_priority(const char *filename, audio_feedback_priority_t priority,
+                                           audio_feedback_wav_callback_t callback)
+{
+    if (!feedback_state.initialized) {
+        ESP_LOGE(TAG, "Audio feedback not initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
     if (!filename) {
         ESP_LOGE(TAG, "Invalid filename");
         return ESP_ERR_INVALID_ARG;
     }
-    
-    if (feedback_state.is_playing) {
-        ESP_LOGW(TAG, "Audio feedback already playing, stopping current playback");
-        audio_feedback_stop();
-    }
-    
-    ESP_LOGI(TAG, "Starting async WAV playback: %s", filename);
-    
-    feedback_state.is_playing = true;
-    feedback_state.current_wav_callback = callback;
-    
-    // Create a copy of the filename for the task
-    char *filename_copy = mem_alloc(strlen(filename) + 1, MEM_POLICY_PREFER_PSRAM, "wav_filename");
-    if (!filename_copy) {
-        ESP_LOGE(TAG, "Failed to allocate memory for filename");
-        feedback_state.is_playing = false;
-        return ESP_ERR_NO_MEM;
+
+    // Constant time when pre-loaded; otherwise loads on the caller's task once
+    feedback_cue_t *cue = feedback_load_cue(filename);
+    if (!cue) {
+        return ESP_ERR_NOT_FOUND;
     }
-    strcpy(filename_copy, filename);
-    
-    // Create playback task pinned to Core 0 for audio processing
-    BaseType_t ret = xTaskCreatePinnedToCore(
-        audio_feedback_playback_task,
-        "audio_feedback_task",
-        4096,
-        filename_copy,
-        5,
-        &feedback_state.playback_task_handle,
-        0  // Pin to Core 0 for audio
-    );
-    
-    if (ret != pdPASS) {
-        ESP_LOGE(TAG, "Failed to create playback task");
-        mem_free(filename_copy);
-        feedback_state.is_playing = false;
-        return ESP_FAIL;
+
+    feedback_request_t req = {
+        .cue = cue,
+        .priority = priority,
+        .wav_callback = callback,
+    };
+    return feedback_enqueue(&req);
+}
+
+esp_err_t audio_feedback_play_wav(const char *filename, audio_feedback_wav_callback_t callback)
+{
+    return audio_feedback_play_wav_priority(filename, AUDIO_FEEDBACK_PRIO_NORMAL, callback);
+}
+
+esp_err_t audio_feedback_preload(const char *filename)
+{
+    if (!feedback_state.initialized) {
+        return ESP_ERR_INVALID_STATE;
     }
-    
-    return ESP_OK;
+    if (!filename) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return feedback_load_cue(filename) ? ESP_OK : ESP_ERR_NOT_FOUND;
 }
 
 esp_err_t audio_feedback_stop(void)
@@ -167,26 +645,34 @@ esp_err_t audio_feedback_stop(void)
     if (!feedback_state.initialized) {
         return ESP_ERR_INVALID_STATE;
     }
-    
+
     ESP_LOGI(TAG, "Stopping current feedback");
-    
-    feedback_state.is_playing = false;
-    
-    // Stop async task if running
-    if (feedback_state.playback_task_handle) {
-        vTaskDelete(feedback_state.playback_task_handle);
-        feedback_state.playback_task_handle = NULL;
-    }
-    
-    // Reset player to stop current playback
-    audio_player_reset(&feedback_state.player_sys);
-    
+
+    // The worker notices at the next chunk boundary and cuts the stream itself
+    feedback_request_t dropped[FEEDBACK_QUEUE_LEN];
+    xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+    int dropped_count = feedback_state.queue_count;
+    memcpy(dropped, feedback_state.queue, sizeof(feedback_request_t) * dropped_count);
+    feedback_state.queue_count = 0;
+    feedback_state.stop_requested = feedback_state.current_active;
+    xSemaphoreGive(feedback_state.lock);
+
+    for (int i = 0; i < dropped_count; i++) {
+        feedback_complete(&dropped[i], false);
+    }
+
     return ESP_OK;
 }
 
 bool audio_feedback_is_playing(void)
 {
-    return feedback_state.is_playing;
+    if (!feedback_state.initialized) {
+        return false;
+    }
+    xSemaphoreTake(feedback_state.lock, portMAX_DELAY);
+    bool playing = feedback_state.is_playing || feedback_state.queue_count > 0;
+    xSemaphoreGive(feedback_state.lock);
+    return playing;
 }
 
 esp_err_t audio_feedback_set_volume(uint8_t volume)
@@ -194,15 +680,13 @@ esp_err_t audio_feedback_set_volume(uint8_t volume)
     if (!feedback_state.initialized) {
         return ESP_ERR_INVALID_STATE;
     }
-    
+
     if (volume > 100) {
         volume = 100;
     }
-    
+
     feedback_state.volume = volume;
     ESP_LOGI(TAG, "Volume set to %d%%", volume);
-    
+
     return ESP_OK;
 }
-
-
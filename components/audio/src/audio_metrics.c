@@ -0,0 +1,369 @@
+#include "audio_metrics.h"
+#include <esp_log.h>
+#include <string.h>
+#include <math.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "audio_render.h"
+#include "memory_manager.h"
+#include "metrics.h"
+#include "trace.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "audio_metrics";
+
+#ifdef CONFIG_AG_AUDIO_METRICS_ENABLE
+
+#define METRICS_BLOCK_MS        20
+#define METRICS_FLOOR_DBFS      -96.0f
+#define METRICS_IDLE_GAP_MS     1000    // Longer render gaps are pauses, not underruns
+
+// Running sums for the block being filled
+typedef struct {
+    uint64_t sum_sq;
+    int32_t peak;
+    uint32_t clipped;
+    uint32_t samples;
+    uint32_t block_samples;
+} level_acc_t;
+
+// Wrapper state behind the render handle av_render writes to
+typedef struct {
+    audio_render_handle_t inner;
+    av_render_audio_frame_info_t info;
+    level_acc_t acc;
+    int64_t base_us;            // Wall time matching written_bytes == 0
+    uint64_t written_bytes;
+    bool measure_levels;
+} metrics_render_t;
+
+// Module state
+static struct {
+    portMUX_TYPE lock;
+    audio_metrics_t metrics;
+    level_acc_t mic_acc;
+    uint64_t cycles;
+    int64_t since_us;
+} metrics_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// Registry copies of the hot-path numbers, for scraping
+static struct {
+    metric_t *mic_rms_dbfs;
+    metric_t *mic_clipped;
+    metric_t *speaker_rms_dbfs;
+    metric_t *speaker_clipped;
+    metric_t *underruns;
+    metric_t *queue_ms;
+} audio_registry = {0};
+
+static void audio_metrics_register(void)
+{
+    audio_registry.mic_rms_dbfs = metrics_gauge("audio_mic_rms_dbfs", "Mic RMS level of the last 20 ms block");
+    audio_registry.mic_clipped = metrics_counter("audio_mic_clipped_samples_total", "Mic samples at full scale");
+    audio_registry.speaker_rms_dbfs = metrics_gauge("audio_speaker_rms_dbfs", "Speaker RMS level of the last 20 ms block");
+    audio_registry.speaker_clipped = metrics_counter("audio_speaker_clipped_samples_total", "Speaker samples at full scale");
+    audio_registry.underruns = metrics_counter("audio_render_underruns_total", "Render starved mid-stream");
+    audio_registry.queue_ms = metrics_gauge("audio_render_queue_ms", "Audio handed to the codec but not yet played");
+}
+
+static esp_capture_err_t (*source_read_frame)(esp_capture_audio_src_if_t *src,
+                                              esp_capture_stream_frame_t *frame) = NULL;
+
+static float to_dbfs(float level)
+{
+    if (level < 1.0f) {
+        return METRICS_FLOOR_DBFS;
+    }
+    return 20.0f * log10f(level / 32768.0f);
+}
+
+static void level_publish(level_acc_t *acc, audio_level_stats_t *stats)
+{
+    audio_level_block_t block = {
+        .rms_dbfs = to_dbfs(sqrtf((float)acc->sum_sq / acc->samples)),
+        .peak_dbfs = to_dbfs((float)acc->peak),
+        .clipped = acc->clipped,
+    };
+
+    taskENTER_CRITICAL(&metrics_state.lock);
+    stats->last = block;
+    stats->blocks++;
+    if (stats->blocks == 1 || block.peak_dbfs > stats->peak_hold_dbfs) {
+        stats->peak_hold_dbfs = block.peak_dbfs;
+    }
+    if (block.clipped) {
+        stats->clipped_samples += block.clipped;
+        stats->clipped_blocks++;
+    }
+    taskEXIT_CRITICAL(&metrics_state.lock);
+
+    bool mic = stats == &metrics_state.metrics.mic;
+    metric_set(mic ? audio_registry.mic_rms_dbfs : audio_registry.speaker_rms_dbfs, (int32_t)block.rms_dbfs);
+    metric_add(mic ? audio_registry.mic_clipped : audio_registry.speaker_clipped, block.clipped);
+
+    acc->sum_sq = 0;
+    acc->peak = 0;
+    acc->clipped = 0;
+    acc->samples = 0;
+}
+
+// Single pass over interleaved PCM16; channels are pooled, which is what a level meter wants
+static void level_feed(level_acc_t *acc, audio_level_stats_t *stats, const int16_t *pcm, uint32_t count)
+{
+    while (count > 0) {
+        uint32_t n = acc->block_samples - acc->samples;
+        if (n > count) {
+            n = count;
+        }
+
+        uint64_t sum_sq = 0;
+        int32_t peak = acc->peak;
+        uint32_t clipped = 0;
+        for (uint32_t i = 0; i < n; i++) {
+            int32_t s = pcm[i];
+            int32_t a = s < 0 ? -s : s;
+            sum_sq += (uint32_t)(s * s);
+            if (a > peak) {
+                peak = a;
+            }
+            clipped += a >= 32767;
+        }
+        acc->sum_sq += sum_sq;
+        acc->peak = peak;
+        acc->clipped += clipped;
+        acc->samples += n;
+
+        if (acc->samples == acc->block_samples) {
+            level_publish(acc, stats);
+        }
+        pcm += n;
+        count -= n;
+    }
+}
+
+static void metrics_charge(uint32_t start_cycles)
+{
+    uint32_t spent = esp_cpu_get_cycle_count() - start_cycles;
+    taskENTER_CRITICAL(&metrics_state.lock);
+    metrics_state.cycles += spent;
+    taskEXIT_CRITICAL(&metrics_state.lock);
+}
+
+static esp_capture_err_t metrics_source_read_frame(esp_capture_audio_src_if_t *src,
+                                                   esp_capture_stream_frame_t *frame)
+{
+    TRACE_BEGIN("mic_read");
+    esp_capture_err_t ret = source_read_frame(src, frame);
+    TRACE_END("mic_read");
+    if (ret != ESP_CAPTURE_ERR_OK || frame->size <= 0) {
+        return ret;
+    }
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    level_feed(&metrics_state.mic_acc, &metrics_state.metrics.mic,
+               (const int16_t *)frame->data, frame->size / sizeof(int16_t));
+    metrics_charge(start);
+    return ret;
+}
+
+static audio_render_handle_t metrics_render_init(void *cfg, int size)
+{
+    if (cfg == NULL || size != sizeof(audio_render_handle_t)) {
+        return NULL;
+    }
+    metrics_render_t *render = mem_calloc(1, sizeof(metrics_render_t), MEM_POLICY_REQUIRE_INTERNAL, "metrics_render");
+    if (render) {
+        render->inner = *(audio_render_handle_t *)cfg;
+    }
+    return render;
+}
+
+static int metrics_render_open(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    metrics_render_t *render = (metrics_render_t *)h;
+    render->info = *info;
+    render->measure_levels = info->bits_per_sample == 16;
+    memset(&render->acc, 0, sizeof(render->acc));
+    render->acc.block_samples = info->sample_rate * info->channel * METRICS_BLOCK_MS / 1000;
+    render->written_bytes = 0;
+    render->base_us = 0;
+    return audio_render_open(render->inner, info);
+}
+
+// Track how far writes run ahead of the playback clock; falling behind is an underrun
+static void metrics_render_clock(metrics_render_t *render, int size)
+{
+    uint32_t bytes_per_ms = render->info.sample_rate * render->info.channel * (render->info.bits_per_sample / 8) / 1000;
+    if (bytes_per_ms == 0) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    if (render->base_us == 0) {
+        render->base_us = now;
+    }
+
+    int32_t played_ms = (int32_t)((now - render->base_us) / 1000);
+    int32_t queue_ms = (int32_t)(render->written_bytes / bytes_per_ms) - played_ms;
+    bool underrun = queue_ms < 0 && -queue_ms < METRICS_IDLE_GAP_MS;
+    if (queue_ms < 0) {
+        // Restart the clock from this write
+        render->base_us = now;
+        render->written_bytes = 0;
+        queue_ms = 0;
+    }
+    render->written_bytes += size;
+
+    taskENTER_CRITICAL(&metrics_state.lock);
+    audio_metrics_t *m = &metrics_state.metrics;
+    m->render_underruns += underrun;
+    m->render_queue_ms = queue_ms;
+    if (m->render_queue_min_ms == 0 || queue_ms < m->render_queue_min_ms) {
+        m->render_queue_min_ms = queue_ms;
+    }
+    taskEXIT_CRITICAL(&metrics_state.lock);
+
+    metric_add(audio_registry.underruns, underrun);
+    metric_set(audio_registry.queue_ms, queue_ms);
+}
+
+static int metrics_render_write(audio_render_handle_t h, uint8_t *pcm_data, int pcm_size)
+{
+    metrics_render_t *render = (metrics_render_t *)h;
+
+    uint32_t start = esp_cpu_get_cycle_count();
+    metrics_render_clock(render, pcm_size);
+    if (render->measure_levels && render->acc.block_samples) {
+        level_feed(&render->acc, &metrics_state.metrics.speaker,
+                   (const int16_t *)pcm_data, pcm_size / sizeof(int16_t));
+    }
+    metrics_charge(start);
+
+    TRACE_BEGIN("render_write");
+    int ret = audio_render_write(render->inner, pcm_data, pcm_size);
+    TRACE_END("render_write");
+    return ret;
+}
+
+static int metrics_render_get_latency(audio_render_handle_t h, uint32_t *latency)
+{
+    return audio_render_get_latency(((metrics_render_t *)h)->inner, latency);
+}
+
+static int metrics_render_get_frame_info(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    return audio_render_get_frame_info(((metrics_render_t *)h)->inner, info);
+}
+
+static int metrics_render_set_speed(audio_render_handle_t h, float speed)
+{
+    return audio_render_set_speed(((metrics_render_t *)h)->inner, speed);
+}
+
+static int metrics_render_close(audio_render_handle_t h)
+{
+    metrics_render_t *render = (metrics_render_t *)h;
+    render->base_us = 0;
+    return audio_render_close(render->inner);
+}
+
+static void metrics_render_deinit(audio_render_handle_t h)
+{
+    metrics_render_t *render = (metrics_render_t *)h;
+    audio_render_free_handle(render->inner);
+    mem_free(render);
+}
+
+void audio_metrics_attach_source(esp_capture_audio_src_if_t *src)
+{
+    if (!src || src->read_frame == metrics_source_read_frame) {
+        return;
+    }
+    audio_metrics_register();
+    metrics_state.mic_acc.block_samples =
+        CONFIG_AG_AUDIO_MIC_SAMPLE_RATE * CONFIG_AG_AUDIO_MIC_CHANNELS * METRICS_BLOCK_MS / 1000;
+    source_read_frame = src->read_frame;
+    src->read_frame = metrics_source_read_frame;
+}
+
+audio_render_handle_t audio_metrics_wrap_render(audio_render_handle_t render)
+{
+    if (render == NULL) {
+        return NULL;
+    }
+    audio_metrics_register();
+    audio_render_cfg_t cfg = {
+        .ops = {
+            .init = metrics_render_init,
+            .open = metrics_render_open,
+            .write = metrics_render_write,
+            .get_latency = metrics_render_get_latency,
+            .get_frame_info = metrics_render_get_frame_info,
+            .set_speed = metrics_render_set_speed,
+            .close = metrics_render_close,
+            .deinit = metrics_render_deinit,
+        },
+        .cfg = &render,
+        .cfg_size = sizeof(render),
+    };
+    audio_render_handle_t wrapped = audio_render_alloc_handle(&cfg);
+    if (wrapped == NULL) {
+        ESP_LOGW(TAG, "Render metrics unavailable");
+        return render;
+    }
+    return wrapped;
+}
+
+void audio_metrics_get(audio_metrics_t *metrics)
+{
+    if (!metrics) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&metrics_state.lock);
+    *metrics = metrics_state.metrics;
+    uint64_t cycles = metrics_state.cycles;
+    int64_t since = metrics_state.since_us;
+    taskEXIT_CRITICAL(&metrics_state.lock);
+
+    int64_t elapsed_us = now - since;
+    metrics->cpu_percent = elapsed_us > 0
+        ? (float)cycles * 100.0f / ((float)elapsed_us * CONFIG_ESP_DEFAULT_CPU_FREQ_MHZ)
+        : 0.0f;
+}
+
+void audio_metrics_reset(void)
+{
+    taskENTER_CRITICAL(&metrics_state.lock);
+    memset(&metrics_state.metrics, 0, sizeof(metrics_state.metrics));
+    metrics_state.cycles = 0;
+    metrics_state.since_us = esp_timer_get_time();
+    taskEXIT_CRITICAL(&metrics_state.lock);
+}
+
+#else // !CONFIG_AG_AUDIO_METRICS_ENABLE
+
+void audio_metrics_attach_source(esp_capture_audio_src_if_t *src)
+{
+}
+
+audio_render_handle_t audio_metrics_wrap_render(audio_render_handle_t render)
+{
+    return render;
+}
+
+void audio_metrics_get(audio_metrics_t *metrics)
+{
+    if (metrics) {
+        memset(metrics, 0, sizeof(*metrics));
+    }
+}
+
+void audio_metrics_reset(void)
+{
+    ESP_LOGD(TAG, "Audio metrics disabled");
+}
+
+#endif // CONFIG_AG_AUDIO_METRICS_ENABLE
@@ -14,6 +14,8 @@
 #include "media/audio_capture.h"
 #include "media/audio_player.h"
 #include "media/audio_media.h"
+#include "audio_preroll.h"
+#include "board_module.h"
 #include "freertos/FreeRTOS.h"
 
 static const char *TAG = "audio_module";
@@ -30,6 +32,7 @@ static const char *TAG = "audio_module";
 static struct {
     bool initialized;
     bool system_ready;
+    bool media_built;           // Capture/player live for the rest of the run
     audio_event_callback_t event_callback;
     int current_volume;
     bool output_released;
@@ -90,34 +93,51 @@ esp_err_t audio_module_start(void)
         return ESP_FAIL;
     }
     
+    if (audio_state.system_ready) {
+        ESP_LOGI(TAG, "Audio system already running, reusing media objects");
+        return ESP_OK;
+    }
+    
     ESP_LOGI(TAG, "Starting audio system...");
     
-    // Build up media system using submodules
-    esp_err_t ret = audio_buildup_media_system();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to build media system: %s", esp_err_to_name(ret));
-        return ret;
+    // Build up media system using submodules; it outlives WebRTC sessions
+    if (!audio_state.media_built) {
+        esp_err_t ret = audio_buildup_media_system();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to build media system: %s", esp_err_to_name(ret));
+            return ret;
+        }
+        audio_state.media_built = true;
     }
     
     // Set initial volume
-    esp_codec_dev_handle_t play_handle = get_playback_handle();
+    esp_codec_dev_handle_t play_handle = audio_media_get_playback_handle();
     if (play_handle) {
+        board_module_i2c_lock();
         esp_codec_dev_set_out_vol(play_handle, audio_state.current_volume);
+        board_module_i2c_unlock();
         ESP_LOGI(TAG, "Set playback volume to %d", audio_state.current_volume);
     } else {
         ESP_LOGW(TAG, "No playback handle available - board may not be initialized");
     }
     
     // Set initial microphone gain using codec handles directly
-    esp_codec_dev_handle_t record_handle = get_record_handle();
+    esp_codec_dev_handle_t record_handle = audio_media_get_record_handle();
     if (record_handle) {
+        board_module_i2c_lock();
         esp_codec_dev_set_in_gain(record_handle, CONFIG_AG_AUDIO_DEFAULT_MIC_GAIN);
+        board_module_i2c_unlock();
         ESP_LOGI(TAG, "Set microphone gain to %.1f", (float)CONFIG_AG_AUDIO_DEFAULT_MIC_GAIN);
     } else {
         ESP_LOGW(TAG, "No record handle available - board may not be initialized");
     }
     
     audio_state.system_ready = true;
+
+    // Keep what the user says while WebRTC is still connecting
+    if (audio_preroll_start() != ESP_OK) {
+        ESP_LOGW(TAG, "Pre-roll unavailable, speech before connect will be lost");
+    }
     
     // Notify via callback
     if (audio_state.event_callback) {
@@ -174,9 +194,11 @@ esp_err_t audio_module_set_volume(int volume)
     
     // Apply volume if system is ready
     if (audio_state.system_ready) {
-        esp_codec_dev_handle_t play_handle = get_playback_handle();
+        esp_codec_dev_handle_t play_handle = audio_media_get_playback_handle();
         if (play_handle) {
+            board_module_i2c_lock();
             esp_err_t ret = esp_codec_dev_set_out_vol(play_handle, volume);
+            board_module_i2c_unlock();
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to set volume: %s", esp_err_to_name(ret));
                 return ret;
@@ -202,9 +224,11 @@ esp_err_t audio_module_set_mic_gain(float gain)
     
     // Apply gain if system is ready
     if (audio_state.system_ready) {
-        esp_codec_dev_handle_t record_handle = get_record_handle();
+        esp_codec_dev_handle_t record_handle = audio_media_get_record_handle();
         if (record_handle) {
+            board_module_i2c_lock();
             esp_err_t ret = esp_codec_dev_set_in_gain(record_handle, gain);
+            board_module_i2c_unlock();
             if (ret != ESP_OK) {
                 ESP_LOGE(TAG, "Failed to set mic gain: %s", esp_err_to_name(ret));
                 return ret;
@@ -338,26 +362,26 @@ esp_err_t audio_module_restore_output(void)
         // Small delay to ensure hardware is stable after resume
         vTaskDelay(pdMS_TO_TICKS(15));
         
-        ESP_LOGI(TAG, "🔄 Restoring WebRTC OPUS stream configuration");
+        ESP_LOGI(TAG, "🔄 Restoring WebRTC stream configuration");
         
         av_render_audio_frame_info_t webrtc_format = {
-            .sample_rate = 24000,
-            .channel = 2,
+            .sample_rate = AUDIO_PLAYER_FRAME_RATE,
+            .channel = AUDIO_PLAYER_FRAME_CHANNELS,
             .bits_per_sample = 16,
         };
         av_render_set_fixed_frame_info(audio_state.player_sys.player, &webrtc_format);
         
         av_render_audio_info_t webrtc_stream = {
             .codec = AV_RENDER_AUDIO_CODEC_PCM,
-            .sample_rate = 24000,
-            .channel = 2,
+            .sample_rate = AUDIO_PLAYER_FRAME_RATE,
+            .channel = AUDIO_PLAYER_FRAME_CHANNELS,
         };
         ret = av_render_add_audio_stream(audio_state.player_sys.player, &webrtc_stream);
         if (ret != 0) {
-            ESP_LOGE(TAG, "❌ CRITICAL: Failed to restore WebRTC OPUS stream: %d", ret);
+            ESP_LOGE(TAG, "❌ CRITICAL: Failed to restore WebRTC stream: %d", ret);
             return ESP_FAIL;
         } else {
-            ESP_LOGI(TAG, "✅ WebRTC OPUS stream restored successfully");
+            ESP_LOGI(TAG, "✅ WebRTC stream restored successfully");
         }
         
     } else {
@@ -0,0 +1,400 @@
+#include "audio_preroll.h"
+#include <esp_log.h>
+#include <string.h>
+#include <inttypes.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "esp_codec_dev.h"
+#include "media/audio_media.h"
+#include "audio_feedback.h"
+#include "board_module.h"
+#include "memory_manager.h"
+#include "metrics.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "audio_preroll";
+
+#ifdef CONFIG_AG_AUDIO_PREROLL_ENABLE
+
+#define PREROLL_SAMPLE_RATE     24000   // Realtime API pcm16 input rate
+#define PREROLL_BYTES_PER_MS    (PREROLL_SAMPLE_RATE * 2 / 1000)
+#define PREROLL_FRAME_MS        20
+#define PREROLL_FRAME_SAMPLES   (PREROLL_SAMPLE_RATE * PREROLL_FRAME_MS / 1000)
+#define PREROLL_RING_BYTES      (CONFIG_AG_AUDIO_PREROLL_MS * PREROLL_BYTES_PER_MS)
+#define PREROLL_SPEECH_FRAMES   3       // Consecutive loud frames before speech is declared
+#define PREROLL_LEAD_IN_MS      300     // Kept ahead of the detected onset (soft word starts)
+#define PREROLL_FLUSH_CHUNK_MS  200
+#define PREROLL_HANDOFF_WAIT_MS 100
+
+// Module state
+static struct {
+    SemaphoreHandle_t lock;
+    SemaphoreHandle_t stopped;
+    TaskHandle_t task_handle;
+    volatile bool stop_requested;
+    bool running;
+
+    uint8_t *ring;
+    uint32_t total_bytes;       // Bytes ever written; ring holds the newest PREROLL_RING_BYTES
+    uint32_t speech_pos;        // Absolute byte position of the speech onset
+    bool speech;
+    int loud_frames;
+
+    audio_preroll_stats_t stats;
+} preroll_state = {0};
+
+static struct {
+    metric_t *flushed_ms;
+    metric_t *overwritten_ms;
+    metric_t *flush_ms;
+    metric_t *heard_ms;
+} preroll_metrics;
+
+static esp_capture_err_t (*source_start)(esp_capture_audio_src_if_t *src) = NULL;
+
+static void preroll_metrics_register(void)
+{
+    static const uint32_t flushed_bounds[] = {250, 500, 1000, 2000, 3000, 5000};
+    static const uint32_t flush_bounds[] = {10, 25, 50, 100, 250, 500};
+    preroll_metrics.flushed_ms = metrics_histogram("audio_preroll_flushed_ms",
+        "Buffered speech sent per flush", flushed_bounds, sizeof(flushed_bounds) / sizeof(flushed_bounds[0]));
+    preroll_metrics.overwritten_ms = metrics_counter("audio_preroll_overwritten_ms_total",
+        "Speech lost because the ring wrapped before the flush");
+    preroll_metrics.flush_ms = metrics_histogram("audio_preroll_flush_ms",
+        "Handoff to end of flush", flush_bounds, sizeof(flush_bounds) / sizeof(flush_bounds[0]));
+    preroll_metrics.heard_ms = metrics_gauge("audio_preroll_first_heard_ms",
+        "Boot to first committed user audio");
+}
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Energy detector on one mono frame
+static bool frame_is_loud(const int16_t *pcm, int samples)
+{
+    int64_t energy = 0;
+    for (int i = 0; i < samples; i++) {
+        energy += (int32_t)pcm[i] * pcm[i];
+    }
+    int64_t threshold = (int64_t)CONFIG_AG_AUDIO_PREROLL_SPEECH_LEVEL * CONFIG_AG_AUDIO_PREROLL_SPEECH_LEVEL;
+    return energy / samples > threshold;
+}
+
+static void preroll_push(const int16_t *pcm, int samples)
+{
+    uint32_t size = samples * sizeof(int16_t);
+    // Our own feedback sounds reach the mic too; they must not count as speech
+    bool loud = !audio_feedback_is_playing() && frame_is_loud(pcm, samples);
+
+    xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+    uint32_t pos = preroll_state.total_bytes % PREROLL_RING_BYTES;
+    uint32_t first = PREROLL_RING_BYTES - pos < size ? PREROLL_RING_BYTES - pos : size;
+    memcpy(preroll_state.ring + pos, pcm, first);
+    memcpy(preroll_state.ring, (const uint8_t *)pcm + first, size - first);
+    preroll_state.total_bytes += size;
+
+    if (!preroll_state.speech) {
+        preroll_state.loud_frames = loud ? preroll_state.loud_frames + 1 : 0;
+        if (preroll_state.loud_frames == PREROLL_SPEECH_FRAMES) {
+            preroll_state.speech = true;
+            preroll_state.speech_pos = preroll_state.total_bytes - PREROLL_SPEECH_FRAMES * size;
+            preroll_state.stats.speech_ms = now_ms();
+        }
+    }
+    xSemaphoreGive(preroll_state.lock);
+}
+
+static void preroll_task(void *pvParameters)
+{
+    esp_codec_dev_handle_t record_handle = audio_media_get_record_handle();
+    const int channels = CONFIG_AG_AUDIO_MIC_CHANNELS;
+    int16_t *frame = mem_alloc(PREROLL_FRAME_SAMPLES * channels * sizeof(int16_t),
+                               MEM_POLICY_REQUIRE_INTERNAL, "preroll_frame");
+
+    esp_codec_dev_sample_info_t fs = {
+        .sample_rate = PREROLL_SAMPLE_RATE,
+        .channel = channels,
+        .bits_per_sample = 16,
+    };
+    bool opened = false;
+    if (record_handle && frame) {
+        board_module_i2c_lock();
+        opened = esp_codec_dev_open(record_handle, &fs) == ESP_CODEC_DEV_OK;
+        board_module_i2c_unlock();
+    }
+    if (!opened) {
+        ESP_LOGW(TAG, "Microphone unavailable, pre-roll disabled for this session");
+    } else {
+        ESP_LOGI(TAG, "Pre-roll recording (%d ms ring)", CONFIG_AG_AUDIO_PREROLL_MS);
+    }
+
+    while (opened && !preroll_state.stop_requested) {
+        int ret = esp_codec_dev_read(record_handle, frame, PREROLL_FRAME_SAMPLES * channels * sizeof(int16_t));
+        if (ret != ESP_CODEC_DEV_OK) {
+            ESP_LOGW(TAG, "Mic read failed: %d", ret);
+            break;
+        }
+        // Downmix in place to the mono layout the server expects
+        for (int i = 0; channels > 1 && i < PREROLL_FRAME_SAMPLES; i++) {
+            int32_t sum = 0;
+            for (int c = 0; c < channels; c++) {
+                sum += frame[i * channels + c];
+            }
+            frame[i] = (int16_t)(sum / channels);
+        }
+        preroll_push(frame, PREROLL_FRAME_SAMPLES);
+    }
+
+    if (opened) {
+        board_module_i2c_lock();
+        esp_codec_dev_close(record_handle);
+        board_module_i2c_unlock();
+    }
+    mem_free(frame);
+
+    preroll_state.running = false;
+    preroll_state.task_handle = NULL;
+    xSemaphoreGive(preroll_state.stopped);
+    vTaskDelete(NULL);
+}
+
+// Stop reading and wait until the task has closed the codec
+static esp_err_t preroll_stop(void)
+{
+    if (!preroll_state.running) {
+        return ESP_OK;
+    }
+    preroll_state.stop_requested = true;
+    // A concurrent caller may take the exit signal first; running is cleared before it is given
+    if (xSemaphoreTake(preroll_state.stopped, pdMS_TO_TICKS(PREROLL_HANDOFF_WAIT_MS)) != pdTRUE &&
+        preroll_state.running) {
+        return ESP_ERR_TIMEOUT;
+    }
+    preroll_state.stats.handoff_ms = now_ms();
+
+    xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+    uint32_t held = preroll_state.total_bytes < PREROLL_RING_BYTES ? preroll_state.total_bytes : PREROLL_RING_BYTES;
+    xSemaphoreGive(preroll_state.lock);
+    ESP_LOGI(TAG, "Microphone released after %"PRIu32" ms, %"PRIu32" ms buffered%s",
+             preroll_state.stats.handoff_ms - preroll_state.stats.start_ms,
+             held / PREROLL_BYTES_PER_MS, preroll_state.speech ? " (speech)" : "");
+    return ESP_OK;
+}
+
+// Called right before the capture opens the codec; two readers must never share it
+static esp_capture_err_t preroll_source_start(esp_capture_audio_src_if_t *src)
+{
+    if (preroll_stop() != ESP_OK) {
+        // The task still holds the codec and closes it once its read returns
+        ESP_LOGE(TAG, "Pre-roll did not release the microphone in time, capture not started");
+        return ESP_CAPTURE_ERR_TIMEOUT;
+    }
+    // Opening the codec configures it over I2C
+    board_module_i2c_lock();
+    esp_capture_err_t ret = source_start(src);
+    board_module_i2c_unlock();
+    return ret;
+}
+
+esp_err_t audio_preroll_start(void)
+{
+    if (preroll_state.running) {
+        return ESP_OK;
+    }
+
+    if (!preroll_state.lock) {
+        preroll_state.lock = xSemaphoreCreateMutex();
+        preroll_state.stopped = xSemaphoreCreateBinary();
+        preroll_state.ring = mem_alloc(PREROLL_RING_BYTES, MEM_POLICY_PREFER_PSRAM, "preroll_ring");
+        if (!preroll_state.lock || !preroll_state.stopped || !preroll_state.ring) {
+            ESP_LOGE(TAG, "Failed to allocate pre-roll ring (%d bytes)", PREROLL_RING_BYTES);
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
+    preroll_metrics_register();
+    audio_preroll_discard();
+    xSemaphoreTake(preroll_state.stopped, 0);   // Clear a stale exit signal
+    memset(&preroll_state.stats, 0, sizeof(preroll_state.stats));
+    preroll_state.stats.enabled = true;
+    preroll_state.stats.start_ms = now_ms();
+    preroll_state.stop_requested = false;
+    preroll_state.running = true;
+
+    BaseType_t ret = xTaskCreatePinnedToCore(preroll_task, "audio_preroll", 3072, NULL, 10,
+                                             &preroll_state.task_handle, 0);
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create pre-roll task");
+        preroll_state.running = false;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+void audio_preroll_attach_source(esp_capture_audio_src_if_t *src)
+{
+    if (!src || src->start == preroll_source_start) {
+        return;
+    }
+    source_start = src->start;
+    src->start = preroll_source_start;
+}
+
+bool audio_preroll_has_speech(void)
+{
+    return preroll_state.speech;
+}
+
+esp_err_t audio_preroll_flush(audio_preroll_sink_t sink, void *ctx)
+{
+    if (!sink) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!preroll_state.speech) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    // The channel can open before the capture takes the microphone; freeze the ring first
+    esp_err_t ret = preroll_stop();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    uint8_t *chunk = mem_alloc(PREROLL_FLUSH_CHUNK_MS * PREROLL_BYTES_PER_MS, MEM_POLICY_PREFER_PSRAM,
+                               "preroll_chunk");
+    if (!chunk) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+    uint32_t end = preroll_state.total_bytes;
+    uint32_t oldest = end > PREROLL_RING_BYTES ? end - PREROLL_RING_BYTES : 0;
+    uint32_t lead_in = PREROLL_LEAD_IN_MS * PREROLL_BYTES_PER_MS;
+    uint32_t pos = preroll_state.speech_pos > lead_in ? preroll_state.speech_pos - lead_in : 0;
+    if (pos < oldest) {
+        preroll_state.stats.overwritten_ms = (oldest - pos) / PREROLL_BYTES_PER_MS;
+        metric_add(preroll_metrics.overwritten_ms, preroll_state.stats.overwritten_ms);
+        pos = oldest;
+    }
+    xSemaphoreGive(preroll_state.lock);
+
+    // Copy each chunk out under the lock and send it without; sends can block
+    uint32_t sent = 0;
+    while (pos < end && ret == ESP_OK) {
+        uint32_t offset = pos % PREROLL_RING_BYTES;
+        uint32_t n = end - pos;
+        if (n > PREROLL_FLUSH_CHUNK_MS * PREROLL_BYTES_PER_MS) {
+            n = PREROLL_FLUSH_CHUNK_MS * PREROLL_BYTES_PER_MS;
+        }
+        uint32_t first = n < PREROLL_RING_BYTES - offset ? n : PREROLL_RING_BYTES - offset;
+
+        xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+        bool valid = preroll_state.total_bytes == end;     // Not discarded meanwhile
+        if (valid) {
+            memcpy(chunk, preroll_state.ring + offset, first);
+            memcpy(chunk + first, preroll_state.ring, n - first);
+        }
+        xSemaphoreGive(preroll_state.lock);
+        if (!valid) {
+            ret = ESP_ERR_INVALID_STATE;
+            break;
+        }
+
+        ret = sink(chunk, n, ctx);
+        pos += n;
+        sent += n;
+    }
+    mem_free(chunk);
+
+    xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+    preroll_state.total_bytes = 0;
+    preroll_state.speech = false;
+    preroll_state.loud_frames = 0;
+    xSemaphoreGive(preroll_state.lock);
+
+    preroll_state.stats.flush_ms = now_ms();
+    preroll_state.stats.flushed_audio_ms = sent / PREROLL_BYTES_PER_MS;
+    metric_observe(preroll_metrics.flushed_ms, preroll_state.stats.flushed_audio_ms);
+    metric_observe(preroll_metrics.flush_ms, preroll_state.stats.flush_ms - preroll_state.stats.handoff_ms);
+    ESP_LOGD(TAG, "Flushed %"PRIu32" ms of pre-roll speech in %"PRIu32" ms",
+             preroll_state.stats.flushed_audio_ms, preroll_state.stats.flush_ms - preroll_state.stats.handoff_ms);
+    return ret;
+}
+
+void audio_preroll_discard(void)
+{
+    if (!preroll_state.lock) {
+        return;
+    }
+    xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+    preroll_state.total_bytes = 0;
+    preroll_state.speech = false;
+    preroll_state.loud_frames = 0;
+    xSemaphoreGive(preroll_state.lock);
+}
+
+void audio_preroll_note_heard(void)
+{
+    if (preroll_state.stats.enabled && preroll_state.stats.heard_ms == 0) {
+        preroll_state.stats.heard_ms = now_ms();
+        metric_set(preroll_metrics.heard_ms, preroll_state.stats.heard_ms);
+        ESP_LOGD(TAG, "Boot to first committed user audio: %"PRIu32" ms (speech began at %"PRIu32" ms)",
+                 preroll_state.stats.heard_ms, preroll_state.stats.speech_ms);
+    }
+}
+
+void audio_preroll_get_stats(audio_preroll_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    *stats = preroll_state.stats;
+    if (preroll_state.lock) {
+        xSemaphoreTake(preroll_state.lock, portMAX_DELAY);
+        uint32_t held = preroll_state.total_bytes < PREROLL_RING_BYTES ? preroll_state.total_bytes : PREROLL_RING_BYTES;
+        xSemaphoreGive(preroll_state.lock);
+        stats->buffered_ms = held / PREROLL_BYTES_PER_MS;
+    }
+}
+
+#else // !CONFIG_AG_AUDIO_PREROLL_ENABLE
+
+esp_err_t audio_preroll_start(void)
+{
+    ESP_LOGD(TAG, "Pre-roll disabled");
+    return ESP_OK;
+}
+
+void audio_preroll_attach_source(esp_capture_audio_src_if_t *src)
+{
+}
+
+bool audio_preroll_has_speech(void)
+{
+    return false;
+}
+
+esp_err_t audio_preroll_flush(audio_preroll_sink_t sink, void *ctx)
+{
+    return ESP_ERR_NOT_FOUND;
+}
+
+void audio_preroll_discard(void)
+{
+}
+
+void audio_preroll_note_heard(void)
+{
+}
+
+void audio_preroll_get_stats(audio_preroll_stats_t *stats)
+{
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+#endif // CONFIG_AG_AUDIO_PREROLL_ENABLE
@@ -8,6 +8,8 @@
 #include "esp_audio_enc_default.h"
 #include "esp_capture_defaults.h"
 #include "sdkconfig.h"
+#include "audio_preroll.h"
+#include "audio_metrics.h"
 
 static const char *TAG = "audio_capture";
 
@@ -39,7 +41,7 @@ esp_err_t audio_capture_build_system(audio_capture_system_t *capture_sys)
 #ifdef CONFIG_AG_AUDIO_ENABLE_AEC
     // Use AEC audio source for echo cancellation
     esp_capture_audio_aec_src_cfg_t codec_cfg = {
-        .record_handle = get_record_handle(),
+        .record_handle = audio_media_get_record_handle(),
     #if CONFIG_IDF_TARGET_ESP32S3
             .channel = 4,
             .channel_mask = 1 | 2,
@@ -52,7 +54,7 @@ esp_err_t audio_capture_build_system(audio_capture_system_t *capture_sys)
 #else
     // Use basic audio source without AEC (more stable)
     esp_capture_audio_dev_src_cfg_t codec_cfg = {
-        .record_handle = get_record_handle(),
+        .record_handle = audio_media_get_record_handle(),
     };
     
     ESP_LOGI(TAG, "Using basic audio source (AEC disabled for stability)");
@@ -62,6 +64,10 @@ esp_err_t audio_capture_build_system(audio_capture_system_t *capture_sys)
     
     RET_ON_NULL(capture_sys->aud_src, ESP_ERR_NO_MEM);
     ESP_LOGI(TAG, "Audio source created successfully");
+
+    // Pre-roll owns the microphone until this source is started
+    audio_preroll_attach_source(capture_sys->aud_src);
+    audio_metrics_attach_source(capture_sys->aud_src);
     
     // Create capture system
     esp_capture_cfg_t cfg = {
@@ -0,0 +1,334 @@
+#include "audio_file_dev.h"
+#include <esp_log.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_timer.h"
+#include "esp_codec_dev.h"
+#include "audio_codec_data_if.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "memory_manager.h"
+
+static const char *TAG = "audio_file_dev";
+
+struct audio_file_dev {
+    audio_codec_data_if_t base;     // Must stay first: esp_codec_dev calls back with this pointer
+    esp_codec_dev_handle_t handle;
+    esp_codec_dev_type_t type;
+    audio_file_dev_cfg_t cfg;
+    char path[64];
+    FILE *f;
+    bool is_open;
+    bool eof;
+    audio_wav_info_t file_info;     // Layout stored in the file
+    esp_codec_dev_sample_info_t fs; // Layout requested by the consumer
+    uint32_t data_pos;              // Bytes of file PCM consumed / produced
+    uint64_t start_us;              // Realtime pacing origin
+    uint64_t paced_bytes;           // Consumer-side bytes since start_us
+    uint8_t *scratch;               // Channel conversion buffer
+    int scratch_size;
+};
+
+static int file_dev_open(const audio_codec_data_if_t *h, void *data_cfg, int cfg_size)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static bool file_dev_is_open(const audio_codec_data_if_t *h)
+{
+    return ((const audio_file_dev_t *)h)->is_open;
+}
+
+static int file_dev_enable(const audio_codec_data_if_t *h, esp_codec_dev_type_t dev_type, bool enable)
+{
+    audio_file_dev_t *dev = (audio_file_dev_t *)h;
+    if (enable) {
+        dev->start_us = 0;
+        dev->paced_bytes = 0;
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+static int file_dev_set_fmt(const audio_codec_data_if_t *h, esp_codec_dev_type_t dev_type,
+                            esp_codec_dev_sample_info_t *fs)
+{
+    audio_file_dev_t *dev = (audio_file_dev_t *)h;
+
+    if (dev->type == ESP_CODEC_DEV_TYPE_OUT) {
+        if (dev->data_pos > 0 &&
+            (fs->sample_rate != dev->file_info.sample_rate || fs->channel != dev->file_info.channels ||
+             fs->bits_per_sample != dev->file_info.bits_per_sample)) {
+            ESP_LOGW(TAG, "%s: format change after data was written, keeping %"PRIu32"Hz/%u ch",
+                     dev->path, dev->file_info.sample_rate, dev->file_info.channels);
+            return ESP_CODEC_DEV_NOT_SUPPORT;
+        }
+        dev->file_info.sample_rate = fs->sample_rate;
+        dev->file_info.channels = fs->channel;
+        dev->file_info.bits_per_sample = fs->bits_per_sample;
+        dev->fs = *fs;
+        return ESP_CODEC_DEV_OK;
+    }
+
+    if (fs->bits_per_sample != dev->file_info.bits_per_sample) {
+        ESP_LOGE(TAG, "%s: file is %u-bit, consumer wants %u-bit", dev->path,
+                 dev->file_info.bits_per_sample, fs->bits_per_sample);
+        return ESP_CODEC_DEV_NOT_SUPPORT;
+    }
+    if (fs->channel != dev->file_info.channels && fs->bits_per_sample != 16) {
+        ESP_LOGE(TAG, "%s: channel conversion only supported for 16-bit PCM", dev->path);
+        return ESP_CODEC_DEV_NOT_SUPPORT;
+    }
+    if (fs->sample_rate != dev->file_info.sample_rate) {
+        ESP_LOGW(TAG, "%s: file is %"PRIu32"Hz, consumer wants %"PRIu32"Hz (no resampling)",
+                 dev->path, dev->file_info.sample_rate, fs->sample_rate);
+    }
+    dev->fs = *fs;
+    return ESP_CODEC_DEV_OK;
+}
+
+// Sleep until the consumer is no further ahead of the wall clock than a real device would be
+static void file_dev_pace(audio_file_dev_t *dev, int size)
+{
+    uint32_t byte_rate = dev->fs.sample_rate * dev->fs.channel * (dev->fs.bits_per_sample / 8);
+    if (!dev->cfg.realtime || byte_rate == 0) {
+        return;
+    }
+    uint64_t now = esp_timer_get_time();
+    if (dev->start_us == 0) {
+        dev->start_us = now;
+    }
+    dev->paced_bytes += size;
+    uint64_t due = dev->start_us + dev->paced_bytes * 1000000ULL / byte_rate;
+    if (due > now + 1000) {
+        vTaskDelay(pdMS_TO_TICKS((due - now) / 1000));
+    }
+}
+
+static int file_dev_ensure_scratch(audio_file_dev_t *dev, int size)
+{
+    if (dev->scratch_size >= size) {
+        return ESP_CODEC_DEV_OK;
+    }
+    mem_free(dev->scratch);
+    dev->scratch = mem_alloc(size, MEM_POLICY_PREFER_PSRAM, "file_dev");
+    dev->scratch_size = dev->scratch ? size : 0;
+    return dev->scratch ? ESP_CODEC_DEV_OK : ESP_CODEC_DEV_DRV_ERR;
+}
+
+// Read file PCM, rewinding or zero-filling at the end of the data chunk
+static int file_dev_read_raw(audio_file_dev_t *dev, uint8_t *data, int size)
+{
+    int filled = 0;
+    while (filled < size) {
+        uint32_t left = dev->file_info.data_size - dev->data_pos;
+        if (left == 0) {
+            if (dev->cfg.loop && dev->file_info.data_size > 0) {
+                fseek(dev->f, dev->file_info.data_offset, SEEK_SET);
+                dev->data_pos = 0;
+                continue;
+            }
+            dev->eof = true;
+            memset(data + filled, 0, size - filled);
+            break;
+        }
+        int want = (size - filled) < (int)left ? (size - filled) : (int)left;
+        int got = fread(data + filled, 1, want, dev->f);
+        if (got <= 0) {
+            dev->file_info.data_size = dev->data_pos;  // Truncated file
+            continue;
+        }
+        filled += got;
+        dev->data_pos += got;
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+static int file_dev_read(const audio_codec_data_if_t *h, uint8_t *data, int size)
+{
+    audio_file_dev_t *dev = (audio_file_dev_t *)h;
+    if (!dev->is_open || dev->type != ESP_CODEC_DEV_TYPE_IN) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+
+    int out_ch = dev->fs.channel;
+    int in_ch = dev->file_info.channels;
+    if (out_ch == in_ch) {
+        file_dev_read_raw(dev, data, size);
+    } else {
+        // 16-bit up/down-mix between the file layout and the requested layout
+        int frames = size / (out_ch * 2);
+        int in_size = frames * in_ch * 2;
+        if (file_dev_ensure_scratch(dev, in_size) != ESP_CODEC_DEV_OK) {
+            return ESP_CODEC_DEV_DRV_ERR;
+        }
+        file_dev_read_raw(dev, dev->scratch, in_size);
+        const int16_t *src = (const int16_t *)dev->scratch;
+        int16_t *dst = (int16_t *)data;
+        for (int i = 0; i < frames; i++) {
+            int32_t sum = 0;
+            for (int c = 0; c < in_ch; c++) {
+                sum += src[i * in_ch + c];
+            }
+            int16_t sample = (int16_t)(sum / in_ch);
+            for (int c = 0; c < out_ch; c++) {
+                dst[i * out_ch + c] = sample;
+            }
+        }
+    }
+
+    file_dev_pace(dev, size);
+    return ESP_CODEC_DEV_OK;
+}
+
+static int file_dev_write(const audio_codec_data_if_t *h, uint8_t *data, int size)
+{
+    audio_file_dev_t *dev = (audio_file_dev_t *)h;
+    if (!dev->is_open || dev->type != ESP_CODEC_DEV_TYPE_OUT) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    if (dev->f == NULL) {
+        dev->data_pos += size;
+        file_dev_pace(dev, size);
+        return ESP_CODEC_DEV_OK;
+    }
+    if (dev->data_pos == 0 && dev->file_info.data_offset == 0) {
+        // First write: lay down a header with the negotiated format, sizes patched on close
+        if (audio_wav_write_header(dev->f, &dev->file_info) != ESP_OK) {
+            return ESP_CODEC_DEV_WRITE_FAIL;
+        }
+        dev->file_info.data_offset = ftell(dev->f);
+    }
+    if (fwrite(data, 1, size, dev->f) != (size_t)size) {
+        ESP_LOGE(TAG, "%s: write failed after %"PRIu32" bytes", dev->path, dev->data_pos);
+        return ESP_CODEC_DEV_WRITE_FAIL;
+    }
+    dev->data_pos += size;
+    file_dev_pace(dev, size);
+    return ESP_CODEC_DEV_OK;
+}
+
+static int file_dev_close(const audio_codec_data_if_t *h)
+{
+    return ESP_CODEC_DEV_OK;
+}
+
+static audio_file_dev_t *file_dev_create(const audio_file_dev_cfg_t *cfg, esp_codec_dev_type_t type)
+{
+    if (!cfg || !cfg->path || (type == ESP_CODEC_DEV_TYPE_IN && cfg->path[0] == '\0')) {
+        ESP_LOGE(TAG, "Invalid file device config");
+        return NULL;
+    }
+
+    audio_file_dev_t *dev = mem_calloc(1, sizeof(audio_file_dev_t), MEM_POLICY_PREFER_PSRAM, "file_dev");
+    if (!dev) {
+        return NULL;
+    }
+    dev->cfg = *cfg;
+    dev->type = type;
+    strncpy(dev->path, cfg->path, sizeof(dev->path) - 1);
+    dev->cfg.path = dev->path;
+
+    if (type == ESP_CODEC_DEV_TYPE_OUT && cfg->path[0] == '\0') {
+        // Discarding speaker: counts bytes but stores nothing
+        dev->f = NULL;
+    } else if ((dev->f = fopen(dev->path, type == ESP_CODEC_DEV_TYPE_IN ? "rb" : "w+b")) == NULL) {
+        ESP_LOGE(TAG, "Failed to open %s", dev->path);
+        mem_free(dev);
+        return NULL;
+    }
+    if (type == ESP_CODEC_DEV_TYPE_IN) {
+        if (audio_wav_read_header(dev->f, &dev->file_info) != ESP_OK) {
+            ESP_LOGE(TAG, "Not a PCM WAV file: %s", dev->path);
+            fclose(dev->f);
+            mem_free(dev);
+            return NULL;
+        }
+    }
+
+    dev->base.open = file_dev_open;
+    dev->base.is_open = file_dev_is_open;
+    dev->base.enable = file_dev_enable;
+    dev->base.set_fmt = file_dev_set_fmt;
+    dev->base.read = file_dev_read;
+    dev->base.write = file_dev_write;
+    dev->base.close = file_dev_close;
+    dev->is_open = true;
+
+    esp_codec_dev_cfg_t dev_cfg = {
+        .dev_type = type,
+        .data_if = &dev->base,
+    };
+    dev->handle = esp_codec_dev_new(&dev_cfg);
+    if (!dev->handle) {
+        ESP_LOGE(TAG, "Failed to create codec device for %s", dev->path);
+        if (dev->f) {
+            fclose(dev->f);
+        }
+        mem_free(dev);
+        return NULL;
+    }
+
+    ESP_LOGI(TAG, "%s device backed by %s", type == ESP_CODEC_DEV_TYPE_IN ? "Mic" : "Speaker",
+             dev->f ? dev->path : "(discard)");
+    return dev;
+}
+
+audio_file_dev_t *audio_file_dev_open_mic(const audio_file_dev_cfg_t *cfg)
+{
+    audio_file_dev_t *dev = file_dev_create(cfg, ESP_CODEC_DEV_TYPE_IN);
+    if (dev) {
+        ESP_LOGI(TAG, "Mic WAV: %"PRIu32"Hz, %u ch, %u bits, %"PRIu32" bytes",
+                 dev->file_info.sample_rate, dev->file_info.channels,
+                 dev->file_info.bits_per_sample, dev->file_info.data_size);
+    }
+    return dev;
+}
+
+audio_file_dev_t *audio_file_dev_open_speaker(const audio_file_dev_cfg_t *cfg)
+{
+    return file_dev_create(cfg, ESP_CODEC_DEV_TYPE_OUT);
+}
+
+esp_codec_dev_handle_t audio_file_dev_get_handle(audio_file_dev_t *dev)
+{
+    return dev ? dev->handle : NULL;
+}
+
+esp_err_t audio_file_dev_get_info(audio_file_dev_t *dev, audio_wav_info_t *info)
+{
+    if (!dev || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *info = dev->file_info;
+    if (dev->type == ESP_CODEC_DEV_TYPE_OUT) {
+        info->data_size = dev->data_pos;
+    }
+    return ESP_OK;
+}
+
+bool audio_file_dev_at_eof(audio_file_dev_t *dev)
+{
+    return dev ? dev->eof : true;
+}
+
+void audio_file_dev_close(audio_file_dev_t *dev)
+{
+    if (!dev) {
+        return;
+    }
+
+    esp_codec_dev_close(dev->handle);
+    esp_codec_dev_delete(dev->handle);
+    dev->is_open = false;
+
+    if (dev->type == ESP_CODEC_DEV_TYPE_OUT && dev->f && dev->data_pos > 0) {
+        dev->file_info.data_size = dev->data_pos;
+        audio_wav_write_header(dev->f, &dev->file_info);
+        ESP_LOGI(TAG, "Wrote %"PRIu32" bytes to %s", dev->data_pos, dev->path);
+    }
+    if (dev->f) {
+        fclose(dev->f);
+    }
+    mem_free(dev->scratch);
+    mem_free(dev);
+}
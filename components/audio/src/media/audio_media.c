@@ -0,0 +1,53 @@
+#include "audio_media.h"
+#include <esp_log.h>
+#include "codec_init.h"
+#include "sdkconfig.h"
+#ifdef CONFIG_AG_AUDIO_FILE_DEVICES
+#include "audio_file_dev.h"
+#endif
+
+#ifdef CONFIG_AG_AUDIO_FILE_DEVICES
+static const char *TAG = "audio_media";
+
+static audio_file_dev_t *file_mic = NULL;
+static audio_file_dev_t *file_speaker = NULL;
+#endif
+
+esp_codec_dev_handle_t audio_media_get_record_handle(void)
+{
+#ifdef CONFIG_AG_AUDIO_FILE_DEVICES
+    if (file_mic == NULL) {
+        audio_file_dev_cfg_t cfg = {
+            .path = CONFIG_AG_AUDIO_FILE_MIC_PATH,
+            .realtime = true,
+            .loop = true,
+        };
+        file_mic = audio_file_dev_open_mic(&cfg);
+        if (file_mic == NULL) {
+            ESP_LOGE(TAG, "File mic unavailable: %s", CONFIG_AG_AUDIO_FILE_MIC_PATH);
+        }
+    }
+    return audio_file_dev_get_handle(file_mic);
+#else
+    return get_record_handle();
+#endif
+}
+
+esp_codec_dev_handle_t audio_media_get_playback_handle(void)
+{
+#ifdef CONFIG_AG_AUDIO_FILE_DEVICES
+    if (file_speaker == NULL) {
+        audio_file_dev_cfg_t cfg = {
+            .path = CONFIG_AG_AUDIO_FILE_SPEAKER_PATH,
+            .realtime = true,
+        };
+        file_speaker = audio_file_dev_open_speaker(&cfg);
+        if (file_speaker == NULL) {
+            ESP_LOGE(TAG, "File speaker unavailable: %s", CONFIG_AG_AUDIO_FILE_SPEAKER_PATH);
+        }
+    }
+    return audio_file_dev_get_handle(file_speaker);
+#else
+    return get_playback_handle();
+#endif
+}
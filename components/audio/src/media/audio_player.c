@@ -7,12 +7,16 @@
 #include "esp_audio_dec_default.h"
 #include "sdkconfig.h"
 #include "audio_capture.h"
+#include "audio_wav.h"
+#include "board_module.h"
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "memory_manager.h"
+#include "audio_metrics.h"
+#include "audio_render_bridge.h"
 
 static const char *TAG = "audio_player";
 
@@ -26,15 +30,23 @@ esp_err_t audio_player_build_system(audio_player_system_t *player_sys)
     ESP_LOGI(TAG, "Building audio player system");
     
     i2s_render_cfg_t i2s_cfg = {
-        .play_handle = get_playback_handle(),
+        .play_handle = audio_media_get_playback_handle(),
     };
-    player_sys->audio_render = av_render_alloc_i2s_render(&i2s_cfg);
-    if (player_sys->audio_render == NULL) {
+    audio_render_handle_t i2s_render = av_render_alloc_i2s_render(&i2s_cfg);
+    if (i2s_render == NULL) {
         ESP_LOGE(TAG, "Failed to create audio render");
         return ESP_FAIL;
     }
-    
+    // Level/underrun telemetry sits between av_render and the I2S render
+    player_sys->audio_render = audio_metrics_wrap_render(i2s_render);
+#ifdef CONFIG_AG_WEBRTC_AUDIO_G711
+    // 8 kHz decoder output is upsampled right before the I2S render
+    player_sys->audio_render = audio_render_bridge_wrap(player_sys->audio_render);
+#endif
+    
+    board_module_i2c_lock();
     esp_codec_dev_set_out_vol(i2s_cfg.play_handle, CONFIG_AG_AUDIO_DEFAULT_PLAYBACK_VOL);
+    board_module_i2c_unlock();
     
     av_render_cfg_t render_cfg = {
         .audio_render = player_sys->audio_render,
@@ -48,10 +60,10 @@ esp_err_t audio_player_build_system(audio_player_system_t *player_sys)
         return ESP_FAIL;
     }
     
-    // Configure for WebRTC: 1 channel to match WebRTC OPUS configuration
+    // Configure for WebRTC: every stream is converted to the decoder output format
     av_render_audio_frame_info_t aud_info = {
-        .sample_rate = 24000,
-        .channel = 2,
+        .sample_rate = AUDIO_PLAYER_FRAME_RATE,
+        .channel = AUDIO_PLAYER_FRAME_CHANNELS,
         .bits_per_sample = 16,
     };
     av_render_set_fixed_frame_info(player_sys->player, &aud_info);
@@ -105,125 +117,161 @@ esp_err_t audio_player_reset(audio_player_system_t *player_sys)
     return ESP_OK;
 }
 
-// WAV Header structures
-typedef struct {
-    char     riff[4];          // "RIFF"
-    uint32_t file_size;        // File size - 8
-    char     wave[4];          // "WAVE"
-} __attribute__((packed)) wav_riff_header_t;
+esp_err_t audio_player_open_pcm_stream(audio_player_system_t *player_sys, uint32_t sample_rate,
+                                      uint8_t channels, uint8_t bits_per_sample)
+{
+    if (!player_sys || !player_sys->player) {
+        ESP_LOGE(TAG, "Invalid parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    // Raw PCM stream (WAV payloads and pre-loaded clips)
+    av_render_audio_info_t pcm_info = {
+        .codec = AV_RENDER_AUDIO_CODEC_PCM,
+        .sample_rate = sample_rate,
+        .channel = channels,
+        .bits_per_sample = bits_per_sample,
+    };
+    int ret = av_render_add_audio_stream(player_sys->player, &pcm_info);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to add audio stream: %d", ret);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
 
-typedef struct {
-    char     fmt[4];           // "fmt "
-    uint32_t fmt_size;         // Format chunk size
-    uint16_t audio_format;     // Audio format (1 = PCM)
-    uint16_t num_channels;     // Number of channels
-    uint32_t sample_rate;      // Sample rate
-    uint32_t byte_rate;        // Byte rate
-    uint16_t block_align;      // Block align
-    uint16_t bits_per_sample;  // Bits per sample
-} __attribute__((packed)) wav_fmt_chunk_t;
+esp_err_t audio_player_write_pcm(audio_player_system_t *player_sys, const uint8_t *data,
+                                 uint32_t size, uint32_t pts)
+{
+    av_render_audio_data_t audio_data = {
+        .pts = pts,
+        .data = (uint8_t *)data,
+        .size = size,
+        .eos = false,
+    };
+    
+    // Add audio data with retry while the render FIFO drains
+    int ret;
+    int retry_count = 0;
+    while ((ret = av_render_add_audio_data(player_sys->player, &audio_data)) != 0 && retry_count < 50) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+        retry_count++;
+    }
+    
+    if (ret != 0) {
+        ESP_LOGW(TAG, "Failed to add audio data");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
 
-typedef struct {
-    char     data[4];          // "data"
-    uint32_t data_size;        // Data size
-} __attribute__((packed)) wav_data_chunk_t;
+esp_err_t audio_player_close_pcm_stream(audio_player_system_t *player_sys, bool send_eos)
+{
+    if (!player_sys || !player_sys->player) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    if (send_eos) {
+        av_render_audio_data_t eos_data = { .eos = true };
+        av_render_add_audio_data(player_sys->player, &eos_data);
+    }
+    
+    av_render_flush(player_sys->player);
+    
+    // Reset player after playback - WebRTC will restore OPUS stream when it resumes
+    int ret = av_render_reset(player_sys->player);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "❌ Failed to reset player: %d", ret);
+        return ESP_FAIL;
+    }
+    ESP_LOGI(TAG, "✅ Player reset - WebRTC will restore OPUS stream on resume");
+    return ESP_OK;
+}
 
-esp_err_t audio_player_play_wav(audio_player_system_t *player_sys, const char *filename)
+esp_err_t audio_player_load_wav(const char *filename, uint32_t max_size, audio_pcm_clip_t *clip)
 {
-    if (!player_sys || !player_sys->player || !filename) {
-        ESP_LOGE(TAG, "Invalid parameters");
+    if (!filename || !clip) {
         return ESP_ERR_INVALID_ARG;
     }
     
-    ESP_LOGI(TAG, "🔊 Playing WAV file: %s", filename);
+    memset(clip, 0, sizeof(*clip));
     
-    // Open file
     FILE *f = fopen(filename, "rb");
     if (f == NULL) {
         ESP_LOGE(TAG, "Failed to open WAV file: %s", filename);
         return ESP_ERR_NOT_FOUND;
     }
     
-    // Read RIFF header
-    wav_riff_header_t riff_header;
-    if (fread(&riff_header, 1, sizeof(riff_header), f) != sizeof(riff_header)) {
-        ESP_LOGE(TAG, "Failed to read RIFF header");
+    audio_wav_info_t wav;
+    if (audio_wav_read_header(f, &wav) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to parse WAV file: %s", filename);
         fclose(f);
         return ESP_FAIL;
     }
+    if (max_size && wav.data_size > max_size) {
+        ESP_LOGW(TAG, "%s is %"PRIu32" bytes, over the %"PRIu32" byte preload limit",
+                 filename, wav.data_size, max_size);
+        fclose(f);
+        return ESP_ERR_INVALID_SIZE;
+    }
     
-    // Validate RIFF format
-    if (strncmp(riff_header.riff, "RIFF", 4) != 0 || strncmp(riff_header.wave, "WAVE", 4) != 0) {
-        ESP_LOGE(TAG, "Invalid WAV file format");
+    clip->data = mem_alloc(wav.data_size, MEM_POLICY_PREFER_PSRAM, "pcm_clip");
+    if (!clip->data) {
         fclose(f);
-        return ESP_FAIL;
+        return ESP_ERR_NO_MEM;
     }
+    clip->size = fread(clip->data, 1, wav.data_size, f);
+    clip->sample_rate = wav.sample_rate;
+    clip->channels = wav.channels;
+    clip->bits_per_sample = wav.bits_per_sample;
+    fclose(f);
     
-    // Find fmt and data chunks
-    wav_fmt_chunk_t fmt_chunk = {0};
-    wav_data_chunk_t data_chunk = {0};
-    bool fmt_found = false, data_found = false;
-    long data_start_pos = 0;
-    
-    // Try direct parsing first (fmt at offset 12)
-    fseek(f, 12, SEEK_SET);
-    char chunk_id[4];
-    uint32_t wav_chunk_size;
-    
-    if (fread(chunk_id, 1, 4, f) == 4 && strncmp(chunk_id, "fmt ", 4) == 0) {
-        if (fread(&wav_chunk_size, 1, 4, f) == 4 && wav_chunk_size >= 16) {
-            if (fread(&fmt_chunk.audio_format, 1, 16, f) == 16) {
-                memcpy(fmt_chunk.fmt, "fmt ", 4);
-                fmt_chunk.fmt_size = wav_chunk_size;
-                fmt_found = true;
-                
-                // Skip extra fmt data
-                if (wav_chunk_size > 16) {
-                    fseek(f, wav_chunk_size - 16, SEEK_CUR);
-                }
-                
-                // Look for data chunk
-                if (fread(chunk_id, 1, 4, f) == 4 && strncmp(chunk_id, "data", 4) == 0) {
-                    if (fread(&wav_chunk_size, 1, 4, f) == 4) {
-                        memcpy(data_chunk.data, "data", 4);
-                        data_chunk.data_size = wav_chunk_size;
-                        data_start_pos = ftell(f);
-                        data_found = true;
-                    }
-                }
-            }
-        }
+    ESP_LOGI(TAG, "Loaded %s: %"PRIu32"Hz, %d ch, %"PRIu32" bytes",
+             filename, clip->sample_rate, clip->channels, clip->size);
+    return ESP_OK;
+}
+
+void audio_player_free_clip(audio_pcm_clip_t *clip)
+{
+    if (clip) {
+        mem_free(clip->data);
+        memset(clip, 0, sizeof(*clip));
+    }
+}
+
+esp_err_t audio_player_play_wav(audio_player_system_t *player_sys, const char *filename)
+{
+    if (!player_sys || !player_sys->player || !filename) {
+        ESP_LOGE(TAG, "Invalid parameters");
+        return ESP_ERR_INVALID_ARG;
+    }
+    
+    ESP_LOGI(TAG, "🔊 Playing WAV file: %s", filename);
+    
+    // Open file
+    FILE *f = fopen(filename, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open WAV file: %s", filename);
+        return ESP_ERR_NOT_FOUND;
     }
     
-    if (!fmt_found || !data_found) {
-        ESP_LOGE(TAG, "Failed to parse WAV chunks");
+    audio_wav_info_t wav;
+    if (audio_wav_read_header(f, &wav) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to parse WAV file: %s", filename);
         fclose(f);
         return ESP_FAIL;
     }
     
     ESP_LOGI(TAG, "WAV: %"PRIu32"Hz, %d channels, %d bits, %"PRIu32" bytes", 
-                fmt_chunk.sample_rate, fmt_chunk.num_channels, 
-                fmt_chunk.bits_per_sample, data_chunk.data_size);
+                wav.sample_rate, wav.channels, wav.bits_per_sample, wav.data_size);
     
-    // Add WAV audio stream using PCM codec (WAV files contain raw PCM data)
-    av_render_audio_info_t wav_info = {
-        .codec = AV_RENDER_AUDIO_CODEC_PCM,
-        .sample_rate = fmt_chunk.sample_rate,
-        .channel = fmt_chunk.num_channels,
-        .bits_per_sample = fmt_chunk.bits_per_sample,
-    };
-    int ret = av_render_add_audio_stream(player_sys->player, &wav_info);
-    if (ret != 0) {
-        ESP_LOGE(TAG, "Failed to add audio stream: %d", ret);
+    if (audio_player_open_pcm_stream(player_sys, wav.sample_rate, wav.channels, wav.bits_per_sample) != ESP_OK) {
         fclose(f);
         return ESP_FAIL;
     }
     
-    // Stream audio data directly from file (memory efficient)
-    fseek(f, data_start_pos, SEEK_SET);
-    
     // Stream audio with timing (memory efficient - read chunks as needed)
-    uint32_t bytes_per_second = fmt_chunk.sample_rate * fmt_chunk.num_channels * (fmt_chunk.bits_per_sample / 8);
+    uint32_t bytes_per_second = wav.sample_rate * wav.channels * (wav.bits_per_sample / 8);
     const size_t chunk_size = (bytes_per_second * 20) / 1000; // 20ms chunks
     uint32_t bytes_sent = 0;
     uint32_t pts = 0;
@@ -233,11 +281,12 @@ esp_err_t audio_player_play_wav(audio_player_system_t *player_sys, const char *f
     if (!chunk_buffer) {
         ESP_LOGE(TAG, "Failed to allocate chunk buffer (%zu bytes)", chunk_size);
         fclose(f);
+        audio_player_close_pcm_stream(player_sys, false);
         return ESP_ERR_NO_MEM;
     }
     
-    while (bytes_sent < data_chunk.data_size) {
-        size_t remaining = data_chunk.data_size - bytes_sent;
+    while (bytes_sent < wav.data_size) {
+        size_t remaining = wav.data_size - bytes_sent;
         size_t current_chunk = (remaining > chunk_size) ? chunk_size : remaining;
         
         // Read chunk from file
@@ -246,28 +295,8 @@ esp_err_t audio_player_play_wav(audio_player_system_t *player_sys, const char *f
             // End of file reached
             break;
         }
-        if (bytes_read != current_chunk) {
-            // Last chunk might be smaller, that's normal
-            ESP_LOGI(TAG, "Last chunk: %zu bytes (expected %zu)", bytes_read, current_chunk);
-            current_chunk = bytes_read; // Adjust to actual bytes read
-        }
-        
-        av_render_audio_data_t audio_data = {
-            .pts = pts,
-            .data = chunk_buffer,
-            .size = bytes_read, // Use actual bytes read
-            .eos = false,
-        };
-        
-        // Add audio data with retry
-        int retry_count = 0;
-        while ((ret = av_render_add_audio_data(player_sys->player, &audio_data)) != 0 && retry_count < 50) {
-            vTaskDelay(pdMS_TO_TICKS(1));
-            retry_count++;
-        }
         
-        if (ret != 0) {
-            ESP_LOGW(TAG, "Failed to add audio data");
+        if (audio_player_write_pcm(player_sys, chunk_buffer, bytes_read, pts) != ESP_OK) {
             break;
         }
         
@@ -279,23 +308,11 @@ esp_err_t audio_player_play_wav(audio_player_system_t *player_sys, const char *f
     
     mem_free(chunk_buffer);
     
-    // Send EOS
-    av_render_audio_data_t eos_data = { .eos = true };
-    av_render_add_audio_data(player_sys->player, &eos_data);
-    
     // Close file after streaming
     fclose(f);
     
-    av_render_flush(player_sys->player);
-    
-    // Reset player after WAV playback - WebRTC will restore OPUS stream when it resumes
-    ret = av_render_reset(player_sys->player);
-    if (ret != 0) {
-        ESP_LOGE(TAG, "❌ Failed to reset player: %d", ret);
-    } else {
-        ESP_LOGI(TAG, "✅ Player reset - WebRTC will restore OPUS stream on resume");
-    }
+    audio_player_close_pcm_stream(player_sys, true);
     
     ESP_LOGI(TAG, "✅ WAV playback completed: %s", filename);
     return ESP_OK;
-}
\ No newline at end of file
+}
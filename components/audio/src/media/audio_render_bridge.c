@@ -0,0 +1,137 @@
+#include "audio_render_bridge.h"
+#include <esp_log.h>
+#include <string.h>
+#include "audio_resample.h"
+#include "memory_manager.h"
+
+static const char *TAG = "audio_bridge";
+
+#define BRIDGE_OUT_RATE         24000
+#define BRIDGE_OUT_CHANNELS     2
+
+typedef struct {
+    audio_render_handle_t inner;
+    av_render_audio_frame_info_t info;  // Format av_render writes in
+    audio_resample_x3_t resample;
+    bool upsample;
+    int16_t *scratch;
+    uint32_t scratch_size;
+} bridge_render_t;
+
+static audio_render_handle_t bridge_render_init(void *cfg, int size)
+{
+    if (cfg == NULL || size != sizeof(audio_render_handle_t)) {
+        return NULL;
+    }
+    bridge_render_t *bridge = mem_calloc(1, sizeof(bridge_render_t), MEM_POLICY_REQUIRE_INTERNAL, "audio_bridge");
+    if (bridge) {
+        bridge->inner = *(audio_render_handle_t *)cfg;
+    }
+    return bridge;
+}
+
+static int bridge_render_open(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    bridge_render_t *bridge = (bridge_render_t *)h;
+    bridge->info = *info;
+    bridge->upsample = info->bits_per_sample == 16 && info->channel <= 2 &&
+                       info->sample_rate * 3 == BRIDGE_OUT_RATE;
+    if (!bridge->upsample) {
+        return audio_render_open(bridge->inner, info);
+    }
+
+    audio_resample_x3_init(&bridge->resample, info->channel, BRIDGE_OUT_CHANNELS);
+    av_render_audio_frame_info_t out_info = {
+        .sample_rate = BRIDGE_OUT_RATE,
+        .channel = BRIDGE_OUT_CHANNELS,
+        .bits_per_sample = 16,
+    };
+    ESP_LOGI(TAG, "Bridging %lu Hz %u ch to %d Hz %d ch", (unsigned long)info->sample_rate,
+             info->channel, BRIDGE_OUT_RATE, BRIDGE_OUT_CHANNELS);
+    return audio_render_open(bridge->inner, &out_info);
+}
+
+static int bridge_render_write(audio_render_handle_t h, uint8_t *pcm_data, int pcm_size)
+{
+    bridge_render_t *bridge = (bridge_render_t *)h;
+    if (!bridge->upsample) {
+        return audio_render_write(bridge->inner, pcm_data, pcm_size);
+    }
+
+    uint32_t frames = pcm_size / (sizeof(int16_t) * bridge->info.channel);
+    uint32_t out_size = frames * 3 * BRIDGE_OUT_CHANNELS * sizeof(int16_t);
+    if (out_size > bridge->scratch_size) {
+        int16_t *scratch = mem_realloc(bridge->scratch, out_size, MEM_POLICY_REQUIRE_INTERNAL, "audio_bridge");
+        if (scratch == NULL) {
+            ESP_LOGE(TAG, "No memory for %lu byte bridge buffer", (unsigned long)out_size);
+            return -1;
+        }
+        bridge->scratch = scratch;
+        bridge->scratch_size = out_size;
+    }
+    audio_resample_x3_process(&bridge->resample, (const int16_t *)pcm_data, frames, bridge->scratch);
+    return audio_render_write(bridge->inner, (uint8_t *)bridge->scratch, out_size);
+}
+
+static int bridge_render_get_latency(audio_render_handle_t h, uint32_t *latency)
+{
+    return audio_render_get_latency(((bridge_render_t *)h)->inner, latency);
+}
+
+static int bridge_render_get_frame_info(audio_render_handle_t h, av_render_audio_frame_info_t *info)
+{
+    bridge_render_t *bridge = (bridge_render_t *)h;
+    if (bridge->upsample) {
+        // Report the format av_render writes, not the one the codec runs at
+        *info = bridge->info;
+        return 0;
+    }
+    return audio_render_get_frame_info(bridge->inner, info);
+}
+
+static int bridge_render_set_speed(audio_render_handle_t h, float speed)
+{
+    return audio_render_set_speed(((bridge_render_t *)h)->inner, speed);
+}
+
+static int bridge_render_close(audio_render_handle_t h)
+{
+    bridge_render_t *bridge = (bridge_render_t *)h;
+    bridge->upsample = false;
+    return audio_render_close(bridge->inner);
+}
+
+static void bridge_render_deinit(audio_render_handle_t h)
+{
+    bridge_render_t *bridge = (bridge_render_t *)h;
+    audio_render_free_handle(bridge->inner);
+    mem_free(bridge->scratch);
+    mem_free(bridge);
+}
+
+audio_render_handle_t audio_render_bridge_wrap(audio_render_handle_t render)
+{
+    if (render == NULL) {
+        return NULL;
+    }
+    audio_render_cfg_t cfg = {
+        .ops = {
+            .init = bridge_render_init,
+            .open = bridge_render_open,
+            .write = bridge_render_write,
+            .get_latency = bridge_render_get_latency,
+            .get_frame_info = bridge_render_get_frame_info,
+            .set_speed = bridge_render_set_speed,
+            .close = bridge_render_close,
+            .deinit = bridge_render_deinit,
+        },
+        .cfg = &render,
+        .cfg_size = sizeof(render),
+    };
+    audio_render_handle_t wrapped = audio_render_alloc_handle(&cfg);
+    if (wrapped == NULL) {
+        ESP_LOGW(TAG, "Render bridge unavailable, av_render will resample");
+        return render;
+    }
+    return wrapped;
+}
@@ -0,0 +1,45 @@
+/*
+ * Fixed-ratio PCM16 upsampler used by the G.711 render bridge
+ */
+
+#include "audio_resample.h"
+
+void audio_resample_x3_init(audio_resample_x3_t *rs, uint8_t in_channels, uint8_t out_channels)
+{
+    rs->last[0] = 0;
+    rs->last[1] = 0;
+    rs->in_channels = in_channels == 2 ? 2 : 1;
+    rs->out_channels = out_channels < rs->in_channels ? rs->in_channels : (out_channels == 2 ? 2 : 1);
+}
+
+size_t audio_resample_x3_process(audio_resample_x3_t *rs, const int16_t *in, size_t frames, int16_t *out)
+{
+    const int in_ch = rs->in_channels;
+    const int out_ch = rs->out_channels;
+
+    for (int ch = 0; ch < in_ch; ch++) {
+        int32_t prev = rs->last[ch];
+        const int16_t *src = in + ch;
+        int16_t *dst = out + ch;
+        for (size_t i = 0; i < frames; i++) {
+            int32_t cur = *src;
+            int32_t diff = cur - prev;
+            // Taps at 1/3, 2/3 and 3/3 of the way from the previous sample
+            dst[0] = (int16_t)(prev + diff / 3);
+            dst[out_ch] = (int16_t)(prev + diff * 2 / 3);
+            dst[2 * out_ch] = (int16_t)cur;
+            prev = cur;
+            src += in_ch;
+            dst += 3 * out_ch;
+        }
+        rs->last[ch] = (int16_t)prev;
+    }
+
+    if (out_ch > in_ch) {
+        // Mono to stereo: copy left into right
+        for (size_t i = 0; i < frames * 3; i++) {
+            out[2 * i + 1] = out[2 * i];
+        }
+    }
+    return frames * 3;
+}
@@ -0,0 +1,135 @@
+#include "audio_wav.h"
+#include <esp_log.h>
+#include <string.h>
+#include <inttypes.h>
+
+static const char *TAG = "audio_wav";
+
+// WAV Header structures
+typedef struct {
+    char     riff[4];          // "RIFF"
+    uint32_t file_size;        // File size - 8
+    char     wave[4];          // "WAVE"
+} __attribute__((packed)) wav_riff_header_t;
+
+typedef struct {
+    char     id[4];            // Chunk ID
+    uint32_t size;             // Chunk payload size
+} __attribute__((packed)) wav_chunk_header_t;
+
+typedef struct {
+    uint16_t audio_format;     // Audio format (1 = PCM)
+    uint16_t num_channels;     // Number of channels
+    uint32_t sample_rate;      // Sample rate
+    uint32_t byte_rate;        // Byte rate
+    uint16_t block_align;      // Block align
+    uint16_t bits_per_sample;  // Bits per sample
+} __attribute__((packed)) wav_fmt_body_t;
+
+#define WAV_FORMAT_PCM 1
+
+esp_err_t audio_wav_read_header(FILE *f, audio_wav_info_t *info)
+{
+    if (!f || !info) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    memset(info, 0, sizeof(*info));
+
+    // File length, used to clamp streamed/placeholder data sizes
+    fseek(f, 0, SEEK_END);
+    long file_len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    wav_riff_header_t riff_header;
+    if (fread(&riff_header, 1, sizeof(riff_header), f) != sizeof(riff_header) ||
+        strncmp(riff_header.riff, "RIFF", 4) != 0 || strncmp(riff_header.wave, "WAVE", 4) != 0) {
+        ESP_LOGE(TAG, "Invalid WAV file format");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    bool fmt_found = false;
+    wav_chunk_header_t chunk;
+    while (fread(&chunk, 1, sizeof(chunk), f) == sizeof(chunk)) {
+        if (strncmp(chunk.id, "fmt ", 4) == 0) {
+            wav_fmt_body_t fmt;
+            if (chunk.size < sizeof(fmt) || fread(&fmt, 1, sizeof(fmt), f) != sizeof(fmt)) {
+                ESP_LOGE(TAG, "Truncated fmt chunk");
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (fmt.audio_format != WAV_FORMAT_PCM) {
+                ESP_LOGE(TAG, "Unsupported WAV format %u (only PCM)", fmt.audio_format);
+                return ESP_ERR_NOT_SUPPORTED;
+            }
+            info->sample_rate = fmt.sample_rate;
+            info->channels = fmt.num_channels;
+            info->bits_per_sample = fmt.bits_per_sample;
+            fmt_found = true;
+
+            // Skip extra fmt data (chunks are word aligned)
+            long extra = (long)chunk.size - (long)sizeof(fmt) + (chunk.size & 1);
+            if (extra > 0) {
+                fseek(f, extra, SEEK_CUR);
+            }
+        } else if (strncmp(chunk.id, "data", 4) == 0) {
+            if (!fmt_found) {
+                ESP_LOGE(TAG, "data chunk before fmt chunk");
+                return ESP_ERR_INVALID_ARG;
+            }
+            info->data_offset = ftell(f);
+            long available = file_len - info->data_offset;
+            info->data_size = (available >= 0 && chunk.size > (uint32_t)available) ?
+                              (uint32_t)available : chunk.size;
+            return ESP_OK;
+        } else {
+            // LIST, fact, etc.
+            fseek(f, (long)chunk.size + (chunk.size & 1), SEEK_CUR);
+        }
+    }
+
+    ESP_LOGE(TAG, "Failed to parse WAV chunks");
+    return ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t audio_wav_write_header(FILE *f, const audio_wav_info_t *info)
+{
+    if (!f || !info || info->bits_per_sample == 0 || info->channels == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint16_t block_align = info->channels * (info->bits_per_sample / 8);
+    wav_riff_header_t riff_header = {
+        .riff = {'R', 'I', 'F', 'F'},
+        .file_size = 36 + info->data_size,
+        .wave = {'W', 'A', 'V', 'E'},
+    };
+    wav_chunk_header_t fmt_header = {
+        .id = {'f', 'm', 't', ' '},
+        .size = sizeof(wav_fmt_body_t),
+    };
+    wav_fmt_body_t fmt = {
+        .audio_format = WAV_FORMAT_PCM,
+        .num_channels = info->channels,
+        .sample_rate = info->sample_rate,
+        .byte_rate = info->sample_rate * block_align,
+        .block_align = block_align,
+        .bits_per_sample = info->bits_per_sample,
+    };
+    wav_chunk_header_t data_header = {
+        .id = {'d', 'a', 't', 'a'},
+        .size = info->data_size,
+    };
+
+    fseek(f, 0, SEEK_SET);
+    if (fwrite(&riff_header, 1, sizeof(riff_header), f) != sizeof(riff_header) ||
+        fwrite(&fmt_header, 1, sizeof(fmt_header), f) != sizeof(fmt_header) ||
+        fwrite(&fmt, 1, sizeof(fmt), f) != sizeof(fmt) ||
+        fwrite(&data_header, 1, sizeof(data_header), f) != sizeof(data_header)) {
+        ESP_LOGE(TAG, "Failed to write WAV header");
+        return ESP_FAIL;
+    }
+
+    ESP_LOGD(TAG, "WAV header: %"PRIu32"Hz, %u ch, %u bits, %"PRIu32" bytes",
+             info->sample_rate, info->channels, info->bits_per_sample, info->data_size);
+    return ESP_OK;
+}
@@ -27,6 +27,20 @@ extern "C" {
  */
 esp_err_t board_module_init(void);
 
+/**
+ * @brief Take the board I2C bus shared by the codec and the camera SCCB
+ *
+ * Both drive the port 0 pins, so codec control and sensor power up
+ * must not overlap. Blocks until the bus is free; a no-op before
+ * board_module_init().
+ */
+void board_module_i2c_lock(void);
+
+/**
+ * @brief Release the bus taken by board_module_i2c_lock()
+ */
+void board_module_i2c_unlock(void);
+
 #ifdef __cplusplus
 }
 #endif
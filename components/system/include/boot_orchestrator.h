@@ -0,0 +1,71 @@
+#ifndef BOOT_ORCHESTRATOR_H
+#define BOOT_ORCHESTRATOR_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Dependency-driven parallel boot
+ *
+ * Each step names the steps it needs; a step starts as soon as all of them
+ * have finished. One worker per core picks up ready steps, so independent
+ * initialization (WiFi association next to codec and camera bring-up) runs
+ * concurrently. Dependencies must name earlier steps, which keeps the graph
+ * acyclic by construction.
+ */
+
+#define BOOT_MAX_STEPS          16
+#define BOOT_MAX_DEPS           6
+#define BOOT_CORE_ANY           -1
+
+typedef struct {
+    const char *name;
+    esp_err_t (*init)(void);
+    const char *deps[BOOT_MAX_DEPS];    // Names of earlier steps, unused slots NULL
+    int core;                           // BOOT_CORE_ANY, 0 or 1
+} boot_step_t;
+
+typedef struct {
+    const char *name;
+    int core;                           // Core the step ran on
+    uint32_t ready_ms;                  // Since power-on: last dependency finished
+    uint32_t start_ms;
+    uint32_t end_ms;
+    esp_err_t result;
+    bool ran;
+} boot_step_timing_t;
+
+/**
+ * @brief Run the steps and wait until all have finished
+ *
+ * A failing step stops further steps from starting; steps already running
+ * are waited for.
+ * @param steps Step table
+ * @param count Number of steps, at most BOOT_MAX_STEPS
+ * @return ESP_OK, the first step error, or ESP_ERR_INVALID_ARG for a bad table
+ */
+esp_err_t boot_orchestrator_run(const boot_step_t *steps, int count);
+
+/**
+ * @brief Copy per-step timing of the last run
+ * @param timings Output array
+ * @param max Capacity of timings
+ * @return Number of steps copied
+ */
+int boot_orchestrator_get_timings(boot_step_timing_t *timings, int max);
+
+/**
+ * @brief Print the step timing table
+ */
+void boot_orchestrator_print(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // BOOT_ORCHESTRATOR_H
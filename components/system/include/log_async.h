@@ -0,0 +1,96 @@
+#ifndef LOG_ASYNC_H
+#define LOG_ASYNC_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Asynchronous, rate-limited log output
+ *
+ * Installed as the esp_log output function. A task logging with ESP_LOGx
+ * only formats the line into a ring buffer and returns; a low-priority
+ * drain task writes the ring to the console UART. Lines that do not fit
+ * are dropped and counted instead of blocking the caller.
+ *
+ * Tags can get a token-bucket limit (lines per second plus a burst). Info,
+ * debug and verbose lines over the limit are dropped and counted per tag;
+ * warnings and errors always pass. Limits come from
+ * CONFIG_AG_LOG_ASYNC_LIMITS and can be changed with the `log` command.
+ *
+ * Output stays synchronous from ISRs, before the scheduler runs and after
+ * log_async_set_enabled(false). Pending lines are flushed on esp_restart(),
+ * and the panic handler writes them to the ROM console before the backtrace.
+ */
+
+#define LOG_ASYNC_MAX_LIMITS    16
+#define LOG_ASYNC_TAG_LEN       16
+
+typedef struct {
+    char tag[LOG_ASYNC_TAG_LEN];
+    uint16_t per_sec;
+    uint16_t burst;
+    uint32_t passed;
+    uint32_t dropped;
+} log_async_limit_t;
+
+typedef struct {
+    bool enabled;
+    uint32_t buffer_size;
+    uint32_t buffer_used;
+    uint32_t buffer_peak;
+    uint32_t lines;             // Queued since init
+    uint32_t dropped_full;      // Ring had no room
+    uint32_t dropped_rate;      // Over a tag limit
+} log_async_status_t;
+
+/**
+ * @brief Allocate the ring, start the drain task and take over esp_log output
+ * @return ESP_OK, ESP_ERR_NO_MEM, or ESP_ERR_NOT_SUPPORTED without CONFIG_AG_LOG_ASYNC_ENABLE
+ */
+esp_err_t log_async_init(void);
+
+/**
+ * @brief Switch between ring output and the original synchronous output
+ *
+ * Switching to synchronous drains the ring first, so lines stay in order.
+ */
+void log_async_set_enabled(bool enabled);
+
+/**
+ * @brief Set the limit for one tag
+ * @param tag Tag as passed to ESP_LOGx
+ * @param per_sec Lines per second; 0 removes the limit
+ * @param burst Lines allowed at once after a quiet period; 0 means per_sec
+ * @return ESP_OK, ESP_ERR_NO_MEM if LOG_ASYNC_MAX_LIMITS tags are limited
+ */
+esp_err_t log_async_set_limit(const char *tag, uint16_t per_sec, uint16_t burst);
+
+/**
+ * @brief Current limits with their pass and drop counts
+ * @param limits Output array
+ * @param max Entries in limits
+ * @return Number of entries written
+ */
+int log_async_get_limits(log_async_limit_t *limits, int max);
+
+/**
+ * @brief Buffer and drop counters
+ * @param status Output
+ */
+void log_async_get_status(log_async_status_t *status);
+
+/**
+ * @brief Write out everything queued, from the calling task
+ */
+void log_async_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // LOG_ASYNC_H
@@ -53,6 +53,13 @@ typedef enum {
     MEM_POLICY_ADAPTIVE          // Adjust based on current memory
 } memory_policy_t;
 
+// System-wide heap allocation counters (fed by heap hooks when CONFIG_HEAP_USE_HOOKS=y)
+typedef struct {
+    uint32_t allocs;
+    uint32_t frees;
+    uint32_t alloc_bytes;    // Wraps; use deltas
+} mem_heap_counters_t;
+
 // Initialize memory manager
 esp_err_t memory_manager_init(void);
 
@@ -73,6 +80,13 @@ void memory_manager_get_status(memory_status_t* status);
 void memory_manager_print_status(void);
 void memory_manager_print_tasks(void);
 
+// Refresh the heap and CPU load gauges in the metrics registry (no task walk, no allocation)
+void memory_manager_refresh_metrics(void);
+
+// Allocation statistics: mm_alloc calls/failures, and raw heap counters
+void memory_manager_get_alloc_stats(uint32_t* count, uint32_t* failures);
+bool memory_manager_get_heap_counters(mem_heap_counters_t* counters);
+
 // Monitoring and alerts
 bool memory_manager_check_pressure(void);
 esp_err_t memory_manager_adjust_for_pressure(void);
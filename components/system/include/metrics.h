@@ -0,0 +1,157 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Process-wide metrics registry
+ *
+ * Modules register counters, gauges and fixed-bucket histograms once, keep
+ * the returned handle, and update it from their hot paths. An update is a
+ * single 32-bit atomic (two for a histogram), so it never locks and is safe
+ * from any task. `metrics` dumps the registry on the console and
+ * metrics_export_text() renders it in the Prometheus text format.
+ *
+ * Names follow Prometheus conventions: module_thing_unit, with _total for
+ * counters. Names and help strings are kept by pointer and must be static.
+ * Every update helper accepts NULL, so a failed registration (registry full)
+ * only loses that metric.
+ */
+
+#define METRICS_MAX             64
+#define METRICS_MAX_HISTOGRAMS  16
+#define METRICS_MAX_BUCKETS     10
+
+typedef enum {
+    METRIC_COUNTER,             // Only goes up; wraps at 2^32
+    METRIC_GAUGE,               // Signed value that is set or moved
+    METRIC_HISTOGRAM,           // Observations counted in fixed buckets
+} metric_type_t;
+
+typedef struct {
+    uint8_t bucket_count;
+    uint32_t bounds[METRICS_MAX_BUCKETS];       // Upper bounds, ascending
+    uint32_t buckets[METRICS_MAX_BUCKETS + 1];  // Per bucket, last one above every bound
+    uint32_t sum;
+} metric_histogram_t;
+
+typedef struct {
+    const char *name;
+    const char *help;
+    metric_type_t type;
+    uint32_t value;             // Counter, or gauge as int32_t
+    metric_histogram_t *hist;
+} metric_t;
+
+/**
+ * @brief Register a counter, or return the one registered under this name
+ * @param name Metric name
+ * @param help One-line description
+ * @return Handle, NULL if the registry is full
+ */
+metric_t *metrics_counter(const char *name, const char *help);
+
+/**
+ * @brief Register a gauge, or return the one registered under this name
+ * @param name Metric name
+ * @param help One-line description
+ * @return Handle, NULL if the registry is full
+ */
+metric_t *metrics_gauge(const char *name, const char *help);
+
+/**
+ * @brief Register a histogram, or return the one registered under this name
+ * @param name Metric name
+ * @param help One-line description
+ * @param bounds Bucket upper bounds, ascending
+ * @param count Number of bounds, at most METRICS_MAX_BUCKETS
+ * @return Handle, NULL if the registry is full or the bounds are invalid
+ */
+metric_t *metrics_histogram(const char *name, const char *help, const uint32_t *bounds, int count);
+
+/**
+ * @brief Find a registered metric
+ * @param name Metric name
+ * @return Handle, NULL if not registered
+ */
+metric_t *metrics_find(const char *name);
+
+static inline void metric_add(metric_t *m, uint32_t n)
+{
+    if (m) {
+        __atomic_fetch_add(&m->value, n, __ATOMIC_RELAXED);
+    }
+}
+
+static inline void metric_inc(metric_t *m)
+{
+    metric_add(m, 1);
+}
+
+static inline void metric_set(metric_t *m, int32_t value)
+{
+    if (m) {
+        __atomic_store_n(&m->value, (uint32_t)value, __ATOMIC_RELAXED);
+    }
+}
+
+static inline uint32_t metric_get(const metric_t *m)
+{
+    return m ? __atomic_load_n(&m->value, __ATOMIC_RELAXED) : 0;
+}
+
+/**
+ * @brief Count one observation in a histogram
+ * @param m Histogram handle
+ * @param value Observed value, in the unit of the bounds
+ */
+void metric_observe(metric_t *m, uint32_t value);
+
+/**
+ * @brief Number of observations in a histogram
+ * @param m Histogram handle
+ * @return Sum of all buckets
+ */
+uint32_t metric_histogram_count(const metric_t *m);
+
+/**
+ * @brief Print metrics on the console
+ * @param prefix Only names starting with this, NULL for all
+ */
+void metrics_print(const char *prefix);
+
+/**
+ * @brief Render every metric in the Prometheus text exposition format
+ *
+ * Like snprintf: writes at most size - 1 characters plus a terminator and
+ * returns the length the full text needs.
+ * @param buf Output buffer, may be NULL when size is 0
+ * @param size Capacity of buf
+ * @return Length of the complete text
+ */
+size_t metrics_export_text(char *buf, size_t size);
+
+/**
+ * @brief Render every metric as one flat JSON object
+ *
+ * Counters and gauges map to numbers; a histogram maps to its count, sum
+ * and the p50/p90 bucket bounds (null above the last bound). Same return
+ * convention as metrics_export_text().
+ * @param buf Output buffer, may be NULL when size is 0
+ * @param size Capacity of buf
+ * @return Length of the complete text
+ */
+size_t metrics_export_json(char *buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // METRICS_H
@@ -0,0 +1,76 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Statistical sampling profiler
+ *
+ * A general-purpose timer on each core interrupts at CONFIG_AG_PROF_SAMPLE_HZ
+ * and records the interrupted PC and task into a PSRAM buffer, until the
+ * requested duration fills it. The PC is read from the exception frame the
+ * interrupt entry saved on the task's stack, so no JTAG probe is needed.
+ *
+ * profiler_dump() prints the samples, counted per task and PC, as PROF
+ * lines. tools/prof/prof_report.py symbolizes them against the build's ELF
+ * and lists the hot functions.
+ */
+
+#define PROF_MAX_CORES          2
+
+typedef struct {
+    bool running;
+    uint32_t sample_hz;
+    uint32_t capacity;                  // Samples per core
+    uint32_t samples[PROF_MAX_CORES];   // Recorded per core
+    uint32_t nested[PROF_MAX_CORES];    // Skipped: the timer interrupted another ISR
+    uint32_t tasks;                     // Distinct tasks seen
+} profiler_status_t;
+
+/**
+ * @brief Start sampling; earlier samples are discarded
+ * @param seconds Sampling time; sampling stops by itself when it has passed
+ * @return ESP_OK, ESP_ERR_NO_MEM, or ESP_ERR_NOT_SUPPORTED without CONFIG_AG_PROF_ENABLE
+ */
+esp_err_t profiler_start(uint32_t seconds);
+
+/**
+ * @brief Stop sampling early; the samples are kept for profiler_dump()
+ */
+void profiler_stop(void);
+
+/**
+ * @brief Sampling state and counts
+ * @param status Output
+ */
+void profiler_get_status(profiler_status_t *status);
+
+/**
+ * @brief Stop sampling and print the samples as PROF lines on stdout
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if nothing was sampled
+ */
+esp_err_t profiler_dump(void);
+
+/**
+ * @brief Self-check: profile a short busy loop and require samples
+ *
+ * Spins on the calling task for a fraction of a second with the timers
+ * running. A run without a single sample means the alarm handler drops
+ * every tick; earlier samples are discarded.
+ * @param status Output counts of the check run, may be NULL
+ * @return ESP_OK if samples were recorded, ESP_FAIL if none,
+ *         ESP_ERR_NOT_SUPPORTED without CONFIG_AG_PROF_ENABLE
+ */
+esp_err_t profiler_check(profiler_status_t *status);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // PROFILER_H
@@ -0,0 +1,93 @@
+#ifndef STRESS_SCENARIO_H
+#define STRESS_SCENARIO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <esp_err.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Mixed-workload stress scenario with pass/fail SLOs
+ *
+ * Runs synthetic versions of the device's concurrent work for a fixed time,
+ * each in its own task with the priority and core of the real one:
+ * - audio: 20 ms frames through a calibrated Opus-sized encode kernel
+ * - vision: frame captures into PSRAM and base64 encodes at a frame rate
+ * - preview: MJPEG clients, each frame copied out in HTTP-sized chunks
+ * - data channel: realtime JSON events parsed at a message rate; every
+ *   turn_interval_ms one asks for a vision capture and the reply is built
+ *   as a conversation.item.create, timing the whole turn
+ *
+ * Only FreeRTOS, esp_timer, cJSON and mbedtls are used, so the same
+ * scenario runs on the device and on the Linux target.
+ */
+
+typedef struct {
+    uint32_t duration_s;
+    uint32_t audio_streams;         // 20 ms encode loops, 0 = off
+    uint32_t audio_encode_us;       // Kernel cost per frame on an idle core
+    uint32_t vision_fps;            // Captures + base64 per second, 0 = off
+    uint32_t frame_kb;              // Synthetic JPEG size
+    uint32_t preview_clients;       // 0 = off
+    uint32_t preview_fps;
+    uint32_t dc_msgs_per_s;         // Data channel events per second, 0 = off
+    uint32_t turn_interval_ms;      // Vision turns, 0 = off
+    // SLOs
+    uint32_t slo_audio_miss_permille;
+    uint32_t slo_turn_p95_ms;
+    uint32_t slo_heap_drift_kb;
+} stress_scenario_cfg_t;
+
+typedef struct {
+    uint32_t duration_ms;
+    uint32_t audio_frames;
+    uint32_t audio_misses;          // Frames that finished after their 20 ms period
+    uint32_t audio_late_max_us;     // Worst finish past the frame release
+    uint32_t vision_frames;
+    uint32_t vision_failures;       // Allocation or encode failed
+    uint32_t preview_frames;        // Frames sent, summed over clients
+    uint32_t dc_messages;
+    uint32_t dc_max_us;             // Worst single message parse
+    uint32_t turns;
+    uint32_t turn_p50_ms;
+    uint32_t turn_p95_ms;
+    uint32_t turn_max_ms;
+    int32_t heap_drift_bytes;       // Free heap before - after; positive is a leak
+    uint32_t heap_min_free_kb;      // Lowest free heap seen during the run
+    bool audio_pass;
+    bool turn_pass;
+    bool heap_pass;
+    bool pass;
+} stress_scenario_result_t;
+
+/**
+ * @brief Defaults from Kconfig (CONFIG_AG_STRESS_*)
+ * @param cfg Output
+ */
+void stress_scenario_default_cfg(stress_scenario_cfg_t *cfg);
+
+/**
+ * @brief Run the scenario to completion; blocks for cfg->duration_s plus a short drain
+ * @param cfg Scenario configuration
+ * @param result Measurements and SLO verdicts
+ * @return ESP_OK when the scenario ran (check result->pass), ESP_ERR_INVALID_STATE
+ *         if one is already running, ESP_ERR_NO_MEM, ESP_ERR_NOT_SUPPORTED
+ *         without CONFIG_AG_STRESS_ENABLE
+ */
+esp_err_t stress_scenario_run(const stress_scenario_cfg_t *cfg, stress_scenario_result_t *result);
+
+/**
+ * @brief Print the measurements with PASS/FAIL per SLO
+ * @param cfg Configuration the scenario ran with
+ * @param result Results from stress_scenario_run()
+ */
+void stress_scenario_print_result(const stress_scenario_cfg_t *cfg, const stress_scenario_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // STRESS_SCENARIO_H
@@ -0,0 +1,93 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Timeline tracer
+ *
+ * Begin/end/instant events go into one fixed-size ring per core, with the
+ * CPU cycle counter as timestamp (esp_timer microseconds when power
+ * management may change the clock). Recording reserves a slot with one
+ * atomic add, so it never locks and works from any task. Rings are
+ * allocated on the first trace_start() and the oldest events are
+ * overwritten once full.
+ *
+ * trace_export_json() writes the Chrome trace_event format, which opens in
+ * Perfetto (ui.perfetto.dev) or chrome://tracing, one row per task.
+ *
+ * Record through the TRACE_* macros: they compile to nothing without
+ * CONFIG_AG_TRACE_ENABLE (off in sdkconfig.production). Event names are
+ * kept by pointer and must be static strings.
+ */
+
+#define TRACE_MAX_CORES         2
+
+typedef enum {
+    TRACE_PHASE_BEGIN = 'B',
+    TRACE_PHASE_END = 'E',
+    TRACE_PHASE_INSTANT = 'i',
+} trace_phase_t;
+
+typedef struct {
+    bool running;
+    uint32_t capacity;                  // Events per core
+    uint32_t recorded[TRACE_MAX_CORES]; // Per core since trace_start, including overwritten ones
+} trace_status_t;
+
+/**
+ * @brief Sink for trace_export_json()
+ * @return 0 to continue, anything else to abort the export
+ */
+typedef int (*trace_write_t)(const char *data, size_t len, void *ctx);
+
+void trace_record(trace_phase_t phase, const char *name);
+
+#if CONFIG_AG_TRACE_ENABLE
+#define TRACE_BEGIN(name)       trace_record(TRACE_PHASE_BEGIN, name)
+#define TRACE_END(name)         trace_record(TRACE_PHASE_END, name)
+#define TRACE_INSTANT(name)     trace_record(TRACE_PHASE_INSTANT, name)
+#else
+#define TRACE_BEGIN(name)       do { } while (0)
+#define TRACE_END(name)         do { } while (0)
+#define TRACE_INSTANT(name)     do { } while (0)
+#endif
+
+/**
+ * @brief Clear the rings and start recording
+ * @return ESP_OK, ESP_ERR_NO_MEM, or ESP_ERR_NOT_SUPPORTED without CONFIG_AG_TRACE_ENABLE
+ */
+esp_err_t trace_start(void);
+
+/**
+ * @brief Stop recording; the rings keep their events for export
+ */
+void trace_stop(void);
+
+/**
+ * @brief Recording state and event counts
+ * @param status Output
+ */
+void trace_get_status(trace_status_t *status);
+
+/**
+ * @brief Stop recording and write the rings as Chrome trace_event JSON
+ * @param write Called with consecutive pieces of the document
+ * @param ctx Passed to write
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if nothing was recorded, ESP_FAIL if write aborted
+ */
+esp_err_t trace_export_json(trace_write_t write, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TRACE_H
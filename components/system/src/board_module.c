@@ -1,5 +1,7 @@
 #include "board_module.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 #include "codec_board.h"
 #include "codec_init.h"
 #include "sdkconfig.h"
@@ -9,6 +11,7 @@ static const char *TAG = "board_module";
 // Module state
 static struct {
     bool initialized;
+    SemaphoreHandle_t i2c_lock;     // Codec control and camera SCCB share port 0
 } board_state = {0};
 
 esp_err_t board_module_init(void)
@@ -20,6 +23,14 @@ esp_err_t board_module_init(void)
     
     ESP_LOGI(TAG, "Initializing board hardware peripherals");
     
+    if (!board_state.i2c_lock) {
+        board_state.i2c_lock = xSemaphoreCreateMutex();
+        if (!board_state.i2c_lock) {
+            ESP_LOGE(TAG, "Failed to create I2C bus lock");
+            return ESP_ERR_NO_MEM;
+        }
+    }
+
     // Set codec board type for hardware configuration
     set_codec_board_type(CONFIG_AG_SYSTEM_BOARD_NAME);
     
@@ -44,3 +55,17 @@ esp_err_t board_module_init(void)
     ESP_LOGI(TAG, "Board hardware peripherals initialized successfully");
     return ESP_OK;
 }
+
+void board_module_i2c_lock(void)
+{
+    if (board_state.i2c_lock) {
+        xSemaphoreTake(board_state.i2c_lock, portMAX_DELAY);
+    }
+}
+
+void board_module_i2c_unlock(void)
+{
+    if (board_state.i2c_lock) {
+        xSemaphoreGive(board_state.i2c_lock);
+    }
+}
@@ -0,0 +1,243 @@
+#include "boot_orchestrator.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "media_lib_os.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "boot";
+
+#define BOOT_MAX_WORKERS        2
+#define BOOT_BIT_WAKE(core)     (BIT0 << (core))    // Per worker: something finished
+#define BOOT_BIT_WAKE_ALL       (BOOT_BIT_WAKE(0) | BOOT_BIT_WAKE(1))
+#define BOOT_BIT_DONE           BIT2
+
+// Orchestrator state; the lock guards the masks and the timing table
+static struct {
+    portMUX_TYPE lock;
+    const boot_step_t *steps;
+    int count;
+    uint32_t deps[BOOT_MAX_STEPS];  // Bit per step index
+    uint32_t started;
+    uint32_t done;
+    esp_err_t error;
+    int workers;
+    int running_workers;
+    EventGroupHandle_t events;
+    uint32_t start_ms;
+    uint32_t end_ms;
+    boot_step_timing_t timings[BOOT_MAX_STEPS];
+} boot_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+static int find_step(const boot_step_t *steps, int count, const char *name)
+{
+    for (int i = 0; i < count; i++) {
+        if (strcmp(steps[i].name, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Call with the lock held; -1 when nothing is ready for this core
+static int pick_step(int core)
+{
+    if (boot_state.error != ESP_OK) {
+        return -1;
+    }
+    for (int i = 0; i < boot_state.count; i++) {
+        uint32_t bit = 1u << i;
+        int want = boot_state.steps[i].core;
+        if ((boot_state.started & bit) || (boot_state.deps[i] & ~boot_state.done)) {
+            continue;
+        }
+        if (want == BOOT_CORE_ANY || want == core || boot_state.workers == 1) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Call with the lock held
+static bool all_finished(void)
+{
+    if (boot_state.started & ~boot_state.done) {
+        return false;
+    }
+    return boot_state.error != ESP_OK || boot_state.done == (1u << boot_state.count) - 1;
+}
+
+static void boot_worker(void *arg)
+{
+    int core = (int)(intptr_t)arg;
+    while (true) {
+        // Clear before looking, so a step finishing meanwhile still wakes us
+        xEventGroupClearBits(boot_state.events, BOOT_BIT_WAKE(core));
+        taskENTER_CRITICAL(&boot_state.lock);
+        if (all_finished()) {
+            taskEXIT_CRITICAL(&boot_state.lock);
+            break;
+        }
+        int index = pick_step(core);
+        if (index >= 0) {
+            boot_state.started |= 1u << index;
+            boot_state.timings[index].core = core;
+            boot_state.timings[index].start_ms = now_ms();
+            boot_state.timings[index].ran = true;
+        }
+        taskEXIT_CRITICAL(&boot_state.lock);
+        if (index < 0) {
+            xEventGroupWaitBits(boot_state.events, BOOT_BIT_WAKE(core), pdFALSE, pdFALSE, portMAX_DELAY);
+            continue;
+        }
+
+        const boot_step_t *step = &boot_state.steps[index];
+        esp_err_t ret = step->init();
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Step '%s' failed: %s", step->name, esp_err_to_name(ret));
+        }
+
+        taskENTER_CRITICAL(&boot_state.lock);
+        boot_state.timings[index].end_ms = now_ms();
+        boot_state.timings[index].result = ret;
+        boot_state.done |= 1u << index;
+        if (ret != ESP_OK && boot_state.error == ESP_OK) {
+            boot_state.error = ret;
+        }
+        taskEXIT_CRITICAL(&boot_state.lock);
+        xEventGroupSetBits(boot_state.events, BOOT_BIT_WAKE_ALL);
+    }
+
+    taskENTER_CRITICAL(&boot_state.lock);
+    bool last = --boot_state.running_workers == 0;
+    taskEXIT_CRITICAL(&boot_state.lock);
+    if (last) {
+        xEventGroupSetBits(boot_state.events, BOOT_BIT_DONE);
+    }
+    media_lib_thread_destroy(NULL);
+}
+
+esp_err_t boot_orchestrator_run(const boot_step_t *steps, int count)
+{
+    if (steps == NULL || count <= 0 || count > BOOT_MAX_STEPS || boot_state.steps != NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(boot_state.deps, 0, sizeof(boot_state.deps));
+    memset(boot_state.timings, 0, sizeof(boot_state.timings));
+    for (int i = 0; i < count; i++) {
+        if (find_step(steps, i, steps[i].name) >= 0 || steps[i].init == NULL) {
+            ESP_LOGE(TAG, "Step '%s' duplicated or without init", steps[i].name);
+            return ESP_ERR_INVALID_ARG;
+        }
+        for (int d = 0; d < BOOT_MAX_DEPS && steps[i].deps[d]; d++) {
+            // Only earlier steps: no cycles possible
+            int dep = find_step(steps, i, steps[i].deps[d]);
+            if (dep < 0) {
+                ESP_LOGE(TAG, "Step '%s' depends on unknown or later step '%s'",
+                         steps[i].name, steps[i].deps[d]);
+                return ESP_ERR_INVALID_ARG;
+            }
+            boot_state.deps[i] |= 1u << dep;
+        }
+        boot_state.timings[i].name = steps[i].name;
+        boot_state.timings[i].core = steps[i].core;
+    }
+
+    boot_state.events = xEventGroupCreate();
+    if (boot_state.events == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    boot_state.steps = steps;
+    boot_state.count = count;
+    boot_state.started = 0;
+    boot_state.done = 0;
+    boot_state.error = ESP_OK;
+    boot_state.workers = portNUM_PROCESSORS < BOOT_MAX_WORKERS ? portNUM_PROCESSORS : BOOT_MAX_WORKERS;
+    boot_state.running_workers = boot_state.workers;
+    boot_state.start_ms = now_ms();
+
+    static const char *worker_names[BOOT_MAX_WORKERS] = {"boot_0", "boot_1"};
+    for (int core = 0; core < boot_state.workers; core++) {
+        if (media_lib_thread_create_from_scheduler(NULL, worker_names[core], boot_worker,
+                                                   (void *)(intptr_t)core) != 0) {
+            // Workers already running finish what they can reach; the rest is an error
+            ESP_LOGE(TAG, "Failed to create boot worker %d", core);
+            taskENTER_CRITICAL(&boot_state.lock);
+            boot_state.error = ESP_FAIL;
+            boot_state.running_workers -= boot_state.workers - core;
+            bool none = boot_state.running_workers == 0;
+            taskEXIT_CRITICAL(&boot_state.lock);
+            if (none) {
+                return ESP_FAIL;
+            }
+            xEventGroupSetBits(boot_state.events, BOOT_BIT_WAKE_ALL);
+            break;
+        }
+    }
+    xEventGroupWaitBits(boot_state.events, BOOT_BIT_DONE, pdFALSE, pdTRUE, portMAX_DELAY);
+    boot_state.end_ms = now_ms();
+
+    // A step was ready once its last dependency finished
+    for (int i = 0; i < count; i++) {
+        uint32_t ready = boot_state.start_ms;
+        for (int d = 0; d < count; d++) {
+            if ((boot_state.deps[i] & (1u << d)) && boot_state.timings[d].end_ms > ready) {
+                ready = boot_state.timings[d].end_ms;
+            }
+        }
+        boot_state.timings[i].ready_ms = ready;
+    }
+    boot_orchestrator_print();
+    return boot_state.error;
+}
+
+int boot_orchestrator_get_timings(boot_step_timing_t *timings, int max)
+{
+    if (timings == NULL || max <= 0) {
+        return 0;
+    }
+    taskENTER_CRITICAL(&boot_state.lock);
+    int count = boot_state.count < max ? boot_state.count : max;
+    memcpy(timings, boot_state.timings, count * sizeof(boot_step_timing_t));
+    taskEXIT_CRITICAL(&boot_state.lock);
+    return count;
+}
+
+void boot_orchestrator_print(void)
+{
+    boot_step_timing_t timings[BOOT_MAX_STEPS];
+    int count = boot_orchestrator_get_timings(timings, BOOT_MAX_STEPS);
+    if (count == 0) {
+        printf("No boot steps recorded\n");
+        return;
+    }
+    uint32_t serial_ms = 0;
+    printf("Boot steps (%d workers, ms since power-on):\n", boot_state.workers);
+    printf("  %-14s | %4s | %6s | %6s | %6s | %6s | %6s\n", "Step", "Core", "Ready", "Start", "End",
+           "Took", "Queued");
+    for (int i = 0; i < count; i++) {
+        const boot_step_timing_t *t = &timings[i];
+        if (!t->ran) {
+            printf("  %-14s | %4s | %6s | %6s | %6s | %6s | %6s\n", t->name, "-", "-", "-", "-", "-", "-");
+            continue;
+        }
+        uint32_t took = t->end_ms - t->start_ms;
+        serial_ms += took;
+        printf("  %-14s | %4d | %6" PRIu32 " | %6" PRIu32 " | %6" PRIu32 " | %6" PRIu32 " | %6" PRIu32 "%s\n", t->name, t->core, t->ready_ms,
+               t->start_ms, t->end_ms, took, t->start_ms - t->ready_ms,
+               t->result != ESP_OK ? " failed" : "");
+    }
+    printf("  Steps took %" PRIu32 " ms (%" PRIu32 " ms if run one after another), finished %" PRIu32 " ms after power-on\n",
+           boot_state.end_ms - boot_state.start_ms, serial_ms, boot_state.end_ms);
+}
@@ -0,0 +1,20 @@
+/*
+ * Board Module - Linux target
+ * The host board has no codec and no I2C bus; the camera shim still takes
+ * the bus lock around sensor power up, so it is a no-op here.
+ */
+
+#include "board_module.h"
+
+esp_err_t board_module_init(void)
+{
+    return ESP_OK;
+}
+
+void board_module_i2c_lock(void)
+{
+}
+
+void board_module_i2c_unlock(void)
+{
+}
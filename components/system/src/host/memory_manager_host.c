@@ -0,0 +1,221 @@
+/*
+ * Memory Manager - Linux target
+ * Same API on top of malloc. There is no PSRAM or DMA memory on the host, so
+ * every policy allocates from the process heap; the allocation counters and
+ * metrics behave as on the device.
+ */
+
+#include "memory_manager.h"
+#include "metrics.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <esp_timer.h>
+#include <malloc.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+static const char *TAG = "mem_manager";
+
+static struct {
+    bool initialized;
+    memory_status_t status;
+    esp_timer_handle_t monitor_timer;
+    metric_t *allocs;
+    metric_t *alloc_failures;
+    metric_t *internal_free_kb;
+    metric_t *internal_min_free_kb;
+    metric_t *largest_block_kb;
+    // mem_alloc traffic stands in for the device's heap hooks
+    mem_heap_counters_t heap_counters;
+} mem_state;
+
+static void update_memory_status(void)
+{
+    struct mallinfo2 info = mallinfo2();
+    size_t free_kb = info.fordblks / 1024;
+
+    mem_state.status.internal_total_kb = info.arena / 1024;
+    mem_state.status.internal_free_kb = free_kb;
+    if (mem_state.status.internal_min_free_kb == 0 || free_kb < mem_state.status.internal_min_free_kb) {
+        mem_state.status.internal_min_free_kb = free_kb;
+    }
+    mem_state.status.dma_free_kb = free_kb;
+    mem_state.status.largest_free_block_kb = free_kb;
+
+    metric_set(mem_state.internal_free_kb, mem_state.status.internal_free_kb);
+    metric_set(mem_state.internal_min_free_kb, mem_state.status.internal_min_free_kb);
+    metric_set(mem_state.largest_block_kb, mem_state.status.largest_free_block_kb);
+}
+
+static void memory_monitor_cb(void* arg)
+{
+    update_memory_status();
+    ESP_LOGD(TAG, "[AUTO] Heap: %u KB arena, %u KB free | Allocations: %" PRIu32,
+             (unsigned)mem_state.status.internal_total_kb, (unsigned)mem_state.status.internal_free_kb,
+             metric_get(mem_state.allocs));
+}
+
+esp_err_t memory_manager_init(void)
+{
+    if (mem_state.initialized) {
+        return ESP_OK;
+    }
+
+    ESP_LOGI(TAG, "Initializing memory manager (host heap)");
+
+    mem_state.allocs = metrics_counter("mem_allocs_total", "mem_alloc/mem_calloc calls");
+    mem_state.alloc_failures = metrics_counter("mem_alloc_failures_total", "mem_alloc/mem_calloc calls that returned NULL");
+    mem_state.internal_free_kb = metrics_gauge("mem_internal_free_kb", "Free internal RAM");
+    mem_state.internal_min_free_kb = metrics_gauge("mem_internal_min_free_kb", "Lowest free internal RAM since boot");
+    mem_state.largest_block_kb = metrics_gauge("mem_largest_block_kb", "Largest free block");
+
+    update_memory_status();
+    mem_state.initialized = true;
+    return ESP_OK;
+}
+
+void* mm_alloc(size_t size, memory_policy_t policy, const char* tag)
+{
+    if (!mem_state.initialized) {
+        ESP_LOGE(TAG, "Memory manager not initialized!");
+        return NULL;
+    }
+
+    metric_inc(mem_state.allocs);
+    void* ptr = malloc(size);
+    if (!ptr) {
+        metric_inc(mem_state.alloc_failures);
+        ESP_LOGE(TAG, "[%s] Failed to allocate %u bytes", tag, (unsigned)size);
+        return NULL;
+    }
+    __atomic_fetch_add(&mem_state.heap_counters.allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&mem_state.heap_counters.alloc_bytes, size, __ATOMIC_RELAXED);
+    ESP_LOGD(TAG, "[%s] Allocated %u bytes", tag, (unsigned)size);
+    return ptr;
+}
+
+void* mm_calloc(size_t n, size_t size, memory_policy_t policy, const char* tag)
+{
+    void* ptr = mm_alloc(n * size, policy, tag);
+    if (ptr) {
+        memset(ptr, 0, n * size);
+    }
+    return ptr;
+}
+
+void* mm_realloc(void* ptr, size_t size, memory_policy_t policy, const char* tag)
+{
+    if (!ptr) {
+        return mm_alloc(size, policy, tag);
+    }
+
+    void* new_ptr = realloc(ptr, size);
+    if (!new_ptr) {
+        ESP_LOGE(TAG, "[%s] Realloc failed for %u bytes", tag, (unsigned)size);
+    }
+    return new_ptr;
+}
+
+void mm_free(void* ptr)
+{
+    if (ptr) {
+        __atomic_fetch_add(&mem_state.heap_counters.frees, 1, __ATOMIC_RELAXED);
+        free(ptr);
+    }
+}
+
+void memory_manager_get_status(memory_status_t* status)
+{
+    if (!mem_state.initialized || !status) {
+        return;
+    }
+
+    update_memory_status();
+    memcpy(status, &mem_state.status, sizeof(memory_status_t));
+}
+
+void memory_manager_refresh_metrics(void)
+{
+    if (mem_state.initialized) {
+        update_memory_status();
+    }
+}
+
+void memory_manager_print_status(void)
+{
+    update_memory_status();
+
+    ESP_LOGI(TAG, "========== Memory Status ==========");
+    ESP_LOGI(TAG, "Host heap: %u KB arena, %u KB free (min: %u KB)",
+             (unsigned)mem_state.status.internal_total_kb,
+             (unsigned)mem_state.status.internal_free_kb,
+             (unsigned)mem_state.status.internal_min_free_kb);
+    ESP_LOGI(TAG, "Allocations: %" PRIu32 " (failures: %" PRIu32 ")",
+             metric_get(mem_state.allocs),
+             metric_get(mem_state.alloc_failures));
+    ESP_LOGI(TAG, "===================================");
+}
+
+void memory_manager_print_tasks(void)
+{
+    ESP_LOGI(TAG, "Task stack usage is not tracked on the Linux target");
+}
+
+void memory_manager_get_alloc_stats(uint32_t* count, uint32_t* failures)
+{
+    if (count) {
+        *count = metric_get(mem_state.allocs);
+    }
+    if (failures) {
+        *failures = metric_get(mem_state.alloc_failures);
+    }
+}
+
+bool memory_manager_get_heap_counters(mem_heap_counters_t* counters)
+{
+    // Only mem_alloc traffic: libc allocations made by the IDF stubs are not seen
+    if (counters) {
+        counters->allocs = __atomic_load_n(&mem_state.heap_counters.allocs, __ATOMIC_RELAXED);
+        counters->frees = __atomic_load_n(&mem_state.heap_counters.frees, __ATOMIC_RELAXED);
+        counters->alloc_bytes = __atomic_load_n(&mem_state.heap_counters.alloc_bytes, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+bool memory_manager_check_pressure(void)
+{
+    return false;
+}
+
+esp_err_t memory_manager_adjust_for_pressure(void)
+{
+    return ESP_OK;
+}
+
+void memory_manager_enable_monitoring(uint32_t interval_ms)
+{
+    if (mem_state.monitor_timer) {
+        esp_timer_stop(mem_state.monitor_timer);
+        esp_timer_delete(mem_state.monitor_timer);
+    }
+
+    esp_timer_create_args_t timer_args = {
+        .callback = memory_monitor_cb,
+        .name = "mem_monitor"
+    };
+
+    ESP_ERROR_CHECK(esp_timer_create(&timer_args, &mem_state.monitor_timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(mem_state.monitor_timer, interval_ms * 1000));
+}
+
+// The workstation heap is never the limit; the device checks stay on the device
+bool mem_can_enable_vision(void)
+{
+    return true;
+}
+
+bool mem_can_enable_hd_video(void)
+{
+    return true;
+}
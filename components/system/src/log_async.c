@@ -0,0 +1,447 @@
+#include "log_async.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_system.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+#include "media_lib_os.h"
+#include "memory_manager.h"
+#include "metrics.h"
+#include "sdkconfig.h"
+
+#if CONFIG_AG_LOG_ASYNC_ENABLE
+
+static const char *TAG = "log_async";
+
+#define LOG_LINE_MAX            192     // Longer lines are cut, keeping the line ending
+#define LOG_COLOR_ENDING        "\033[0m\n"  // Color reset esp_log puts before the newline
+#define LOG_RECORD_HEADER       2       // Line length, little endian
+#define LOG_DROP_REPORT_US      1000000
+
+typedef struct {
+    log_async_limit_t info;
+    int64_t credit_us;          // Token bucket in microseconds of budget
+    int64_t last_us;
+} log_limit_t;
+
+// Module state; the ring and limits are guarded by lock, output by drain_lock
+static struct {
+    portMUX_TYPE lock;
+    volatile bool enabled;
+    vprintf_like_t original;
+    uint8_t *ring;
+    uint32_t size;
+    uint32_t head;              // Bytes ever written; position is head % size
+    uint32_t tail;              // Bytes ever read
+    uint32_t peak;
+    log_limit_t limits[LOG_ASYNC_MAX_LIMITS];
+    int limit_count;
+    uint32_t dropped_full;
+    uint32_t dropped_rate;
+    uint32_t reported_full;
+    uint32_t reported_rate;
+    int64_t reported_us;
+    SemaphoreHandle_t pending;  // Given by writers, taken by the drain task
+    SemaphoreHandle_t drain_lock;
+    metric_t *lines;
+    metric_t *full;
+    metric_t *rate;
+} log_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void ring_copy_in(uint32_t pos, const void *data, uint32_t len)
+{
+    uint32_t at = pos % log_state.size;
+    uint32_t first = len < log_state.size - at ? len : log_state.size - at;
+    memcpy(log_state.ring + at, data, first);
+    memcpy(log_state.ring, (const uint8_t *)data + first, len - first);
+}
+
+static void ring_copy_out(uint32_t pos, void *data, uint32_t len)
+{
+    uint32_t at = pos % log_state.size;
+    uint32_t first = len < log_state.size - at ? len : log_state.size - at;
+    memcpy(data, log_state.ring + at, first);
+    memcpy((uint8_t *)data + first, log_state.ring, len - first);
+}
+
+// Level letter and tag of an esp_log line: "I (1234) tag: ...", maybe behind a color escape
+static bool parse_line(const char *line, int len, char *level, char *tag)
+{
+    const char *p = line;
+    const char *end = line + len;
+    if (p < end && *p == '\033') {
+        p = memchr(p, 'm', end - p);
+        if (p == NULL) {
+            return false;
+        }
+        p++;
+    }
+    if (p >= end) {
+        return false;
+    }
+    *level = *p;
+    const char *close = memchr(p, ')', end - p);
+    if (close == NULL || close + 2 >= end || close[1] != ' ') {
+        return false;
+    }
+    const char *start = close + 2;
+    const char *colon = memchr(start, ':', end - start);
+    if (colon == NULL) {
+        return false;
+    }
+    size_t n = colon - start;
+    if (n >= LOG_ASYNC_TAG_LEN) {
+        n = LOG_ASYNC_TAG_LEN - 1;
+    }
+    memcpy(tag, start, n);
+    tag[n] = '\0';
+    return true;
+}
+
+// Called with lock held
+static log_limit_t *find_limit(const char *tag)
+{
+    for (int i = 0; i < log_state.limit_count; i++) {
+        if (strcmp(log_state.limits[i].info.tag, tag) == 0) {
+            return &log_state.limits[i];
+        }
+    }
+    return NULL;
+}
+
+// Called with lock held
+static bool limit_admit(log_limit_t *limit, int64_t now)
+{
+    int64_t cost = 1000000 / limit->info.per_sec;
+    int64_t cap = cost * limit->info.burst;
+    limit->credit_us += now - limit->last_us;
+    limit->last_us = now;
+    if (limit->credit_us > cap) {
+        limit->credit_us = cap;
+    }
+    if (limit->credit_us < cost) {
+        limit->info.dropped++;
+        return false;
+    }
+    limit->credit_us -= cost;
+    limit->info.passed++;
+    return true;
+}
+
+static int log_async_vprintf(const char *fmt, va_list args)
+{
+    if (!log_state.enabled || xPortInIsrContext() || xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) {
+        return log_state.original(fmt, args);
+    }
+
+    // Arguments may point at the caller's stack, so the line is formatted here
+    char line[LOG_LINE_MAX];
+    int len = vsnprintf(line, sizeof(line), fmt, args);
+    if (len <= 0) {
+        return len;
+    }
+    int ret = len;
+    if (len >= (int)sizeof(line)) {
+        // A cut colored line still resets the color, or the next lines inherit it
+        const char *ending = line[0] == '\033' ? LOG_COLOR_ENDING : "\n";
+        int n = strlen(ending);
+        len = sizeof(line) - 1;
+        memcpy(line + len - n, ending, n);
+    }
+
+    char level = 0;
+    char tag[LOG_ASYNC_TAG_LEN];
+    bool tagged = log_state.limit_count > 0 && parse_line(line, len, &level, tag);
+    int64_t now = tagged ? esp_timer_get_time() : 0;
+
+    metric_t *dropped = NULL;
+    taskENTER_CRITICAL(&log_state.lock);
+    log_limit_t *limit = tagged && level != 'E' && level != 'W' ? find_limit(tag) : NULL;
+    if (limit && !limit_admit(limit, now)) {
+        log_state.dropped_rate++;
+        dropped = log_state.rate;
+    } else if (log_state.head - log_state.tail + LOG_RECORD_HEADER + len > log_state.size) {
+        log_state.dropped_full++;
+        dropped = log_state.full;
+    } else {
+        uint8_t header[LOG_RECORD_HEADER] = {len & 0xFF, len >> 8};
+        ring_copy_in(log_state.head, header, LOG_RECORD_HEADER);
+        ring_copy_in(log_state.head + LOG_RECORD_HEADER, line, len);
+        log_state.head += LOG_RECORD_HEADER + len;
+        uint32_t used = log_state.head - log_state.tail;
+        if (used > log_state.peak) {
+            log_state.peak = used;
+        }
+    }
+    taskEXIT_CRITICAL(&log_state.lock);
+
+    metric_inc(dropped ? dropped : log_state.lines);
+    xSemaphoreGive(log_state.pending);
+    return ret;
+}
+
+// Next queued line into line; 0 when the ring is empty
+static int ring_take(char *line)
+{
+    int len = 0;
+    taskENTER_CRITICAL(&log_state.lock);
+    if (log_state.head != log_state.tail) {
+        uint8_t header[LOG_RECORD_HEADER];
+        ring_copy_out(log_state.tail, header, LOG_RECORD_HEADER);
+        len = header[0] | (header[1] << 8);
+        ring_copy_out(log_state.tail + LOG_RECORD_HEADER, line, len);
+        log_state.tail += LOG_RECORD_HEADER + len;
+    }
+    taskEXIT_CRITICAL(&log_state.lock);
+    return len;
+}
+
+// Called with drain_lock held; returns true while drops are left to report
+static bool drain(bool force_report)
+{
+    char line[LOG_LINE_MAX];
+    int len;
+    while ((len = ring_take(line)) > 0) {
+        fwrite(line, 1, len, stdout);
+    }
+
+    // At most one drop summary per LOG_DROP_REPORT_US, so a flood does not become one
+    uint32_t full = log_state.dropped_full;
+    uint32_t rate = log_state.dropped_rate;
+    bool unreported = full != log_state.reported_full || rate != log_state.reported_rate;
+    int64_t now = esp_timer_get_time();
+    if (unreported && (force_report || now - log_state.reported_us >= LOG_DROP_REPORT_US)) {
+        printf("W (%" PRIu32 ") %s: dropped %" PRIu32 " lines over rate limits, %" PRIu32 " with the buffer full\n",
+               esp_log_timestamp(), TAG, rate - log_state.reported_rate, full - log_state.reported_full);
+        log_state.reported_full = full;
+        log_state.reported_rate = rate;
+        log_state.reported_us = now;
+        unreported = false;
+    }
+    fflush(stdout);
+    return unreported;
+}
+
+static void log_drain_task(void *arg)
+{
+    bool unreported = false;
+    while (1) {
+        // Wake up for a late drop summary even if nothing else is logged
+        xSemaphoreTake(log_state.pending, unreported ? pdMS_TO_TICKS(LOG_DROP_REPORT_US / 1000) : portMAX_DELAY);
+        xSemaphoreTake(log_state.drain_lock, portMAX_DELAY);
+        unreported = drain(false);
+        xSemaphoreGive(log_state.drain_lock);
+    }
+}
+
+void log_async_flush(void)
+{
+    if (log_state.ring == NULL) {
+        return;
+    }
+    // Bounded: the shutdown handler may run while the drain task holds the lock
+    if (xSemaphoreTake(log_state.drain_lock, pdMS_TO_TICKS(200)) == pdTRUE) {
+        drain(true);
+        xSemaphoreGive(log_state.drain_lock);
+    }
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
+void __real_esp_panic_handler(void *info);
+
+// Linked in with --wrap: the drain task will not run again, so the ring is
+// written straight to the ROM console. No locks and no stdio; the other core
+// is halted and may have stopped inside either.
+void __wrap_esp_panic_handler(void *info)
+{
+    if (log_state.ring) {
+        char line[LOG_LINE_MAX + 1];
+        uint32_t tail = log_state.tail;
+        while (log_state.head - tail >= LOG_RECORD_HEADER) {
+            uint8_t header[LOG_RECORD_HEADER];
+            ring_copy_out(tail, header, LOG_RECORD_HEADER);
+            uint32_t len = header[0] | (header[1] << 8);
+            if (len > LOG_LINE_MAX || log_state.head - tail < LOG_RECORD_HEADER + len) {
+                break;      // Record torn by a writer on the halted core
+            }
+            ring_copy_out(tail + LOG_RECORD_HEADER, line, len);
+            line[len] = '\0';
+            esp_rom_printf("%s", line);
+            tail += LOG_RECORD_HEADER + len;
+        }
+        log_state.tail = tail;
+    }
+    __real_esp_panic_handler(info);
+}
+#endif
+
+// "tag=per_sec[/burst],..." from Kconfig
+static void apply_config_limits(void)
+{
+    char spec[sizeof(CONFIG_AG_LOG_ASYNC_LIMITS)];
+    strlcpy(spec, CONFIG_AG_LOG_ASYNC_LIMITS, sizeof(spec));
+    char *save = NULL;
+    for (char *item = strtok_r(spec, ", ", &save); item; item = strtok_r(NULL, ", ", &save)) {
+        char *eq = strchr(item, '=');
+        if (eq == NULL) {
+            ESP_LOGW(TAG, "Ignoring limit '%s', expected tag=per_sec[/burst]", item);
+            continue;
+        }
+        *eq = '\0';
+        char *slash = strchr(eq + 1, '/');
+        int per_sec = atoi(eq + 1);
+        int burst = slash ? atoi(slash + 1) : 0;
+        log_async_set_limit(item, per_sec, burst);
+    }
+}
+
+esp_err_t log_async_init(void)
+{
+    if (log_state.ring) {
+        return ESP_OK;
+    }
+    log_state.pending = xSemaphoreCreateBinary();
+    log_state.drain_lock = xSemaphoreCreateMutex();
+    log_state.ring = mem_alloc(CONFIG_AG_LOG_ASYNC_BUFFER_SIZE, MEM_POLICY_PREFER_PSRAM, "log_async");
+    if (log_state.pending == NULL || log_state.drain_lock == NULL || log_state.ring == NULL) {
+        ESP_LOGE(TAG, "No memory for the log ring");
+        return ESP_ERR_NO_MEM;
+    }
+    log_state.size = CONFIG_AG_LOG_ASYNC_BUFFER_SIZE;
+
+    log_state.lines = metrics_counter("log_lines_total", "Log lines queued for output");
+    log_state.full = metrics_counter("log_dropped_full_total", "Log lines dropped with the log buffer full");
+    log_state.rate = metrics_counter("log_dropped_rate_total", "Log lines dropped over a tag rate limit");
+    apply_config_limits();
+
+    if (media_lib_thread_create_from_scheduler(NULL, "log_drain", log_drain_task, NULL) != 0) {
+        ESP_LOGE(TAG, "Failed to create drain task");
+        return ESP_FAIL;
+    }
+    esp_register_shutdown_handler(log_async_flush);
+    log_state.original = esp_log_set_vprintf(log_async_vprintf);
+    log_state.enabled = true;
+    ESP_LOGI(TAG, "Logging through a %" PRIu32 " byte buffer, %d tag limits",
+             log_state.size, log_state.limit_count);
+    return ESP_OK;
+}
+
+void log_async_set_enabled(bool enabled)
+{
+    if (log_state.ring == NULL) {
+        return;
+    }
+    log_state.enabled = enabled;
+    if (!enabled) {
+        log_async_flush();
+    }
+}
+
+esp_err_t log_async_set_limit(const char *tag, uint16_t per_sec, uint16_t burst)
+{
+    if (tag == NULL || tag[0] == '\0') {
+        return ESP_ERR_INVALID_ARG;
+    }
+    char key[LOG_ASYNC_TAG_LEN];
+    strlcpy(key, tag, sizeof(key));
+    esp_err_t ret = ESP_OK;
+
+    taskENTER_CRITICAL(&log_state.lock);
+    log_limit_t *limit = find_limit(key);
+    if (per_sec == 0) {
+        if (limit) {
+            *limit = log_state.limits[--log_state.limit_count];
+        }
+    } else {
+        if (limit == NULL && log_state.limit_count < LOG_ASYNC_MAX_LIMITS) {
+            limit = &log_state.limits[log_state.limit_count++];
+            memset(limit, 0, sizeof(*limit));
+            strlcpy(limit->info.tag, key, sizeof(limit->info.tag));
+        }
+        if (limit) {
+            limit->info.per_sec = per_sec;
+            limit->info.burst = burst ? burst : per_sec;
+            // Start with a full bucket
+            limit->credit_us = (int64_t)limit->info.burst * (1000000 / per_sec);
+            limit->last_us = 0;
+        } else {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+    taskEXIT_CRITICAL(&log_state.lock);
+    return ret;
+}
+
+int log_async_get_limits(log_async_limit_t *limits, int max)
+{
+    if (limits == NULL) {
+        return 0;
+    }
+    int count = 0;
+    taskENTER_CRITICAL(&log_state.lock);
+    for (; count < log_state.limit_count && count < max; count++) {
+        limits[count] = log_state.limits[count].info;
+    }
+    taskEXIT_CRITICAL(&log_state.lock);
+    return count;
+}
+
+void log_async_get_status(log_async_status_t *status)
+{
+    if (status == NULL) {
+        return;
+    }
+    memset(status, 0, sizeof(*status));
+    taskENTER_CRITICAL(&log_state.lock);
+    status->enabled = log_state.enabled;
+    status->buffer_size = log_state.size;
+    status->buffer_used = log_state.head - log_state.tail;
+    status->buffer_peak = log_state.peak;
+    status->dropped_full = log_state.dropped_full;
+    status->dropped_rate = log_state.dropped_rate;
+    taskEXIT_CRITICAL(&log_state.lock);
+    status->lines = metric_get(log_state.lines);
+}
+
+#else // !CONFIG_AG_LOG_ASYNC_ENABLE
+
+esp_err_t log_async_init(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void log_async_set_enabled(bool enabled)
+{
+}
+
+esp_err_t log_async_set_limit(const char *tag, uint16_t per_sec, uint16_t burst)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+int log_async_get_limits(log_async_limit_t *limits, int max)
+{
+    return 0;
+}
+
+void log_async_get_status(log_async_status_t *status)
+{
+    if (status) {
+        memset(status, 0, sizeof(*status));
+    }
+}
+
+void log_async_flush(void)
+{
+}
+
+#endif // CONFIG_AG_LOG_ASYNC_ENABLE
@@ -4,6 +4,7 @@
  */
 
 #include "memory_manager.h"
+#include "metrics.h"
 #include <esp_log.h>
 #include <esp_system.h>
 #include <esp_heap_caps.h>
@@ -13,6 +14,7 @@
 #include <string.h>
 #include "sdkconfig.h"
 #include "esp_chip_info.h"
+#include "esp_attr.h"
 
 static const char *TAG = "mem_manager";
 
@@ -26,9 +28,35 @@ static struct {
     bool initialized;
     memory_status_t status;
     esp_timer_handle_t monitor_timer;
-    uint32_t allocation_count;
-    uint32_t allocation_failures;
-} mem_state = {0};
+    metric_t *allocs;
+    metric_t *alloc_failures;
+    metric_t *internal_free_kb;
+    metric_t *internal_min_free_kb;
+    metric_t *psram_free_kb;
+    metric_t *largest_block_kb;
+    metric_t *cpu_load_pct[portNUM_PROCESSORS];
+    portMUX_TYPE cpu_lock;
+    int64_t cpu_sample_us;
+    uint32_t idle_run_time[portNUM_PROCESSORS];
+} mem_state = {
+    .cpu_lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+#if CONFIG_HEAP_USE_HOOKS
+// Updated from heap hooks, which may run with the flash cache disabled
+static DRAM_ATTR mem_heap_counters_t heap_counters = {0};
+
+void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps)
+{
+    __atomic_fetch_add(&heap_counters.allocs, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&heap_counters.alloc_bytes, size, __ATOMIC_RELAXED);
+}
+
+void IRAM_ATTR esp_heap_trace_free_hook(void* ptr)
+{
+    __atomic_fetch_add(&heap_counters.frees, 1, __ATOMIC_RELAXED);
+}
+#endif
 
 // Forward declaration
 static void update_memory_status(void);
@@ -38,8 +66,8 @@ static void memory_monitor_cb(void* arg)
 {
     update_memory_status();
     
-    // ALWAYS show status every 30 seconds (not just warnings)
-    ESP_LOGI(TAG, "[AUTO] Internal: %u KB free (min:%u) | PSRAM: %u KB free (min:%u) | DMA: %u KB | Largest: %u KB",
+    // Levels are in the metrics registry; only problems are logged
+    ESP_LOGD(TAG, "[AUTO] Internal: %u KB free (min:%u) | PSRAM: %u KB free (min:%u) | DMA: %u KB | Largest: %u KB",
              mem_state.status.internal_free_kb,
              mem_state.status.internal_min_free_kb,
              mem_state.status.psram_free_kb,
@@ -70,8 +98,43 @@ static void memory_monitor_cb(void* arg)
     }
 }
 
-// Update current memory status
-static void update_memory_status(void)
+// Per-core load since the previous sample, from the idle tasks' run time
+static void update_cpu_load(void)
+{
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    uint32_t idle[portNUM_PROCESSORS];
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        idle[core] = (uint32_t)ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+    }
+    int64_t now = esp_timer_get_time();
+
+    // Samples closer than 100 ms apart are too noisy; keep the older baseline
+    taskENTER_CRITICAL(&mem_state.cpu_lock);
+    bool first = mem_state.cpu_sample_us == 0;
+    int64_t elapsed = now - mem_state.cpu_sample_us;
+    bool publish = !first && elapsed >= 100000;
+    uint32_t idle_delta[portNUM_PROCESSORS];
+    if (first || publish) {
+        for (int core = 0; core < portNUM_PROCESSORS; core++) {
+            idle_delta[core] = idle[core] - mem_state.idle_run_time[core];
+            mem_state.idle_run_time[core] = idle[core];
+        }
+        mem_state.cpu_sample_us = now;
+    }
+    taskEXIT_CRITICAL(&mem_state.cpu_lock);
+
+    if (!publish) {
+        return;
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t idle_pct = (uint32_t)((int64_t)idle_delta[core] * 100 / elapsed);
+        metric_set(mem_state.cpu_load_pct[core], idle_pct >= 100 ? 0 : 100 - idle_pct);
+    }
+#endif
+}
+
+// Heap levels and CPU load; cheap enough for every scrape
+static void update_heap_status(void)
 {
     // Internal memory
     mem_state.status.internal_total_kb = heap_caps_get_total_size(MALLOC_CAP_INTERNAL) / 1024;
@@ -91,6 +154,18 @@ static void update_memory_status(void)
     // Largest free block (fragmentation indicator)
     mem_state.status.largest_free_block_kb = heap_caps_get_largest_free_block(MALLOC_CAP_DEFAULT) / 1024;
     
+    metric_set(mem_state.internal_free_kb, mem_state.status.internal_free_kb);
+    metric_set(mem_state.internal_min_free_kb, mem_state.status.internal_min_free_kb);
+    metric_set(mem_state.psram_free_kb, mem_state.status.psram_free_kb);
+    metric_set(mem_state.largest_block_kb, mem_state.status.largest_free_block_kb);
+    update_cpu_load();
+}
+
+// Update current memory status
+static void update_memory_status(void)
+{
+    update_heap_status();
+    
     // Check memory pressure
     mem_state.status.low_internal_memory = (mem_state.status.internal_free_kb < MIN_INTERNAL_FREE_KB);
     mem_state.status.low_psram_memory = (mem_state.status.psram_free_kb < MIN_PSRAM_FREE_KB);
@@ -157,6 +232,19 @@ esp_err_t memory_manager_init(void)
     
     ESP_LOGI(TAG, "Flash: %u MB", mem_state.status.flash_size_mb);
     
+    mem_state.allocs = metrics_counter("mem_allocs_total", "mem_alloc/mem_calloc calls");
+    mem_state.alloc_failures = metrics_counter("mem_alloc_failures_total", "mem_alloc/mem_calloc calls that returned NULL");
+    mem_state.internal_free_kb = metrics_gauge("mem_internal_free_kb", "Free internal RAM");
+    mem_state.internal_min_free_kb = metrics_gauge("mem_internal_min_free_kb", "Lowest free internal RAM since boot");
+    mem_state.psram_free_kb = metrics_gauge("mem_psram_free_kb", "Free PSRAM");
+    mem_state.largest_block_kb = metrics_gauge("mem_largest_block_kb", "Largest free block");
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+    static const char *cpu_names[] = {"cpu_core0_load_pct", "cpu_core1_load_pct"};
+    for (int core = 0; core < portNUM_PROCESSORS && core < 2; core++) {
+        mem_state.cpu_load_pct[core] = metrics_gauge(cpu_names[core], "Time not spent in the idle task");
+    }
+#endif
+    
     // Initial status update
     update_memory_status();
     
@@ -177,7 +265,7 @@ void* mm_alloc(size_t size, memory_policy_t policy, const char* tag)
     void* ptr = NULL;
     uint32_t caps = 0;
     
-    mem_state.allocation_count++;
+    metric_inc(mem_state.allocs);
     
     switch (policy) {
         case MEM_POLICY_PREFER_PSRAM:
@@ -215,11 +303,11 @@ void* mm_alloc(size_t size, memory_policy_t policy, const char* tag)
     if (ptr) {
         ESP_LOGD(TAG, "[%s] Allocated %u bytes (caps=0x%lx)", tag, (unsigned)size, (unsigned long)caps);
     } else {
-        mem_state.allocation_failures++;
+        metric_inc(mem_state.alloc_failures);
         ESP_LOGE(TAG, "[%s] Failed to allocate %u bytes (caps=0x%lx)", tag, (unsigned)size, (unsigned long)caps);
         
         // Try emergency cleanup
-        if (mem_state.allocation_failures > 10) {
+        if (metric_get(mem_state.alloc_failures) > 10) {
             ESP_LOGE(TAG, "Too many allocation failures, attempting cleanup...");
             memory_manager_adjust_for_pressure();
         }
@@ -279,6 +367,13 @@ void memory_manager_get_status(memory_status_t* status)
     memcpy(status, &mem_state.status, sizeof(memory_status_t));
 }
 
+void memory_manager_refresh_metrics(void)
+{
+    if (mem_state.initialized) {
+        update_heap_status();
+    }
+}
+
 void memory_manager_print_status(void)
 {
     update_memory_status();
@@ -311,11 +406,38 @@ void memory_manager_print_status(void)
     }
     
     ESP_LOGI(TAG, "Allocations: %lu (failures: %lu)",
-             (unsigned long)mem_state.allocation_count,
-             (unsigned long)mem_state.allocation_failures);
+             (unsigned long)metric_get(mem_state.allocs),
+             (unsigned long)metric_get(mem_state.alloc_failures));
     ESP_LOGI(TAG, "===================================");
 }
 
+void memory_manager_get_alloc_stats(uint32_t* count, uint32_t* failures)
+{
+    if (count) {
+        *count = metric_get(mem_state.allocs);
+    }
+    if (failures) {
+        *failures = metric_get(mem_state.alloc_failures);
+    }
+}
+
+bool memory_manager_get_heap_counters(mem_heap_counters_t* counters)
+{
+#if CONFIG_HEAP_USE_HOOKS
+    if (counters) {
+        counters->allocs = __atomic_load_n(&heap_counters.allocs, __ATOMIC_RELAXED);
+        counters->frees = __atomic_load_n(&heap_counters.frees, __ATOMIC_RELAXED);
+        counters->alloc_bytes = __atomic_load_n(&heap_counters.alloc_bytes, __ATOMIC_RELAXED);
+    }
+    return true;
+#else
+    if (counters) {
+        memset(counters, 0, sizeof(*counters));
+    }
+    return false;
+#endif
+}
+
 void memory_manager_print_tasks(void)
 {
     update_memory_status();
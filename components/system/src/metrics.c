@@ -0,0 +1,299 @@
+#include "metrics.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+
+static const char *TAG = "metrics";
+
+// Entries are only appended; count is published after the entry is filled,
+// so readers walk the table without the lock
+static struct {
+    portMUX_TYPE lock;
+    metric_t metrics[METRICS_MAX];
+    metric_histogram_t hists[METRICS_MAX_HISTOGRAMS];
+    int count;
+    int hist_count;
+} registry = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static const char *type_name[] = {"counter", "gauge", "histogram"};
+
+static int registry_count(void)
+{
+    return __atomic_load_n(&registry.count, __ATOMIC_ACQUIRE);
+}
+
+metric_t *metrics_find(const char *name)
+{
+    int count = registry_count();
+    for (int i = 0; i < count; i++) {
+        if (strcmp(registry.metrics[i].name, name) == 0) {
+            return &registry.metrics[i];
+        }
+    }
+    return NULL;
+}
+
+static metric_t *metrics_register(const char *name, const char *help, metric_type_t type,
+                                  const uint32_t *bounds, int bound_count)
+{
+    if (name == NULL) {
+        return NULL;
+    }
+    bool full = false;
+    taskENTER_CRITICAL(&registry.lock);
+    metric_t *m = metrics_find(name);
+    if (m == NULL) {
+        if (registry.count == METRICS_MAX ||
+            (type == METRIC_HISTOGRAM && registry.hist_count == METRICS_MAX_HISTOGRAMS)) {
+            full = true;
+        } else {
+            m = &registry.metrics[registry.count];
+            memset(m, 0, sizeof(*m));
+            m->name = name;
+            m->help = help ? help : "";
+            m->type = type;
+            if (type == METRIC_HISTOGRAM) {
+                metric_histogram_t *h = &registry.hists[registry.hist_count++];
+                memset(h, 0, sizeof(*h));
+                h->bucket_count = bound_count;
+                memcpy(h->bounds, bounds, bound_count * sizeof(uint32_t));
+                m->hist = h;
+            }
+            __atomic_store_n(&registry.count, registry.count + 1, __ATOMIC_RELEASE);
+        }
+    }
+    taskEXIT_CRITICAL(&registry.lock);
+
+    if (full) {
+        ESP_LOGW(TAG, "Registry full, %s not registered", name);
+        return NULL;
+    }
+    if (m->type != type) {
+        ESP_LOGE(TAG, "%s already registered as a %s", name, type_name[m->type]);
+        return NULL;
+    }
+    return m;
+}
+
+metric_t *metrics_counter(const char *name, const char *help)
+{
+    return metrics_register(name, help, METRIC_COUNTER, NULL, 0);
+}
+
+metric_t *metrics_gauge(const char *name, const char *help)
+{
+    return metrics_register(name, help, METRIC_GAUGE, NULL, 0);
+}
+
+metric_t *metrics_histogram(const char *name, const char *help, const uint32_t *bounds, int count)
+{
+    if (bounds == NULL || count <= 0 || count > METRICS_MAX_BUCKETS) {
+        return NULL;
+    }
+    for (int i = 1; i < count; i++) {
+        if (bounds[i] <= bounds[i - 1]) {
+            ESP_LOGE(TAG, "%s: bucket bounds must ascend", name);
+            return NULL;
+        }
+    }
+    return metrics_register(name, help, METRIC_HISTOGRAM, bounds, count);
+}
+
+void metric_observe(metric_t *m, uint32_t value)
+{
+    if (m == NULL || m->hist == NULL) {
+        return;
+    }
+    metric_histogram_t *h = m->hist;
+    int i = 0;
+    while (i < h->bucket_count && value > h->bounds[i]) {
+        i++;
+    }
+    __atomic_fetch_add(&h->buckets[i], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&h->sum, value, __ATOMIC_RELAXED);
+}
+
+uint32_t metric_histogram_count(const metric_t *m)
+{
+    if (m == NULL || m->hist == NULL) {
+        return 0;
+    }
+    uint32_t count = 0;
+    for (int i = 0; i <= m->hist->bucket_count; i++) {
+        count += __atomic_load_n(&m->hist->buckets[i], __ATOMIC_RELAXED);
+    }
+    return count;
+}
+
+// Upper bound of the bucket holding the q-th percentile; UINT32_MAX above the last bound
+static uint32_t histogram_percentile(const uint32_t *buckets, const metric_histogram_t *h,
+                                     uint32_t count, int q)
+{
+    uint32_t rank = (count * q + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < h->bucket_count; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return h->bounds[i];
+        }
+    }
+    return UINT32_MAX;
+}
+
+static void print_percentile(const char *label, uint32_t bound, const metric_histogram_t *h)
+{
+    if (bound == UINT32_MAX) {
+        printf(" %s>%" PRIu32, label, h->bounds[h->bucket_count - 1]);
+    } else {
+        printf(" %s<=%" PRIu32, label, bound);
+    }
+}
+
+void metrics_print(const char *prefix)
+{
+    int count = registry_count();
+    size_t prefix_len = prefix ? strlen(prefix) : 0;
+    int shown = 0;
+    for (int i = 0; i < count; i++) {
+        const metric_t *m = &registry.metrics[i];
+        if (prefix_len && strncmp(m->name, prefix, prefix_len) != 0) {
+            continue;
+        }
+        shown++;
+        if (m->type == METRIC_COUNTER) {
+            printf("%-36s %-9s %" PRIu32 "\n", m->name, "counter", metric_get(m));
+            continue;
+        }
+        if (m->type == METRIC_GAUGE) {
+            printf("%-36s %-9s %" PRId32 "\n", m->name, "gauge", (int32_t)metric_get(m));
+            continue;
+        }
+
+        const metric_histogram_t *h = m->hist;
+        uint32_t buckets[METRICS_MAX_BUCKETS + 1];
+        uint32_t n = 0;
+        for (int b = 0; b <= h->bucket_count; b++) {
+            buckets[b] = __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+            n += buckets[b];
+        }
+        uint32_t sum = __atomic_load_n(&h->sum, __ATOMIC_RELAXED);
+        printf("%-36s %-9s n=%" PRIu32, m->name, "histogram", n);
+        if (n) {
+            printf(" avg=%" PRIu32, sum / n);
+            print_percentile("p50", histogram_percentile(buckets, h, n, 50), h);
+            print_percentile("p90", histogram_percentile(buckets, h, n, 90), h);
+            printf("\n  ");
+            for (int b = 0; b < h->bucket_count; b++) {
+                printf(" <=%" PRIu32 ":%" PRIu32, h->bounds[b], buckets[b]);
+            }
+            printf(" >%" PRIu32 ":%" PRIu32, h->bounds[h->bucket_count - 1], buckets[h->bucket_count]);
+        }
+        printf("\n");
+    }
+    if (shown == 0) {
+        printf("No metrics%s%s\n", prefix_len ? " matching " : "", prefix_len ? prefix : "");
+    }
+}
+
+// snprintf into buf at *len, counting what did not fit
+static void __attribute__((format(printf, 4, 5))) append(char *buf, size_t size, size_t *len, const char *fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(*len < size ? buf + *len : NULL, *len < size ? size - *len : 0, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        *len += n;
+    }
+}
+
+size_t metrics_export_text(char *buf, size_t size)
+{
+    size_t len = 0;
+    if (buf && size) {
+        buf[0] = '\0';
+    } else {
+        buf = NULL;
+        size = 0;
+    }
+    int count = registry_count();
+    for (int i = 0; i < count; i++) {
+        const metric_t *m = &registry.metrics[i];
+        append(buf, size, &len, "# HELP %s %s\n# TYPE %s %s\n", m->name, m->help, m->name, type_name[m->type]);
+        if (m->type == METRIC_COUNTER) {
+            append(buf, size, &len, "%s %" PRIu32 "\n", m->name, metric_get(m));
+            continue;
+        }
+        if (m->type == METRIC_GAUGE) {
+            append(buf, size, &len, "%s %" PRId32 "\n", m->name, (int32_t)metric_get(m));
+            continue;
+        }
+        // Prometheus buckets are cumulative; _count is their total, so the two always agree
+        const metric_histogram_t *h = m->hist;
+        uint32_t cumulative = 0;
+        for (int b = 0; b < h->bucket_count; b++) {
+            cumulative += __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+            append(buf, size, &len, "%s_bucket{le=\"%" PRIu32 "\"} %" PRIu32 "\n", m->name, h->bounds[b], cumulative);
+        }
+        cumulative += __atomic_load_n(&h->buckets[h->bucket_count], __ATOMIC_RELAXED);
+        append(buf, size, &len, "%s_bucket{le=\"+Inf\"} %" PRIu32 "\n%s_sum %" PRIu32 "\n%s_count %" PRIu32 "\n",
+               m->name, cumulative, m->name, __atomic_load_n(&h->sum, __ATOMIC_RELAXED), m->name, cumulative);
+    }
+    return len;
+}
+
+// Bound of the percentile bucket as a JSON value; null above the last bound
+static void append_percentile(char *buf, size_t size, size_t *len, const char *label, uint32_t bound)
+{
+    if (bound == UINT32_MAX) {
+        append(buf, size, len, ",\"%s\":null", label);
+    } else {
+        append(buf, size, len, ",\"%s\":%" PRIu32, label, bound);
+    }
+}
+
+size_t metrics_export_json(char *buf, size_t size)
+{
+    size_t len = 0;
+    if (buf && size) {
+        buf[0] = '\0';
+    } else {
+        buf = NULL;
+        size = 0;
+    }
+    append(buf, size, &len, "{");
+    int count = registry_count();
+    for (int i = 0; i < count; i++) {
+        const metric_t *m = &registry.metrics[i];
+        const char *sep = i ? "," : "";
+        if (m->type == METRIC_COUNTER) {
+            append(buf, size, &len, "%s\"%s\":%" PRIu32, sep, m->name, metric_get(m));
+            continue;
+        }
+        if (m->type == METRIC_GAUGE) {
+            append(buf, size, &len, "%s\"%s\":%" PRId32, sep, m->name, (int32_t)metric_get(m));
+            continue;
+        }
+        const metric_histogram_t *h = m->hist;
+        uint32_t buckets[METRICS_MAX_BUCKETS + 1];
+        uint32_t n = 0;
+        for (int b = 0; b <= h->bucket_count; b++) {
+            buckets[b] = __atomic_load_n(&h->buckets[b], __ATOMIC_RELAXED);
+            n += buckets[b];
+        }
+        append(buf, size, &len, "%s\"%s\":{\"count\":%" PRIu32 ",\"sum\":%" PRIu32, sep, m->name, n,
+               __atomic_load_n(&h->sum, __ATOMIC_RELAXED));
+        if (n) {
+            append_percentile(buf, size, &len, "p50", histogram_percentile(buckets, h, n, 50));
+            append_percentile(buf, size, &len, "p90", histogram_percentile(buckets, h, n, 90));
+        }
+        append(buf, size, &len, "}");
+    }
+    append(buf, size, &len, "}\n");
+    return len;
+}
@@ -0,0 +1,385 @@
+#include "profiler.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_timer.h"
+#include "media_lib_os.h"
+#include "memory_manager.h"
+#include "sdkconfig.h"
+
+#if CONFIG_AG_PROF_ENABLE
+
+#include "driver/gptimer.h"
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+#include "xtensa_context.h"
+#else
+#include "riscv/rvruntime-frames.h"
+#endif
+
+static const char *TAG = "profiler";
+
+#define PROF_CORES              (portNUM_PROCESSORS < PROF_MAX_CORES ? portNUM_PROCESSORS : PROF_MAX_CORES)
+#define PROF_MAX_TASKS          32
+#define PROF_TASK_OTHER         0xFF    // Task table full
+#define PROF_TIMER_HZ           1000000
+#define PROF_CHECK_MS           200
+
+typedef struct {
+    uint32_t pc;
+    uint8_t task;               // Index into the task table
+} prof_sample_t;
+
+typedef struct {
+    TaskHandle_t handle;
+    char name[configMAX_TASK_NAME_LEN];     // Copied: the task may be gone by dump time
+} prof_task_t;
+
+// Only the alarm ISR on this core writes here
+typedef struct {
+    gptimer_handle_t timer;
+    prof_sample_t *samples;
+    volatile uint32_t count;
+    volatile uint32_t nested;
+    esp_err_t setup_ret;
+} prof_core_t;
+
+// Module state; the task table is append-only, count published after the entry is filled
+static struct {
+    portMUX_TYPE lock;
+    volatile bool running;
+    uint32_t capacity;          // Samples per core for this run
+    uint32_t allocated;         // Samples per core the buffers hold
+    prof_core_t cores[PROF_MAX_CORES];
+    prof_task_t tasks[PROF_MAX_TASKS];
+    int task_count;
+    SemaphoreHandle_t setup_done;
+} prof_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static uint8_t prof_task_index(TaskHandle_t task)
+{
+    int count = __atomic_load_n(&prof_state.task_count, __ATOMIC_ACQUIRE);
+    for (int i = 0; i < count; i++) {
+        if (prof_state.tasks[i].handle == task) {
+            return i;
+        }
+    }
+
+    uint8_t index = PROF_TASK_OTHER;
+    portENTER_CRITICAL_ISR(&prof_state.lock);
+    // The other core may have added it meanwhile
+    for (int i = count; i < prof_state.task_count; i++) {
+        if (prof_state.tasks[i].handle == task) {
+            index = i;
+        }
+    }
+    if (index == PROF_TASK_OTHER && prof_state.task_count < PROF_MAX_TASKS) {
+        index = prof_state.task_count;
+        prof_state.tasks[index].handle = task;
+        strlcpy(prof_state.tasks[index].name, pcTaskGetName(task), sizeof(prof_state.tasks[index].name));
+        __atomic_store_n(&prof_state.task_count, index + 1, __ATOMIC_RELEASE);
+    }
+    portEXIT_CRITICAL_ISR(&prof_state.lock);
+    return index;
+}
+
+// Interrupt entry saved the task's context on its stack and stored that stack
+// pointer in pxTopOfStack, the first TCB field
+static uint32_t interrupted_pc(TaskHandle_t task)
+{
+    void *frame = *(void **)task;
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    return ((XtExcFrame *)frame)->pc;
+#else
+    return ((RvExcFrame *)frame)->mepc;
+#endif
+}
+
+// The alarm handler itself runs at nesting level 1; above that it preempted another ISR
+static inline bool prof_nested_isr(void)
+{
+#if CONFIG_IDF_TARGET_ARCH_XTENSA
+    extern volatile unsigned port_interruptNesting[];
+    return port_interruptNesting[xPortGetCoreID()] > 1;
+#else
+    extern volatile UBaseType_t port_uxInterruptNesting[];
+    return port_uxInterruptNesting[xPortGetCoreID()] > 1;
+#endif
+}
+
+static bool prof_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *arg)
+{
+    prof_core_t *core = (prof_core_t *)arg;
+    if (!prof_state.running) {
+        return false;
+    }
+    // Nested in another ISR: the saved frame belongs to that ISR's task, not the PC we hit
+    if (prof_nested_isr()) {
+        core->nested++;
+        return false;
+    }
+    if (core->count >= prof_state.capacity) {
+        gptimer_stop(timer);
+        return false;
+    }
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    prof_sample_t *sample = &core->samples[core->count];
+    sample->pc = interrupted_pc(task);
+    sample->task = prof_task_index(task);
+    core->count++;
+    return false;
+}
+
+// Runs on the core to sample: the alarm interrupt is allocated where the callbacks are registered
+static esp_err_t prof_timer_create(prof_core_t *core)
+{
+    gptimer_config_t config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = PROF_TIMER_HZ,
+    };
+    esp_err_t ret = gptimer_new_timer(&config, &core->timer);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    gptimer_event_callbacks_t callbacks = {
+        .on_alarm = prof_on_alarm,
+    };
+    gptimer_alarm_config_t alarm = {
+        .alarm_count = PROF_TIMER_HZ / CONFIG_AG_PROF_SAMPLE_HZ,
+        .reload_count = 0,
+        .flags.auto_reload_on_alarm = true,
+    };
+    ret = gptimer_register_event_callbacks(core->timer, &callbacks, core);
+    if (ret == ESP_OK) {
+        ret = gptimer_set_alarm_action(core->timer, &alarm);
+    }
+    if (ret == ESP_OK) {
+        ret = gptimer_enable(core->timer);
+    }
+    if (ret != ESP_OK) {
+        gptimer_del_timer(core->timer);
+        core->timer = NULL;
+    }
+    return ret;
+}
+
+static void prof_setup_task(void *arg)
+{
+    prof_core_t *core = (prof_core_t *)arg;
+    core->setup_ret = prof_timer_create(core);
+    xSemaphoreGive(prof_state.setup_done);
+    media_lib_thread_destroy(NULL);
+}
+
+// One timer per core, created once and kept
+static esp_err_t prof_timers_init(void)
+{
+    if (prof_state.cores[0].timer) {
+        return ESP_OK;
+    }
+    if (prof_state.setup_done == NULL) {
+        prof_state.setup_done = xSemaphoreCreateCounting(PROF_MAX_CORES, 0);
+        if (prof_state.setup_done == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    }
+    static const char *setup_names[PROF_MAX_CORES] = {"prof_0", "prof_1"};
+    for (int i = 0; i < PROF_CORES; i++) {
+        prof_core_t *core = &prof_state.cores[i];
+        if (media_lib_thread_create_from_scheduler(NULL, setup_names[i], prof_setup_task, core) != 0) {
+            ESP_LOGE(TAG, "Failed to create setup task for core %d", i);
+            return ESP_FAIL;
+        }
+        xSemaphoreTake(prof_state.setup_done, portMAX_DELAY);
+        if (core->setup_ret != ESP_OK) {
+            ESP_LOGE(TAG, "Timer on core %d: %s", i, esp_err_to_name(core->setup_ret));
+            return core->setup_ret;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t profiler_start(uint32_t seconds)
+{
+    if (seconds == 0 || seconds > CONFIG_AG_PROF_MAX_SECONDS) {
+        seconds = CONFIG_AG_PROF_MAX_SECONDS;
+    }
+    profiler_stop();
+    esp_err_t ret = prof_timers_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    // Buffers only grow; a shorter run reuses them
+    uint32_t capacity = seconds * CONFIG_AG_PROF_SAMPLE_HZ;
+    if (capacity > prof_state.allocated) {
+        prof_state.capacity = 0;
+        prof_state.allocated = 0;
+        for (int i = 0; i < PROF_CORES; i++) {
+            prof_core_t *core = &prof_state.cores[i];
+            mem_free(core->samples);
+            core->samples = mem_alloc(capacity * sizeof(prof_sample_t), MEM_POLICY_PREFER_PSRAM, "profiler");
+            if (core->samples == NULL) {
+                ESP_LOGE(TAG, "No memory for %" PRIu32 " samples", capacity);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        prof_state.allocated = capacity;
+    }
+
+    taskENTER_CRITICAL(&prof_state.lock);
+    prof_state.task_count = 0;
+    taskEXIT_CRITICAL(&prof_state.lock);
+    for (int i = 0; i < PROF_CORES; i++) {
+        prof_state.cores[i].count = 0;
+        prof_state.cores[i].nested = 0;
+    }
+    prof_state.capacity = capacity;
+    prof_state.running = true;
+    for (int i = 0; i < PROF_CORES; i++) {
+        gptimer_set_raw_count(prof_state.cores[i].timer, 0);
+        gptimer_start(prof_state.cores[i].timer);
+    }
+    ESP_LOGI(TAG, "Sampling at %d Hz for %" PRIu32 " s", CONFIG_AG_PROF_SAMPLE_HZ, seconds);
+    return ESP_OK;
+}
+
+void profiler_stop(void)
+{
+    if (!prof_state.running) {
+        return;
+    }
+    prof_state.running = false;
+    for (int i = 0; i < PROF_CORES; i++) {
+        // Already stopped by the ISR when its buffer filled up
+        gptimer_stop(prof_state.cores[i].timer);
+    }
+}
+
+void profiler_get_status(profiler_status_t *status)
+{
+    if (status == NULL) {
+        return;
+    }
+    memset(status, 0, sizeof(*status));
+    status->sample_hz = CONFIG_AG_PROF_SAMPLE_HZ;
+    status->capacity = prof_state.capacity;
+    for (int i = 0; i < PROF_CORES; i++) {
+        status->samples[i] = prof_state.cores[i].count;
+        status->nested[i] = prof_state.cores[i].nested;
+        status->running |= prof_state.running && status->samples[i] < prof_state.capacity;
+    }
+    status->tasks = __atomic_load_n(&prof_state.task_count, __ATOMIC_ACQUIRE);
+}
+
+static int sample_compare(const void *a, const void *b)
+{
+    const prof_sample_t *x = (const prof_sample_t *)a;
+    const prof_sample_t *y = (const prof_sample_t *)b;
+    if (x->task != y->task) {
+        return x->task < y->task ? -1 : 1;
+    }
+    if (x->pc != y->pc) {
+        return x->pc < y->pc ? -1 : 1;
+    }
+    return 0;
+}
+
+esp_err_t profiler_dump(void)
+{
+    profiler_stop();
+    profiler_status_t status;
+    profiler_get_status(&status);
+    if (status.samples[0] == 0 && status.samples[1] == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    printf("PROF BEGIN hz=%" PRIu32 " cores=%d\n", status.sample_hz, PROF_CORES);
+    for (int i = 0; i < (int)status.tasks; i++) {
+        printf("PROF T %d %s\n", i, prof_state.tasks[i].name);
+    }
+    printf("PROF T %d (other)\n", PROF_TASK_OTHER);
+
+    // Counted per task and PC; order within the run no longer matters
+    for (int c = 0; c < PROF_CORES; c++) {
+        prof_core_t *core = &prof_state.cores[c];
+        qsort(core->samples, core->count, sizeof(prof_sample_t), sample_compare);
+        uint32_t run = 0;
+        for (uint32_t i = 0; i < core->count; i++) {
+            run++;
+            if (i + 1 == core->count || sample_compare(&core->samples[i], &core->samples[i + 1]) != 0) {
+                printf("PROF S %d %u 0x%08" PRIx32 " %" PRIu32 "\n", c, core->samples[i].task, core->samples[i].pc, run);
+                run = 0;
+            }
+        }
+    }
+    printf("PROF END samples=%" PRIu32 ",%" PRIu32 " nested=%" PRIu32 ",%" PRIu32 "\n",
+           status.samples[0], status.samples[1], status.nested[0], status.nested[1]);
+    return ESP_OK;
+}
+
+esp_err_t profiler_check(profiler_status_t *status)
+{
+    esp_err_t ret = profiler_start(1);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // Task context on this core the whole time, so every tick should land
+    volatile uint32_t spins = 0;
+    int64_t end = esp_timer_get_time() + PROF_CHECK_MS * 1000;
+    while (esp_timer_get_time() < end) {
+        spins++;
+    }
+    profiler_stop();
+
+    profiler_status_t local;
+    status = status ? status : &local;
+    profiler_get_status(status);
+    uint32_t samples = 0;
+    for (int i = 0; i < PROF_CORES; i++) {
+        samples += status->samples[i];
+    }
+    if (samples == 0) {
+        ESP_LOGE(TAG, "No samples in %d ms of busy loop", PROF_CHECK_MS);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+#else // !CONFIG_AG_PROF_ENABLE
+
+esp_err_t profiler_start(uint32_t seconds)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void profiler_stop(void)
+{
+}
+
+void profiler_get_status(profiler_status_t *status)
+{
+    if (status) {
+        memset(status, 0, sizeof(*status));
+    }
+}
+
+esp_err_t profiler_dump(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t profiler_check(profiler_status_t *status)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_AG_PROF_ENABLE
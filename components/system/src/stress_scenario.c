@@ -0,0 +1,512 @@
+/*
+ * Stress Scenario
+ * Synthetic audio, vision, preview and data-channel load running together,
+ * measured against deadline, turn-latency and heap-drift SLOs.
+ */
+
+#include "stress_scenario.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sdkconfig.h"
+
+#if CONFIG_AG_STRESS_ENABLE
+
+#include "cJSON.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "mbedtls/base64.h"
+#include "media_lib_os.h"
+#include "memory_manager.h"
+
+static const char *TAG = "stress";
+
+#define STRESS_FRAME_US         20000   // Audio frame period
+#define STRESS_FRAME_SAMPLES    480     // 20 ms at 24 kHz
+#define STRESS_COEFFS           64
+#define STRESS_CALIBRATE_ROUNDS 64
+#define STRESS_MAX_AUDIO        2
+#define STRESS_MAX_TASKS        (STRESS_MAX_AUDIO + 3)
+#define STRESS_MAX_TURNS        128
+#define STRESS_TICK_MS          10      // Poll period of the rate-driven workloads
+#define STRESS_CHUNK            4096    // Preview send chunk, as httpd_resp_send_chunk gets it
+#define STRESS_DC_MSG_MAX       512
+#define STRESS_IMAGE_PREFIX     "data:image/jpeg;base64,"
+
+// Module state; each workload task writes only its own result fields
+static struct {
+    portMUX_TYPE lock;
+    bool running;
+    volatile bool stop;
+    const stress_scenario_cfg_t *cfg;
+    stress_scenario_result_t *result;
+    SemaphoreHandle_t done;             // Given by each task as it exits
+    QueueHandle_t turns;                // Turn start times, data channel -> vision
+    uint8_t *frame;                     // Synthetic JPEG every workload reads
+    uint32_t frame_len;
+    float coeffs[STRESS_COEFFS];
+    uint32_t audio_rounds;              // Kernel rounds per frame
+    uint32_t turn_ms[STRESS_MAX_TURNS];
+    volatile float sink;                // Keeps the kernel from being optimized away
+} stress_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static inline uint32_t lcg_next(uint32_t *seed)
+{
+    *seed = *seed * 1664525u + 1013904223u;
+    return *seed;
+}
+
+// Multiply-accumulate over the frame against a rotating coefficient window,
+// the shape (not the maths) of a transform codec's analysis stage
+static float audio_kernel(const float *pcm, uint32_t rounds)
+{
+    float acc = 0.0f;
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (int n = 0; n < STRESS_FRAME_SAMPLES; n++) {
+            acc = acc * 0.999f + pcm[n] * stress_state.coeffs[(n + r) & (STRESS_COEFFS - 1)];
+        }
+    }
+    return acc;
+}
+
+// Rounds that take audio_encode_us on this core while nothing else runs
+static uint32_t audio_calibrate(uint32_t encode_us)
+{
+    float *pcm = mem_alloc(STRESS_FRAME_SAMPLES * sizeof(float), MEM_POLICY_REQUIRE_INTERNAL, "stress_pcm");
+    if (pcm == NULL) {
+        return 1;
+    }
+    for (int n = 0; n < STRESS_FRAME_SAMPLES; n++) {
+        pcm[n] = (float)(n % 97) / 97.0f;
+    }
+    int64_t start = esp_timer_get_time();
+    stress_state.sink = audio_kernel(pcm, STRESS_CALIBRATE_ROUNDS);
+    int64_t elapsed = esp_timer_get_time() - start;
+    mem_free(pcm);
+    if (elapsed <= 0) {
+        elapsed = 1;
+    }
+    uint64_t rounds = (uint64_t)STRESS_CALIBRATE_ROUNDS * encode_us / elapsed;
+    return rounds ? (uint32_t)rounds : 1;
+}
+
+static void task_exit(void)
+{
+    xSemaphoreGive(stress_state.done);
+    media_lib_thread_destroy(NULL);
+}
+
+// One 20 ms stream: frames are released on a fixed schedule and queue up behind
+// a slow one, as captured audio does, so one stall can cost several deadlines
+static void stress_audio_task(void *arg)
+{
+    float *pcm = mem_alloc(STRESS_FRAME_SAMPLES * sizeof(float), MEM_POLICY_REQUIRE_INTERNAL, "stress_pcm");
+    uint32_t frames = 0;
+    uint32_t misses = 0;
+    uint32_t late_max = 0;
+    uint32_t seed = (uint32_t)(uintptr_t)arg;
+
+    int64_t start = esp_timer_get_time();
+    while (pcm && !stress_state.stop) {
+        int64_t release = start + (int64_t)frames * STRESS_FRAME_US;
+        int64_t wait = release - esp_timer_get_time();
+        if (wait > 0) {
+            vTaskDelay(pdMS_TO_TICKS((wait + 999) / 1000));
+        }
+        for (int n = 0; n < STRESS_FRAME_SAMPLES; n++) {
+            pcm[n] = (float)(int16_t)lcg_next(&seed) / 32768.0f;
+        }
+        stress_state.sink = audio_kernel(pcm, stress_state.audio_rounds);
+
+        int64_t late = esp_timer_get_time() - release;
+        if (late > STRESS_FRAME_US) {
+            misses++;
+        }
+        if (late > late_max) {
+            late_max = (uint32_t)late;
+        }
+        frames++;
+    }
+    mem_free(pcm);
+
+    taskENTER_CRITICAL(&stress_state.lock);
+    stress_state.result->audio_frames += frames;
+    stress_state.result->audio_misses += misses;
+    if (late_max > stress_state.result->audio_late_max_us) {
+        stress_state.result->audio_late_max_us = late_max;
+    }
+    taskEXIT_CRITICAL(&stress_state.lock);
+    task_exit();
+}
+
+// Capture into PSRAM and base64 it; a turn also wraps it in the conversation.item.create
+// the vision request sends, built and printed with cJSON
+static bool vision_capture(bool turn)
+{
+    size_t prefix = strlen(STRESS_IMAGE_PREFIX);
+    size_t b64_size = prefix + (stress_state.frame_len + 2) / 3 * 4 + 1;
+    uint8_t *frame = mem_alloc(stress_state.frame_len, MEM_POLICY_PREFER_PSRAM, "stress_frame");
+    unsigned char *b64 = mem_alloc(b64_size, MEM_POLICY_PREFER_PSRAM, "stress_b64");
+    bool ok = frame && b64;
+    if (ok) {
+        memcpy(frame, stress_state.frame, stress_state.frame_len);
+        memcpy(b64, STRESS_IMAGE_PREFIX, prefix);
+        size_t written = 0;
+        ok = mbedtls_base64_encode(b64 + prefix, b64_size - prefix, &written,
+                                   frame, stress_state.frame_len) == 0;
+    }
+    if (ok && turn) {
+        cJSON *root = cJSON_CreateObject();
+        cJSON *item = cJSON_AddObjectToObject(root, "item");
+        cJSON *content = cJSON_AddArrayToObject(item, "content");
+        cJSON *image = cJSON_CreateObject();
+        cJSON_AddStringToObject(root, "type", "conversation.item.create");
+        cJSON_AddStringToObject(item, "type", "message");
+        cJSON_AddStringToObject(item, "role", "user");
+        cJSON_AddStringToObject(image, "type", "input_image");
+        cJSON_AddStringToObject(image, "image_url", (const char *)b64);
+        cJSON_AddItemToArray(content, image);
+        char *json = cJSON_PrintUnformatted(root);
+        ok = json != NULL;
+        cJSON_free(json);
+        cJSON_Delete(root);
+    }
+    mem_free(frame);
+    mem_free(b64);
+    return ok;
+}
+
+static void stress_vision_task(void *arg)
+{
+    const stress_scenario_cfg_t *cfg = stress_state.cfg;
+    stress_scenario_result_t *result = stress_state.result;
+    uint32_t captures = 0;
+    int64_t start = esp_timer_get_time();
+
+    while (!stress_state.stop) {
+        int64_t requested;
+        if (xQueueReceive(stress_state.turns, &requested, pdMS_TO_TICKS(STRESS_TICK_MS)) == pdTRUE) {
+            if (!vision_capture(true)) {
+                result->vision_failures++;
+            }
+            if (result->turns < STRESS_MAX_TURNS) {
+                stress_state.turn_ms[result->turns] = (uint32_t)((esp_timer_get_time() - requested) / 1000);
+            }
+            result->turns++;
+            continue;
+        }
+        uint32_t due = (uint32_t)((esp_timer_get_time() - start) * cfg->vision_fps / 1000000);
+        for (; captures < due && !stress_state.stop; captures++) {
+            if (vision_capture(false)) {
+                result->vision_frames++;
+            } else {
+                result->vision_failures++;
+            }
+        }
+    }
+    task_exit();
+}
+
+// Every client gets each frame as a multipart header plus STRESS_CHUNK pieces
+static void stress_preview_task(void *arg)
+{
+    const stress_scenario_cfg_t *cfg = stress_state.cfg;
+    stress_scenario_result_t *result = stress_state.result;
+    char *chunk = mem_alloc(STRESS_CHUNK, MEM_POLICY_REQUIRE_INTERNAL, "stress_chunk");
+    uint32_t frames = 0;
+    int64_t start = esp_timer_get_time();
+
+    while (chunk && !stress_state.stop) {
+        vTaskDelay(pdMS_TO_TICKS(STRESS_TICK_MS));
+        uint32_t due = (uint32_t)((esp_timer_get_time() - start) * cfg->preview_fps / 1000000);
+        for (; frames < due && !stress_state.stop; frames++) {
+            for (uint32_t c = 0; c < cfg->preview_clients; c++) {
+                snprintf(chunk, STRESS_CHUNK, "\r\n--frame\r\nContent-Type: image/jpeg\r\nContent-Length: %" PRIu32 "\r\n\r\n",
+                         stress_state.frame_len);
+                for (uint32_t off = 0; off < stress_state.frame_len; off += STRESS_CHUNK) {
+                    uint32_t n = stress_state.frame_len - off < STRESS_CHUNK ? stress_state.frame_len - off : STRESS_CHUNK;
+                    memcpy(chunk, stress_state.frame + off, n);
+                }
+                result->preview_frames++;
+            }
+        }
+    }
+    mem_free(chunk);
+    task_exit();
+}
+
+static const char *dc_event_types[] = {
+    "response.audio_transcript.delta",
+    "response.output_audio.delta",
+    "input_audio_buffer.speech_started",
+    "rate_limits.updated",
+};
+
+// Server events arrive at a steady rate and are parsed like the data channel handler does;
+// every turn_interval_ms one starts a vision turn
+static void stress_dc_task(void *arg)
+{
+    const stress_scenario_cfg_t *cfg = stress_state.cfg;
+    stress_scenario_result_t *result = stress_state.result;
+    char *msg = mem_alloc(STRESS_DC_MSG_MAX, MEM_POLICY_PREFER_PSRAM, "stress_dc");
+    uint32_t seed = 1;
+    uint32_t turns_started = 0;
+    int64_t start = esp_timer_get_time();
+
+    while (msg && !stress_state.stop) {
+        vTaskDelay(pdMS_TO_TICKS(STRESS_TICK_MS));
+        int64_t now = esp_timer_get_time();
+        uint32_t due = (uint32_t)((now - start) * cfg->dc_msgs_per_s / 1000000);
+        while (result->dc_messages < due && !stress_state.stop) {
+            uint32_t n = result->dc_messages;
+            snprintf(msg, STRESS_DC_MSG_MAX,
+                     "{\"type\":\"%s\",\"event_id\":\"event_%08" PRIx32 "\",\"response_id\":\"resp_%08" PRIx32 "\","
+                     "\"item_id\":\"item_%08" PRIx32 "\",\"output_index\":0,\"content_index\":0,"
+                     "\"delta\":\"The quick brown fox jumps over the lazy dog %" PRIu32 "\"}",
+                     dc_event_types[n % (sizeof(dc_event_types) / sizeof(dc_event_types[0]))],
+                     lcg_next(&seed), n / 40, n / 10, n);
+
+            int64_t parse_start = esp_timer_get_time();
+            cJSON *event = cJSON_Parse(msg);
+            const cJSON *type = cJSON_GetObjectItem(event, "type");
+            const cJSON *delta = cJSON_GetObjectItem(event, "delta");
+            if (cJSON_IsString(type) && strcmp(type->valuestring, "response.audio_transcript.delta") == 0 &&
+                cJSON_IsString(delta)) {
+                stress_state.sink += (float)strlen(delta->valuestring);
+            }
+            cJSON_Delete(event);
+            uint32_t parse_us = (uint32_t)(esp_timer_get_time() - parse_start);
+            if (parse_us > result->dc_max_us) {
+                result->dc_max_us = parse_us;
+            }
+            result->dc_messages++;
+        }
+        if (cfg->turn_interval_ms &&
+            (now - start) / 1000 >= (int64_t)(turns_started + 1) * cfg->turn_interval_ms) {
+            turns_started++;
+            xQueueSend(stress_state.turns, &now, 0);
+        }
+    }
+    mem_free(msg);
+    task_exit();
+}
+
+void stress_scenario_default_cfg(stress_scenario_cfg_t *cfg)
+{
+    if (cfg == NULL) {
+        return;
+    }
+    *cfg = (stress_scenario_cfg_t) {
+        .duration_s = 30,
+        .audio_streams = CONFIG_AG_STRESS_AUDIO_STREAMS,
+        .audio_encode_us = CONFIG_AG_STRESS_AUDIO_ENCODE_US,
+        .vision_fps = CONFIG_AG_STRESS_VISION_FPS,
+        .frame_kb = CONFIG_AG_STRESS_FRAME_KB,
+        .preview_clients = CONFIG_AG_STRESS_PREVIEW_CLIENTS,
+        .preview_fps = CONFIG_AG_STRESS_PREVIEW_FPS,
+        .dc_msgs_per_s = CONFIG_AG_STRESS_DC_MSGS_PER_S,
+        .turn_interval_ms = CONFIG_AG_STRESS_TURN_INTERVAL_MS,
+        .slo_audio_miss_permille = CONFIG_AG_STRESS_SLO_AUDIO_MISS_PERMILLE,
+        .slo_turn_p95_ms = CONFIG_AG_STRESS_SLO_TURN_P95_MS,
+        .slo_heap_drift_kb = CONFIG_AG_STRESS_SLO_HEAP_DRIFT_KB,
+    };
+}
+
+static int compare_u32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void finish_result(const stress_scenario_cfg_t *cfg, stress_scenario_result_t *result)
+{
+    uint32_t kept = result->turns < STRESS_MAX_TURNS ? result->turns : STRESS_MAX_TURNS;
+    if (kept) {
+        qsort(stress_state.turn_ms, kept, sizeof(uint32_t), compare_u32);
+        result->turn_p50_ms = stress_state.turn_ms[kept / 2];
+        result->turn_p95_ms = stress_state.turn_ms[(kept * 95 - 1) / 100];
+        result->turn_max_ms = stress_state.turn_ms[kept - 1];
+    }
+    result->audio_pass = (uint64_t)result->audio_misses * 1000 <=
+                         (uint64_t)cfg->slo_audio_miss_permille * result->audio_frames;
+    // Turns were asked for but none finished: that is a miss, not a pass
+    result->turn_pass = cfg->turn_interval_ms == 0 ||
+                        cfg->duration_s * 1000 < cfg->turn_interval_ms ||
+                        (result->turns > 0 && result->turn_p95_ms <= cfg->slo_turn_p95_ms);
+    result->heap_pass = result->heap_drift_bytes <= (int32_t)(cfg->slo_heap_drift_kb * 1024);
+    result->pass = result->audio_pass && result->turn_pass && result->heap_pass;
+}
+
+static int spawn(const char *name, void (*body)(void *), void *arg)
+{
+    if (media_lib_thread_create_from_scheduler(NULL, name, body, arg) != 0) {
+        ESP_LOGE(TAG, "Failed to create %s", name);
+        return 0;
+    }
+    return 1;
+}
+
+esp_err_t stress_scenario_run(const stress_scenario_cfg_t *cfg, stress_scenario_result_t *result)
+{
+    if (cfg == NULL || result == NULL || cfg->duration_s == 0 || cfg->frame_kb == 0 ||
+        cfg->audio_streams > STRESS_MAX_AUDIO) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&stress_state.lock);
+    bool busy = stress_state.running;
+    stress_state.running = true;
+    taskEXIT_CRITICAL(&stress_state.lock);
+    if (busy) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    memset(result, 0, sizeof(*result));
+    uint32_t heap_before = esp_get_free_heap_size();
+    result->heap_min_free_kb = heap_before / 1024;
+
+    esp_err_t ret = ESP_OK;
+    stress_state.cfg = cfg;
+    stress_state.result = result;
+    stress_state.stop = false;
+    stress_state.frame_len = cfg->frame_kb * 1024;
+    stress_state.frame = mem_alloc(stress_state.frame_len, MEM_POLICY_PREFER_PSRAM, "stress_src");
+    stress_state.done = xSemaphoreCreateCounting(STRESS_MAX_TASKS, 0);
+    stress_state.turns = xQueueCreate(8, sizeof(int64_t));
+    if (stress_state.frame == NULL || stress_state.done == NULL || stress_state.turns == NULL) {
+        ret = ESP_ERR_NO_MEM;
+        goto cleanup;
+    }
+
+    // JPEG markers around noise, so base64 sees incompressible-looking data
+    uint32_t seed = 0x5EED;
+    for (uint32_t i = 0; i < stress_state.frame_len; i++) {
+        stress_state.frame[i] = (uint8_t)(lcg_next(&seed) >> 24);
+    }
+    stress_state.frame[0] = 0xFF;
+    stress_state.frame[1] = 0xD8;
+    stress_state.frame[stress_state.frame_len - 2] = 0xFF;
+    stress_state.frame[stress_state.frame_len - 1] = 0xD9;
+    for (int i = 0; i < STRESS_COEFFS; i++) {
+        stress_state.coeffs[i] = (float)((i * 37) % STRESS_COEFFS) / STRESS_COEFFS - 0.5f;
+    }
+    if (cfg->audio_streams) {
+        stress_state.audio_rounds = audio_calibrate(cfg->audio_encode_us);
+    }
+
+    ESP_LOGI(TAG, "Running %" PRIu32 " s: %" PRIu32 " audio (%" PRIu32 " rounds/frame), vision %" PRIu32 " fps, "
+             "%" PRIu32 " preview clients, %" PRIu32 " dc msg/s, turn every %" PRIu32 " ms",
+             cfg->duration_s, cfg->audio_streams, stress_state.audio_rounds, cfg->vision_fps,
+             cfg->preview_clients, cfg->dc_msgs_per_s, cfg->turn_interval_ms);
+
+    static const char *audio_names[STRESS_MAX_AUDIO] = {"st_audio0", "st_audio1"};
+    int tasks = 0;
+    int64_t start = esp_timer_get_time();
+    for (uint32_t i = 0; i < cfg->audio_streams; i++) {
+        tasks += spawn(audio_names[i], stress_audio_task, (void *)(uintptr_t)(i + 1));
+    }
+    if (cfg->vision_fps || cfg->turn_interval_ms) {
+        tasks += spawn("st_vision", stress_vision_task, NULL);
+    }
+    if (cfg->preview_clients && cfg->preview_fps) {
+        tasks += spawn("st_preview", stress_preview_task, NULL);
+    }
+    if (cfg->dc_msgs_per_s || cfg->turn_interval_ms) {
+        tasks += spawn("st_dc", stress_dc_task, NULL);
+    }
+
+    int64_t end = start + (int64_t)cfg->duration_s * 1000000;
+    while (esp_timer_get_time() < end) {
+        vTaskDelay(pdMS_TO_TICKS(100));
+        uint32_t free_kb = esp_get_free_heap_size() / 1024;
+        if (free_kb < result->heap_min_free_kb) {
+            result->heap_min_free_kb = free_kb;
+        }
+    }
+    stress_state.stop = true;
+    // The tasks write through cfg and result, which live in the caller's frame,
+    // so this cannot return before every one of them has exited
+    for (int i = 0; i < tasks; i++) {
+        if (xSemaphoreTake(stress_state.done, pdMS_TO_TICKS(5000)) != pdTRUE) {
+            ESP_LOGW(TAG, "Workload task slow to stop, %d of %d still running", tasks - i, tasks);
+            xSemaphoreTake(stress_state.done, portMAX_DELAY);
+        }
+    }
+    result->duration_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+
+cleanup:
+    mem_free(stress_state.frame);
+    stress_state.frame = NULL;
+    if (stress_state.done) {
+        vSemaphoreDelete(stress_state.done);
+        stress_state.done = NULL;
+    }
+    if (stress_state.turns) {
+        vQueueDelete(stress_state.turns);
+        stress_state.turns = NULL;
+    }
+    if (ret == ESP_OK) {
+        // Idle frees the workload task stacks
+        vTaskDelay(pdMS_TO_TICKS(200));
+        result->heap_drift_bytes = (int32_t)heap_before - (int32_t)esp_get_free_heap_size();
+        finish_result(cfg, result);
+    }
+    stress_state.running = false;
+    return ret;
+}
+
+void stress_scenario_print_result(const stress_scenario_cfg_t *cfg, const stress_scenario_result_t *result)
+{
+    if (cfg == NULL || result == NULL || result->duration_ms == 0) {
+        printf("No stress results\n");
+        return;
+    }
+    printf("========== Stress Scenario ==========\n");
+    printf("Duration: %.1f s\n", result->duration_ms / 1000.0);
+    printf("Audio:   %" PRIu32 " frames, %" PRIu32 " deadline misses (%.2f%%), worst %.1f ms after release\n",
+           result->audio_frames, result->audio_misses,
+           result->audio_frames ? result->audio_misses * 100.0 / result->audio_frames : 0.0,
+           result->audio_late_max_us / 1000.0);
+    printf("Vision:  %" PRIu32 " frames, %" PRIu32 " failures\n", result->vision_frames, result->vision_failures);
+    printf("Preview: %" PRIu32 " frames sent\n", result->preview_frames);
+    printf("DC:      %" PRIu32 " messages, worst parse %" PRIu32 " us\n", result->dc_messages, result->dc_max_us);
+    printf("Turns:   %" PRIu32 ", p50 %" PRIu32 " ms, p95 %" PRIu32 " ms, max %" PRIu32 " ms\n",
+           result->turns, result->turn_p50_ms, result->turn_p95_ms, result->turn_max_ms);
+    printf("Heap:    drift %" PRId32 " bytes, lowest free %" PRIu32 " KB\n",
+           result->heap_drift_bytes, result->heap_min_free_kb);
+    printf("SLO audio misses <= %" PRIu32 " permille: %s\n", cfg->slo_audio_miss_permille,
+           result->audio_pass ? "PASS" : "FAIL");
+    printf("SLO turn p95 <= %" PRIu32 " ms: %s\n", cfg->slo_turn_p95_ms, result->turn_pass ? "PASS" : "FAIL");
+    printf("SLO heap drift <= %" PRIu32 " KB: %s\n", cfg->slo_heap_drift_kb, result->heap_pass ? "PASS" : "FAIL");
+    printf("Result: %s\n", result->pass ? "PASS" : "FAIL");
+    printf("=====================================\n");
+}
+
+#else // !CONFIG_AG_STRESS_ENABLE
+
+void stress_scenario_default_cfg(stress_scenario_cfg_t *cfg)
+{
+    if (cfg) {
+        memset(cfg, 0, sizeof(*cfg));
+    }
+}
+
+esp_err_t stress_scenario_run(const stress_scenario_cfg_t *cfg, stress_scenario_result_t *result)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void stress_scenario_print_result(const stress_scenario_cfg_t *cfg, const stress_scenario_result_t *result)
+{
+    printf("Stress scenario not enabled (CONFIG_AG_STRESS_ENABLE)\n");
+}
+
+#endif // CONFIG_AG_STRESS_ENABLE
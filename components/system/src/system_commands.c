@@ -5,11 +5,20 @@
 
 #include "system_commands.h"
 #include "memory_manager.h"
+#include "boot_orchestrator.h"
+#include "metrics.h"
+#include "trace.h"
+#include "profiler.h"
+#include "log_async.h"
+#include "stress_scenario.h"
 #include <esp_log.h>
 #include <esp_console.h>
 #include <esp_system.h>
 #include <esp_chip_info.h>
 #include <argtable3/argtable3.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
 #include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -64,14 +73,200 @@ static int cmd_sys_info(int argc, char **argv)
     return 0;
 }
 
+// boot_timing command
+static int cmd_boot_timing(int argc, char **argv)
+{
+    boot_orchestrator_print();
+    return 0;
+}
+
+// metrics command
+static struct {
+    struct arg_str *prefix;
+    struct arg_end *end;
+} metrics_args;
+
+static int cmd_metrics(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &metrics_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, metrics_args.end, argv[0]);
+        return 1;
+    }
+    metrics_print(metrics_args.prefix->count ? metrics_args.prefix->sval[0] : NULL);
+    return 0;
+}
+
+// trace command
+static struct {
+    struct arg_str *action;
+    struct arg_end *end;
+} trace_args;
+
+static int trace_write_stdout(const char *data, size_t len, void *ctx)
+{
+    return fwrite(data, 1, len, stdout) == len ? 0 : -1;
+}
+
+static int cmd_trace(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &trace_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, trace_args.end, argv[0]);
+        return 1;
+    }
+    
+    const char *action = trace_args.action->count ? trace_args.action->sval[0] : "status";
+    esp_err_t ret = ESP_OK;
+    if (strcmp(action, "start") == 0) {
+        ret = trace_start();
+    } else if (strcmp(action, "stop") == 0) {
+        trace_stop();
+    } else if (strcmp(action, "dump") == 0) {
+        ret = trace_export_json(trace_write_stdout, NULL);
+        fflush(stdout);
+    } else if (strcmp(action, "status") != 0) {
+        printf("Usage: trace [start|stop|status|dump]\n");
+        return 1;
+    }
+    if (ret != ESP_OK) {
+        printf("trace %s: %s\n", action, esp_err_to_name(ret));
+        return 1;
+    }
+    
+    if (strcmp(action, "dump") != 0) {
+        trace_status_t status;
+        trace_get_status(&status);
+        printf("Tracing %s, %lu events per core, recorded core 0: %lu, core 1: %lu\n",
+               status.running ? "on" : "off", status.capacity, status.recorded[0], status.recorded[1]);
+    }
+    return 0;
+}
+
+// prof command
+static struct {
+    struct arg_str *action;
+    struct arg_int *seconds;
+    struct arg_end *end;
+} prof_args;
+
+static int cmd_prof(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &prof_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, prof_args.end, argv[0]);
+        return 1;
+    }
+    
+    const char *action = prof_args.action->count ? prof_args.action->sval[0] : "status";
+    esp_err_t ret = ESP_OK;
+    if (strcmp(action, "start") == 0) {
+        ret = profiler_start(prof_args.seconds->count ? prof_args.seconds->ival[0] : 0);
+    } else if (strcmp(action, "stop") == 0) {
+        profiler_stop();
+    } else if (strcmp(action, "dump") == 0) {
+        ret = profiler_dump();
+        fflush(stdout);
+    } else if (strcmp(action, "check") == 0) {
+        ret = profiler_check(NULL);
+    } else if (strcmp(action, "status") != 0) {
+        printf("Usage: prof [start [seconds]|stop|status|dump|check]\n");
+        return 1;
+    }
+    if (ret != ESP_OK) {
+        printf("prof %s: %s\n", action, esp_err_to_name(ret));
+        return 1;
+    }
+    
+    if (strcmp(action, "dump") != 0) {
+        profiler_status_t status;
+        profiler_get_status(&status);
+        printf("Profiling %s at %" PRIu32 " Hz, %" PRIu32 " samples per core, core 0: %" PRIu32 " (%" PRIu32 " nested), "
+               "core 1: %" PRIu32 " (%" PRIu32 " nested), %" PRIu32 " tasks\n",
+               status.running ? "on" : "off", status.sample_hz, status.capacity,
+               status.samples[0], status.nested[0], status.samples[1], status.nested[1], status.tasks);
+    }
+    return 0;
+}
+
+// log command
+static struct {
+    struct arg_str *action;
+    struct arg_str *tag;
+    struct arg_int *per_sec;
+    struct arg_int *burst;
+    struct arg_end *end;
+} log_args;
+
+static int cmd_log(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **) &log_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, log_args.end, argv[0]);
+        return 1;
+    }
+    
+    const char *action = log_args.action->count ? log_args.action->sval[0] : "status";
+    if (strcmp(action, "limit") == 0) {
+        if (!log_args.tag->count || !log_args.per_sec->count || log_args.per_sec->ival[0] < 0 ||
+            log_args.per_sec->ival[0] > UINT16_MAX) {
+            printf("Usage: log limit <tag> <lines_per_sec> [burst]; 0 removes the limit\n");
+            return 1;
+        }
+        int burst = log_args.burst->count ? log_args.burst->ival[0] : 0;
+        esp_err_t ret = log_async_set_limit(log_args.tag->sval[0], log_args.per_sec->ival[0],
+                                            burst > 0 && burst <= UINT16_MAX ? burst : 0);
+        if (ret != ESP_OK) {
+            printf("log limit: %s\n", esp_err_to_name(ret));
+            return 1;
+        }
+    } else if (strcmp(action, "sync") == 0 || strcmp(action, "async") == 0) {
+        log_async_set_enabled(strcmp(action, "async") == 0);
+    } else if (strcmp(action, "flush") == 0) {
+        log_async_flush();
+    } else if (strcmp(action, "status") != 0) {
+        printf("Usage: log [status|limit <tag> <per_sec> [burst]|sync|async|flush]\n");
+        return 1;
+    }
+    
+    log_async_status_t status;
+    log_async_get_status(&status);
+    printf("Log output %s, buffer %lu/%lu bytes (peak %lu), %lu lines, dropped %lu over limits, %lu buffer full\n",
+           status.enabled ? "async" : "sync", status.buffer_used, status.buffer_size, status.buffer_peak,
+           status.lines, status.dropped_rate, status.dropped_full);
+    log_async_limit_t limits[LOG_ASYNC_MAX_LIMITS];
+    int count = log_async_get_limits(limits, LOG_ASYNC_MAX_LIMITS);
+    for (int i = 0; i < count; i++) {
+        printf("  %-16s %5u/s burst %-5u passed %-8lu dropped %lu\n", limits[i].tag,
+               limits[i].per_sec, limits[i].burst, limits[i].passed, limits[i].dropped);
+    }
+    return 0;
+}
+
 // stress_test command
 static struct {
     struct arg_int *duration;
-    struct arg_lit *memory;
-    struct arg_lit *cpu;
+    struct arg_int *audio;
+    struct arg_int *vision;
+    struct arg_int *preview;
+    struct arg_int *dc;
+    struct arg_int *turn;
     struct arg_end *end;
 } stress_args;
 
+// Overrides the Kconfig default when given
+static bool stress_option(const struct arg_int *arg, uint32_t *value)
+{
+    if (arg->count == 0) {
+        return true;
+    }
+    if (arg->ival[0] < 0) {
+        return false;
+    }
+    *value = arg->ival[0];
+    return true;
+}
+
 static int cmd_stress_test(int argc, char **argv)
 {
     int nerrors = arg_parse(argc, argv, (void **) &stress_args);
@@ -80,45 +275,28 @@ static int cmd_stress_test(int argc, char **argv)
         return 1;
     }
     
-    int duration = stress_args.duration->ival[0];
-    bool test_memory = stress_args.memory->count > 0;
-    bool test_cpu = stress_args.cpu->count > 0;
-    
-    ESP_LOGI(TAG, "Starting stress test for %d seconds...", duration);
-    
-    if (test_memory) {
-        ESP_LOGI(TAG, "Memory stress: allocating/freeing buffers");
-        // Simple memory stress
-        for (int i = 0; i < duration * 10; i++) {
-            void* ptr = mem_alloc(1024 + (i % 10) * 1024, 
-                                 MEM_POLICY_ADAPTIVE, "stress");
-            if (ptr) {
-                vTaskDelay(pdMS_TO_TICKS(50));
-                mem_free(ptr);
-            }
-            vTaskDelay(pdMS_TO_TICKS(50));
-        }
+    stress_scenario_cfg_t cfg;
+    stress_scenario_default_cfg(&cfg);
+    cfg.duration_s = stress_args.duration->ival[0];
+    if (!stress_option(stress_args.audio, &cfg.audio_streams) ||
+        !stress_option(stress_args.vision, &cfg.vision_fps) ||
+        !stress_option(stress_args.preview, &cfg.preview_clients) ||
+        !stress_option(stress_args.dc, &cfg.dc_msgs_per_s) ||
+        !stress_option(stress_args.turn, &cfg.turn_interval_ms) ||
+        stress_args.duration->ival[0] <= 0) {
+        printf("Duration must be positive and rates not negative\n");
+        return 1;
     }
     
-    if (test_cpu) {
-        ESP_LOGI(TAG, "CPU stress: computation loop");
-        // Simple CPU stress
-        volatile uint32_t counter = 0;
-        uint64_t end_time = esp_timer_get_time() + (duration * 1000000);
-        while (esp_timer_get_time() < end_time) {
-            for (int i = 0; i < 10000; i++) {
-                counter++;
-            }
-            if (counter % 1000000 == 0) {
-                vTaskDelay(1); // Yield occasionally
-            }
-        }
+    stress_scenario_result_t result;
+    esp_err_t ret = stress_scenario_run(&cfg, &result);
+    if (ret != ESP_OK) {
+        printf("stress_test: %s\n", esp_err_to_name(ret));
+        return 1;
     }
-    
-    ESP_LOGI(TAG, "Stress test completed");
+    stress_scenario_print_result(&cfg, &result);
     memory_manager_print_status();
-    
-    return 0;
+    return result.pass ? 0 : 1;
 }
 
 // restart command
@@ -161,16 +339,84 @@ esp_err_t system_commands_register(void)
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&sys_info_cmd));
     
+    // boot_timing command
+    const esp_console_cmd_t boot_timing_cmd = {
+        .command = "boot_timing",
+        .help = "Show per-step boot timing",
+        .hint = NULL,
+        .func = &cmd_boot_timing,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&boot_timing_cmd));
+    
+    // metrics command
+    metrics_args.prefix = arg_str0(NULL, NULL, "<prefix>", "Only metrics whose name starts with this");
+    metrics_args.end = arg_end(1);
+    
+    const esp_console_cmd_t metrics_cmd = {
+        .command = "metrics",
+        .help = "Show registered counters, gauges and histograms",
+        .hint = "[<prefix>]",
+        .func = &cmd_metrics,
+        .argtable = &metrics_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&metrics_cmd));
+    
+    // trace command
+    trace_args.action = arg_str0(NULL, NULL, "<start|stop|status|dump>", "Action, status by default");
+    trace_args.end = arg_end(1);
+    
+    const esp_console_cmd_t trace_cmd = {
+        .command = "trace",
+        .help = "Record a task timeline; dump prints Chrome trace JSON",
+        .hint = "[start|stop|status|dump]",
+        .func = &cmd_trace,
+        .argtable = &trace_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&trace_cmd));
+    
+    // prof command
+    prof_args.action = arg_str0(NULL, NULL, "<start|stop|status|dump|check>", "Action, status by default");
+    prof_args.seconds = arg_int0(NULL, NULL, "<seconds>", "Sampling time for start");
+    prof_args.end = arg_end(2);
+    
+    const esp_console_cmd_t prof_cmd = {
+        .command = "prof",
+        .help = "Sample PC and task on both cores; dump prints PROF lines for tools/prof/prof_report.py",
+        .hint = "[start [<seconds>]|stop|status|dump]",
+        .func = &cmd_prof,
+        .argtable = &prof_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&prof_cmd));
+    
+    // log command
+    log_args.action = arg_str0(NULL, NULL, "<status|limit|sync|async|flush>", "Action, status by default");
+    log_args.tag = arg_str0(NULL, NULL, "<tag>", "Tag for limit");
+    log_args.per_sec = arg_int0(NULL, NULL, "<per_sec>", "Lines per second for limit, 0 removes it");
+    log_args.burst = arg_int0(NULL, NULL, "<burst>", "Lines allowed at once, per_sec by default");
+    log_args.end = arg_end(4);
+    
+    const esp_console_cmd_t log_cmd = {
+        .command = "log",
+        .help = "Async log output: buffer and drop counters, per-tag rate limits",
+        .hint = "[status|limit <tag> <per_sec> [burst]|sync|async|flush]",
+        .func = &cmd_log,
+        .argtable = &log_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&log_cmd));
+    
     // stress_test command
     stress_args.duration = arg_int1(NULL, NULL, "<seconds>", "Test duration");
-    stress_args.memory = arg_lit0("m", "memory", "Test memory allocation");
-    stress_args.cpu = arg_lit0("c", "cpu", "Test CPU load");
-    stress_args.end = arg_end(2);
+    stress_args.audio = arg_int0("a", "audio", "<streams>", "20 ms audio encode streams (0-2)");
+    stress_args.vision = arg_int0("v", "vision", "<fps>", "Vision captures + base64 per second");
+    stress_args.preview = arg_int0("p", "preview", "<clients>", "Preview stream clients");
+    stress_args.dc = arg_int0("j", "dc", "<msgs/s>", "Data channel JSON events per second");
+    stress_args.turn = arg_int0("t", "turn", "<ms>", "Vision turn interval, 0 for none");
+    stress_args.end = arg_end(6);
     
     const esp_console_cmd_t stress_cmd = {
         .command = "stress_test",
-        .help = "Run stress test",
-        .hint = "<seconds> [-m] [-c]",
+        .help = "Run the mixed audio/vision/preview/data channel scenario and check its SLOs",
+        .hint = "<seconds> [-a streams] [-v fps] [-p clients] [-j msgs/s] [-t turn_ms]",
         .func = &cmd_stress_test,
         .argtable = &stress_args
     };
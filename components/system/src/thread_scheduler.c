@@ -1,10 +1,13 @@
 #include "thread_scheduler.h"
 #include <esp_log.h>
+#include <inttypes.h>
 #include <string.h>
 #include "media_lib_adapter.h"
 #include "media_lib_os.h"
-#include "esp_capture.h"
 #include "sdkconfig.h"
+#if !CONFIG_IDF_TARGET_LINUX
+#include "esp_capture.h"
+#endif
 
 static const char *TAG = "thread_scheduler";
 
@@ -47,12 +50,58 @@ static void global_thread_scheduler(const char *thread_name, media_lib_thread_cf
         schedule_cfg->priority = 5;            // Low priority
         schedule_cfg->core_id = 0;             // Core 0
     }
-    // WebRTC initialization tasks
-    else if (strcmp(thread_name, "webrtc_start") == 0 || strcmp(thread_name, "webrtc_stop") == 0) {
+    // Parallel boot workers
+    else if (strcmp(thread_name, "boot_0") == 0 || strcmp(thread_name, "boot_1") == 0) {
+        schedule_cfg->stack_size = 6 * 1024;   // 6KB stack, module init
+        schedule_cfg->priority = 5;            // Low priority
+        schedule_cfg->core_id = thread_name[5] - '0';  // One boot worker per core
+    }
+    // Log output; runs when nothing else wants the CPU
+    else if (strcmp(thread_name, "log_drain") == 0) {
+        schedule_cfg->stack_size = 3 * 1024;   // 3KB stack, fwrite only
+        schedule_cfg->priority = 1;            // Just above idle
+        schedule_cfg->core_id = 0;             // Core 0
+    }
+    // stress_test workloads, each with the priority and core of the task it stands in for
+    else if (strcmp(thread_name, "st_audio0") == 0 || strcmp(thread_name, "st_audio1") == 0) {
+        schedule_cfg->stack_size = 4 * 1024;   // 4KB stack
+        schedule_cfg->priority = 10;           // As aenc_0
+        schedule_cfg->core_id = 1;             // Core 1
+    }
+    else if (strcmp(thread_name, "st_vision") == 0) {
+        schedule_cfg->stack_size = 6 * 1024;   // 6KB stack, cJSON print
+        schedule_cfg->priority = 4;            // As vision_init and the vision request
+        schedule_cfg->core_id = 1;             // Core 1
+    }
+    else if (strcmp(thread_name, "st_preview") == 0) {
+        schedule_cfg->stack_size = 4 * 1024;   // 4KB stack
+        schedule_cfg->priority = 5;            // As the httpd task
+        schedule_cfg->core_id = 0;             // Core 0
+    }
+    else if (strcmp(thread_name, "st_dc") == 0) {
+        schedule_cfg->stack_size = 6 * 1024;   // 6KB stack, cJSON parse
+        schedule_cfg->priority = 18;           // As pc_task, which delivers data channel messages
+        schedule_cfg->core_id = 1;             // Core 1
+    }
+    // Profiler timer setup; the sample interrupt is allocated on the core that registers it
+    else if (strcmp(thread_name, "prof_0") == 0 || strcmp(thread_name, "prof_1") == 0) {
+        schedule_cfg->stack_size = 3 * 1024;   // 3KB stack
+        schedule_cfg->priority = 5;            // Low priority
+        schedule_cfg->core_id = thread_name[5] - '0';  // One per core
+    }
+    // WebRTC initialization tasks and the peer reconnect task
+    else if (strcmp(thread_name, "webrtc_start") == 0 || strcmp(thread_name, "webrtc_stop") == 0 ||
+             strcmp(thread_name, "webrtc_reconn") == 0) {
         schedule_cfg->stack_size = 8 * 1024;   // 8KB stack
         schedule_cfg->priority = 5;            // Low priority
         schedule_cfg->core_id = 0;             // Core 0
     }
+    // DNS pre-resolution and the link-quality monitor; both mostly wait on lwIP
+    else if (strcmp(thread_name, "dns_refresh") == 0 || strcmp(thread_name, "link_mon") == 0) {
+        schedule_cfg->stack_size = 4 * 1024;   // 4KB stack
+        schedule_cfg->priority = 4;            // Below the WebRTC tasks
+        schedule_cfg->core_id = 0;             // Core 0
+    }
     // Vision initialization task
     else if (strcmp(thread_name, "vision_init") == 0) {
         schedule_cfg->stack_size = 6 * 1024;   // 6KB stack
@@ -61,11 +110,13 @@ static void global_thread_scheduler(const char *thread_name, media_lib_thread_cf
     }
     
     // ========== Audio Tasks ==========
-    // Audio encoding - OPUS needs huge stack
-#ifdef CONFIG_AG_WEBRTC_SUPPORT_OPUS
+    // Audio encoding - OPUS needs huge stack, G711 is a table lookup
     else if (strcmp(thread_name, "aenc_0") == 0) {
-        // For OPUS encoder it needs huge stack, when using G711 can set it to small value
+#ifdef CONFIG_AG_WEBRTC_SUPPORT_OPUS
         schedule_cfg->stack_size = 40 * 1024;  // 40KB stack for OPUS
+#else
+        schedule_cfg->stack_size = 6 * 1024;   // 6KB stack for G711
+#endif
         schedule_cfg->priority = 10;           // Medium priority
         schedule_cfg->core_id = 1;             // Core 1 for audio processing
     }
@@ -74,18 +125,23 @@ static void global_thread_scheduler(const char *thread_name, media_lib_thread_cf
         schedule_cfg->priority = 10;           // Medium priority
         schedule_cfg->core_id = 0;             // Core 0 for I/O
     }
-#endif
     // Audio source reading - AUD_SRC thread
     else if (strcmp(thread_name, "AUD_SRC") == 0) {
 #ifdef CONFIG_AG_WEBRTC_SUPPORT_OPUS
         schedule_cfg->stack_size = 40 * 1024;  // 40KB stack for OPUS
+#elif !defined(CONFIG_AG_AUDIO_ENABLE_AEC)
+        schedule_cfg->stack_size = 6 * 1024;   // 6KB stack, plain I2S read
 #endif
         schedule_cfg->priority = 15;           // High priority for timing
         schedule_cfg->core_id = 0;             // Core 0 for I/O (default from original)
     }
     // Audio decoding - critical for real-time audio
     else if (strcmp(thread_name, "Adec") == 0) {
+#ifdef CONFIG_AG_WEBRTC_SUPPORT_OPUS
         schedule_cfg->stack_size = 40 * 1024;  // 40KB stack
+#else
+        schedule_cfg->stack_size = 8 * 1024;   // 8KB stack for G711
+#endif
         schedule_cfg->priority = 15;           // High priority
         schedule_cfg->core_id = 0;             // Core 0 for audio processing
     }
@@ -105,10 +161,11 @@ static void global_thread_scheduler(const char *thread_name, media_lib_thread_cf
         ESP_LOGW(TAG, "Unknown thread '%s', using default config", thread_name);
     }
     
-    ESP_LOGI(TAG, "Thread '%s': stack=%lu, priority=%d, core=%d", 
+    ESP_LOGI(TAG, "Thread '%s': stack=%" PRIu32 ", priority=%d, core=%d", 
              thread_name, schedule_cfg->stack_size, schedule_cfg->priority, schedule_cfg->core_id);
 }
 
+#if !CONFIG_IDF_TARGET_LINUX
 /**
  * @brief Capture scheduler for esp_capture tasks
  */
@@ -125,6 +182,7 @@ static void capture_scheduler(const char *name, esp_capture_thread_schedule_cfg_
     schedule_cfg->priority = cfg.priority;
     schedule_cfg->core_id = cfg.core_id;
 }
+#endif
 
 esp_err_t thread_scheduler_init(void)
 {
@@ -133,14 +191,20 @@ esp_err_t thread_scheduler_init(void)
     // Initialize media library adapter
     media_lib_add_default_adapter();
     
-    // Set the capture thread scheduler
+#if !CONFIG_IDF_TARGET_LINUX
+    // Set the capture thread scheduler (no esp_capture in the host build)
     esp_capture_set_thread_scheduler(capture_scheduler);
+#endif
     
     // Set the global thread scheduler callback
     media_lib_thread_set_schedule_cb(global_thread_scheduler);
     
     ESP_LOGI(TAG, "Thread scheduler initialized successfully");
+#ifdef CONFIG_AG_WEBRTC_SUPPORT_OPUS
     ESP_LOGI(TAG, "Stack allocations: WebRTC(35KB), Audio(40KB), Default(4KB)");
+#else
+    ESP_LOGI(TAG, "Stack allocations: WebRTC(35KB), Audio(6-8KB, G711), Default(4KB)");
+#endif
     
     return ESP_OK;
 }
\ No newline at end of file
@@ -0,0 +1,300 @@
+#include "trace.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "memory_manager.h"
+
+#if CONFIG_AG_TRACE_ENABLE
+
+#include "esp_cpu.h"
+#include "esp_ipc.h"
+#include "esp_rom_sys.h"
+#include "esp_timer.h"
+
+static const char *TAG = "trace";
+
+#define TRACE_EVENTS            CONFIG_AG_TRACE_EVENTS_PER_CORE
+#define TRACE_CORES             (portNUM_PROCESSORS < TRACE_MAX_CORES ? portNUM_PROCESSORS : TRACE_MAX_CORES)
+#define TRACE_MAX_THREADS       48      // Distinct tasks named in one export
+#define TRACE_CHUNK             512
+
+typedef struct {
+    uint32_t ticks;
+    const char *name;
+    TaskHandle_t task;
+    uint8_t phase;
+    char task_name[configMAX_TASK_NAME_LEN];    // Copied: the task may be gone by export time
+} trace_event_t;
+
+typedef struct {
+    trace_event_t *events;
+    uint32_t head;              // Events ever reserved; slot is head % TRACE_EVENTS
+} trace_ring_t;
+
+// Ticks and esp_timer time read together on one core
+typedef struct {
+    uint32_t ticks;
+    int64_t us;
+} trace_sync_t;
+
+// Module state
+static struct {
+    volatile bool running;
+    trace_ring_t rings[TRACE_MAX_CORES];
+} trace_state = {0};
+
+// The cycle counter stops and changes rate under DFS and light sleep
+static inline uint32_t trace_ticks(void)
+{
+#if CONFIG_PM_ENABLE
+    return (uint32_t)esp_timer_get_time();
+#else
+    return esp_cpu_get_cycle_count();
+#endif
+}
+
+static uint32_t ticks_per_us(void)
+{
+#if CONFIG_PM_ENABLE
+    return 1;
+#else
+    return esp_rom_get_cpu_ticks_per_us();
+#endif
+}
+
+void trace_record(trace_phase_t phase, const char *name)
+{
+    if (!trace_state.running) {
+        return;
+    }
+    // A task moved to the other core between these lines gets that core's stamp; rare and small
+    trace_ring_t *ring = &trace_state.rings[esp_cpu_get_core_id()];
+    uint32_t seq = __atomic_fetch_add(&ring->head, 1, __ATOMIC_RELAXED);
+    trace_event_t *e = &ring->events[seq % TRACE_EVENTS];
+    e->ticks = trace_ticks();
+    e->name = name;
+    e->task = xTaskGetCurrentTaskHandle();
+    e->phase = phase;
+    strlcpy(e->task_name, pcTaskGetName(NULL), sizeof(e->task_name));
+}
+
+esp_err_t trace_start(void)
+{
+    trace_state.running = false;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        trace_ring_t *ring = &trace_state.rings[core];
+        if (ring->events == NULL) {
+            ring->events = mem_calloc(TRACE_EVENTS, sizeof(trace_event_t), MEM_POLICY_PREFER_PSRAM, "trace");
+            if (ring->events == NULL) {
+                ESP_LOGE(TAG, "No memory for %d events on core %d", TRACE_EVENTS, core);
+                return ESP_ERR_NO_MEM;
+            }
+        }
+        __atomic_store_n(&ring->head, 0, __ATOMIC_RELAXED);
+    }
+    trace_state.running = true;
+    return ESP_OK;
+}
+
+void trace_stop(void)
+{
+    trace_state.running = false;
+}
+
+void trace_get_status(trace_status_t *status)
+{
+    if (status == NULL) {
+        return;
+    }
+    memset(status, 0, sizeof(*status));
+    status->running = trace_state.running;
+    status->capacity = TRACE_EVENTS;
+    for (int core = 0; core < TRACE_CORES; core++) {
+        status->recorded[core] = __atomic_load_n(&trace_state.rings[core].head, __ATOMIC_RELAXED);
+    }
+}
+
+static void trace_sync(void *arg)
+{
+    trace_sync_t *sync = (trace_sync_t *)arg;
+    sync->ticks = trace_ticks();
+    sync->us = esp_timer_get_time();
+}
+
+// Ticks from earlier to later; a small backwards step (preempted between reserve and stamp) stays negative
+static int64_t tick_gap(uint32_t later, uint32_t earlier)
+{
+    uint32_t d = later - earlier;
+    return d > 0xFF000000u ? (int64_t)(int32_t)d : (int64_t)d;
+}
+
+// Buffered writer; stops calling the sink after it fails once
+typedef struct {
+    trace_write_t write;
+    void *ctx;
+    char buf[TRACE_CHUNK];
+    size_t len;
+    bool failed;
+    bool first;
+} trace_out_t;
+
+static void out_flush(trace_out_t *out)
+{
+    if (out->len && !out->failed && out->write(out->buf, out->len, out->ctx) != 0) {
+        out->failed = true;
+    }
+    out->len = 0;
+}
+
+// One JSON array element; a comma goes before every element but the first
+static void out_event(trace_out_t *out, const char *fmt, ...)
+{
+    char line[160];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, args);
+    va_end(args);
+    if (n <= 0) {
+        return;
+    }
+    if ((size_t)n >= sizeof(line)) {
+        n = sizeof(line) - 1;
+    }
+    if (out->len + n + 2 > sizeof(out->buf)) {
+        out_flush(out);
+    }
+    if (!out->first) {
+        out->buf[out->len++] = ',';
+    }
+    out->first = false;
+    memcpy(out->buf + out->len, line, n);
+    out->len += n;
+    out->buf[out->len++] = '\n';
+}
+
+esp_err_t trace_export_json(trace_write_t write, void *ctx)
+{
+    if (write == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    trace_state.running = false;
+    // Let writers that passed the running check finish their slot
+    vTaskDelay(pdMS_TO_TICKS(2));
+    trace_status_t status;
+    trace_get_status(&status);
+    if (status.recorded[0] == 0 && status.recorded[1] == 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    trace_out_t *out = mem_calloc(1, sizeof(trace_out_t), MEM_POLICY_PREFER_PSRAM, "trace_out");
+    TaskHandle_t *named = mem_calloc(TRACE_MAX_THREADS, sizeof(TaskHandle_t), MEM_POLICY_PREFER_PSRAM, "trace_out");
+    if (out == NULL || named == NULL) {
+        mem_free(out);
+        mem_free(named);
+        return ESP_ERR_NO_MEM;
+    }
+    out->write = write;
+    out->ctx = ctx;
+    out->first = true;
+    int named_count = 0;
+    uint32_t tpu = ticks_per_us();
+
+    const char *head = "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n";
+    memcpy(out->buf, head, strlen(head));
+    out->len = strlen(head);
+    out_event(out, "{\"ph\":\"M\",\"pid\":0,\"name\":\"process_name\",\"args\":{\"name\":\"%s\"}}",
+              CONFIG_AG_SYSTEM_BOARD_NAME);
+
+    for (int core = 0; core < TRACE_CORES && !out->failed; core++) {
+        trace_ring_t *ring = &trace_state.rings[core];
+        uint32_t end = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+        if (ring->events == NULL || end == 0) {
+            continue;
+        }
+        uint32_t start = end > TRACE_EVENTS ? end - TRACE_EVENTS : 0;
+
+        // Anchor the newest event to esp_timer time, read on the core whose counter stamped it
+        trace_sync_t sync;
+#if CONFIG_PM_ENABLE || CONFIG_FREERTOS_UNICORE
+        trace_sync(&sync);
+#else
+        esp_ipc_call_blocking(core, trace_sync, &sync);
+#endif
+        // Age of the oldest event, walking gaps back from the anchor; a core quiet for a
+        // whole counter wrap (~17 s at 240 MHz) shifts everything before the gap
+        int64_t age = tick_gap(sync.ticks, ring->events[(end - 1) % TRACE_EVENTS].ticks);
+        for (uint32_t i = end - 1; i > start; i--) {
+            age += tick_gap(ring->events[i % TRACE_EVENTS].ticks, ring->events[(i - 1) % TRACE_EVENTS].ticks);
+        }
+
+        for (uint32_t i = start; i < end && !out->failed; i++) {
+            const trace_event_t *e = &ring->events[i % TRACE_EVENTS];
+            if (i > start) {
+                age -= tick_gap(e->ticks, ring->events[(i - 1) % TRACE_EVENTS].ticks);
+            }
+            int64_t ts_ns = sync.us * 1000 - age * 1000 / tpu;
+
+            int n = 0;
+            while (n < named_count && named[n] != e->task) {
+                n++;
+            }
+            if (n == named_count && named_count < TRACE_MAX_THREADS) {
+                named[named_count++] = e->task;
+                out_event(out, "{\"ph\":\"M\",\"pid\":0,\"tid\":%" PRIu32 ",\"name\":\"thread_name\","
+                          "\"args\":{\"name\":\"%s\"}}", (uint32_t)(uintptr_t)e->task, e->task_name);
+            }
+            out_event(out, "{\"ph\":\"%c\",\"pid\":0,\"tid\":%" PRIu32 ",\"ts\":%" PRId64 ".%03" PRId64 ","
+                      "\"name\":\"%s\",\"args\":{\"core\":%d}%s}",
+                      e->phase, (uint32_t)(uintptr_t)e->task, ts_ns / 1000, ts_ns % 1000,
+                      e->name, core, e->phase == TRACE_PHASE_INSTANT ? ",\"s\":\"t\"" : "");
+        }
+    }
+
+    if (!out->failed) {
+        const char *tail = "]}\n";
+        if (out->len + strlen(tail) > sizeof(out->buf)) {
+            out_flush(out);
+        }
+        memcpy(out->buf + out->len, tail, strlen(tail));
+        out->len += strlen(tail);
+        out_flush(out);
+    }
+    bool failed = out->failed;
+    mem_free(out);
+    mem_free(named);
+
+    return failed ? ESP_FAIL : ESP_OK;
+}
+
+#else // !CONFIG_AG_TRACE_ENABLE
+
+void trace_record(trace_phase_t phase, const char *name)
+{
+}
+
+esp_err_t trace_start(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+void trace_stop(void)
+{
+}
+
+void trace_get_status(trace_status_t *status)
+{
+    if (status) {
+        memset(status, 0, sizeof(*status));
+    }
+}
+
+esp_err_t trace_export_json(trace_write_t write, void *ctx)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+#endif // CONFIG_AG_TRACE_ENABLE
@@ -81,6 +81,31 @@ typedef struct {
     uint64_t total_bytes_processed;
 } cam_stats_t;
 
+/**
+ * @brief Camera sensor power statistics
+ *
+ * With CONFIG_AG_VISION_LAZY_INIT the sensor and its frame buffers are only
+ * brought up on first use or by cam_module_prewarm(), and released again after
+ * CONFIG_AG_VISION_IDLE_RELEASE_MS without use.
+ */
+typedef struct {
+    bool powered;                    // Sensor up and frame buffers allocated
+    uint32_t power_ups;
+    uint32_t releases;               // Idle releases
+    uint32_t prewarms;               // Power ups done by cam_module_prewarm()
+    uint32_t last_power_up_ms;       // esp_camera_init time
+    uint32_t max_power_up_ms;
+    uint32_t held_bytes;             // Heap held while powered, measured at the last power up
+    uint32_t cold_requests;          // Vision requests that had to power the sensor up
+    uint32_t cold_request_ms;        // Last one, request to encoded frames
+    uint32_t cold_request_avg_ms;
+    uint32_t warm_requests;
+    uint32_t warm_request_ms;
+    uint32_t warm_request_avg_ms;
+    uint64_t powered_ms;             // Since init
+    uint64_t released_ms;
+} cam_power_stats_t;
+
 /**
  * @brief Camera/Vision event callback
  */
@@ -227,10 +252,30 @@ esp_err_t cam_module_test_capture(void);
 /**
  * @brief Check if module is ready and active
  * 
+ * With lazy init the sensor may still be off; it powers up on the next use.
+ * 
  * @return true if ready, false otherwise
  */
 bool cam_module_is_ready(void);
 
+/**
+ * @brief Power the sensor up in a low-priority background task
+ * 
+ * Takes the sensor bring-up off the first vision request. No-op when the
+ * sensor is already up.
+ * 
+ * @return ESP_OK when started or not needed
+ */
+esp_err_t cam_module_prewarm(void);
+
+/**
+ * @brief Get sensor power statistics
+ * 
+ * @param stats Output statistics structure
+ * @return ESP_OK on success
+ */
+esp_err_t cam_module_get_power_stats(cam_power_stats_t *stats);
+
 /**
  * @brief Deinitialize camera/vision module
  * 
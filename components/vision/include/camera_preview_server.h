@@ -1,7 +1,9 @@
 #pragma once
 
 #include <esp_err.h>
-#include <esp_http_server.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -22,6 +24,17 @@ esp_err_t camera_preview_server_init(uint16_t port);
  */
 esp_err_t camera_preview_server_start(void);
 
+/**
+ * @brief Serve /metrics (Prometheus text) and /metrics.json without the preview
+ * 
+ * Starts the HTTP server if the preview has not; the endpoints stay up when
+ * the preview is stopped. Needs no frame buffers.
+ * 
+ * @param port HTTP server port, ignored if the server is already running
+ * @return ESP_OK on success
+ */
+esp_err_t camera_preview_server_start_metrics(uint16_t port);
+
 /**
  * @brief Stop camera preview server
  * 
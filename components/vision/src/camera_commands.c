@@ -232,6 +232,30 @@ static int cmd_cam_stats(int argc, char **argv)
     return 0;
 }
 
+// Show sensor power-up/release counts, cold-start latency and idle memory saved
+static int cmd_cam_power(int argc, char **argv)
+{
+    cam_power_stats_t power;
+    esp_err_t ret = cam_module_get_power_stats(&power);
+    if (ret != ESP_OK) {
+        printf("Failed to get power statistics: %s\n", esp_err_to_name(ret));
+        return 1;
+    }
+    
+    uint64_t total_ms = power.powered_ms + power.released_ms;
+    printf("Camera sensor: %s\n", power.powered ? "POWERED" : "RELEASED");
+    printf("  Power ups: %lu (%lu pre-warm), idle releases: %lu\n",
+           power.power_ups, power.prewarms, power.releases);
+    printf("  Power-up time: last %lu ms, max %lu ms\n", power.last_power_up_ms, power.max_power_up_ms);
+    printf("  Vision requests: cold %lu (last %lu ms, avg %lu ms), warm %lu (last %lu ms, avg %lu ms)\n",
+           power.cold_requests, power.cold_request_ms, power.cold_request_avg_ms,
+           power.warm_requests, power.warm_request_ms, power.warm_request_avg_ms);
+    printf("  Released %llu of %llu s (%llu%%), freeing %lu bytes meanwhile\n",
+           power.released_ms / 1000, total_ms / 1000,
+           total_ms ? power.released_ms * 100 / total_ms : 0, power.held_bytes);
+    return 0;
+}
+
 // Start live preview stream
 static int cmd_cam_stream_start(int argc, char **argv)
 {
@@ -553,6 +577,12 @@ esp_err_t camera_commands_register(void)
             .hint = NULL,
             .func = &cmd_cam_stats,
         },
+        {
+            .command = "cam_power",
+            .help = "Show sensor power ups, idle releases, cold-start latency and memory saved",
+            .hint = NULL,
+            .func = &cmd_cam_power,
+        },
         {
             .command = "cam_stream_start",
             .help = "Start live camera preview stream to laptop",
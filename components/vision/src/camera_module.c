@@ -1,5 +1,6 @@
 #include "camera_module.h"
 #include <esp_log.h>
+#include <inttypes.h>
 #include <esp_timer.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -7,15 +8,27 @@
 #include <freertos/queue.h>
 #include <string.h>
 #include <stdlib.h>
+#include "board_module.h"
 #include "memory_manager.h"
+#include "metrics.h"
+#include "trace.h"
 #include "mbedtls/base64.h"
 #include "camera_preview_server.h"
 #include "esp_camera.h"
 #include "vision_utils.h"
 #include "codec_board.h"
+#include "esp_heap_caps.h"
+#include "media_lib_os.h"
+#include "sdkconfig.h"
 
 static const char *TAG = "cam_module";
 
+#ifdef CONFIG_AG_VISION_LAZY_INIT
+#define CAM_IDLE_RELEASE_MS     CONFIG_AG_VISION_IDLE_RELEASE_MS
+#else
+#define CAM_IDLE_RELEASE_MS     0       // Sensor stays up once started
+#endif
+
 // Module state
 static struct {
     bool initialized;
@@ -28,13 +41,59 @@ static struct {
     bool camera_initialized;
     
     // Frame management - queue removed, using on-demand capture
-    SemaphoreHandle_t stats_mutex;
-    cam_stats_t stats;
+    cam_stats_t stats;                  // Flags only; counters live in cam_metrics
     
     // Tasks
     TaskHandle_t capture_task_handle;
+
+    // Sensor power: brought up on first use, released after CAM_IDLE_RELEASE_MS
+    SemaphoreHandle_t power_lock;       // Held while the sensor is powered up, used or released
+    esp_timer_handle_t idle_timer;
+    bool prewarm_pending;
+    int64_t power_since_us;             // Last power up or release
+    uint64_t powered_ms;
+    uint64_t released_ms;
+    cam_power_stats_t power;
+    uint64_t cold_request_total_ms;
+    uint64_t warm_request_total_ms;
 } cam_state = {0};
 
+// Registry handles; they outlive cam_module_deinit so counters run since boot
+static struct {
+    metric_t *frames;
+    metric_t *frames_dropped;
+    metric_t *bytes;
+    metric_t *fps;
+    metric_t *power_ups;
+    metric_t *releases;
+    metric_t *powered;
+    metric_t *held_bytes;
+    metric_t *power_up_ms;
+    metric_t *cold_request_ms;
+    metric_t *warm_request_ms;
+} cam_metrics = {0};
+
+static void camera_metrics_register(void)
+{
+    static const uint32_t power_up_bounds[] = {50, 100, 200, 300, 500, 750, 1000, 2000};
+    static const uint32_t request_bounds[] = {100, 200, 300, 500, 750, 1000, 1500, 2000, 3000, 5000};
+
+    cam_metrics.frames = metrics_counter("cam_frames_total", "Frames captured by the streaming task");
+    cam_metrics.frames_dropped = metrics_counter("cam_frames_dropped_total", "Streaming frame grabs that failed");
+    cam_metrics.bytes = metrics_counter("cam_bytes_total", "JPEG bytes captured by the streaming task");
+    cam_metrics.fps = metrics_gauge("cam_fps", "Streaming frames in the last second");
+    cam_metrics.power_ups = metrics_counter("cam_power_ups_total", "Sensor bring-ups");
+    cam_metrics.releases = metrics_counter("cam_releases_total", "Sensor releases after idle");
+    cam_metrics.powered = metrics_gauge("cam_powered", "1 while the sensor and frame buffers are up");
+    cam_metrics.held_bytes = metrics_gauge("cam_held_bytes", "Heap held by the powered sensor");
+    cam_metrics.power_up_ms = metrics_histogram("cam_power_up_ms", "esp_camera_init time",
+                                                power_up_bounds, sizeof(power_up_bounds) / sizeof(power_up_bounds[0]));
+    cam_metrics.cold_request_ms = metrics_histogram("cam_vision_cold_ms", "Vision capture including sensor power up",
+                                                    request_bounds, sizeof(request_bounds) / sizeof(request_bounds[0]));
+    cam_metrics.warm_request_ms = metrics_histogram("cam_vision_warm_ms", "Vision capture with the sensor already up",
+                                                    request_bounds, sizeof(request_bounds) / sizeof(request_bounds[0]));
+}
+
 // Convert quality enum to camera settings
 static void quality_to_camera_settings(cam_quality_t quality, 
                                        framesize_t *framesize, 
@@ -56,6 +115,103 @@ static void quality_to_camera_settings(cam_quality_t quality,
     }
 }
 
+// Call with power_lock held
+static void camera_account_power(int64_t now_us)
+{
+    uint64_t span_ms = (now_us - cam_state.power_since_us) / 1000;
+    if (cam_state.camera_initialized) {
+        cam_state.powered_ms += span_ms;
+    } else {
+        cam_state.released_ms += span_ms;
+    }
+    cam_state.power_since_us = now_us;
+}
+
+// Call with power_lock held
+static esp_err_t camera_power_up(void)
+{
+    if (cam_state.camera_initialized) {
+        return ESP_OK;
+    }
+    // Apply settings changed while the sensor was off
+    framesize_t framesize = FRAMESIZE_VGA;
+    uint8_t jpeg_quality = 12;
+    quality_to_camera_settings(cam_state.config.quality, &framesize, &jpeg_quality);
+    cam_state.camera_config.frame_size = framesize;
+    cam_state.camera_config.jpeg_quality = jpeg_quality;
+
+    size_t free_before = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    int64_t start = esp_timer_get_time();
+    // SCCB probing runs on the codec's I2C pins
+    board_module_i2c_lock();
+    esp_err_t ret = esp_camera_init(&cam_state.camera_config);
+    board_module_i2c_unlock();
+    int64_t now = esp_timer_get_time();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Camera init failed: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    size_t free_after = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+
+    camera_account_power(now);
+    cam_state.camera_initialized = true;
+    cam_state.power.powered = true;
+    cam_state.power.power_ups++;
+    cam_state.power.last_power_up_ms = (uint32_t)((now - start) / 1000);
+    if (cam_state.power.last_power_up_ms > cam_state.power.max_power_up_ms) {
+        cam_state.power.max_power_up_ms = cam_state.power.last_power_up_ms;
+    }
+    // Approximate: other tasks allocate meanwhile
+    cam_state.power.held_bytes = free_before > free_after ? (uint32_t)(free_before - free_after) : 0;
+    metric_inc(cam_metrics.power_ups);
+    metric_observe(cam_metrics.power_up_ms, cam_state.power.last_power_up_ms);
+    metric_set(cam_metrics.powered, 1);
+    metric_set(cam_metrics.held_bytes, cam_state.power.held_bytes);
+    ESP_LOGD(TAG, "Camera powered up in %" PRIu32 " ms, holding %" PRIu32 " bytes",
+             cam_state.power.last_power_up_ms, cam_state.power.held_bytes);
+    return ESP_OK;
+}
+
+// Call with power_lock held
+static void camera_release(void)
+{
+    if (!cam_state.camera_initialized) {
+        return;
+    }
+    board_module_i2c_lock();
+    esp_camera_deinit();
+    board_module_i2c_unlock();
+    camera_account_power(esp_timer_get_time());
+    cam_state.camera_initialized = false;
+    cam_state.power.powered = false;
+    cam_state.power.releases++;
+    metric_inc(cam_metrics.releases);
+    metric_set(cam_metrics.powered, 0);
+    ESP_LOGD(TAG, "Camera released, %" PRIu32 " bytes freed", cam_state.power.held_bytes);
+}
+
+// Restart the idle countdown after a use; call with power_lock held
+static void camera_touch(void)
+{
+    if (cam_state.idle_timer) {
+        esp_timer_stop(cam_state.idle_timer);
+        esp_timer_start_once(cam_state.idle_timer, (uint64_t)CAM_IDLE_RELEASE_MS * 1000);
+    }
+}
+
+static void camera_idle_timer_cb(void *arg)
+{
+    // A user holding the lock re-arms the timer when it is done
+    if (xSemaphoreTake(cam_state.power_lock, 0) != pdTRUE) {
+        return;
+    }
+    // Streaming keeps the sensor; cam_module_stop re-arms the timer
+    if (!cam_state.streaming) {
+        camera_release();
+    }
+    xSemaphoreGive(cam_state.power_lock);
+}
+
 // Camera capture task
 static void camera_capture_task(void *pvParameters)
 {
@@ -73,24 +229,23 @@ static void camera_capture_task(void *pvParameters)
         
         // Throttle capture rate
         if (now - last_capture >= pdMS_TO_TICKS(frame_interval_ms)) {
+            TRACE_BEGIN("cam_fb_get");
             camera_fb_t *fb = esp_camera_fb_get();
+            TRACE_END("cam_fb_get");
             if (fb != NULL) {
+                TRACE_BEGIN("cam_frame");
                 // Increment frame count for FPS calculation
                 fps_frame_count++;
                 
                 // Update statistics
-                if (xSemaphoreTake(cam_state.stats_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                    cam_state.stats.total_frames_captured++;
-                    cam_state.stats.total_bytes_processed += fb->len;
-                    
-                    // Update FPS every second
-                    if (now - fps_last_update >= pdMS_TO_TICKS(1000)) {
-                        cam_state.stats.current_fps = fps_frame_count;
-                        fps_frame_count = 0;
-                        fps_last_update = now;
-                    }
-                    
-                    xSemaphoreGive(cam_state.stats_mutex);
+                metric_inc(cam_metrics.frames);
+                metric_add(cam_metrics.bytes, fb->len);
+                
+                // Update FPS every second
+                if (now - fps_last_update >= pdMS_TO_TICKS(1000)) {
+                    metric_set(cam_metrics.fps, fps_frame_count);
+                    fps_frame_count = 0;
+                    fps_last_update = now;
                 }
                 
                 // Send frame to HTTP preview server if stream mode is enabled
@@ -111,20 +266,18 @@ static void camera_capture_task(void *pvParameters)
                         .width = fb->width,
                         .height = fb->height,
                         .timestamp_ms = (uint32_t)(esp_timer_get_time() / 1000),
-                        .sequence_num = cam_state.stats.total_frames_captured,
+                        .sequence_num = metric_get(cam_metrics.frames),
                         .format_id = ESP_CAPTURE_FMT_ID_MJPEG
                     };
                     cam_state.event_callback(CAM_EVENT_FRAME_READY, &cv_frame);
                 }
                 
                 esp_camera_fb_return(fb);
+                TRACE_END("cam_frame");
                 last_capture = now;
             } else {
                 // Camera error
-                if (xSemaphoreTake(cam_state.stats_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
-                    cam_state.stats.frames_dropped++;
-                    xSemaphoreGive(cam_state.stats_mutex);
-                }
+                metric_inc(cam_metrics.frames_dropped);
             }
         }
         
@@ -159,15 +312,22 @@ esp_err_t cam_module_init(const cam_config_t *config, cam_event_callback_t callb
     memcpy(&cam_state.config, config, sizeof(cam_config_t));
     cam_state.event_callback = callback;
     
-    // Create statistics mutex
-    cam_state.stats_mutex = xSemaphoreCreateMutex();
-    if (!cam_state.stats_mutex) {
-        ESP_LOGE(TAG, "Failed to create statistics mutex");
+    camera_metrics_register();
+    
+    cam_state.power_lock = xSemaphoreCreateMutex();
+    if (!cam_state.power_lock) {
+        ESP_LOGE(TAG, "Failed to create power mutex");
         return ESP_ERR_NO_MEM;
     }
     
     // Initialize statistics
     memset(&cam_state.stats, 0, sizeof(cam_stats_t));
+    memset(&cam_state.power, 0, sizeof(cam_power_stats_t));
+    cam_state.powered_ms = 0;
+    cam_state.released_ms = 0;
+    cam_state.cold_request_total_ms = 0;
+    cam_state.warm_request_total_ms = 0;
+    cam_state.power_since_us = esp_timer_get_time();
     
     // Get camera configuration from codec_board
     camera_cfg_t board_cam_cfg;
@@ -238,14 +398,29 @@ esp_err_t cam_module_init(const cam_config_t *config, cam_event_callback_t callb
              cam_state.camera_config.pin_href,
              cam_state.camera_config.pin_pclk);  
     
+    if (CAM_IDLE_RELEASE_MS > 0) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = camera_idle_timer_cb,
+            .name = "cam_idle",
+        };
+        ret = esp_timer_create(&timer_args, &cam_state.idle_timer);
+        if (ret != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to create idle timer: %s", esp_err_to_name(ret));
+            goto cleanup;
+        }
+    }
+    
+#ifdef CONFIG_AG_VISION_LAZY_INIT
+    // Sensor and frame buffers come up on first use or by cam_module_prewarm()
+    ESP_LOGI(TAG, "Camera configured, sensor starts on first use");
+#else
     // Initialize camera
-    ret = esp_camera_init(&cam_state.camera_config);
+    ret = camera_power_up();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Camera init failed: %s", esp_err_to_name(ret));
         goto cleanup;
     }
+#endif
     
-    cam_state.camera_initialized = true;
     cam_state.initialized = true;
     
     // Initialize preview server for laptop viewing
@@ -267,15 +442,19 @@ esp_err_t cam_module_init(const cam_config_t *config, cam_event_callback_t callb
     return ESP_OK;
     
 cleanup:
-    if (cam_state.stats_mutex) {
-        vSemaphoreDelete(cam_state.stats_mutex);
+    if (cam_state.power_lock) {
+        vSemaphoreDelete(cam_state.power_lock);
+    }
+    if (cam_state.idle_timer) {
+        esp_timer_delete(cam_state.idle_timer);
     }
+    memset(&cam_state, 0, sizeof(cam_state));
     return ESP_FAIL;
 }
 
 esp_err_t cam_module_start(cam_mode_t mode)
 {
-    if (!cam_state.initialized || !cam_state.camera_initialized) {
+    if (!cam_state.initialized) {
         ESP_LOGE(TAG, "Module not initialized");
         return ESP_FAIL;
     }
@@ -285,19 +464,32 @@ esp_err_t cam_module_start(cam_mode_t mode)
         return ESP_OK;
     }
     
-    ESP_LOGI(TAG, "Starting camera/vision capture (mode: %d)", mode);
+    // Mark streaming before dropping the lock so the idle timer cannot
+    // release the sensor between power up and the capture task starting
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    esp_err_t err = camera_power_up();
+    if (err == ESP_OK) {
+        cam_state.config.mode = mode;
+        cam_state.streaming = true;
+        cam_state.stats.is_streaming = true;
+    }
+    xSemaphoreGive(cam_state.power_lock);
+    if (err != ESP_OK) {
+        return err;
+    }
     
-    cam_state.config.mode = mode;
-    cam_state.streaming = true;
-    cam_state.stats.is_streaming = true;
+    ESP_LOGI(TAG, "Starting camera/vision capture (mode: %d)", mode);
     
     // Start capture task
     BaseType_t ret = xTaskCreate(camera_capture_task, "cam_capture", 8192, NULL, 5, 
                                 &cam_state.capture_task_handle);
     if (ret != pdPASS) {
         ESP_LOGE(TAG, "Failed to create capture task");
+        xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
         cam_state.streaming = false;
         cam_state.stats.is_streaming = false;
+        camera_touch();
+        xSemaphoreGive(cam_state.power_lock);
         return ESP_FAIL;
     }
     
@@ -334,6 +526,10 @@ esp_err_t cam_module_stop(void)
         }
     }
 
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    camera_touch();
+    xSemaphoreGive(cam_state.power_lock);
+
     // Notify streaming stopped
     if (cam_state.event_callback) {
         cam_state.event_callback(CAM_EVENT_STREAM_STOPPED, NULL);
@@ -402,11 +598,16 @@ esp_err_t cam_module_set_quality(cam_quality_t quality)
     uint8_t jpeg_quality = 12;             // Default to MEDIUM quality
     quality_to_camera_settings(quality, &framesize, &jpeg_quality);
     
-    sensor_t *sensor = esp_camera_sensor_get();
+    // A released sensor picks the setting up at its next power up
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    sensor_t *sensor = cam_state.camera_initialized ? esp_camera_sensor_get() : NULL;
     if (sensor) {
+        board_module_i2c_lock();
         sensor->set_framesize(sensor, framesize);
         sensor->set_quality(sensor, jpeg_quality);
+        board_module_i2c_unlock();
     }
+    xSemaphoreGive(cam_state.power_lock);
     
     return ESP_OK;
 }
@@ -417,7 +618,7 @@ esp_err_t cam_module_set_fps(uint32_t fps)
         return ESP_FAIL;
     }
     
-    ESP_LOGI(TAG, "Setting FPS to: %lu", fps);
+    ESP_LOGI(TAG, "Setting FPS to: %" PRIu32, fps);
     cam_state.config.fps = fps;
     
     return ESP_OK;
@@ -429,17 +630,16 @@ esp_err_t cam_module_get_stats(cam_stats_t *stats)
         return ESP_ERR_INVALID_ARG;
     }
     
-    if (xSemaphoreTake(cam_state.stats_mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
-        memcpy(stats, &cam_state.stats, sizeof(cam_stats_t));
-        
-        // Buffer usage no longer relevant without queue
-        stats->buffer_usage_percent = 0;
-        
-        xSemaphoreGive(cam_state.stats_mutex);
-        return ESP_OK;
-    }
+    memcpy(stats, &cam_state.stats, sizeof(cam_stats_t));
+    stats->total_frames_captured = metric_get(cam_metrics.frames);
+    stats->frames_dropped = metric_get(cam_metrics.frames_dropped);
+    stats->total_bytes_processed = metric_get(cam_metrics.bytes);
+    stats->current_fps = metric_get(cam_metrics.fps);
+    
+    // Buffer usage no longer relevant without queue
+    stats->buffer_usage_percent = 0;
     
-    return ESP_ERR_TIMEOUT;
+    return ESP_OK;
 }
 
 esp_err_t cam_module_test_capture(void)
@@ -451,22 +651,81 @@ esp_err_t cam_module_test_capture(void)
     
     ESP_LOGI(TAG, "Testing camera capture...");
     
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    esp_err_t ret = camera_power_up();
+    if (ret != ESP_OK) {
+        xSemaphoreGive(cam_state.power_lock);
+        return ret;
+    }
+    
     // Try to capture a single frame
     camera_fb_t *fb = esp_camera_fb_get();
     if (fb) {
-        ESP_LOGI(TAG, "Test successful - captured %zu bytes (%dx%d)", 
+        ESP_LOGI(TAG, "Test successful - captured %zu bytes (%zux%zu)", 
                  fb->len, fb->width, fb->height);
         esp_camera_fb_return(fb);
-        return ESP_OK;
     } else {
         ESP_LOGE(TAG, "Test failed - could not capture frame");
-        return ESP_FAIL;
+        ret = ESP_FAIL;
     }
+    camera_touch();
+    xSemaphoreGive(cam_state.power_lock);
+    return ret;
 }
 
 bool cam_module_is_ready(void)
 {
-    return cam_state.initialized && cam_state.camera_initialized;
+    // The sensor itself may be released; it comes back on the next use
+    return cam_state.initialized;
+}
+
+static void camera_prewarm_task(void *arg)
+{
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    if (!cam_state.camera_initialized && camera_power_up() == ESP_OK) {
+        cam_state.power.prewarms++;
+        camera_touch();
+    }
+    xSemaphoreGive(cam_state.power_lock);
+    cam_state.prewarm_pending = false;
+    media_lib_thread_destroy(NULL);
+}
+
+esp_err_t cam_module_prewarm(void)
+{
+    if (!cam_state.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (cam_state.camera_initialized || cam_state.prewarm_pending) {
+        return ESP_OK;
+    }
+    cam_state.prewarm_pending = true;
+    if (media_lib_thread_create_from_scheduler(NULL, "vision_init", camera_prewarm_task, NULL) != 0) {
+        ESP_LOGE(TAG, "Failed to create pre-warm task");
+        cam_state.prewarm_pending = false;
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t cam_module_get_power_stats(cam_power_stats_t *stats)
+{
+    if (!cam_state.initialized || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    *stats = cam_state.power;
+    uint64_t span_ms = (esp_timer_get_time() - cam_state.power_since_us) / 1000;
+    stats->powered_ms = cam_state.powered_ms + (cam_state.camera_initialized ? span_ms : 0);
+    stats->released_ms = cam_state.released_ms + (cam_state.camera_initialized ? 0 : span_ms);
+    if (stats->cold_requests) {
+        stats->cold_request_avg_ms = (uint32_t)(cam_state.cold_request_total_ms / stats->cold_requests);
+    }
+    if (stats->warm_requests) {
+        stats->warm_request_avg_ms = (uint32_t)(cam_state.warm_request_total_ms / stats->warm_requests);
+    }
+    xSemaphoreGive(cam_state.power_lock);
+    return ESP_OK;
 }
 
 esp_err_t cam_module_deinit(void)
@@ -482,17 +741,29 @@ esp_err_t cam_module_deinit(void)
         cam_module_stop();
     }
     
+    // Wait for a pre-warm in flight
+    for (int i = 0; i < 100 && cam_state.prewarm_pending; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    
+    if (cam_state.idle_timer) {
+        esp_timer_stop(cam_state.idle_timer);
+        esp_timer_delete(cam_state.idle_timer);
+        cam_state.idle_timer = NULL;
+    }
+    
     // Deinit camera
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
     if (cam_state.camera_initialized) {
+        board_module_i2c_lock();
         esp_camera_deinit();
+        board_module_i2c_unlock();
         cam_state.camera_initialized = false;
     }
+    xSemaphoreGive(cam_state.power_lock);
     
     // Clean up mutex
-    if (cam_state.stats_mutex) {
-        vSemaphoreDelete(cam_state.stats_mutex);
-        cam_state.stats_mutex = NULL;
-    }
+    vSemaphoreDelete(cam_state.power_lock);
     
     // Reset state
     memset(&cam_state, 0, sizeof(cam_state));
@@ -501,15 +772,11 @@ esp_err_t cam_module_deinit(void)
     return ESP_OK;
 }
 
-// Recording/capture statistics  
+// Recording/capture settings; frame counts are the cam_frames metrics
 static struct {
     uint32_t capture_interval_ms;
-    uint32_t total_captured_for_recording;
-    uint32_t total_dropped_for_recording;
 } recording_stats = {
     .capture_interval_ms = CONFIG_AG_VISION_CAPTURE_INTERVAL_MS,
-    .total_captured_for_recording = 0,
-    .total_dropped_for_recording = 0
 };
 
 esp_err_t cam_module_start_capture(void)
@@ -533,7 +800,7 @@ esp_err_t cam_module_start_recording(const cam_recording_config_t *config)
         return ESP_ERR_INVALID_ARG;
     }
     
-    ESP_LOGI(TAG, "📹 Starting recording: fps=%lu, max_frames=%lu, circular=%d", 
+    ESP_LOGI(TAG, "📹 Starting recording: fps=%" PRIu32 ", max_frames=%" PRIu32 ", circular=%d", 
              config->fps, config->max_frames, config->circular_buffer);
     
     // Start capture with configured FPS
@@ -551,17 +818,17 @@ esp_err_t cam_module_start_recording(const cam_recording_config_t *config)
     // - Configure circular buffer if needed
     // - Set max frames limit
     
-    ESP_LOGI(TAG, "Recording started with %lu ms interval", interval);
+    ESP_LOGI(TAG, "Recording started with %" PRIu32 " ms interval", interval);
     return ESP_OK;
 }
 
 esp_err_t cam_module_get_capture_stats(uint32_t *frames_captured, uint32_t *frames_dropped)
 {
     if (frames_captured) {
-        *frames_captured = recording_stats.total_captured_for_recording;
+        *frames_captured = metric_get(cam_metrics.frames);
     }
     if (frames_dropped) {
-        *frames_dropped = recording_stats.total_dropped_for_recording;
+        *frames_dropped = metric_get(cam_metrics.frames_dropped);
     }
     return ESP_OK;
 }
@@ -588,9 +855,8 @@ bool cam_module_is_capturing(void)
 // Vision frame capture implementation (battery efficient on-demand)
 char** cam_module_get_vision_frames(int max_frames, int *frame_count)
 {
-    if (!cam_state.initialized || !cam_state.camera_initialized) {
-        ESP_LOGE(TAG, "Camera module not initialized (init:%d, camera:%d)", 
-                 cam_state.initialized, cam_state.camera_initialized);
+    if (!cam_state.initialized) {
+        ESP_LOGE(TAG, "Camera module not initialized");
         if (frame_count) *frame_count = 0;
         return NULL;
     }
@@ -603,11 +869,25 @@ char** cam_module_get_vision_frames(int max_frames, int *frame_count)
     ESP_LOGI(TAG, "📸 Starting on-demand capture of %d frames", max_frames);
     uint32_t start_time = (uint32_t)(esp_timer_get_time() / 1000);
     
+    // Holding the lock keeps the idle timer from releasing the sensor mid-capture
+    xSemaphoreTake(cam_state.power_lock, portMAX_DELAY);
+    bool cold = !cam_state.camera_initialized;
+    TRACE_BEGIN("cam_power_up");
+    esp_err_t power_ret = camera_power_up();
+    TRACE_END("cam_power_up");
+    if (power_ret != ESP_OK) {
+        xSemaphoreGive(cam_state.power_lock);
+        if (frame_count) *frame_count = 0;
+        return NULL;
+    }
+    
     // Allocate array for frame pointers
     char **frames = mem_alloc(sizeof(char*) * max_frames, 
                              MEM_POLICY_PREFER_PSRAM, "ondemand_frame_array");
     if (!frames) {
         ESP_LOGE(TAG, "Failed to allocate frame array");
+        camera_touch();
+        xSemaphoreGive(cam_state.power_lock);
         if (frame_count) *frame_count = 0;
         return NULL;
     }
@@ -619,7 +899,9 @@ char** cam_module_get_vision_frames(int max_frames, int *frame_count)
         uint32_t frame_start = (uint32_t)(esp_timer_get_time() / 1000);
         
         // Get fresh frame directly from camera hardware
+        TRACE_BEGIN("cam_fb_get");
         camera_fb_t *fb = esp_camera_fb_get();
+        TRACE_END("cam_fb_get");
         if (!fb) {
             ESP_LOGW(TAG, "Failed to capture frame %d", i + 1);
             continue;
@@ -635,8 +917,10 @@ char** cam_module_get_vision_frames(int max_frames, int *frame_count)
                                               MEM_POLICY_PREFER_PSRAM, "base64_encode");
         
         if (base64_data) {
+            TRACE_BEGIN("base64");
             int ret = mbedtls_base64_encode(base64_data, (fb->len * 4 / 3) + 16, 
                                            &output_len, fb->buf, fb->len);
+            TRACE_END("base64");
             
             if (ret == 0) {
                 frames[actual_count] = (char *)base64_data;
@@ -661,8 +945,20 @@ char** cam_module_get_vision_frames(int max_frames, int *frame_count)
     }
     
     uint32_t total_time = (uint32_t)(esp_timer_get_time() / 1000) - start_time;
-    ESP_LOGI(TAG, "⏱️ On-demand capture completed: %d/%d frames in %u ms", 
-            actual_count, max_frames, (unsigned)total_time);
+    ESP_LOGI(TAG, "⏱️ On-demand capture completed: %d/%d frames in %u ms (%s)", 
+            actual_count, max_frames, (unsigned)total_time, cold ? "cold" : "warm");
+    metric_observe(cold ? cam_metrics.cold_request_ms : cam_metrics.warm_request_ms, total_time);
+    if (cold) {
+        cam_state.power.cold_requests++;
+        cam_state.power.cold_request_ms = total_time;
+        cam_state.cold_request_total_ms += total_time;
+    } else {
+        cam_state.power.warm_requests++;
+        cam_state.power.warm_request_ms = total_time;
+        cam_state.warm_request_total_ms += total_time;
+    }
+    camera_touch();
+    xSemaphoreGive(cam_state.power_lock);
     
     if (actual_count == 0) {
         mem_free(frames);
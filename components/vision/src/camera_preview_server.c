@@ -4,8 +4,12 @@
 #include <esp_wifi.h>
 #include <string.h>
 #include "memory_manager.h"
+#include "metrics.h"
+#include "trace.h"
 static const char *TAG = "cam_preview_server";
 
+#define METRICS_BUF_INITIAL     4096
+
 // Server state with double buffering
 static struct {
     bool initialized;
@@ -24,6 +28,11 @@ static struct {
     size_t frame_buffer_capacity;
     
     SemaphoreHandle_t buffer_swap_mutex;   // Only for swapping pointers
+    
+    // Scrape endpoints; httpd runs handlers on one task, so the buffer needs no lock
+    bool metrics_serving;
+    char *metrics_buf;
+    size_t metrics_buf_size;
 } server_state = {0};
 
 // HTML page for camera preview
@@ -111,6 +120,138 @@ static esp_err_t stream_handler(httpd_req_t *req)
     return ret;
 }
 
+typedef size_t (*metrics_render_t)(char *buf, size_t size);
+
+// HTTP handler for /metrics and /metrics.json; user_ctx is the renderer
+static esp_err_t metrics_handler(httpd_req_t *req)
+{
+    metrics_render_t render = (metrics_render_t)req->user_ctx;
+    memory_manager_refresh_metrics();
+    
+    // Grows only when the registry outgrew the buffer, which stops after the first scrapes
+    size_t len = server_state.metrics_buf ? render(server_state.metrics_buf, server_state.metrics_buf_size) : 0;
+    if (!server_state.metrics_buf || len >= server_state.metrics_buf_size) {
+        size_t size = len < METRICS_BUF_INITIAL ? METRICS_BUF_INITIAL : len + len / 4;
+        mem_free(server_state.metrics_buf);
+        server_state.metrics_buf = mem_alloc(size, MEM_POLICY_PREFER_PSRAM, "metrics_http");
+        server_state.metrics_buf_size = server_state.metrics_buf ? size : 0;
+        if (!server_state.metrics_buf) {
+            return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "Out of memory");
+        }
+        len = render(server_state.metrics_buf, server_state.metrics_buf_size);
+        if (len >= server_state.metrics_buf_size) {
+            len = server_state.metrics_buf_size - 1;
+        }
+    }
+    
+    httpd_resp_set_type(req, render == metrics_export_json ? "application/json" : "text/plain; version=0.0.4");
+    httpd_resp_set_hdr(req, "Cache-Control", "no-cache");
+    return httpd_resp_send(req, server_state.metrics_buf, len);
+}
+
+static int trace_write_chunk(const char *data, size_t len, void *ctx)
+{
+    return httpd_resp_send_chunk((httpd_req_t *)ctx, data, len) == ESP_OK ? 0 : -1;
+}
+
+// HTTP handler for /trace.json; stops the trace and streams it as Chrome trace_event JSON
+static esp_err_t trace_handler(httpd_req_t *req)
+{
+    trace_status_t status;
+    trace_get_status(&status);
+    if (status.recorded[0] == 0 && status.recorded[1] == 0) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No trace recorded; run 'trace start' first");
+    }
+    
+    httpd_resp_set_type(req, "application/json");
+    httpd_resp_set_hdr(req, "Content-Disposition", "attachment; filename=\"trace.json\"");
+    if (trace_export_json(trace_write_chunk, req) != ESP_OK) {
+        return ESP_FAIL;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+// Start httpd once; the preview and the scrape endpoints share it
+static esp_err_t server_ensure_started(void)
+{
+    if (server_state.server_handle) {
+        return ESP_OK;
+    }
+    
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = server_state.port;
+    config.max_open_sockets = 4;
+    config.task_priority = 5;
+    
+    esp_err_t ret = httpd_start(&server_state.server_handle, &config);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(ret));
+        server_state.server_handle = NULL;
+        return ret;
+    }
+    return ESP_OK;
+}
+
+esp_err_t camera_preview_server_start_metrics(uint16_t port)
+{
+    if (server_state.metrics_serving) {
+        return ESP_OK;
+    }
+    if (!server_state.server_handle) {
+        server_state.port = port;
+    }
+    
+    esp_err_t ret = server_ensure_started();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+    // httpd may already be up for the preview, so register here rather than on start
+    httpd_uri_t metrics_uri = {
+        .uri = "/metrics",
+        .method = HTTP_GET,
+        .handler = metrics_handler,
+        .user_ctx = (void *)metrics_export_text
+    };
+    
+    httpd_uri_t metrics_json_uri = {
+        .uri = "/metrics.json",
+        .method = HTTP_GET,
+        .handler = metrics_handler,
+        .user_ctx = (void *)metrics_export_json
+    };
+    
+    httpd_uri_t trace_uri = {
+        .uri = "/trace.json",
+        .method = HTTP_GET,
+        .handler = trace_handler,
+        .user_ctx = NULL
+    };
+    
+    ret = httpd_register_uri_handler(server_state.server_handle, &metrics_uri);
+    if (ret == ESP_OK) {
+        ret = httpd_register_uri_handler(server_state.server_handle, &metrics_json_uri);
+    }
+    if (ret == ESP_OK) {
+        ret = httpd_register_uri_handler(server_state.server_handle, &trace_uri);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to register metrics handlers: %s", esp_err_to_name(ret));
+        httpd_unregister_uri_handler(server_state.server_handle, "/metrics", HTTP_GET);
+        httpd_unregister_uri_handler(server_state.server_handle, "/metrics.json", HTTP_GET);
+        httpd_unregister_uri_handler(server_state.server_handle, "/trace.json", HTTP_GET);
+        if (!server_state.running) {
+            httpd_stop(server_state.server_handle);
+            server_state.server_handle = NULL;
+        }
+        return ret;
+    }
+    
+    server_state.metrics_serving = true;
+    ESP_LOGI(TAG, "Metrics at http://<your-esp32-ip>:%d/metrics (and /metrics.json)", server_state.port);
+    return ESP_OK;
+}
+
 esp_err_t camera_preview_server_init(uint16_t port)
 {
     if (server_state.initialized) {
@@ -170,14 +311,8 @@ esp_err_t camera_preview_server_start(void)
     
     ESP_LOGI(TAG, "Starting camera preview HTTP server");
     
-    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
-    config.server_port = server_state.port;
-    config.max_open_sockets = 4;
-    config.task_priority = 5;
-    
-    esp_err_t ret = httpd_start(&server_state.server_handle, &config);
+    esp_err_t ret = server_ensure_started();
     if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(ret));
         return ret;
     }
     
@@ -221,7 +356,11 @@ esp_err_t camera_preview_server_stop(void)
     
     ESP_LOGI(TAG, "Stopping camera preview server");
     
-    if (server_state.server_handle) {
+    if (server_state.metrics_serving) {
+        // Keep httpd up for scrapers; only the preview goes away
+        httpd_unregister_uri_handler(server_state.server_handle, "/", HTTP_GET);
+        httpd_unregister_uri_handler(server_state.server_handle, "/stream", HTTP_GET);
+    } else if (server_state.server_handle) {
         esp_err_t ret = httpd_stop(server_state.server_handle);
         if (ret != ESP_OK) {
             ESP_LOGE(TAG, "Failed to stop HTTP server: %s", esp_err_to_name(ret));
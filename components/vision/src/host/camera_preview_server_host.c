@@ -0,0 +1,47 @@
+/*
+ * Camera preview server - Linux target
+ * There is no esp_http_server on the host; the preview and the metrics
+ * endpoints report not supported and the camera pipeline runs without them.
+ */
+
+#include "camera_preview_server.h"
+
+esp_err_t camera_preview_server_init(uint16_t port)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t camera_preview_server_start(void)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t camera_preview_server_start_metrics(uint16_t port)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
+
+esp_err_t camera_preview_server_stop(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t camera_preview_server_deinit(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t camera_preview_server_send_frame(uint8_t *frame_data, size_t frame_size)
+{
+    return ESP_ERR_INVALID_STATE;
+}
+
+bool camera_preview_server_is_running(void)
+{
+    return false;
+}
+
+esp_err_t camera_preview_server_get_url(char *url_buffer, size_t buffer_size)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,116 @@
+#ifndef HTTPS_SESSION_H
+#define HTTPS_SESSION_H
+
+#include <esp_err.h>
+#include <stdint.h>
+#include "https_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Keep-alive HTTPS client shared by the signaling requests
+ *
+ * One connection to the API host is kept open between requests, so the token
+ * POST and the SDP POST of a session share a single TCP + TLS handshake. When
+ * the connection has to be reopened (server idle timeout, WiFi flap) the saved
+ * TLS session ticket is offered, which skips the certificate chain and the key
+ * exchange. Requests are serialized; callers on different tasks simply wait.
+ */
+
+typedef struct {
+    uint32_t requests;
+    uint32_t failures;
+    uint32_t connects;          // TCP + TLS handshakes
+    uint32_t reused;            // Requests sent on an already open connection
+    uint32_t retries;           // Requests repeated on a new connection (idle socket closed by the server)
+    uint32_t first_connect_ms;  // First handshake, no session ticket yet
+    uint32_t last_connect_ms;
+    uint32_t total_connect_ms;
+} https_session_stats_t;
+
+/**
+ * @brief Average request time of one https_session_bench() mode
+ */
+typedef struct {
+    uint32_t ok;
+    uint32_t avg_ms;
+    uint32_t min_ms;
+    uint32_t max_ms;
+} https_bench_mode_t;
+
+typedef struct {
+    https_bench_mode_t cold;        // New client per request: full handshake every time
+    https_bench_mode_t resumed;     // Reconnect per request with the saved TLS session
+    https_bench_mode_t keepalive;   // One connection for all requests
+} https_bench_result_t;
+
+/**
+ * @brief Create the shared client state
+ * @return ESP_OK on success
+ */
+esp_err_t https_session_init(void);
+
+/**
+ * @brief POST through the shared connection
+ *
+ * Drop-in for https_post(): headers are "Name: value" strings ending with NULL,
+ * and the body callback only runs for 2xx responses.
+ * @param url Full URL; must be on the same host as earlier requests to reuse the connection
+ * @param headers NULL-terminated header list, may be NULL
+ * @param data Request body
+ * @param body Called with the complete response body
+ * @param ctx Passed to the body callback
+ * @return 0 on success, -1 on transport error or non-2xx status
+ */
+int https_session_post(const char *url, char **headers, const char *data, http_body_t body, void *ctx);
+
+/**
+ * @brief POST through the shared connection to an address resolved by the caller
+ *
+ * The URL host stays the TLS server name (SNI and certificate check) and the
+ * Host header; only the TCP connect goes to addr, so the request does no
+ * lookup of its own. https_session_post() is this with a dns_cache lookup.
+ * @param url Full URL
+ * @param addr IP literal from dns_cache_resolve(), NULL or empty to resolve in esp-tls
+ * @param headers NULL-terminated header list, may be NULL
+ * @param data Request body
+ * @param body Called with the complete response body
+ * @param ctx Passed to the body callback
+ * @return 0 on success, -1 on transport error or non-2xx status
+ */
+int https_session_post_to(const char *url, const char *addr, char **headers, const char *data,
+                          http_body_t body, void *ctx);
+
+/**
+ * @brief Close the connection but keep the TLS session for the next connect
+ *
+ * Called when the link goes down; the socket would be dead anyway.
+ */
+void https_session_close(void);
+
+/**
+ * @brief Get request and handshake counters
+ * @param stats Output statistics
+ */
+void https_session_get_stats(https_session_stats_t *stats);
+
+/**
+ * @brief Compare handshake cost: cold connects, resumed connects and keep-alive
+ *
+ * Runs count GET requests per mode on private clients; any HTTP status counts
+ * as a completed request. Blocks for the whole run. Without
+ * CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS the resumed mode does full handshakes.
+ * @param url URL to request
+ * @param count Requests per mode
+ * @param result Output timings
+ * @return ESP_OK if every mode completed at least one request
+ */
+esp_err_t https_session_bench(const char *url, int count, https_bench_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTPS_SESSION_H
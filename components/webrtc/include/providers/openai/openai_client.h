@@ -20,6 +20,21 @@ esp_err_t openai_realtime_start(void);
  */
 esp_err_t openai_realtime_stop(void);
 
+/**
+ * @brief Fetch the ephemeral token for the next session in the background
+ * @return ESP_OK if a token is cached or being fetched
+ */
+esp_err_t openai_realtime_prefetch(void);
+
+/**
+ * @brief Mark the next session as a replacement for a dropped one
+ *
+ * The session configuration is sent as usual once the data channel opens,
+ * but the greeting is skipped.
+ * @param restore true for a reconnect, false for a fresh session
+ */
+void openai_realtime_set_restore(bool restore);
+
 /**
  * @brief Send text message to OpenAI
  * @param text Text message to send
@@ -5,6 +5,7 @@
 #include "esp_webrtc_defaults.h"
 #include "esp_peer_default.h"
 #include "common.h"
+#include "webrtc_sdp.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -16,6 +17,7 @@ extern "C" {
 typedef struct {
     char *token; /*!< OpenAI API token */
     char *voice; /*!< Voice to select (optional) */
+    const char *audio_codec; /*!< rtpmap name kept in the offer (optional, NULL keeps all) */
 } openai_signaling_cfg_t;
 
 /**
@@ -24,6 +26,14 @@ typedef struct {
  */
 const esp_peer_signaling_impl_t *openai_signaling_get_impl(void);
 
+/**
+ * @brief Get the SDP summary of the last exchange
+ * @param offer Output offer rewrite summary, may be NULL
+ * @param answer Output negotiated parameters, may be NULL
+ * @return true if an answer has been parsed since boot
+ */
+bool openai_signaling_get_sdp_info(webrtc_sdp_offer_info_t *offer, webrtc_sdp_answer_t *answer);
+
 #ifdef __cplusplus
 }
 #endif
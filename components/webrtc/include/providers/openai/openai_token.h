@@ -0,0 +1,78 @@
+#ifndef OPENAI_TOKEN_H
+#define OPENAI_TOKEN_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ephemeral token cache
+ *
+ * Realtime client secrets are fetched in the background so a session start
+ * finds one ready instead of paying an extra HTTPS round trip. A fetch happens
+ * at WiFi up. While a session is pending or running, fetches also happen after
+ * a token is used and shortly before the cached one expires. An idle device
+ * lets its token lapse. Each token is handed out to one session only.
+ */
+
+typedef struct {
+    bool ready;                 // A valid token is cached
+    bool fetching;
+    uint32_t ttl_left_s;        // Local lifetime left of the cached token
+    int64_t expires_at;         // Server expiry of the cached token (unix seconds)
+    uint32_t fetches;
+    uint32_t failures;
+    uint32_t hits;              // Sessions that found a token ready
+    uint32_t misses;            // Sessions that had to wait for a fetch
+    uint32_t last_fetch_ms;     // Duration of the last successful fetch
+} openai_token_stats_t;
+
+/**
+ * @brief Create the cache (event group and refresh timer)
+ * @return ESP_OK on success
+ */
+esp_err_t openai_token_init(void);
+
+/**
+ * @brief Fetch a token in the background unless one is cached or in flight
+ *
+ * A cached token for a different voice is dropped.
+ * @param api_key OpenAI API key used for the client secret request
+ * @param voice Session voice, NULL for the Kconfig default
+ * @return ESP_OK if a token is cached or being fetched
+ */
+esp_err_t openai_token_prefetch(const char *api_key, const char *voice);
+
+/**
+ * @brief Take the cached token, waiting for an in-flight fetch if needed
+ *
+ * Blocks on the cache event group, not by polling. Starts the next prefetch.
+ * @param timeout_ms Maximum wait
+ * @return Token string owned by the caller (free with mem_free), NULL on failure or timeout
+ */
+char *openai_token_take(uint32_t timeout_ms);
+
+/**
+ * @brief Tell the cache whether a session is pending or running
+ *
+ * Only then is the used token replaced and the cached one refreshed before it
+ * expires; otherwise the refresh timer stays off.
+ * @param active true from session start until it is stopped on purpose
+ */
+void openai_token_set_active(bool active);
+
+/**
+ * @brief Get cache statistics
+ * @param stats Output statistics
+ */
+void openai_token_get_stats(openai_token_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OPENAI_TOKEN_H
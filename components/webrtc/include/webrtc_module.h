@@ -3,6 +3,7 @@
 
 #include <esp_err.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +19,37 @@ typedef enum {
     WEBRTC_STATE_FAILED
 } webrtc_state_t;
 
+/**
+ * @brief Session resume statistics
+ *
+ * Time-to-audio runs from the WiFi link coming back (GOT_IP) to the peer
+ * connection carrying media again.
+ */
+typedef struct {
+    uint32_t sessions;              // Peer connections that reached media
+    uint32_t reconnects;            // Of those, sessions resumed after a WiFi flap
+    uint32_t last_outage_ms;        // Link down time before the latest reconnect
+    uint32_t last_time_to_audio_ms;
+    uint32_t max_time_to_audio_ms;
+    uint32_t total_time_to_audio_ms;
+} webrtc_session_stats_t;
+
+/**
+ * @brief Peer reconnect statistics
+ *
+ * Recovery time runs from the peer connection dropping (link still up) to the
+ * data channel of the replacement session being open.
+ */
+typedef struct {
+    uint32_t drops;                 // Peer connection losses while the link was up
+    uint32_t recoveries;
+    uint32_t attempts;              // Restarts tried, including the successful ones
+    uint32_t last_attempts;         // Restarts the latest recovery needed
+    uint32_t last_recovery_ms;
+    uint32_t max_recovery_ms;
+    uint32_t total_recovery_ms;
+} webrtc_reconnect_stats_t;
+
 /**
  * @brief WebRTC event callback
  */
@@ -80,6 +112,48 @@ esp_err_t webrtc_module_pause_audio(void);
  */
 esp_err_t webrtc_module_resume_audio(void);
 
+/**
+ * @brief Record a WiFi link change
+ *
+ * Repeated notifications for the same state (e.g. disconnect retries) are ignored.
+ * @param up true when the link got an IP, false when it dropped
+ * @return On link up: how long the link was down in ms (0 on the first connect)
+ */
+uint32_t webrtc_module_note_link(bool up);
+
+/**
+ * @brief Record that the peer connection is carrying media (called by the provider)
+ */
+void webrtc_module_note_media_ready(void);
+
+/**
+ * @brief Get session resume statistics
+ * @param stats Output statistics
+ */
+void webrtc_module_get_session_stats(webrtc_session_stats_t *stats);
+
+/**
+ * @brief Record a peer connection change (called by the provider)
+ *
+ * A drop while the WiFi link is up starts the reconnect state machine:
+ * restarts with jittered exponential backoff until the data channel opens
+ * again. Drops during a WiFi outage are left to the link-up restart.
+ * @param up true when the data channel opened, false when the peer failed or closed
+ */
+void webrtc_module_note_peer(bool up);
+
+/**
+ * @brief Close the peer connection as if it had failed, to exercise reconnect
+ * @return ESP_OK if a drop was simulated, ESP_ERR_INVALID_STATE if not connected
+ */
+esp_err_t webrtc_module_simulate_drop(void);
+
+/**
+ * @brief Get peer reconnect statistics
+ * @param stats Output statistics
+ */
+void webrtc_module_get_reconnect_stats(webrtc_reconnect_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,93 @@
+#ifndef WEBRTC_SDP_H
+#define WEBRTC_SDP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief SDP offer rewriting and answer parsing
+ *
+ * Line-based, no allocation except the rewritten offer, and no dependency on
+ * the peer stack, so it also builds on the host.
+ */
+
+/**
+ * @brief What to keep in a local offer
+ */
+typedef struct {
+    const char *audio_codec;    // rtpmap name to keep in m=audio (e.g. "opus"), NULL keeps all
+    uint8_t max_candidates;     // Per media section, 0 = no limit
+    bool keep_ipv6;             // IPv6 and mDNS (.local) candidates
+    bool keep_tcp;              // TCP candidates
+    bool keep_extmap;           // RTP header extensions
+} webrtc_sdp_filter_t;
+
+/**
+ * @brief Result of one offer rewrite
+ */
+typedef struct {
+    uint32_t in_bytes;
+    uint32_t out_bytes;
+    uint16_t lines_dropped;
+    uint16_t payloads_dropped;      // Audio payload types removed from m=audio
+    uint16_t candidates_kept;
+    uint16_t candidates_dropped;
+} webrtc_sdp_offer_info_t;
+
+/**
+ * @brief Parameters the remote answer settled on
+ */
+typedef struct {
+    char codec[16];                 // rtpmap name of the first audio payload type
+    uint8_t payload_type;
+    uint32_t clock_rate;
+    uint8_t channels;
+    uint16_t ptime;                 // a=ptime, 0 when absent
+    uint16_t maxptime;
+    uint16_t minptime;              // Opus fmtp
+    bool useinbandfec;
+    bool usedtx;
+    bool stereo;
+    uint32_t maxaveragebitrate;
+    bool data_channel;              // m=application present
+    uint16_t sctp_port;
+    uint32_t max_message_size;
+    uint16_t candidates;
+} webrtc_sdp_answer_t;
+
+/**
+ * @brief Rewrite a local offer, dropping what the session will never use
+ *
+ * Payload types whose codec differs from filter->audio_codec are removed from
+ * m=audio along with their rtpmap/fmtp/rtcp-fb lines. Candidates are filtered
+ * (TCP, IPv6/mDNS, duplicates) and capped per section, keeping the stack's
+ * priority order. A rule that would leave a section with no codec or no
+ * candidate is not applied to that section.
+ * @param sdp Offer text, need not be NUL-terminated
+ * @param size Offer length in bytes
+ * @param filter What to keep
+ * @param out Output buffer, at least size + 1 bytes (the result never grows)
+ * @param info Optional rewrite summary
+ * @return Length written to out (NUL-terminated)
+ */
+int webrtc_sdp_minimize(const char *sdp, int size, const webrtc_sdp_filter_t *filter,
+                        char *out, webrtc_sdp_offer_info_t *info);
+
+/**
+ * @brief Extract the negotiated audio and data channel parameters of an answer
+ * @param sdp Answer text, need not be NUL-terminated
+ * @param size Answer length in bytes
+ * @param answer Output parameters
+ * @return true if an audio section was found
+ */
+bool webrtc_sdp_parse_answer(const char *sdp, int size, webrtc_sdp_answer_t *answer);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEBRTC_SDP_H
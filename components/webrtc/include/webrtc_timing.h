@@ -0,0 +1,96 @@
+#ifndef WEBRTC_TIMING_H
+#define WEBRTC_TIMING_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WEBRTC_TIMING_WINDOW    32      // Connections kept for the rolling histograms
+#define WEBRTC_TIMING_BUCKETS   8
+#define WEBRTC_TIMING_NONE      UINT32_MAX
+
+/**
+ * @brief Connection setup phases, in the order they normally complete
+ *
+ * Each phase is timed from the previous one that was reached. ICE and DTLS
+ * finish inside the peer stack and are only reported together (PEER).
+ */
+typedef enum {
+    WEBRTC_PHASE_SIGNALING,     // Signaling started, peer connection created
+    WEBRTC_PHASE_OFFER,         // Local SDP offer generated
+    WEBRTC_PHASE_TOKEN,         // Ephemeral token in hand (0 when prefetched)
+    WEBRTC_PHASE_DNS,           // API host resolved (0 when cached)
+    WEBRTC_PHASE_ANSWER,        // SDP POST answered
+    WEBRTC_PHASE_PEER,          // ICE + DTLS connected
+    WEBRTC_PHASE_SCTP,          // SCTP association up
+    WEBRTC_PHASE_CHANNEL,       // oai-events data channel open
+    WEBRTC_PHASE_SESSION,       // First session.created received
+    WEBRTC_PHASE_MAX
+} webrtc_phase_t;
+
+/**
+ * @brief Distribution of one phase over the rolling window
+ */
+typedef struct {
+    uint32_t samples;                           // Connections that reached this phase
+    uint32_t p50_ms;
+    uint32_t p90_ms;
+    uint32_t max_ms;
+    uint32_t hist[WEBRTC_TIMING_BUCKETS];       // Counts per webrtc_timing_bucket_ms() bucket
+} webrtc_phase_stats_t;
+
+typedef struct {
+    uint32_t connections;       // Setups completed since reset
+    uint32_t failures;          // Setups that failed or were abandoned
+    webrtc_phase_stats_t phase[WEBRTC_PHASE_MAX];
+    webrtc_phase_stats_t total; // webrtc_start to session.created
+} webrtc_timing_stats_t;
+
+/**
+ * @brief Start timing a new connection; an unfinished one counts as a failure
+ */
+void webrtc_timing_begin(void);
+
+/**
+ * @brief Record that a phase completed
+ *
+ * Only the first mark per connection counts. Marking WEBRTC_PHASE_SESSION
+ * closes the connection, logs its one-line summary and adds it to the window.
+ * @param phase Phase that just completed
+ */
+void webrtc_timing_mark(webrtc_phase_t phase);
+
+/**
+ * @brief Abandon the connection being timed and log how far it got
+ */
+void webrtc_timing_fail(void);
+
+/**
+ * @brief Compute percentiles and histograms over the rolling window
+ * @param stats Output statistics
+ */
+void webrtc_timing_get_stats(webrtc_timing_stats_t *stats);
+
+/**
+ * @brief Clear the window and counters
+ */
+void webrtc_timing_reset(void);
+
+/**
+ * @brief Short name of a phase, as used in the summary line
+ */
+const char *webrtc_timing_phase_name(webrtc_phase_t phase);
+
+/**
+ * @brief Upper bound of a histogram bucket
+ * @return Bound in ms, WEBRTC_TIMING_NONE for the last (open) bucket
+ */
+uint32_t webrtc_timing_bucket_ms(int bucket);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WEBRTC_TIMING_H
@@ -0,0 +1,147 @@
+/*
+ * HTTPS session - Linux target
+ * Same API on top of the host https_post(), which answers from files instead
+ * of the network. The connect/reuse accounting is emulated: the first request
+ * and the first one after https_session_close() pay $AG_HOST_HTTPS_CONNECT_MS
+ * as a handshake, so the signaling timings keep their device shape.
+ */
+
+#include "https_session.h"
+#include <esp_log.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "metrics.h"
+
+static const char *TAG = "https_session";
+
+static struct {
+    SemaphoreHandle_t mutex;
+    bool connected;             // An emulated connection is open
+    https_session_stats_t stats;
+} session_state = {0};
+
+static struct {
+    metric_t *requests;
+    metric_t *failures;
+    metric_t *reused;
+    metric_t *connect_ms;
+} session_metrics;
+
+static void session_note_request(bool connected, uint32_t connect_ms, bool ok)
+{
+    https_session_stats_t *stats = &session_state.stats;
+    stats->requests++;
+    stats->failures += !ok;
+    metric_inc(session_metrics.requests);
+    if (!ok) {
+        metric_inc(session_metrics.failures);
+    }
+    if (!connected) {
+        stats->reused += ok;
+        if (ok) {
+            metric_inc(session_metrics.reused);
+        }
+        return;
+    }
+    metric_observe(session_metrics.connect_ms, connect_ms);
+    stats->connects++;
+    if (stats->connects == 1) {
+        stats->first_connect_ms = connect_ms;
+    }
+    stats->last_connect_ms = connect_ms;
+    stats->total_connect_ms += connect_ms;
+}
+
+esp_err_t https_session_init(void)
+{
+    if (session_state.mutex) {
+        return ESP_OK;
+    }
+    session_state.mutex = xSemaphoreCreateMutex();
+    if (session_state.mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create session mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    static const uint32_t connect_bounds[] = {100, 200, 400, 700, 1000, 2000, 4000};
+    session_metrics.requests = metrics_counter("https_requests_total", "Signaling HTTPS requests");
+    session_metrics.failures = metrics_counter("https_request_failures_total", "Requests without a 2xx answer");
+    session_metrics.reused = metrics_counter("https_reused_total", "Requests sent on a kept connection");
+    session_metrics.connect_ms = metrics_histogram("https_connect_ms", "TCP and TLS setup per new connection",
+                                                   connect_bounds, sizeof(connect_bounds) / sizeof(connect_bounds[0]));
+    return ESP_OK;
+}
+
+int https_session_post(const char *url, char **headers, const char *data, http_body_t body, void *ctx)
+{
+    return https_session_post_to(url, NULL, headers, data, body, ctx);
+}
+
+// Nothing to connect to; the address is ignored
+int https_session_post_to(const char *url, const char *addr, char **headers, const char *data,
+                          http_body_t body, void *ctx)
+{
+    if (url == NULL || session_state.mutex == NULL) {
+        return -1;
+    }
+    xSemaphoreTake(session_state.mutex, portMAX_DELAY);
+
+    bool connected = false;
+    uint32_t connect_ms = 0;
+    if (!session_state.connected) {
+        const char *env = getenv("AG_HOST_HTTPS_CONNECT_MS");
+        int64_t start = esp_timer_get_time();
+        if (env && atoi(env) > 0) {
+            vTaskDelay(pdMS_TO_TICKS(atoi(env)));
+        }
+        connect_ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+        connected = true;
+        session_state.connected = true;
+    }
+
+    int ret = https_post(url, headers, (char *)data, NULL, body, ctx);
+    bool ok = ret == 0;
+    session_note_request(connected, connect_ms, ok);
+    if (!ok) {
+        // A failed request drops the connection, as on the device
+        session_state.connected = false;
+    }
+    xSemaphoreGive(session_state.mutex);
+    return ok ? 0 : -1;
+}
+
+void https_session_close(void)
+{
+    if (session_state.mutex == NULL) {
+        return;
+    }
+    if (xSemaphoreTake(session_state.mutex, 0) != pdTRUE) {
+        return;
+    }
+    session_state.connected = false;
+    xSemaphoreGive(session_state.mutex);
+}
+
+void https_session_get_stats(https_session_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (session_state.mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(session_state.mutex, portMAX_DELAY);
+    *stats = session_state.stats;
+    xSemaphoreGive(session_state.mutex);
+}
+
+// Handshake cost only exists against a real server
+esp_err_t https_session_bench(const char *url, int count, https_bench_result_t *result)
+{
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,394 @@
+#include "https_session.h"
+#include "dns_cache.h"
+#include <esp_log.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_http_client.h"
+#include "esp_crt_bundle.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "memory_manager.h"
+#include "metrics.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "https_session";
+
+#define SESSION_TIMEOUT_MS      10000
+#define SESSION_MAX_HEADERS     8
+#define SESSION_HEADER_NAME_LEN 48
+#define SESSION_HOST_LEN        DNS_CACHE_HOST_LEN
+
+// Response of the request in flight
+typedef struct {
+    char *data;
+    int size;
+    int capacity;
+    bool connected;             // A new connection was opened for this request
+    int64_t start_us;
+    int64_t connected_us;
+} session_resp_t;
+
+// Module state; the mutex serializes requests on the shared connection
+static struct {
+    SemaphoreHandle_t mutex;
+    esp_http_client_handle_t client;
+    char host[SESSION_HOST_LEN];    // Authority the client was created for; TLS name and Host header
+    session_resp_t resp;
+    https_session_stats_t stats;
+} session_state = {0};
+
+static esp_err_t session_event_handler(esp_http_client_event_t *evt)
+{
+    session_resp_t *resp = (session_resp_t *)evt->user_data;
+    if (resp == NULL) {
+        return ESP_OK;
+    }
+    switch (evt->event_id) {
+    case HTTP_EVENT_ON_CONNECTED:
+        resp->connected = true;
+        resp->connected_us = esp_timer_get_time();
+        break;
+    case HTTP_EVENT_ON_DATA:
+        if (resp->size + evt->data_len + 1 > resp->capacity) {
+            int capacity = (resp->size + evt->data_len + 1) * 2;
+            char *data = mem_realloc(resp->data, capacity, MEM_POLICY_PREFER_PSRAM, "https_resp");
+            if (data == NULL) {
+                ESP_LOGE(TAG, "No memory for %d byte response", resp->size + evt->data_len);
+                return ESP_ERR_NO_MEM;
+            }
+            resp->data = data;
+            resp->capacity = capacity;
+        }
+        memcpy(resp->data + resp->size, evt->data, evt->data_len);
+        resp->size += evt->data_len;
+        resp->data[resp->size] = '\0';
+        break;
+    default:
+        break;
+    }
+    return ESP_OK;
+}
+
+static esp_http_client_handle_t session_client_create(const char *url, const char *common_name,
+                                                      bool save_session, void *user_data)
+{
+    esp_http_client_config_t cfg = {
+        .url = url,
+        .timeout_ms = SESSION_TIMEOUT_MS,
+        .event_handler = session_event_handler,
+        .user_data = user_data,
+        .keep_alive_enable = true,
+        .common_name = common_name,
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
+        .save_client_session = save_session,
+#endif
+#ifndef CONFIG_ESP_TLS_SKIP_SERVER_CERT_VERIFY
+        .crt_bundle_attach = esp_crt_bundle_attach,
+#endif
+    };
+    return esp_http_client_init(&cfg);
+}
+
+// "https://host:443/path" -> authority "host:443" and host "host"
+static bool session_split_url(const char *url, char *authority, char *host)
+{
+    const char *p = strstr(url, "://");
+    if (p == NULL) {
+        return false;
+    }
+    p += 3;
+    int authority_len = strcspn(p, "/?#");
+    int host_len = *p == '[' ? (int)strcspn(p, "]") + 1 : (int)strcspn(p, ":/?#");
+    if (host_len == 0 || authority_len >= SESSION_HOST_LEN) {
+        return false;
+    }
+    memcpy(authority, p, authority_len);
+    authority[authority_len] = '\0';
+    memcpy(host, p, host_len);
+    host[host_len] = '\0';
+    return true;
+}
+
+// Same URL with the host replaced by the resolved address; NULL when there is nothing to replace
+static char *session_direct_url(const char *url, const char *host, const char *addr)
+{
+    if (addr == NULL || addr[0] == '\0' || strcmp(host, addr) == 0) {
+        return NULL;
+    }
+    const char *start = strstr(url, "://") + 3;
+    bool v6 = strchr(addr, ':') != NULL;
+    int size = strlen(url) + strlen(addr) + 3;
+    char *out = mem_alloc(size, MEM_POLICY_PREFER_PSRAM, "https_url");
+    if (out) {
+        snprintf(out, size, "%.*s%s%s%s%s", (int)(start - url), url,
+                 v6 ? "[" : "", addr, v6 ? "]" : "", start + strlen(host));
+    }
+    return out;
+}
+
+// "Name: value" strings; returns how many names were set so they can be removed afterwards
+static int session_set_headers(esp_http_client_handle_t client, char **headers,
+                               char names[][SESSION_HEADER_NAME_LEN])
+{
+    int count = 0;
+    for (int i = 0; headers && headers[i] && count < SESSION_MAX_HEADERS; i++) {
+        const char *colon = strchr(headers[i], ':');
+        if (colon == NULL || colon - headers[i] >= SESSION_HEADER_NAME_LEN) {
+            ESP_LOGW(TAG, "Skipping malformed header");
+            continue;
+        }
+        int len = colon - headers[i];
+        memcpy(names[count], headers[i], len);
+        names[count][len] = '\0';
+        const char *value = colon + 1;
+        while (*value == ' ') {
+            value++;
+        }
+        esp_http_client_set_header(client, names[count], value);
+        count++;
+    }
+    return count;
+}
+
+static struct {
+    metric_t *requests;
+    metric_t *failures;
+    metric_t *reused;
+    metric_t *connect_ms;
+} session_metrics;
+
+static void session_note_request(const session_resp_t *resp, bool ok)
+{
+    https_session_stats_t *stats = &session_state.stats;
+    stats->requests++;
+    stats->failures += !ok;
+    metric_inc(session_metrics.requests);
+    if (!ok) {
+        metric_inc(session_metrics.failures);
+    }
+    if (!resp->connected) {
+        stats->reused += ok;
+        if (ok) {
+            metric_inc(session_metrics.reused);
+        }
+        return;
+    }
+    uint32_t ms = (uint32_t)((resp->connected_us - resp->start_us) / 1000);
+    metric_observe(session_metrics.connect_ms, ms);
+    stats->connects++;
+    if (stats->connects == 1) {
+        stats->first_connect_ms = ms;
+    }
+    stats->last_connect_ms = ms;
+    stats->total_connect_ms += ms;
+    ESP_LOGD(TAG, "Connected in %lu ms", ms);
+}
+
+esp_err_t https_session_init(void)
+{
+    if (session_state.mutex) {
+        return ESP_OK;
+    }
+    session_state.mutex = xSemaphoreCreateMutex();
+    if (session_state.mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create session mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    static const uint32_t connect_bounds[] = {100, 200, 400, 700, 1000, 2000, 4000};
+    session_metrics.requests = metrics_counter("https_requests_total", "Signaling HTTPS requests");
+    session_metrics.failures = metrics_counter("https_request_failures_total", "Requests without a 2xx answer");
+    session_metrics.reused = metrics_counter("https_reused_total", "Requests sent on a kept connection");
+    session_metrics.connect_ms = metrics_histogram("https_connect_ms", "TCP and TLS setup per new connection",
+                                                   connect_bounds, sizeof(connect_bounds) / sizeof(connect_bounds[0]));
+    return ESP_OK;
+}
+
+int https_session_post(const char *url, char **headers, const char *data, http_body_t body, void *ctx)
+{
+    char addr[DNS_CACHE_ADDR_LEN] = "";
+    if (url && dns_cache_resolve(url, addr, sizeof(addr)) != ESP_OK) {
+        addr[0] = '\0';
+    }
+    return https_session_post_to(url, addr, headers, data, body, ctx);
+}
+
+int https_session_post_to(const char *url, const char *addr, char **headers, const char *data,
+                          http_body_t body, void *ctx)
+{
+    if (url == NULL || session_state.mutex == NULL) {
+        return -1;
+    }
+    char authority[SESSION_HOST_LEN];
+    char host[SESSION_HOST_LEN];
+    if (!session_split_url(url, authority, host)) {
+        ESP_LOGE(TAG, "Bad URL %s", url);
+        return -1;
+    }
+    char *direct_url = session_direct_url(url, host, addr);
+    xSemaphoreTake(session_state.mutex, portMAX_DELAY);
+
+    // The TLS name is fixed at creation, so another host needs another client
+    session_resp_t *resp = &session_state.resp;
+    if (session_state.client && strcmp(session_state.host, host) != 0) {
+        esp_http_client_cleanup(session_state.client);
+        session_state.client = NULL;
+    }
+    if (session_state.client == NULL) {
+        strlcpy(session_state.host, host, sizeof(session_state.host));
+        // The name, not the address, is what the certificate and SNI carry
+        const char *common_name = host[0] != '[' ? session_state.host : NULL;
+        session_state.client = session_client_create(url, common_name, true, resp);
+        if (session_state.client == NULL) {
+            xSemaphoreGive(session_state.mutex);
+            mem_free(direct_url);
+            ESP_LOGE(TAG, "Failed to create HTTP client");
+            return -1;
+        }
+    }
+    esp_http_client_handle_t client = session_state.client;
+
+    // Same address keeps the connection; a different one closes it
+    esp_http_client_set_url(client, direct_url ? direct_url : url);
+    if (direct_url) {
+        esp_http_client_set_header(client, "Host", authority);
+    }
+    esp_http_client_set_method(client, HTTP_METHOD_POST);
+    esp_http_client_set_post_field(client, data, data ? strlen(data) : 0);
+    char names[SESSION_MAX_HEADERS][SESSION_HEADER_NAME_LEN];
+    int header_count = session_set_headers(client, headers, names);
+
+    esp_err_t err = ESP_FAIL;
+    for (int attempt = 0; attempt < 2; attempt++) {
+        resp->size = 0;
+        resp->connected = false;
+        resp->start_us = esp_timer_get_time();
+        err = esp_http_client_perform(client);
+        if (err == ESP_OK || resp->connected) {
+            break;
+        }
+        // Most likely the server dropped the idle connection; reconnect once, resuming the TLS session
+        esp_http_client_close(client);
+        session_state.stats.retries++;
+    }
+
+    int status = err == ESP_OK ? esp_http_client_get_status_code(client) : 0;
+    bool ok = status >= 200 && status < 300;
+    session_note_request(resp, ok);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Request failed: %s", esp_err_to_name(err));
+        esp_http_client_close(client);
+    } else if (!ok) {
+        ESP_LOGW(TAG, "HTTP status %d: %.200s", status, resp->size ? resp->data : "");
+    } else if (body && resp->size > 0) {
+        http_resp_t answer = {
+            .data = resp->data,
+            .size = resp->size,
+        };
+        body(&answer, ctx);
+    }
+
+    for (int i = 0; i < header_count; i++) {
+        esp_http_client_delete_header(client, names[i]);
+    }
+    esp_http_client_set_post_field(client, NULL, 0);
+    xSemaphoreGive(session_state.mutex);
+    mem_free(direct_url);
+    return ok ? 0 : -1;
+}
+
+void https_session_close(void)
+{
+    if (session_state.mutex == NULL) {
+        return;
+    }
+    // A request in flight fails on the dead socket and closes the connection itself
+    if (xSemaphoreTake(session_state.mutex, 0) != pdTRUE) {
+        return;
+    }
+    if (session_state.client) {
+        esp_http_client_close(session_state.client);
+    }
+    xSemaphoreGive(session_state.mutex);
+}
+
+void https_session_get_stats(https_session_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (session_state.mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(session_state.mutex, portMAX_DELAY);
+    *stats = session_state.stats;
+    xSemaphoreGive(session_state.mutex);
+}
+
+// One bench mode; the first request of a reused client is a warm-up and not timed
+static void bench_mode(const char *url, int count, bool reuse_client, bool reconnect,
+                       https_bench_mode_t *out)
+{
+    esp_http_client_handle_t client = NULL;
+    uint64_t total_ms = 0;
+    memset(out, 0, sizeof(*out));
+    out->min_ms = UINT32_MAX;
+
+    for (int i = reuse_client ? -1 : 0; i < count; i++) {
+        if (client == NULL) {
+            client = session_client_create(url, NULL, reuse_client, NULL);
+            if (client == NULL) {
+                break;
+            }
+        }
+        int64_t start = esp_timer_get_time();
+        esp_err_t err = esp_http_client_perform(client);
+        uint32_t ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+        if (err == ESP_OK && i >= 0) {
+            out->ok++;
+            total_ms += ms;
+            if (ms < out->min_ms) {
+                out->min_ms = ms;
+            }
+            if (ms > out->max_ms) {
+                out->max_ms = ms;
+            }
+        } else if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Bench request failed: %s", esp_err_to_name(err));
+        }
+
+        if (!reuse_client) {
+            esp_http_client_cleanup(client);
+            client = NULL;
+        } else if (reconnect || err != ESP_OK) {
+            esp_http_client_close(client);
+        }
+    }
+    if (client) {
+        esp_http_client_cleanup(client);
+    }
+
+    if (out->ok) {
+        out->avg_ms = (uint32_t)(total_ms / out->ok);
+    } else {
+        out->min_ms = 0;
+    }
+}
+
+esp_err_t https_session_bench(const char *url, int count, https_bench_result_t *result)
+{
+    if (url == NULL || count <= 0 || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    ESP_LOGI(TAG, "Benchmarking %d requests per mode against %s", count, url);
+    bench_mode(url, count, false, false, &result->cold);
+    bench_mode(url, count, true, true, &result->resumed);
+    bench_mode(url, count, true, false, &result->keepalive);
+
+    if (!result->cold.ok || !result->resumed.ok || !result->keepalive.ok) {
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
@@ -1,6 +1,7 @@
 #include "openai_client.h"
 #include <esp_log.h>
 #include <string.h>
+#include <strings.h>
 #include <stdlib.h>
 #include "esp_capture.h"
 #include "av_render.h"
@@ -10,22 +11,40 @@
 #include "sdkconfig.h"
 #include "audio_module.h"
 #include "audio_feedback.h"
+#include "audio_preroll.h"
+#include "webrtc_module.h"
+#include "webrtc_timing.h"
+#include "wifi_power.h"
 #include "providers/openai/openai_signaling.h"
+#include "providers/openai/openai_token.h"
 #include "camera_module.h"
 #include "memory_manager.h"
+#include "trace.h"
 #include <cJSON.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
 #include "openai_signaling.h"
 #include "prompts.h"
 #include "mbedtls/base64.h"
-#include "esp_camera.h"
 
 static const char *TAG = "openai_webrtc";
 
 // WebRTC handle
 static esp_webrtc_handle_t webrtc = NULL;
 
+// Session replacing a dropped one: configuration is re-sent, no greeting
+static volatile bool restore_session = false;
+
+// What the answer must settle on for the configured encoder and decoder
+#ifdef CONFIG_AG_WEBRTC_SUPPORT_OPUS
+#define ANSWER_CODEC        "opus"
+#elif defined(CONFIG_AG_WEBRTC_AUDIO_CODEC_G711U)
+#define ANSWER_CODEC        "PCMU"
+#else
+#define ANSWER_CODEC        "PCMA"
+#endif
+#define ANSWER_PTIME_MS     20
+
 // Audio state management
 static struct {
     bool audio_paused;
@@ -236,45 +255,20 @@ static void vision_analysis_task(void *pvParameters)
     
     // Get frames on-demand (battery efficient)
     int frame_count = 0;
+    TRACE_BEGIN("vision_frames");
     char **base64_frames = cam_module_get_vision_frames(params->max_frames, &frame_count);
+    TRACE_END("vision_frames");
     
     if (!base64_frames || frame_count == 0) {
         ESP_LOGW(TAG, "No frames captured, trying single frame capture");
         
-        // Fallback to single frame capture directly from camera
-        camera_fb_t *fb = esp_camera_fb_get();
-        if (!fb) {
+        // One more try for a single frame; the module holds the sensor lock and powers it up
+        base64_frames = cam_module_get_vision_frames(1, &frame_count);
+        if (!base64_frames || frame_count == 0) {
             ESP_LOGE(TAG, "Failed to get frame for analysis");
             send_vision_result_to_openai("Error: Could not capture image for analysis", params->call_id);
             goto cleanup;
         }
-        
-        // Encode single frame to base64
-        size_t encoded_size = 0;
-        mbedtls_base64_encode(NULL, 0, &encoded_size, fb->buf, fb->len);
-        char *single_base64 = mem_alloc(encoded_size + 1, MEM_POLICY_PREFER_PSRAM, "single_base64");
-        if (!single_base64) {
-            esp_camera_fb_return(fb);
-            ESP_LOGE(TAG, "Failed to allocate base64 buffer");
-            send_vision_result_to_openai("Error: Could not capture image for analysis", params->call_id);
-            goto cleanup;
-        }
-        
-        size_t actual_size = 0;
-        mbedtls_base64_encode((unsigned char*)single_base64, encoded_size, &actual_size, fb->buf, fb->len);
-        single_base64[actual_size] = '\0';
-        esp_camera_fb_return(fb);
-        
-        // Create array with single frame
-        base64_frames = mem_alloc(sizeof(char*), MEM_POLICY_PREFER_PSRAM, "frame_array");
-        if (base64_frames) {
-            base64_frames[0] = single_base64;
-            frame_count = 1;
-        } else {
-            mem_free(single_base64);
-            send_vision_result_to_openai("Error: Could not capture image for analysis", params->call_id);
-            goto cleanup;
-        }
     }
     
     ESP_LOGI(TAG, "📷 Got %d/%d frames ready for Realtime API streaming", frame_count, params->max_frames);
@@ -298,7 +292,9 @@ static void vision_analysis_task(void *pvParameters)
     
     // Send images directly via WebRTC Realtime API
     ESP_LOGI(TAG, "🚀 Sending %d images directly to OpenAI Realtime API!", frame_count);
+    TRACE_BEGIN("vision_send");
     send_images_to_realtime(base64_frames, frame_count, combined_prompt);
+    TRACE_END("vision_send");
     
     // Clean up
     mem_free(combined_prompt);
@@ -331,6 +327,7 @@ static int handle_visual_analysis(attribute_t *attr)
     const char *context = attr->s_value ? attr->s_value : "Analyze what you see!";
     const char *call_id = attr->call_id ? attr->call_id : "unknown_call";
     
+    TRACE_INSTANT("vision_request");
     ESP_LOGI(TAG, "🎯 Vision analysis requested: %s", context);
     
     // Prepare parameters for async task
@@ -479,6 +476,84 @@ static int send_function_desc(bool vision_enabled)
     return 0;
 }
 
+// Send one chunk of pre-roll PCM as input_audio_buffer.append
+static esp_err_t send_preroll_chunk(const uint8_t *pcm, uint32_t size, void *ctx)
+{
+    size_t encoded_size = 0;
+    mbedtls_base64_encode(NULL, 0, &encoded_size, pcm, size);
+    char *encoded = mem_alloc(encoded_size + 1, MEM_POLICY_PREFER_PSRAM, "preroll_b64");
+    if (!encoded) {
+        return ESP_ERR_NO_MEM;
+    }
+    size_t actual_size = 0;
+    mbedtls_base64_encode((unsigned char *)encoded, encoded_size, &actual_size, pcm, size);
+    encoded[actual_size] = '\0';
+
+    esp_err_t ret = ESP_FAIL;
+    cJSON *append = cJSON_CreateObject();
+    cJSON_AddStringToObject(append, "type", "input_audio_buffer.append");
+    cJSON_AddStringToObject(append, "audio", encoded);
+    mem_free(encoded);
+
+    char *append_json = cJSON_PrintUnformatted(append);
+    if (append_json) {
+        ret = esp_webrtc_send_custom_data(webrtc, ESP_WEBRTC_CUSTOM_DATA_VIA_DATA_CHANNEL,
+                                          (uint8_t *)append_json, strlen(append_json));
+        mem_free(append_json);
+    }
+    cJSON_Delete(append);
+    return ret;
+}
+
+// Push speech recorded during connection setup, then ask for a reply to it
+static bool send_preroll_audio(void)
+{
+    if (!audio_preroll_has_speech()) {
+        audio_preroll_discard();
+        return false;
+    }
+
+    esp_err_t ret = audio_preroll_flush(send_preroll_chunk, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Pre-roll flush failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+
+    const char *commit_json = "{\"type\":\"input_audio_buffer.commit\"}";
+    esp_webrtc_send_custom_data(webrtc, ESP_WEBRTC_CUSTOM_DATA_VIA_DATA_CHANNEL,
+                                (uint8_t *)commit_json, strlen(commit_json));
+    const char *create_json = "{\"type\":\"response.create\"}";
+    esp_webrtc_send_custom_data(webrtc, ESP_WEBRTC_CUSTOM_DATA_VIA_DATA_CHANNEL,
+                                (uint8_t *)create_json, strlen(create_json));
+    ESP_LOGI(TAG, "Sent pre-roll speech, replying to it instead of greeting");
+    return true;
+}
+
+// The encoder and decoder are built from audio_info, not from the answer, so a
+// mismatch can only be reported; it shows up as garbled or silent audio
+static void check_answer(void)
+{
+    webrtc_sdp_answer_t answer;
+    if (!openai_signaling_get_sdp_info(NULL, &answer)) {
+        return;
+    }
+    ESP_LOGI(TAG, "Answer: %s/%lu/%u pt %u, ptime %u, fec %d, dtx %d, maxavgbitrate %lu",
+             answer.codec, answer.clock_rate, answer.channels, answer.payload_type,
+             answer.ptime, answer.useinbandfec, answer.usedtx, answer.maxaveragebitrate);
+    if (strcasecmp(answer.codec, ANSWER_CODEC) != 0) {
+        ESP_LOGW(TAG, "Answer codec %s, encoder is %s", answer.codec, ANSWER_CODEC);
+    }
+    if (answer.ptime && answer.ptime != ANSWER_PTIME_MS) {
+        ESP_LOGW(TAG, "Answer ptime %u ms, encoder frames are %d ms", answer.ptime, ANSWER_PTIME_MS);
+    }
+    if (answer.minptime > ANSWER_PTIME_MS) {
+        ESP_LOGW(TAG, "Answer minptime %u ms exceeds the %d ms frames", answer.minptime, ANSWER_PTIME_MS);
+    }
+    if (!answer.data_channel) {
+        ESP_LOGW(TAG, "Answer has no data channel; events will not arrive");
+    }
+}
+
 // WebRTC event handler - improved based on WebRTC documentation
 static int webrtc_event_handler(esp_webrtc_event_t *event, void *ctx)
 {
@@ -486,6 +561,7 @@ static int webrtc_event_handler(esp_webrtc_event_t *event, void *ctx)
     
     if (event->type == ESP_WEBRTC_EVENT_DATA_CHANNEL_CONNECTED) {
         ESP_LOGI(TAG, "Data channel connected, creating oai-events channel");
+        webrtc_timing_mark(WEBRTC_PHASE_SCTP);
         
         // Create data channel with proper label for OpenAI events
         // Per the WebRTC API docs, OpenAI uses "oai-events" for event communication
@@ -498,9 +574,26 @@ static int webrtc_event_handler(esp_webrtc_event_t *event, void *ctx)
     }
     else if (event->type == ESP_WEBRTC_EVENT_DATA_CHANNEL_OPENED) {
         ESP_LOGI(TAG, "Data channel opened - sending initial configuration");
+        webrtc_timing_mark(WEBRTC_PHASE_CHANNEL);
+        webrtc_module_note_peer(true);
+        wifi_power_note(WIFI_POWER_SESSION_READY);
         
         // Send session update with configuration (always with vision enabled)
         send_function_desc(true);
+
+        // Speech captured while connecting gets answered instead of the greeting
+        if (send_preroll_audio()) {
+            restore_session = false;
+            ESP_LOGI(TAG, "✅ Fully operational. Ready to receive commands.");
+            return 0;
+        }
+        
+        // A reconnect continues quietly where the dropped session left off
+        if (restore_session) {
+            restore_session = false;
+            ESP_LOGI(TAG, "✅ Session restored after reconnect");
+            return 0;
+        }
         
         // According to WebRTC docs, we can send response.create to trigger initial response
         cJSON *response_create = cJSON_CreateObject();
@@ -522,9 +615,23 @@ static int webrtc_event_handler(esp_webrtc_event_t *event, void *ctx)
         
         ESP_LOGI(TAG, "✅ Fully operational. Ready to receive commands.");
     }
+    else if (event->type == ESP_WEBRTC_EVENT_CONNECTED) {
+        // Media path is up; closes the time-to-audio window of a reconnect
+        webrtc_timing_mark(WEBRTC_PHASE_PEER);
+        check_answer();
+        webrtc_module_note_media_ready();
+    }
     else if (event->type == ESP_WEBRTC_EVENT_CONNECT_FAILED || 
+             event->type == ESP_WEBRTC_EVENT_DISCONNECTED ||
              event->type == ESP_WEBRTC_EVENT_DATA_CHANNEL_CLOSED) {
         ESP_LOGW(TAG, "WebRTC connection issue: event %d", event->type);
+        webrtc_timing_fail();
+        // Events raised while we close the peer ourselves are not drops
+        if (webrtc) {
+            webrtc_module_note_peer(false);
+            // The reconnect sets the peer up again; keep the radio responsive for it
+            wifi_power_note(WIFI_POWER_SESSION_START);
+        }
     }
     else {
         ESP_LOGD(TAG, "WebRTC event: %d", event->type);
@@ -676,7 +783,9 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
 #endif
             
             // Process function calls
+            TRACE_BEGIN("dc_message");
             process_json(json_str);
+            TRACE_END("dc_message");
             
             mem_free(json_str);
         }
@@ -714,6 +823,7 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
             }
             else if (strcmp(type_str, "response.done") == 0) {
                 ESP_LOGI(TAG, "Response completed");
+                wifi_power_note(WIFI_POWER_RESPONSE_DONE);
                 // Clear active response
                 if (response_state.mutex && xSemaphoreTake(response_state.mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     response_state.response_in_progress = false;
@@ -726,6 +836,7 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
             }
             else if (strcmp(type_str, "response.created") == 0) {
                 ESP_LOGI(TAG, "Response generation started");
+                wifi_power_note(WIFI_POWER_RESPONSE_START);
                 // Track active response with improved tracking
                 if (response_state.mutex && xSemaphoreTake(response_state.mutex, pdMS_TO_TICKS(100)) == pdTRUE) {
                     response_state.response_in_progress = true;
@@ -769,6 +880,7 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
             }
             else if (strcmp(type_str, "session.created") == 0) {
                 ESP_LOGI(TAG, "Session created successfully");
+                webrtc_timing_mark(WEBRTC_PHASE_SESSION);
                 // Session is ready - we can now configure it with our tools
                 send_function_desc(true);
             }
@@ -777,9 +889,15 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
             }
             else if (strcmp(type_str, "input_audio_buffer.speech_started") == 0) {
                 ESP_LOGD(TAG, "Speech detected - user is speaking");
+                wifi_power_note(WIFI_POWER_SPEECH_START);
             }
             else if (strcmp(type_str, "input_audio_buffer.speech_stopped") == 0) {
                 ESP_LOGD(TAG, "Speech stopped - processing audio");
+                wifi_power_note(WIFI_POWER_SPEECH_STOP);
+            }
+            else if (strcmp(type_str, "input_audio_buffer.committed") == 0) {
+                // First user audio the server accepted: end of the boot-to-first-word timeline
+                audio_preroll_note_heard();
             }
             else if (strcmp(type_str, "response.audio.delta") == 0) {
                 // Audio data is being received - handled by WebRTC automatically
@@ -787,6 +905,14 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
             else if (strcmp(type_str, "response.audio.done") == 0) {
                 ESP_LOGD(TAG, "Audio response completed");
             }
+            // Playback outlasts response.done: audio still streams in real time
+            else if (strcmp(type_str, "output_audio_buffer.started") == 0) {
+                wifi_power_note(WIFI_POWER_PLAYBACK_START);
+            }
+            else if (strcmp(type_str, "output_audio_buffer.stopped") == 0 ||
+                     strcmp(type_str, "output_audio_buffer.cleared") == 0) {
+                wifi_power_note(WIFI_POWER_PLAYBACK_STOP);
+            }
             else {
                 ESP_LOGD(TAG, "Unhandled message type: %s", type_str);
             }
@@ -801,6 +927,8 @@ static int webrtc_data_handler(esp_webrtc_custom_data_via_t via, uint8_t *data,
 esp_err_t openai_realtime_start(void)
 {
     ESP_LOGI(TAG, "Starting OpenAI WebRTC session");
+    webrtc_timing_begin();
+    wifi_power_note(WIFI_POWER_SESSION_START);
     
     // Initialize response state mutex if not already created
     if (!response_state.mutex) {
@@ -823,6 +951,7 @@ esp_err_t openai_realtime_start(void)
     };
     openai_signaling_cfg_t openai_cfg = {
         .token = OPENAI_API_KEY,
+        .audio_codec = ANSWER_CODEC,
     };
     
     esp_webrtc_cfg_t cfg = {
@@ -832,6 +961,10 @@ esp_err_t openai_realtime_start(void)
                 .codec = ESP_PEER_AUDIO_CODEC_OPUS,
                 .sample_rate = 24000,  // OpenAI Realtime API requirement
                 .channel = 1,           // Mono audio for efficiency
+#elif defined(CONFIG_AG_WEBRTC_AUDIO_CODEC_G711U)
+                .codec = ESP_PEER_AUDIO_CODEC_G711U,
+                .sample_rate = 8000,    // G711 standard rate
+                .channel = 1,
 #else
                 .codec = ESP_PEER_AUDIO_CODEC_G711A,
                 .sample_rate = 8000,    // G711 standard rate
@@ -883,6 +1016,16 @@ esp_err_t openai_realtime_start(void)
     return ESP_OK;
 }
 
+esp_err_t openai_realtime_prefetch(void)
+{
+    return openai_token_prefetch(OPENAI_API_KEY, NULL);
+}
+
+void openai_realtime_set_restore(bool restore)
+{
+    restore_session = restore;
+}
+
 esp_err_t openai_realtime_stop(void)
 {
     ESP_LOGI(TAG, "Stopping OpenAI WebRTC session");
@@ -892,6 +1035,8 @@ esp_err_t openai_realtime_stop(void)
         webrtc = NULL;
         esp_webrtc_close(handle);
     }
+    audio_preroll_discard();
+    wifi_power_note(WIFI_POWER_SESSION_STOP);
     
     // Clean up response tracking state
     if (response_state.mutex) {
@@ -2,124 +2,69 @@
    Integrated signaling implementation for OpenAI WebRTC
 */
 
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdio.h>
-#include "https_client.h"
+#include "https_session.h"
+#include "dns_cache.h"
 #include "esp_log.h"
-#include <cJSON.h>
 #include "openai_signaling.h"
+#include "openai_token.h"
+#include "webrtc_sdp.h"
+#include "webrtc_timing.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include "memory_manager.h"
 
 #define TAG                   "OPENAI_SIGNALING"
+#define TOKEN_WAIT_MS         10000
+#define SDP_STOP_WAIT_MS      1000    // An SDP POST still running after this finishes on its own
 
 #define SAFE_FREE(p) if (p) {   \
     mem_free(p);                \
     p = NULL;                   \
 }
 
-#define GET_KEY_END(str, key) get_key_end(str, key, sizeof(key) - 1)
-
 typedef struct {
     esp_peer_signaling_cfg_t cfg;
     uint8_t                 *remote_sdp;
     int                      remote_sdp_size;
     char                    *ephemeral_token;
-    char                    *api_token;
-    char                    *voice;
-    TaskHandle_t             token_task_handle;
     TaskHandle_t             sdp_task_handle;
-    bool                     token_ready;
+    SemaphoreHandle_t        sdp_done;          // Given by send_sdp_task on exit unless orphaned
+    bool                     sdp_running;       // Guarded by sig_lock, like the two below
+    bool                     stopping;          // stop() began; no answer is delivered any more
+    bool                     orphaned;          // stop() returned first; the task frees sig
     bool                     sdp_ready;
     char                    *local_sdp;
     int                      local_sdp_size;
+    const char              *audio_codec;
 } openai_signaling_t;
 
-// Forward declarations
-static void openai_sdp_answer(http_resp_t *resp, void *ctx);
+// Last offer and answer; kept across sessions for webrtc_sdp
+static struct {
+    webrtc_sdp_offer_info_t offer;
+    webrtc_sdp_answer_t answer;
+    bool has_answer;
+} sdp_state = {0};
 
-static char *get_key_end(char *str, char *key, int len)
-{
-    char *p = strstr(str, key);
-    if (p == NULL) {
-        return NULL;
-    }
-    return p + len;
-}
+// Hands sig between stop() and a send_sdp_task that may still sit in the POST
+static portMUX_TYPE sig_lock = portMUX_INITIALIZER_UNLOCKED;
 
-static void session_answer(http_resp_t *resp, void *ctx)
-{
-    openai_signaling_t *sig = (openai_signaling_t *)ctx;
-    char *ephemeral_token = GET_KEY_END((char *)resp->data, "\"value\"");
-    if (ephemeral_token == NULL) {
-        return;
-    }
-    char *s = strchr(ephemeral_token, '"');
-    if (s == NULL) {
-        return;
-    }
-    s++;
-    char *e = strchr(s, '"');
-    *e = 0;
-    sig->ephemeral_token = strdup(s);
-    *e = '"';
-}
+// Forward declarations
+static void openai_sdp_answer(http_resp_t *resp, void *ctx);
 
-// Async task to get ephemeral token without blocking
-static void get_ephemeral_token_task(void *pvParameters)
+static void signaling_free(openai_signaling_t *sig)
 {
-    openai_signaling_t *sig = (openai_signaling_t *)pvParameters;
-    
-    ESP_LOGI(TAG, "Starting async ephemeral token request...");
-    
-    char content_type[32] = "Content-Type: application/json";
-    int len = strlen("Authorization: Bearer ") + strlen(sig->api_token) + 1;
-    char auth[len];
-    snprintf(auth, len, "Authorization: Bearer %s", sig->api_token);
-    char *header[] = {
-        content_type,
-        auth,
-        NULL,
-    };
-
-    cJSON *root = cJSON_CreateObject();
-    cJSON *session = cJSON_CreateObject();
-    cJSON_AddItemToObject(root, "session", session);
-    cJSON_AddStringToObject(session, "type", "realtime");
-    cJSON_AddStringToObject(session, "model", CONFIG_AG_OPENAI_REALTIME_MODEL);
-
-    cJSON *audio = cJSON_CreateObject();
-    cJSON_AddItemToObject(session, "audio", audio);
-
-    cJSON *input_audio = cJSON_CreateObject();
-    cJSON_AddItemToObject(audio, "input", input_audio);
-    cJSON *input_format = cJSON_CreateObject();
-    cJSON_AddItemToObject(input_audio, "format", input_format);
-    cJSON_AddStringToObject(input_format, "type", "audio/pcm");
-    cJSON_AddNumberToObject(input_format, "rate", 24000);
-    
-    cJSON *output_audio = cJSON_CreateObject();
-    cJSON_AddItemToObject(audio, "output", output_audio);
-    cJSON *output_format = cJSON_CreateObject();
-    cJSON_AddItemToObject(output_audio, "format", output_format);
-    cJSON_AddStringToObject(output_format, "type", "audio/pcm");
-    cJSON_AddNumberToObject(output_format, "rate", 24000);
-    cJSON_AddStringToObject(output_audio, "voice", sig->voice);
-
-    char *json_string = cJSON_Print(root);
-    if (json_string) {
-        https_post("https://api.openai.com/v1/realtime/client_secrets", header, json_string, NULL, session_answer, sig);
-        mem_free(json_string);
+    SAFE_FREE(sig->remote_sdp);
+    SAFE_FREE(sig->ephemeral_token);
+    SAFE_FREE(sig->local_sdp);
+    if (sig->sdp_done) {
+        vSemaphoreDelete(sig->sdp_done);
     }
-    cJSON_Delete(root);
-    
-    sig->token_ready = true;
-    ESP_LOGI(TAG, "Ephemeral token request completed");
-    
-    // Task auto-delete
-    vTaskDelete(NULL);
+    mem_free(sig);
 }
 
 // Async task to send SDP without blocking
@@ -140,11 +85,26 @@ static void send_sdp_task(void *pvParameters)
         NULL,
     };
 
-    int ret = https_post( "https://api.openai.com/v1/realtime/calls?model=" CONFIG_AG_OPENAI_REALTIME_MODEL, header, sig->local_sdp, NULL, openai_sdp_answer, sig);
-    if (ret != 0 || sig->remote_sdp == NULL) {
+    // The request's only lookup: normally a cache hit from the GOT_IP prefetch
+    char addr[DNS_CACHE_ADDR_LEN] = "";
+    if (dns_cache_resolve(CONFIG_AG_OPENAI_API_URL, addr, sizeof(addr)) != ESP_OK) {
+        addr[0] = '\0';
+    }
+    webrtc_timing_mark(WEBRTC_PHASE_DNS);
+
+    // Shares the connection (or at least the TLS session) with the token request
+    int ret = https_session_post_to(CONFIG_AG_OPENAI_API_URL "/v1/realtime/calls?model=" CONFIG_AG_OPENAI_REALTIME_MODEL,
+                                    addr, header, sig->local_sdp, openai_sdp_answer, sig);
+    taskENTER_CRITICAL(&sig_lock);
+    bool stopping = sig->stopping;
+    taskEXIT_CRITICAL(&sig_lock);
+    if (stopping) {
+        ESP_LOGI(TAG, "Signaling stopped during the SDP exchange, answer dropped");
+    } else if (ret != 0 || sig->remote_sdp == NULL) {
         ESP_LOGD(TAG, "Failed to post SDP to OpenAI");
         sig->sdp_ready = false;
     } else {
+        webrtc_timing_mark(WEBRTC_PHASE_ANSWER);
         esp_peer_signaling_msg_t sdp_msg = {
             .type = ESP_PEER_SIGNALING_MSG_SDP,
             .data = sig->remote_sdp,
@@ -158,34 +118,18 @@ static void send_sdp_task(void *pvParameters)
     // Cleanup
     SAFE_FREE(sig->local_sdp);
     
-    // Task auto-delete
-    vTaskDelete(NULL);
-}
-
-static void get_ephemeral_token(openai_signaling_t *sig, char *token, char *voice)
-{
-    // Store parameters for async task
-    sig->api_token = strdup(token);
-    sig->voice = strdup(voice ? voice : CONFIG_AG_OPENAI_VOICE);
-    sig->token_ready = false;
-    
-    // Create async task that won't block audio
-    BaseType_t ret = xTaskCreate(
-        get_ephemeral_token_task,
-        "get_token_task",
-        8192,  // Larger stack for HTTPS
-        sig,
-        3,     // Lower priority than audio feedback
-        &sig->token_task_handle
-    );
-    
-    if (ret != pdPASS) {
-        ESP_LOGD(TAG, "Failed to create ephemeral token task");
-        // Fallback to blocking call
-        get_ephemeral_token_task(sig);
+    // Deleting this task from outside would leave the session mutex taken, so it always exits here
+    taskENTER_CRITICAL(&sig_lock);
+    sig->sdp_running = false;
+    sig->sdp_task_handle = NULL;
+    bool orphaned = sig->orphaned;
+    taskEXIT_CRITICAL(&sig_lock);
+    if (orphaned) {
+        signaling_free(sig);
     } else {
-        ESP_LOGI(TAG, "Ephemeral token task created - non-blocking");
+        xSemaphoreGive(sig->sdp_done);
     }
+    vTaskDelete(NULL);
 }
 
 static int openai_signaling_start(esp_peer_signaling_cfg_t *cfg, esp_peer_signaling_handle_t *h)
@@ -195,10 +139,16 @@ static int openai_signaling_start(esp_peer_signaling_cfg_t *cfg, esp_peer_signal
         return ESP_PEER_ERR_NO_MEM;
     }
     openai_signaling_cfg_t *openai_cfg = (openai_signaling_cfg_t *)cfg->extra_cfg;
+    sig->sdp_done = xSemaphoreCreateBinary();
+    if (sig->sdp_done == NULL) {
+        mem_free(sig);
+        return ESP_PEER_ERR_NO_MEM;
+    }
     sig->cfg = *cfg;
+    sig->audio_codec = openai_cfg->audio_codec;
     
-    // Start ephemeral token request asynchronously (non-blocking)
-    get_ephemeral_token(sig, openai_cfg->token, openai_cfg->voice ? openai_cfg->voice : CONFIG_AG_OPENAI_VOICE);
+    // Usually prefetched at WiFi up; otherwise this starts the request now
+    openai_token_prefetch(openai_cfg->token, openai_cfg->voice);
     
     // Don't wait for token - continue immediately to avoid blocking audio
     *h = sig;
@@ -208,7 +158,8 @@ static int openai_signaling_start(esp_peer_signaling_cfg_t *cfg, esp_peer_signal
     sig->cfg.on_ice_info(&ice_info, sig->cfg.ctx);
     sig->cfg.on_connected(sig->cfg.ctx);
     
-    ESP_LOGI(TAG, "OpenAI signaling started (token request in background)");
+    webrtc_timing_mark(WEBRTC_PHASE_SIGNALING);
+    ESP_LOGI(TAG, "OpenAI signaling started");
     return ESP_PEER_ERR_NONE;
 }
 
@@ -224,6 +175,10 @@ static void openai_sdp_answer(http_resp_t *resp, void *ctx)
     }
     memcpy(sig->remote_sdp, resp->data, resp->size);
     sig->remote_sdp_size = resp->size;
+    sdp_state.has_answer = webrtc_sdp_parse_answer(resp->data, resp->size, &sdp_state.answer);
+    if (!sdp_state.has_answer) {
+        ESP_LOGW(TAG, "Answer has no audio section");
+    }
 }
 
 static int openai_signaling_send_msg(esp_peer_signaling_handle_t h, esp_peer_signaling_msg_t *msg)
@@ -233,18 +188,16 @@ static int openai_signaling_send_msg(esp_peer_signaling_handle_t h, esp_peer_sig
         ESP_LOGI(TAG, "Received BYE message");
     } else if (msg->type == ESP_PEER_SIGNALING_MSG_SDP) {
         ESP_LOGI(TAG, "Sending local SDP to OpenAI");
+        webrtc_timing_mark(WEBRTC_PHASE_OFFER);
         
-        // Wait for ephemeral token to be ready (non-blocking check with timeout)
-        int timeout_ms = 10000; // 10 second timeout
-        while (!sig->token_ready && timeout_ms > 0) {
-            vTaskDelay(pdMS_TO_TICKS(500));
-            timeout_ms -= 500;
-        }
-        
-        if (!sig->token_ready || sig->ephemeral_token == NULL) {
-            ESP_LOGD(TAG, "Ephemeral token not ready after timeout");
+        // Cached token is returned at once; otherwise block until the fetch completes
+        SAFE_FREE(sig->ephemeral_token);
+        sig->ephemeral_token = openai_token_take(TOKEN_WAIT_MS);
+        if (sig->ephemeral_token == NULL) {
+            ESP_LOGE(TAG, "No ephemeral token available");
             return -1;
         }
+        webrtc_timing_mark(WEBRTC_PHASE_TOKEN);
         
         // Store SDP data for async task
         sig->local_sdp_size = msg->size;
@@ -253,10 +206,33 @@ static int openai_signaling_send_msg(esp_peer_signaling_handle_t h, esp_peer_sig
             ESP_LOGD(TAG, "Failed to allocate memory for local SDP");
             return -1;
         }
+#ifdef CONFIG_AG_WEBRTC_SDP_MINIMIZE
+        webrtc_sdp_filter_t filter = {
+            .audio_codec = sig->audio_codec,
+            .max_candidates = CONFIG_AG_WEBRTC_SDP_MAX_CANDIDATES,
+        };
+        sig->local_sdp_size = webrtc_sdp_minimize((const char *)msg->data, msg->size, &filter,
+                                                  sig->local_sdp, &sdp_state.offer);
+        ESP_LOGI(TAG, "Offer %" PRIu32 " -> %" PRIu32 " bytes (%u payload types, %u candidates dropped)",
+                 sdp_state.offer.in_bytes, sdp_state.offer.out_bytes,
+                 sdp_state.offer.payloads_dropped, sdp_state.offer.candidates_dropped);
+#else
         memcpy(sig->local_sdp, msg->data, msg->size);
         sig->local_sdp[msg->size] = '\0';
+        sdp_state.offer = (webrtc_sdp_offer_info_t) {
+            .in_bytes = msg->size,
+            .out_bytes = msg->size,
+        };
+#endif
+        
+        if (sig->sdp_running) {
+            ESP_LOGW(TAG, "SDP exchange already in progress");
+            SAFE_FREE(sig->local_sdp);
+            return -1;
+        }
         
         // Create async SDP send task to avoid blocking audio
+        sig->sdp_running = true;
         BaseType_t ret = xTaskCreate(
             send_sdp_task,
             "send_sdp_task",
@@ -268,6 +244,7 @@ static int openai_signaling_send_msg(esp_peer_signaling_handle_t h, esp_peer_sig
         
         if (ret != pdPASS) {
             ESP_LOGD(TAG, "Failed to create SDP send task");
+            sig->sdp_running = false;
             SAFE_FREE(sig->local_sdp);
             return -1;
         }
@@ -282,24 +259,25 @@ static int openai_signaling_stop(esp_peer_signaling_handle_t h)
     openai_signaling_t *sig = (openai_signaling_t *)h;
     sig->cfg.on_close(sig->cfg.ctx);
     
-    // Stop async token task if still running
-    if (sig->token_task_handle) {
-        vTaskDelete(sig->token_task_handle);
-        sig->token_task_handle = NULL;
-    }
-    
-    // Stop async SDP task if still running
-    if (sig->sdp_task_handle) {
-        vTaskDelete(sig->sdp_task_handle);
-        sig->sdp_task_handle = NULL;
+    // The SDP task holds the shared HTTPS session while it posts, so it is never
+    // deleted: it sees stopping, drops the answer and exits by itself
+    taskENTER_CRITICAL(&sig_lock);
+    sig->stopping = true;
+    bool running = sig->sdp_running;
+    taskEXIT_CRITICAL(&sig_lock);
+    if (running && xSemaphoreTake(sig->sdp_done, pdMS_TO_TICKS(SDP_STOP_WAIT_MS)) != pdTRUE) {
+        taskENTER_CRITICAL(&sig_lock);
+        running = sig->sdp_running;
+        sig->orphaned = running;
+        taskEXIT_CRITICAL(&sig_lock);
+        if (running) {
+            // Ends with the POST (at most the session timeout) and frees sig then
+            ESP_LOGW(TAG, "SDP exchange still running, it finishes in the background");
+            return 0;
+        }
     }
     
-    SAFE_FREE(sig->remote_sdp);
-    SAFE_FREE(sig->ephemeral_token);
-    SAFE_FREE(sig->api_token);
-    SAFE_FREE(sig->voice);
-    SAFE_FREE(sig->local_sdp);
-    SAFE_FREE(sig);
+    signaling_free(sig);
     return 0;
 }
 
@@ -311,4 +289,15 @@ const esp_peer_signaling_impl_t *openai_signaling_get_impl(void)
         .stop = openai_signaling_stop,
     };
     return &impl;
+}
+
+bool openai_signaling_get_sdp_info(webrtc_sdp_offer_info_t *offer, webrtc_sdp_answer_t *answer)
+{
+    if (offer) {
+        *offer = sdp_state.offer;
+    }
+    if (answer) {
+        *answer = sdp_state.answer;
+    }
+    return sdp_state.has_answer;
 }
\ No newline at end of file
@@ -0,0 +1,368 @@
+/* OpenAI ephemeral token cache
+   Prefetches Realtime client secrets so session setup skips one HTTPS round trip
+*/
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include "https_session.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <cJSON.h>
+#include "openai_token.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+#include "memory_manager.h"
+#include "sdkconfig.h"
+
+#define TAG                   "OPENAI_TOKEN"
+
+#define TOKEN_BIT_VALID       BIT0    // A usable token is cached
+#define TOKEN_BIT_DONE        BIT1    // The last fetch finished (either way)
+
+#define TOKEN_TTL_US          ((int64_t)CONFIG_AG_OPENAI_TOKEN_TTL_S * 1000000)
+#define TOKEN_MARGIN_US       ((int64_t)CONFIG_AG_OPENAI_TOKEN_REFRESH_MARGIN_S * 1000000)
+
+#define SAFE_FREE(p) if (p) {   \
+    mem_free(p);                \
+    p = NULL;                   \
+}
+
+// Parsed client_secrets response
+typedef struct {
+    char *value;
+    int64_t expires_at;
+} token_answer_t;
+
+// Module state; guarded by the mutex, HTTPS runs outside it
+static struct {
+    SemaphoreHandle_t mutex;
+    EventGroupHandle_t events;
+    esp_timer_handle_t refresh_timer;
+    char *api_key;
+    char *voice;
+    char *token;                // Cached token, NULL when none
+    char *token_voice;          // Voice the cached token was created for
+    int64_t deadline_us;        // Local time after which the token is not handed out
+    int64_t expires_at;
+    bool fetching;
+    bool active;                // A session is wanted; keep a fresh token around
+    openai_token_stats_t stats;
+} token_state = {0};
+
+static void token_answer(http_resp_t *resp, void *ctx)
+{
+    token_answer_t *answer = (token_answer_t *)ctx;
+    cJSON *root = cJSON_ParseWithLength((const char *)resp->data, resp->size);
+    if (root == NULL) {
+        ESP_LOGE(TAG, "Invalid client secret response");
+        return;
+    }
+    cJSON *value = cJSON_GetObjectItemCaseSensitive(root, "value");
+    cJSON *expires_at = cJSON_GetObjectItemCaseSensitive(root, "expires_at");
+    if (cJSON_IsString(value) && value->valuestring) {
+        answer->value = strdup(value->valuestring);
+    }
+    if (cJSON_IsNumber(expires_at)) {
+        answer->expires_at = (int64_t)expires_at->valuedouble;
+    }
+    cJSON_Delete(root);
+}
+
+static char *token_build_request(const char *voice)
+{
+    cJSON *root = cJSON_CreateObject();
+
+    // Fixed lifetime so expiry is known without a synchronized clock
+    cJSON *expires_after = cJSON_CreateObject();
+    cJSON_AddItemToObject(root, "expires_after", expires_after);
+    cJSON_AddStringToObject(expires_after, "anchor", "created_at");
+    cJSON_AddNumberToObject(expires_after, "seconds", CONFIG_AG_OPENAI_TOKEN_TTL_S);
+
+    cJSON *session = cJSON_CreateObject();
+    cJSON_AddItemToObject(root, "session", session);
+    cJSON_AddStringToObject(session, "type", "realtime");
+    cJSON_AddStringToObject(session, "model", CONFIG_AG_OPENAI_REALTIME_MODEL);
+
+    cJSON *audio = cJSON_CreateObject();
+    cJSON_AddItemToObject(session, "audio", audio);
+
+    cJSON *input_audio = cJSON_CreateObject();
+    cJSON_AddItemToObject(audio, "input", input_audio);
+    cJSON *input_format = cJSON_CreateObject();
+    cJSON_AddItemToObject(input_audio, "format", input_format);
+    cJSON_AddStringToObject(input_format, "type", "audio/pcm");
+    cJSON_AddNumberToObject(input_format, "rate", 24000);
+
+    cJSON *output_audio = cJSON_CreateObject();
+    cJSON_AddItemToObject(audio, "output", output_audio);
+    cJSON *output_format = cJSON_CreateObject();
+    cJSON_AddItemToObject(output_audio, "format", output_format);
+    cJSON_AddStringToObject(output_format, "type", "audio/pcm");
+    cJSON_AddNumberToObject(output_format, "rate", 24000);
+    cJSON_AddStringToObject(output_audio, "voice", voice);
+
+    char *json_string = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    return json_string;
+}
+
+static void token_fetch_task(void *pvParameters)
+{
+    // Snapshot credentials; prefetch may replace them meanwhile
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    char *api_key = token_state.api_key ? strdup(token_state.api_key) : NULL;
+    char *voice = token_state.voice ? strdup(token_state.voice) : NULL;
+    xSemaphoreGive(token_state.mutex);
+
+    token_answer_t answer = {0};
+    int64_t start = esp_timer_get_time();
+    char *body = (api_key && voice) ? token_build_request(voice) : NULL;
+    if (body) {
+        int len = strlen("Authorization: Bearer ") + strlen(api_key) + 1;
+        char auth[len];
+        snprintf(auth, len, "Authorization: Bearer %s", api_key);
+        char content_type[32] = "Content-Type: application/json";
+        char *header[] = {
+            content_type,
+            auth,
+            NULL,
+        };
+        https_session_post(CONFIG_AG_OPENAI_API_URL "/v1/realtime/client_secrets", header, body, token_answer, &answer);
+        mem_free(body);
+    }
+    int64_t end = esp_timer_get_time();
+
+    char *old_token = NULL, *old_voice = NULL;
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    token_state.stats.fetches++;
+    if (answer.value) {
+        old_token = token_state.token;
+        old_voice = token_state.token_voice;
+        token_state.token = answer.value;
+        token_state.token_voice = voice;
+        voice = NULL;
+        token_state.deadline_us = start + TOKEN_TTL_US - TOKEN_MARGIN_US;
+        token_state.expires_at = answer.expires_at;
+        token_state.stats.last_fetch_ms = (uint32_t)((end - start) / 1000);
+    } else {
+        token_state.stats.failures++;
+    }
+    token_state.fetching = false;
+    bool active = token_state.active;
+    xSemaphoreGive(token_state.mutex);
+
+    if (answer.value) {
+        xEventGroupSetBits(token_state.events, TOKEN_BIT_VALID | TOKEN_BIT_DONE);
+        // Replace the token before the server would reject it, but only while a session wants one
+        esp_timer_stop(token_state.refresh_timer);
+        if (active) {
+            esp_timer_start_once(token_state.refresh_timer, TOKEN_TTL_US - TOKEN_MARGIN_US);
+        }
+        ESP_LOGI(TAG, "Token ready in %" PRIu32 " ms (valid %d s)",
+                 (uint32_t)((end - start) / 1000), CONFIG_AG_OPENAI_TOKEN_TTL_S);
+    } else {
+        xEventGroupSetBits(token_state.events, TOKEN_BIT_DONE);
+        ESP_LOGW(TAG, "Token fetch failed");
+    }
+
+    SAFE_FREE(old_token);
+    SAFE_FREE(old_voice);
+    SAFE_FREE(api_key);
+    SAFE_FREE(voice);
+    vTaskDelete(NULL);
+}
+
+static void token_start_fetch(void)
+{
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    if (token_state.fetching || token_state.api_key == NULL) {
+        xSemaphoreGive(token_state.mutex);
+        return;
+    }
+    token_state.fetching = true;
+    xSemaphoreGive(token_state.mutex);
+
+    xEventGroupClearBits(token_state.events, TOKEN_BIT_DONE);
+    BaseType_t ret = xTaskCreate(
+        token_fetch_task,
+        "openai_token",
+        8192,  // Larger stack for HTTPS
+        NULL,
+        3,     // Lower priority than audio feedback
+        NULL
+    );
+    if (ret != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create token fetch task");
+        xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+        token_state.fetching = false;
+        xSemaphoreGive(token_state.mutex);
+        xEventGroupSetBits(token_state.events, TOKEN_BIT_DONE);
+    }
+}
+
+static void token_refresh_cb(void *arg)
+{
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    bool active = token_state.active;
+    xSemaphoreGive(token_state.mutex);
+    if (!active) {
+        // Idle: let the token lapse; the next session start fetches a new one
+        ESP_LOGD(TAG, "Cached token expiring, no session pending");
+        return;
+    }
+    ESP_LOGI(TAG, "Cached token about to expire, refreshing");
+    token_start_fetch();
+}
+
+// Hand the cached token over if it is still usable; drops it if it is not
+static char *token_claim(void)
+{
+    char *token = NULL, *stale = NULL, *voice = NULL;
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    if (token_state.token) {
+        if (esp_timer_get_time() < token_state.deadline_us) {
+            token = token_state.token;
+        } else {
+            stale = token_state.token;
+        }
+        voice = token_state.token_voice;
+        token_state.token = NULL;
+        token_state.token_voice = NULL;
+    }
+    xSemaphoreGive(token_state.mutex);
+
+    xEventGroupClearBits(token_state.events, TOKEN_BIT_VALID);
+    SAFE_FREE(stale);
+    SAFE_FREE(voice);
+    return token;
+}
+
+esp_err_t openai_token_init(void)
+{
+    if (token_state.events) {
+        return ESP_OK;
+    }
+    token_state.mutex = xSemaphoreCreateMutex();
+    token_state.events = xEventGroupCreate();
+    if (token_state.mutex == NULL || token_state.events == NULL) {
+        ESP_LOGE(TAG, "Failed to create token cache locks");
+        return ESP_ERR_NO_MEM;
+    }
+    const esp_timer_create_args_t timer_args = {
+        .callback = token_refresh_cb,
+        .name = "token_refresh",
+    };
+    esp_err_t ret = esp_timer_create(&timer_args, &token_state.refresh_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create token refresh timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    return ESP_OK;
+}
+
+esp_err_t openai_token_prefetch(const char *api_key, const char *voice)
+{
+    if (token_state.events == NULL || api_key == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (voice == NULL) {
+        voice = CONFIG_AG_OPENAI_VOICE;
+    }
+
+    esp_err_t ret = ESP_OK;
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    bool key_changed = token_state.api_key == NULL || strcmp(token_state.api_key, api_key) != 0;
+    if (key_changed) {
+        SAFE_FREE(token_state.api_key);
+        token_state.api_key = strdup(api_key);
+    }
+    if (token_state.voice == NULL || strcmp(token_state.voice, voice) != 0) {
+        SAFE_FREE(token_state.voice);
+        token_state.voice = strdup(voice);
+    }
+    if (token_state.api_key == NULL || token_state.voice == NULL) {
+        ret = ESP_ERR_NO_MEM;
+    }
+    bool cached = token_state.token != NULL && !key_changed &&
+                  token_state.token_voice && strcmp(token_state.token_voice, voice) == 0;
+    xSemaphoreGive(token_state.mutex);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (!cached) {
+        // Drop a token minted for other credentials, then fetch a matching one
+        mem_free(token_claim());
+        token_start_fetch();
+    }
+    return ESP_OK;
+}
+
+char *openai_token_take(uint32_t timeout_ms)
+{
+    if (token_state.events == NULL) {
+        return NULL;
+    }
+
+    bool waited = false;
+    char *token = token_claim();
+    if (token == NULL) {
+        waited = true;
+        token_start_fetch();
+        xEventGroupWaitBits(token_state.events, TOKEN_BIT_VALID | TOKEN_BIT_DONE,
+                            pdFALSE, pdFALSE, pdMS_TO_TICKS(timeout_ms));
+        token = token_claim();
+    }
+
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    if (token) {
+        if (waited) {
+            token_state.stats.misses++;
+        } else {
+            token_state.stats.hits++;
+        }
+    }
+    bool active = token_state.active;
+    xSemaphoreGive(token_state.mutex);
+
+    // Tokens are single use; have the next one ready for a reconnect
+    if (active) {
+        token_start_fetch();
+    }
+    return token;
+}
+
+void openai_token_set_active(bool active)
+{
+    if (token_state.events == NULL) {
+        return;
+    }
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    token_state.active = active;
+    int64_t left_us = token_state.token ? token_state.deadline_us - esp_timer_get_time() : -1;
+    xSemaphoreGive(token_state.mutex);
+
+    esp_timer_stop(token_state.refresh_timer);
+    if (active && left_us >= 0) {
+        esp_timer_start_once(token_state.refresh_timer, left_us);
+    }
+}
+
+void openai_token_get_stats(openai_token_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    xSemaphoreTake(token_state.mutex, portMAX_DELAY);
+    *stats = token_state.stats;
+    stats->ready = token_state.token != NULL && now < token_state.deadline_us;
+    stats->fetching = token_state.fetching;
+    stats->ttl_left_s = stats->ready ? (uint32_t)((token_state.deadline_us - now) / 1000000) : 0;
+    stats->expires_at = stats->ready ? token_state.expires_at : 0;
+    xSemaphoreGive(token_state.mutex);
+}
@@ -1,13 +1,30 @@
 #include "webrtc_commands.h"
 #include "webrtc_module.h"
+#include "webrtc_timing.h"
+#include "https_session.h"
+#include "providers/openai/openai_token.h"
+#include "providers/openai/openai_signaling.h"
+#include "wifi_module.h"
+#include "memory_manager.h"
 #include <esp_console.h>
 #include <esp_log.h>
 #include <argtable3/argtable3.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "sdkconfig.h"
 static const char *TAG = "webrtc_cmd";
 
+#define FLAP_DEFAULT_COUNT      100
+#define FLAP_TIMEOUT_MS         30000
+#define DROP_DEFAULT_COUNT      20
+#define DROP_TIMEOUT_MS         60000
+#define HTTPS_BENCH_DEFAULT     10
+#define HTTPS_BENCH_URL         CONFIG_AG_OPENAI_API_URL "/v1/models"
+
 // WebRTC start command
 static int cmd_webrtc_start(int argc, char **argv)
 {
@@ -48,6 +65,22 @@ static int cmd_webrtc_status(int argc, char **argv)
     printf("  State: %s\n", state_str[state]);
     printf("  Connected: %s\n", webrtc_module_is_connected() ? "Yes" : "No");
     
+    openai_token_stats_t token;
+    openai_token_get_stats(&token);
+    if (token.ready) {
+        printf("  Token: ready (%lu s left)\n", token.ttl_left_s);
+    } else {
+        printf("  Token: %s\n", token.fetching ? "fetching" : "none");
+    }
+    printf("  Token fetches: %lu (%lu failed, last %lu ms) | sessions ready/waited: %lu/%lu\n",
+           token.fetches, token.failures, token.last_fetch_ms, token.hits, token.misses);
+    
+    https_session_stats_t https;
+    https_session_get_stats(&https);
+    printf("  HTTPS: %lu requests (%lu failed) | %lu reused | %lu handshakes (first %lu ms, last %lu ms)\n",
+           https.requests, https.failures, https.reused, https.connects,
+           https.first_connect_ms, https.last_connect_ms);
+    
     // Query detailed status
     webrtc_module_query_status();
     
@@ -95,6 +128,303 @@ static int cmd_webrtc_query(int argc, char **argv)
     return 0;
 }
 
+static void print_session_stats(const webrtc_session_stats_t *stats)
+{
+    printf("  Sessions:      %lu (%lu after reconnect)\n", stats->sessions, stats->reconnects);
+    if (stats->reconnects) {
+        printf("  Last outage:   %lu ms\n", stats->last_outage_ms);
+        printf("  Time-to-audio: last %lu ms | avg %lu ms | max %lu ms\n",
+               stats->last_time_to_audio_ms, stats->total_time_to_audio_ms / stats->reconnects,
+               stats->max_time_to_audio_ms);
+    }
+}
+
+static void print_reconnect_stats(const webrtc_reconnect_stats_t *stats)
+{
+    printf("  Peer drops:    %lu (%lu recovered, %lu attempts)\n",
+           stats->drops, stats->recoveries, stats->attempts);
+    if (stats->recoveries) {
+        printf("  Recovery:      last %lu ms (%lu attempts) | avg %lu ms | max %lu ms\n",
+               stats->last_recovery_ms, stats->last_attempts,
+               stats->total_recovery_ms / stats->recoveries, stats->max_recovery_ms);
+    }
+}
+
+// WebRTC session resume statistics
+static int cmd_webrtc_session(int argc, char **argv)
+{
+    webrtc_session_stats_t stats;
+    webrtc_module_get_session_stats(&stats);
+    webrtc_reconnect_stats_t reconnect;
+    webrtc_module_get_reconnect_stats(&reconnect);
+    printf("WebRTC Session Resume:\n");
+    print_session_stats(&stats);
+    print_reconnect_stats(&reconnect);
+    return 0;
+}
+
+// Last offer rewrite and negotiated answer
+static int cmd_webrtc_sdp(int argc, char **argv)
+{
+    webrtc_sdp_offer_info_t offer;
+    webrtc_sdp_answer_t answer;
+    bool has_answer = openai_signaling_get_sdp_info(&offer, &answer);
+    printf("WebRTC SDP:\n");
+    if (offer.in_bytes == 0) {
+        printf("  No offer sent yet\n");
+        return 0;
+    }
+    printf("  Offer:  %lu -> %lu bytes | %u lines, %u payload types dropped | candidates %u kept, %u dropped\n",
+           offer.in_bytes, offer.out_bytes, offer.lines_dropped, offer.payloads_dropped,
+           offer.candidates_kept, offer.candidates_dropped);
+    if (!has_answer) {
+        printf("  Answer: none\n");
+        return 0;
+    }
+    printf("  Answer: %s/%lu/%u pt %u | ptime %u maxptime %u | %u candidates\n",
+           answer.codec, answer.clock_rate, answer.channels, answer.payload_type,
+           answer.ptime, answer.maxptime, answer.candidates);
+    printf("  Opus:   minptime %u fec %d dtx %d stereo %d maxaveragebitrate %lu\n",
+           answer.minptime, answer.useinbandfec, answer.usedtx, answer.stereo, answer.maxaveragebitrate);
+    printf("  Data:   %s sctp-port %u max-message-size %lu\n",
+           answer.data_channel ? "yes" : "no", answer.sctp_port, answer.max_message_size);
+    return 0;
+}
+
+// WebRTC drop test arguments
+static struct {
+    struct arg_int *count;
+    struct arg_end *end;
+} webrtc_drop_args;
+
+// Drop the peer connection repeatedly with WiFi up and measure time to recovery
+static int cmd_webrtc_drop(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&webrtc_drop_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, webrtc_drop_args.end, argv[0]);
+        return 1;
+    }
+    int count = webrtc_drop_args.count->count ? webrtc_drop_args.count->ival[0] : DROP_DEFAULT_COUNT;
+    if (count <= 0) {
+        printf("Count must be positive\n");
+        return 1;
+    }
+
+    printf("Dropping the peer connection %d times...\n", count);
+    printf("%5s | %13s | %8s\n", "Drop", "Recovery (ms)", "Attempts");
+    for (int i = 1; i <= count; i++) {
+        webrtc_reconnect_stats_t before;
+        webrtc_module_get_reconnect_stats(&before);
+        esp_err_t ret = webrtc_module_simulate_drop();
+        if (ret != ESP_OK) {
+            printf("Drop %d: session not connected (%s)\n", i, esp_err_to_name(ret));
+            return 1;
+        }
+
+        webrtc_reconnect_stats_t after;
+        int64_t deadline = esp_timer_get_time() + DROP_TIMEOUT_MS * 1000LL;
+        do {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            webrtc_module_get_reconnect_stats(&after);
+        } while (after.recoveries == before.recoveries && esp_timer_get_time() < deadline);
+        if (after.recoveries == before.recoveries) {
+            printf("Drop %d: not recovered within %d ms\n", i, DROP_TIMEOUT_MS);
+            return 1;
+        }
+        printf("%5d | %13lu | %8lu\n", i, after.last_recovery_ms, after.last_attempts);
+
+        // Let the restored session settle before the next drop
+        vTaskDelay(pdMS_TO_TICKS(1000));
+    }
+
+    webrtc_reconnect_stats_t stats;
+    webrtc_module_get_reconnect_stats(&stats);
+    printf("Done:\n");
+    print_reconnect_stats(&stats);
+    return 0;
+}
+
+// WebRTC timing command arguments
+static struct {
+    struct arg_lit *reset;
+    struct arg_end *end;
+} webrtc_timing_args;
+
+static void print_phase_row(const char *name, const webrtc_phase_stats_t *phase)
+{
+    if (phase->samples == 0) {
+        printf("%-9s | %6s | %6s | %6s |\n", name, "-", "-", "-");
+        return;
+    }
+    printf("%-9s | %6lu | %6lu | %6lu |", name, phase->p50_ms, phase->p90_ms, phase->max_ms);
+    for (int b = 0; b < WEBRTC_TIMING_BUCKETS; b++) {
+        printf(" %5lu", phase->hist[b]);
+    }
+    printf("\n");
+}
+
+// Per-phase connection setup latency over the last connections
+static int cmd_webrtc_timing(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&webrtc_timing_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, webrtc_timing_args.end, argv[0]);
+        return 1;
+    }
+    if (webrtc_timing_args.reset->count) {
+        webrtc_timing_reset();
+        printf("Connection timing reset\n");
+        return 0;
+    }
+
+    static webrtc_timing_stats_t stats;
+    webrtc_timing_get_stats(&stats);
+    printf("Connection Setup (%lu completed, %lu failed, window %d):\n",
+           stats.connections, stats.failures, WEBRTC_TIMING_WINDOW);
+    if (stats.total.samples == 0) {
+        printf("  No completed connections yet\n");
+        return 0;
+    }
+
+    printf("%-9s | %6s | %6s | %6s |", "Phase", "p50", "p90", "max");
+    for (int b = 0; b < WEBRTC_TIMING_BUCKETS - 1; b++) {
+        printf(" <%4lu", webrtc_timing_bucket_ms(b));
+    }
+    printf(" %5s\n", "more");
+    for (int i = 0; i < WEBRTC_PHASE_MAX; i++) {
+        print_phase_row(webrtc_timing_phase_name(i), &stats.phase[i]);
+    }
+    print_phase_row("total", &stats.total);
+    printf("(times in ms; each phase runs from the previous one reached)\n");
+    return 0;
+}
+
+// HTTPS bench command arguments
+static struct {
+    struct arg_int *count;
+    struct arg_str *url;
+    struct arg_end *end;
+} https_bench_args;
+
+static void print_bench_mode(const char *name, const https_bench_mode_t *mode)
+{
+    printf("  %-10s | %3lu | %6lu | %6lu | %6lu\n", name, mode->ok, mode->avg_ms, mode->min_ms, mode->max_ms);
+}
+
+// Compare full handshakes, resumed TLS sessions and keep-alive against the API host
+static int cmd_https_bench(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&https_bench_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, https_bench_args.end, argv[0]);
+        return 1;
+    }
+    int count = https_bench_args.count->count ? https_bench_args.count->ival[0] : HTTPS_BENCH_DEFAULT;
+    const char *url = https_bench_args.url->count ? https_bench_args.url->sval[0] : HTTPS_BENCH_URL;
+    if (count <= 0) {
+        printf("Count must be positive\n");
+        return 1;
+    }
+
+    printf("HTTPS bench: %d requests per mode to %s\n", count, url);
+    https_bench_result_t result;
+    esp_err_t ret = https_session_bench(url, count, &result);
+    printf("  %-10s | %3s | %6s | %6s | %6s\n", "Mode", "OK", "avg ms", "min ms", "max ms");
+    print_bench_mode("cold", &result.cold);
+    print_bench_mode("resumed", &result.resumed);
+    print_bench_mode("keepalive", &result.keepalive);
+    if (ret != ESP_OK) {
+        printf("Some modes had no successful request\n");
+        return 1;
+    }
+    if (result.cold.avg_ms > result.keepalive.avg_ms) {
+        printf("  Handshake cost: full %lu ms, resumed %lu ms\n",
+               result.cold.avg_ms - result.keepalive.avg_ms,
+               result.resumed.avg_ms > result.keepalive.avg_ms ? result.resumed.avg_ms - result.keepalive.avg_ms : 0);
+    }
+    return 0;
+}
+
+// WebRTC flap test arguments
+static struct {
+    struct arg_int *count;
+    struct arg_end *end;
+} webrtc_flap_args;
+
+// Drop the WiFi link repeatedly and check session resume time and heap drift
+static int cmd_webrtc_flap(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&webrtc_flap_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, webrtc_flap_args.end, argv[0]);
+        return 1;
+    }
+    int count = webrtc_flap_args.count->count ? webrtc_flap_args.count->ival[0] : FLAP_DEFAULT_COUNT;
+    if (count <= 0) {
+        printf("Count must be positive\n");
+        return 1;
+    }
+    if (!webrtc_module_is_connected()) {
+        printf("Start a WebRTC session first\n");
+        return 1;
+    }
+
+    static memory_status_t mem;
+    size_t base_internal = 0, base_psram = 0;
+    size_t min_internal = SIZE_MAX, min_psram = SIZE_MAX;
+
+    printf("Flapping WiFi %d times...\n", count);
+    printf("%5s | %10s | %13s | %13s\n", "Flap", "Audio (ms)", "Internal (KB)", "PSRAM (KB)");
+    for (int i = 1; i <= count; i++) {
+        webrtc_session_stats_t before;
+        webrtc_module_get_session_stats(&before);
+        if (wifi_module_drop_link() != ESP_OK) {
+            printf("Flap %d: could not drop link\n", i);
+            return 1;
+        }
+
+        // Wait for the resumed session to carry media again
+        webrtc_session_stats_t after;
+        int64_t deadline = esp_timer_get_time() + FLAP_TIMEOUT_MS * 1000LL;
+        do {
+            vTaskDelay(pdMS_TO_TICKS(100));
+            webrtc_module_get_session_stats(&after);
+        } while (after.reconnects == before.reconnects && esp_timer_get_time() < deadline);
+        if (after.reconnects == before.reconnects) {
+            printf("Flap %d: no audio within %d ms\n", i, FLAP_TIMEOUT_MS);
+            return 1;
+        }
+
+        memory_manager_get_status(&mem);
+        if (i == 1) {
+            // First resume warms up caches; measure drift from here
+            base_internal = mem.internal_free_kb;
+            base_psram = mem.psram_free_kb;
+        }
+        if (mem.internal_free_kb < min_internal) {
+            min_internal = mem.internal_free_kb;
+        }
+        if (mem.psram_free_kb < min_psram) {
+            min_psram = mem.psram_free_kb;
+        }
+        if (i == 1 || i % 10 == 0 || i == count) {
+            printf("%5d | %10lu | %13u | %13u\n", i, after.last_time_to_audio_ms,
+                   (unsigned)mem.internal_free_kb, (unsigned)mem.psram_free_kb);
+        }
+    }
+
+    webrtc_session_stats_t stats;
+    webrtc_module_get_session_stats(&stats);
+    printf("Done:\n");
+    print_session_stats(&stats);
+    printf("  Internal drift: %+d KB (min %u KB)\n",
+           (int)mem.internal_free_kb - (int)base_internal, (unsigned)min_internal);
+    printf("  PSRAM drift:    %+d KB (min %u KB)\n",
+           (int)mem.psram_free_kb - (int)base_psram, (unsigned)min_psram);
+    return 0;
+}
+
 esp_err_t webrtc_register_commands(void)
 {
     // WebRTC start command
@@ -146,6 +476,77 @@ esp_err_t webrtc_register_commands(void)
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&webrtc_query_cmd));
     
+    // WebRTC session resume statistics
+    const esp_console_cmd_t webrtc_session_cmd = {
+        .command = "webrtc_session",
+        .help = "Show session resume statistics (WiFi flaps and peer reconnects)",
+        .hint = NULL,
+        .func = &cmd_webrtc_session,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&webrtc_session_cmd));
+    
+    // WebRTC drop test command
+    webrtc_drop_args.count = arg_int0("n", "count", "<n>", "Number of peer drops (default 20)");
+    webrtc_drop_args.end = arg_end(2);
+    
+    const esp_console_cmd_t webrtc_drop_cmd = {
+        .command = "webrtc_drop",
+        .help = "Drop the peer connection repeatedly, report time to recovery",
+        .hint = NULL,
+        .func = &cmd_webrtc_drop,
+        .argtable = &webrtc_drop_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&webrtc_drop_cmd));
+    
+    // WebRTC SDP command
+    const esp_console_cmd_t webrtc_sdp_cmd = {
+        .command = "webrtc_sdp",
+        .help = "Show the last offer rewrite and the parameters the answer negotiated",
+        .hint = NULL,
+        .func = &cmd_webrtc_sdp,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&webrtc_sdp_cmd));
+    
+    // WebRTC timing command
+    webrtc_timing_args.reset = arg_lit0("r", "reset", "Clear the timing window");
+    webrtc_timing_args.end = arg_end(2);
+    
+    const esp_console_cmd_t webrtc_timing_cmd = {
+        .command = "webrtc_timing",
+        .help = "Show per-phase connection setup latency (token, DNS, SDP, ICE/DTLS, SCTP, channel, session)",
+        .hint = NULL,
+        .func = &cmd_webrtc_timing,
+        .argtable = &webrtc_timing_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&webrtc_timing_cmd));
+    
+    // HTTPS handshake bench command
+    https_bench_args.count = arg_int0("n", "count", "<n>", "Requests per mode (default 10)");
+    https_bench_args.url = arg_str0(NULL, NULL, "<url>", "URL to request (default: API host /v1/models)");
+    https_bench_args.end = arg_end(3);
+    
+    const esp_console_cmd_t https_bench_cmd = {
+        .command = "https_bench",
+        .help = "Compare HTTPS request time with full handshakes, resumed TLS sessions and keep-alive",
+        .hint = NULL,
+        .func = &cmd_https_bench,
+        .argtable = &https_bench_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&https_bench_cmd));
+    
+    // WebRTC flap test command
+    webrtc_flap_args.count = arg_int0("n", "count", "<n>", "Number of WiFi flaps (default 100)");
+    webrtc_flap_args.end = arg_end(2);
+    
+    const esp_console_cmd_t webrtc_flap_cmd = {
+        .command = "webrtc_flap",
+        .help = "Drop WiFi repeatedly, report time-to-audio and heap drift",
+        .hint = NULL,
+        .func = &cmd_webrtc_flap,
+        .argtable = &webrtc_flap_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&webrtc_flap_cmd));
+    
     ESP_LOGI(TAG, "WebRTC commands registered");
     return ESP_OK;
 }
\ No newline at end of file
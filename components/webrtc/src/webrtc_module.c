@@ -1,16 +1,41 @@
 #include "webrtc_module.h"
 #include <esp_log.h>
 #include <string.h>
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "media_lib_os.h"
 #include "common.h"
+#include "https_session.h"
 #include "wifi_module.h"
+#include "dns_cache.h"
 #include "providers/openai/openai_client.h"
+#include "providers/openai/openai_token.h"
 static const char *TAG = "webrtc_module";
 
+#define RECONNECT_BIT_CANCEL    BIT0    // Stopped on purpose or link lost
+#define RECONNECT_BIT_READY     BIT1    // Data channel of the new session is open
+#define RECONNECT_BIT_FAILED    BIT2    // The new peer connection failed too
+
 // Module state
 static struct {
     bool initialized;
     webrtc_state_t current_state;
     webrtc_event_callback_t event_callback;
+    SemaphoreHandle_t lock;         // Serializes session start/stop
+    // Session resume tracking
+    bool link_up;
+    int64_t link_down_us;
+    int64_t reconnect_us;           // GOT_IP after a flap, 0 once media is back
+    webrtc_session_stats_t session;
+    // Peer reconnect state machine
+    bool armed;                     // Session started and not stopped on purpose
+    volatile bool reconnecting;     // Reconnect task running
+    EventGroupHandle_t reconnect_events;
+    int64_t drop_us;
+    webrtc_reconnect_stats_t reconnect;
 } webrtc_state = {0};
 
 // State change helper
@@ -38,6 +63,24 @@ esp_err_t webrtc_module_init(webrtc_event_callback_t callback)
     
     ESP_LOGI(TAG, "Initializing WebRTC module");
     
+    webrtc_state.lock = xSemaphoreCreateMutex();
+    webrtc_state.reconnect_events = xEventGroupCreate();
+    if (!webrtc_state.lock || !webrtc_state.reconnect_events) {
+        ESP_LOGE(TAG, "Failed to create reconnect state");
+        return ESP_ERR_NO_MEM;
+    }
+    
+    esp_err_t ret = https_session_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // Resolved at every GOT_IP and kept fresh, so signaling never waits on DNS
+    dns_cache_add(CONFIG_AG_OPENAI_API_URL);
+    ret = openai_token_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
     // Store callback
     webrtc_state.event_callback = callback;
     webrtc_state.current_state = WEBRTC_STATE_DISCONNECTED;
@@ -47,13 +90,8 @@ esp_err_t webrtc_module_init(webrtc_event_callback_t callback)
     return ESP_OK;
 }
 
-esp_err_t webrtc_module_start(void)
+static esp_err_t session_start(void)
 {
-    if (!webrtc_state.initialized) {
-        ESP_LOGE(TAG, "WebRTC module not initialized");
-        return ESP_FAIL;
-    }
-    
     ESP_LOGI(TAG, "Starting WebRTC session");
     set_webrtc_state(WEBRTC_STATE_CONNECTING);
     
@@ -77,13 +115,8 @@ esp_err_t webrtc_module_start(void)
     return ESP_OK;
 }
 
-esp_err_t webrtc_module_stop(void)
+static esp_err_t session_stop(void)
 {
-    if (!webrtc_state.initialized) {
-        ESP_LOGE(TAG, "WebRTC module not initialized");
-        return ESP_FAIL;
-    }
-    
     ESP_LOGI(TAG, "Stopping WebRTC session");
     
     esp_err_t ret = openai_realtime_stop();
@@ -97,6 +130,50 @@ esp_err_t webrtc_module_stop(void)
     return ESP_OK;
 }
 
+// Explicit start/stop supersede a reconnect in progress
+static void reconnect_cancel(void)
+{
+    if (webrtc_state.reconnecting) {
+        xEventGroupSetBits(webrtc_state.reconnect_events, RECONNECT_BIT_CANCEL);
+    }
+}
+
+esp_err_t webrtc_module_start(void)
+{
+    if (!webrtc_state.initialized) {
+        ESP_LOGE(TAG, "WebRTC module not initialized");
+        return ESP_FAIL;
+    }
+    
+    reconnect_cancel();
+    openai_realtime_set_restore(false);
+    openai_token_set_active(true);
+    xSemaphoreTake(webrtc_state.lock, portMAX_DELAY);
+    esp_err_t ret = session_start();
+    webrtc_state.armed = ret == ESP_OK;
+    xSemaphoreGive(webrtc_state.lock);
+    if (ret != ESP_OK) {
+        openai_token_set_active(false);
+    }
+    return ret;
+}
+
+esp_err_t webrtc_module_stop(void)
+{
+    if (!webrtc_state.initialized) {
+        ESP_LOGE(TAG, "WebRTC module not initialized");
+        return ESP_FAIL;
+    }
+    
+    reconnect_cancel();
+    openai_token_set_active(false);
+    xSemaphoreTake(webrtc_state.lock, portMAX_DELAY);
+    webrtc_state.armed = false;
+    esp_err_t ret = session_stop();
+    xSemaphoreGive(webrtc_state.lock);
+    return ret;
+}
+
 webrtc_state_t webrtc_module_get_state(void)
 {
     return webrtc_state.current_state;
@@ -182,4 +259,184 @@ esp_err_t webrtc_module_resume_audio(void)
     // Delegate to OpenAI client
     extern esp_err_t openai_realtime_resume_audio(void);
     return openai_realtime_resume_audio();
-}
\ No newline at end of file
+}
+
+uint32_t webrtc_module_note_link(bool up)
+{
+    int64_t now = esp_timer_get_time();
+    if (!up) {
+        if (webrtc_state.link_up) {
+            webrtc_state.link_up = false;
+            webrtc_state.link_down_us = now;
+            // The socket is gone; the TLS session is kept for a resumed handshake
+            https_session_close();
+            // The link-up restart takes over from a peer reconnect
+            reconnect_cancel();
+        }
+        return 0;
+    }
+    if (webrtc_state.link_up) {
+        return 0;
+    }
+
+    webrtc_state.link_up = true;
+    // Have the session token ready before anyone asks for a session
+    openai_realtime_prefetch();
+    if (webrtc_state.link_down_us == 0) {
+        return 0;
+    }
+    uint32_t outage_ms = (uint32_t)((now - webrtc_state.link_down_us) / 1000);
+    webrtc_state.link_down_us = 0;
+    webrtc_state.reconnect_us = now;
+    webrtc_state.session.last_outage_ms = outage_ms;
+    ESP_LOGI(TAG, "Link back after %lu ms, resuming session", outage_ms);
+    return outage_ms;
+}
+
+void webrtc_module_note_media_ready(void)
+{
+    webrtc_session_stats_t *session = &webrtc_state.session;
+    session->sessions++;
+    if (webrtc_state.reconnect_us == 0) {
+        return;
+    }
+
+    uint32_t ms = (uint32_t)((esp_timer_get_time() - webrtc_state.reconnect_us) / 1000);
+    webrtc_state.reconnect_us = 0;
+    session->reconnects++;
+    session->last_time_to_audio_ms = ms;
+    session->total_time_to_audio_ms += ms;
+    if (ms > session->max_time_to_audio_ms) {
+        session->max_time_to_audio_ms = ms;
+    }
+    ESP_LOGI(TAG, "Audio resumed %lu ms after reconnect", ms);
+}
+
+void webrtc_module_get_session_stats(webrtc_session_stats_t *stats)
+{
+    if (stats) {
+        *stats = webrtc_state.session;
+    }
+}
+
+// Exponential backoff, jittered to [delay/2, delay] so devices behind one AP don't retry in lockstep
+static uint32_t reconnect_backoff_ms(uint32_t attempt)
+{
+    uint32_t delay = CONFIG_AG_WEBRTC_RECONNECT_BASE_MS;
+    while (attempt-- > 0 && delay < CONFIG_AG_WEBRTC_RECONNECT_MAX_MS) {
+        delay *= 2;
+    }
+    if (delay > CONFIG_AG_WEBRTC_RECONNECT_MAX_MS) {
+        delay = CONFIG_AG_WEBRTC_RECONNECT_MAX_MS;
+    }
+    return delay / 2 + esp_random() % (delay / 2 + 1);
+}
+
+static void reconnect_task(void *arg)
+{
+    EventGroupHandle_t events = webrtc_state.reconnect_events;
+    uint32_t attempt = 0;
+
+    while (true) {
+        uint32_t delay_ms = reconnect_backoff_ms(attempt);
+        ESP_LOGI(TAG, "Reconnect attempt %lu in %lu ms", attempt + 1, delay_ms);
+        EventBits_t bits = xEventGroupWaitBits(events, RECONNECT_BIT_CANCEL, pdFALSE, pdFALSE,
+                                               pdMS_TO_TICKS(delay_ms));
+        if ((bits & RECONNECT_BIT_CANCEL) || !webrtc_state.link_up) {
+            break;
+        }
+
+        // Token was prefetched at the drop; what is left is the SDP exchange and ICE/DTLS
+        xEventGroupClearBits(events, RECONNECT_BIT_READY | RECONNECT_BIT_FAILED);
+        attempt++;
+        webrtc_state.reconnect.attempts++;
+        xSemaphoreTake(webrtc_state.lock, portMAX_DELAY);
+        bits = xEventGroupGetBits(events);
+        esp_err_t ret = ESP_FAIL;
+        if (!(bits & RECONNECT_BIT_CANCEL)) {
+            openai_realtime_set_restore(true);
+            session_stop();
+            ret = session_start();
+        }
+        xSemaphoreGive(webrtc_state.lock);
+        if (ret != ESP_OK) {
+            // Fresh bits: a cancel or link loss during the attempt ends the loop at the wait
+            if (!(xEventGroupGetBits(events) & RECONNECT_BIT_CANCEL)) {
+                openai_realtime_prefetch();
+            }
+            continue;
+        }
+
+        bits = xEventGroupWaitBits(events, RECONNECT_BIT_CANCEL | RECONNECT_BIT_READY | RECONNECT_BIT_FAILED,
+                                   pdFALSE, pdFALSE, pdMS_TO_TICKS(CONFIG_AG_WEBRTC_RECONNECT_TIMEOUT_MS));
+        if (bits & RECONNECT_BIT_READY) {
+            webrtc_reconnect_stats_t *stats = &webrtc_state.reconnect;
+            uint32_t ms = (uint32_t)((esp_timer_get_time() - webrtc_state.drop_us) / 1000);
+            stats->recoveries++;
+            stats->last_attempts = attempt;
+            stats->last_recovery_ms = ms;
+            stats->total_recovery_ms += ms;
+            if (ms > stats->max_recovery_ms) {
+                stats->max_recovery_ms = ms;
+            }
+            ESP_LOGI(TAG, "Session recovered in %lu ms after %lu attempt(s)", ms, attempt);
+            break;
+        }
+        if (bits & RECONNECT_BIT_CANCEL) {
+            break;
+        }
+        ESP_LOGW(TAG, "Reconnect attempt %lu %s", attempt,
+                 (bits & RECONNECT_BIT_FAILED) ? "failed" : "timed out");
+        // Each session consumes its token; have the next one ready
+        openai_realtime_prefetch();
+    }
+
+    webrtc_state.reconnecting = false;
+    media_lib_thread_destroy(NULL);
+}
+
+void webrtc_module_note_peer(bool up)
+{
+    if (webrtc_state.reconnecting) {
+        xEventGroupSetBits(webrtc_state.reconnect_events, up ? RECONNECT_BIT_READY : RECONNECT_BIT_FAILED);
+        return;
+    }
+    if (up || !webrtc_state.armed || !webrtc_state.link_up) {
+        return;
+    }
+
+    webrtc_state.reconnect.drops++;
+    webrtc_state.drop_us = esp_timer_get_time();
+    ESP_LOGW(TAG, "Peer connection lost, reconnecting");
+    set_webrtc_state(WEBRTC_STATE_CONNECTING);
+    openai_realtime_prefetch();
+
+    webrtc_state.reconnecting = true;
+    xEventGroupClearBits(webrtc_state.reconnect_events,
+                         RECONNECT_BIT_CANCEL | RECONNECT_BIT_READY | RECONNECT_BIT_FAILED);
+    if (media_lib_thread_create_from_scheduler(NULL, "webrtc_reconn", reconnect_task, NULL) != 0) {
+        ESP_LOGE(TAG, "Failed to create reconnect task");
+        webrtc_state.reconnecting = false;
+        set_webrtc_state(WEBRTC_STATE_FAILED);
+    }
+}
+
+esp_err_t webrtc_module_simulate_drop(void)
+{
+    if (!webrtc_module_is_connected() || webrtc_state.reconnecting) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ESP_LOGI(TAG, "Simulating peer connection drop");
+    xSemaphoreTake(webrtc_state.lock, portMAX_DELAY);
+    openai_realtime_stop();
+    xSemaphoreGive(webrtc_state.lock);
+    webrtc_module_note_peer(false);
+    return ESP_OK;
+}
+
+void webrtc_module_get_reconnect_stats(webrtc_reconnect_stats_t *stats)
+{
+    if (stats) {
+        *stats = webrtc_state.reconnect;
+    }
+}
@@ -0,0 +1,374 @@
+#include "webrtc_sdp.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#define SDP_MAX_SECTIONS    8
+#define SDP_MAX_PT          128
+
+// One line of the input, without its terminator
+typedef struct {
+    const char *p;
+    int len;
+} sdp_line_t;
+
+// What the first pass learned about one m= section
+typedef struct {
+    bool audio;
+    uint8_t keep_pt[SDP_MAX_PT / 8];    // Bitmap of payload types to keep
+    bool filter_pt;                     // At least one payload type matches the codec
+    bool filter_candidates;             // At least one candidate passes the filters
+} sdp_section_t;
+
+// Advance to the next line; the terminator (\n or \r\n) is consumed but not included
+static bool next_line(const char **cur, const char *end, sdp_line_t *line)
+{
+    if (*cur >= end) {
+        return false;
+    }
+    const char *nl = memchr(*cur, '\n', end - *cur);
+    const char *stop = nl ? nl : end;
+    line->p = *cur;
+    line->len = stop - *cur;
+    if (line->len > 0 && line->p[line->len - 1] == '\r') {
+        line->len--;
+    }
+    *cur = nl ? nl + 1 : end;
+    return true;
+}
+
+static bool starts_with(const sdp_line_t *line, const char *prefix)
+{
+    int n = strlen(prefix);
+    return line->len >= n && memcmp(line->p, prefix, n) == 0;
+}
+
+// Payload type after "a=rtpmap:", "a=fmtp:" or "a=rtcp-fb:", -1 if none
+static int line_pt(const sdp_line_t *line, const char *prefix)
+{
+    if (!starts_with(line, prefix)) {
+        return -1;
+    }
+    int i = strlen(prefix);
+    int pt = 0, digits = 0;
+    while (i < line->len && isdigit((unsigned char)line->p[i]) && digits < 3) {
+        pt = pt * 10 + (line->p[i++] - '0');
+        digits++;
+    }
+    return digits && pt < SDP_MAX_PT ? pt : -1;
+}
+
+static bool pt_kept(const sdp_section_t *section, int pt)
+{
+    return section->keep_pt[pt / 8] & (1 << (pt % 8));
+}
+
+// Split a line into whitespace-separated fields
+static int split_fields(const sdp_line_t *line, sdp_line_t *fields, int max)
+{
+    int n = 0, i = 0;
+    while (i < line->len && n < max) {
+        while (i < line->len && line->p[i] == ' ') {
+            i++;
+        }
+        if (i >= line->len) {
+            break;
+        }
+        fields[n].p = line->p + i;
+        while (i < line->len && line->p[i] != ' ') {
+            i++;
+        }
+        fields[n].len = line->p + i - fields[n].p;
+        n++;
+    }
+    return n;
+}
+
+static bool field_equals(const sdp_line_t *field, const char *s)
+{
+    return field->len == (int)strlen(s) && strncasecmp(field->p, s, field->len) == 0;
+}
+
+// a=candidate:<foundation> <component> <transport> <priority> <address> <port> typ <type> ...
+static bool candidate_allowed(const sdp_line_t *line, const webrtc_sdp_filter_t *filter,
+                              sdp_line_t *addr, sdp_line_t *port)
+{
+    sdp_line_t fields[8];
+    if (split_fields(line, fields, 8) < 8) {
+        return false;
+    }
+    *addr = fields[4];
+    *port = fields[5];
+    if (!filter->keep_tcp && !field_equals(&fields[2], "udp")) {
+        return false;
+    }
+    if (!filter->keep_ipv6) {
+        if (memchr(addr->p, ':', addr->len)) {
+            return false;
+        }
+        if (addr->len > 6 && strncasecmp(addr->p + addr->len - 6, ".local", 6) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool same_field(const sdp_line_t *a, const sdp_line_t *b)
+{
+    return a->len == b->len && memcmp(a->p, b->p, a->len) == 0;
+}
+
+// First pass: per section, which payload types match the codec and whether any candidate survives
+static int scan_sections(const char *sdp, int size, const webrtc_sdp_filter_t *filter,
+                         sdp_section_t *sections)
+{
+    const char *cur = sdp, *end = sdp + size;
+    sdp_line_t line;
+    int index = -1;
+    while (next_line(&cur, end, &line)) {
+        if (starts_with(&line, "m=")) {
+            if (++index >= SDP_MAX_SECTIONS) {
+                break;
+            }
+            memset(&sections[index], 0, sizeof(sdp_section_t));
+            sections[index].audio = starts_with(&line, "m=audio ");
+            continue;
+        }
+        if (index < 0) {
+            continue;
+        }
+        sdp_section_t *section = &sections[index];
+        int pt = line_pt(&line, "a=rtpmap:");
+        if (section->audio && pt >= 0 && filter->audio_codec) {
+            const char *name = memchr(line.p, ' ', line.len);
+            int codec_len = strlen(filter->audio_codec);
+            if (name && line.p + line.len - (name + 1) > codec_len &&
+                strncasecmp(name + 1, filter->audio_codec, codec_len) == 0 && name[1 + codec_len] == '/') {
+                section->keep_pt[pt / 8] |= 1 << (pt % 8);
+                section->filter_pt = true;
+            }
+        } else if (starts_with(&line, "a=candidate:")) {
+            sdp_line_t addr, port;
+            if (candidate_allowed(&line, filter, &addr, &port)) {
+                section->filter_candidates = true;
+            }
+        }
+    }
+    return index + 1 < SDP_MAX_SECTIONS ? index + 1 : SDP_MAX_SECTIONS;
+}
+
+// m=audio <port> <proto> <pt> <pt> ...: keep the payload types in the bitmap
+static int rewrite_media_line(const sdp_line_t *line, const sdp_section_t *section, char *out,
+                              uint16_t *dropped)
+{
+    sdp_line_t rest = *line;
+    sdp_line_t field;
+    int len = 0;
+    for (int i = 0; split_fields(&rest, &field, 1) == 1; i++) {
+        rest.len -= field.p + field.len - rest.p;
+        rest.p = field.p + field.len;
+        if (i >= 3) {
+            int pt = atoi(field.p);
+            if (pt < 0 || pt >= SDP_MAX_PT || !pt_kept(section, pt)) {
+                (*dropped)++;
+                continue;
+            }
+        }
+        if (len) {
+            out[len++] = ' ';
+        }
+        memcpy(out + len, field.p, field.len);
+        len += field.len;
+    }
+    return len;
+}
+
+int webrtc_sdp_minimize(const char *sdp, int size, const webrtc_sdp_filter_t *filter,
+                        char *out, webrtc_sdp_offer_info_t *info)
+{
+    webrtc_sdp_offer_info_t summary = {
+        .in_bytes = size,
+    };
+    sdp_section_t sections[SDP_MAX_SECTIONS];
+    int section_count = scan_sections(sdp, size, filter, sections);
+
+    const char *cur = sdp, *end = sdp + size;
+    sdp_line_t line;
+    int len = 0, index = -1;
+    int section_candidates = 0;
+    sdp_line_t seen_addr[16], seen_port[16];
+
+    while (next_line(&cur, end, &line)) {
+        // Terminator copied as found, so the output never grows
+        const char *eol = line.p + line.len;
+        int eol_len = cur - eol;
+        sdp_section_t *section = index >= 0 && index < section_count ? &sections[index] : NULL;
+        bool keep = true;
+
+        if (starts_with(&line, "m=")) {
+            index++;
+            section_candidates = 0;
+            section = index < section_count ? &sections[index] : NULL;
+            if (section && section->audio && section->filter_pt) {
+                len += rewrite_media_line(&line, section, out + len, &summary.payloads_dropped);
+                memcpy(out + len, eol, eol_len);
+                len += eol_len;
+                continue;
+            }
+        } else if (section && section->audio && section->filter_pt) {
+            int pt = line_pt(&line, "a=rtpmap:");
+            if (pt < 0) {
+                pt = line_pt(&line, "a=fmtp:");
+            }
+            if (pt < 0) {
+                pt = line_pt(&line, "a=rtcp-fb:");
+            }
+            keep = pt < 0 || pt_kept(section, pt);
+        }
+
+        if (keep && !filter->keep_extmap && starts_with(&line, "a=extmap:")) {
+            keep = false;
+        }
+
+        if (keep && starts_with(&line, "a=candidate:") && section && section->filter_candidates) {
+            sdp_line_t addr, port;
+            keep = candidate_allowed(&line, filter, &addr, &port);
+            for (int i = 0; keep && i < section_candidates && i < 16; i++) {
+                if (same_field(&seen_addr[i], &addr) && same_field(&seen_port[i], &port)) {
+                    keep = false;
+                }
+            }
+            if (keep && filter->max_candidates && section_candidates >= filter->max_candidates) {
+                keep = false;
+            }
+            if (keep) {
+                if (section_candidates < 16) {
+                    seen_addr[section_candidates] = addr;
+                    seen_port[section_candidates] = port;
+                }
+                section_candidates++;
+                summary.candidates_kept++;
+            } else {
+                summary.candidates_dropped++;
+            }
+        } else if (keep && starts_with(&line, "a=candidate:")) {
+            summary.candidates_kept++;
+        }
+
+        if (!keep) {
+            summary.lines_dropped++;
+            continue;
+        }
+        memcpy(out + len, line.p, line.len + eol_len);
+        len += line.len + eol_len;
+    }
+    out[len] = '\0';
+
+    summary.out_bytes = len;
+    if (info) {
+        *info = summary;
+    }
+    return len;
+}
+
+static uint32_t parse_uint(const char *p, const char *end)
+{
+    uint32_t v = 0;
+    while (p < end && isdigit((unsigned char)*p)) {
+        v = v * 10 + (*p++ - '0');
+    }
+    return v;
+}
+
+// a=fmtp:<pt> key=value;key=value
+static void parse_fmtp(const sdp_line_t *line, webrtc_sdp_answer_t *answer)
+{
+    const char *p = memchr(line->p, ' ', line->len);
+    const char *end = line->p + line->len;
+    while (p && p < end) {
+        while (p < end && (*p == ' ' || *p == ';')) {
+            p++;
+        }
+        const char *key = p;
+        const char *eq = NULL;
+        while (p < end && *p != ';') {
+            if (*p == '=' && !eq) {
+                eq = p;
+            }
+            p++;
+        }
+        if (!eq) {
+            continue;
+        }
+        int key_len = eq - key;
+        uint32_t value = parse_uint(eq + 1, p);
+        if (key_len == 8 && strncasecmp(key, "minptime", 8) == 0) {
+            answer->minptime = value;
+        } else if (key_len == 12 && strncasecmp(key, "useinbandfec", 12) == 0) {
+            answer->useinbandfec = value != 0;
+        } else if (key_len == 6 && strncasecmp(key, "usedtx", 6) == 0) {
+            answer->usedtx = value != 0;
+        } else if (key_len == 6 && strncasecmp(key, "stereo", 6) == 0) {
+            answer->stereo = value != 0;
+        } else if (key_len == 17 && strncasecmp(key, "maxaveragebitrate", 17) == 0) {
+            answer->maxaveragebitrate = value;
+        }
+    }
+}
+
+bool webrtc_sdp_parse_answer(const char *sdp, int size, webrtc_sdp_answer_t *answer)
+{
+    memset(answer, 0, sizeof(*answer));
+    const char *cur = sdp, *end = sdp + size;
+    sdp_line_t line;
+    bool in_audio = false, in_application = false, found_audio = false;
+    int audio_pt = -1;
+
+    while (next_line(&cur, end, &line)) {
+        const char *line_end = line.p + line.len;
+        if (starts_with(&line, "m=")) {
+            in_audio = starts_with(&line, "m=audio ") && !found_audio;
+            in_application = starts_with(&line, "m=application ");
+            if (in_audio) {
+                sdp_line_t fields[4];
+                if (split_fields(&line, fields, 4) == 4) {
+                    audio_pt = parse_uint(fields[3].p, fields[3].p + fields[3].len);
+                    answer->payload_type = audio_pt;
+                }
+                found_audio = true;
+            }
+            answer->data_channel |= in_application;
+            continue;
+        }
+        if (starts_with(&line, "a=candidate:")) {
+            answer->candidates++;
+        } else if (in_audio && line_pt(&line, "a=rtpmap:") == audio_pt && audio_pt >= 0) {
+            // a=rtpmap:<pt> <name>/<clock>[/<channels>]
+            const char *name = memchr(line.p, ' ', line.len);
+            const char *slash = name ? memchr(name, '/', line_end - name) : NULL;
+            if (slash) {
+                int n = slash - name - 1;
+                if (n >= (int)sizeof(answer->codec)) {
+                    n = sizeof(answer->codec) - 1;
+                }
+                memcpy(answer->codec, name + 1, n);
+                answer->codec[n] = '\0';
+                answer->clock_rate = parse_uint(slash + 1, line_end);
+                const char *ch = memchr(slash + 1, '/', line_end - slash - 1);
+                answer->channels = ch ? parse_uint(ch + 1, line_end) : 1;
+            }
+        } else if (in_audio && line_pt(&line, "a=fmtp:") == audio_pt && audio_pt >= 0) {
+            parse_fmtp(&line, answer);
+        } else if (in_audio && starts_with(&line, "a=ptime:")) {
+            answer->ptime = parse_uint(line.p + 8, line_end);
+        } else if (in_audio && starts_with(&line, "a=maxptime:")) {
+            answer->maxptime = parse_uint(line.p + 11, line_end);
+        } else if (in_application && starts_with(&line, "a=sctp-port:")) {
+            answer->sctp_port = parse_uint(line.p + 12, line_end);
+        } else if (in_application && starts_with(&line, "a=max-message-size:")) {
+            answer->max_message_size = parse_uint(line.p + 19, line_end);
+        }
+    }
+    return found_audio;
+}
@@ -0,0 +1,237 @@
+#include "webrtc_timing.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_timer.h"
+#include "metrics.h"
+
+static const char *TAG = "webrtc_timing";
+
+static const char *phase_names[WEBRTC_PHASE_MAX] = {
+    "signaling", "offer", "token", "dns", "answer", "peer", "sctp", "channel", "session",
+};
+
+static const uint32_t bucket_ms[WEBRTC_TIMING_BUCKETS] = {
+    50, 100, 200, 500, 1000, 2000, 5000, WEBRTC_TIMING_NONE,
+};
+
+// One completed setup: phase durations, then the total
+typedef struct {
+    uint32_t ms[WEBRTC_PHASE_MAX + 1];
+} timing_record_t;
+
+// Module state
+static struct {
+    portMUX_TYPE lock;
+    bool active;
+    int64_t start_us;
+    int64_t mark_us[WEBRTC_PHASE_MAX];
+    timing_record_t window[WEBRTC_TIMING_WINDOW];
+    uint32_t head;
+    uint32_t filled;
+    uint32_t connections;
+    uint32_t failures;
+} timing_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// Registry view; survives webrtc_timing_reset like any counter
+static struct {
+    bool registered;
+    metric_t *setup_ms;
+    metric_t *connections;
+    metric_t *failures;
+} timing_metrics;
+
+static void timing_metrics_register(void)
+{
+    if (timing_metrics.registered) {
+        return;
+    }
+    timing_metrics.setup_ms = metrics_histogram("webrtc_setup_ms", "Connect to session.created",
+                                                bucket_ms, WEBRTC_TIMING_BUCKETS - 1);
+    timing_metrics.connections = metrics_counter("webrtc_connections_total", "Setups that reached a session");
+    timing_metrics.failures = metrics_counter("webrtc_setup_failures_total", "Setups abandoned or failed");
+    timing_metrics.registered = true;
+}
+
+// Durations between consecutive phases that were reached; skipped phases stay NONE
+static void build_record(timing_record_t *rec, int64_t end_us)
+{
+    int64_t prev = timing_state.start_us;
+    for (int i = 0; i < WEBRTC_PHASE_MAX; i++) {
+        int64_t t = timing_state.mark_us[i];
+        if (t == 0) {
+            rec->ms[i] = WEBRTC_TIMING_NONE;
+            continue;
+        }
+        rec->ms[i] = t > prev ? (uint32_t)((t - prev) / 1000) : 0;
+        prev = t;
+    }
+    rec->ms[WEBRTC_PHASE_MAX] = (uint32_t)((end_us - timing_state.start_us) / 1000);
+}
+
+static void format_record(const timing_record_t *rec, char *buf, size_t size)
+{
+    int len = 0;
+    for (int i = 0; i < WEBRTC_PHASE_MAX && len < (int)size; i++) {
+        if (rec->ms[i] == WEBRTC_TIMING_NONE) {
+            len += snprintf(buf + len, size - len, "%s%s -", i ? ", " : "", phase_names[i]);
+        } else {
+            len += snprintf(buf + len, size - len, "%s%s %" PRIu32, i ? ", " : "", phase_names[i], rec->ms[i]);
+        }
+    }
+}
+
+void webrtc_timing_begin(void)
+{
+    timing_metrics_register();
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&timing_state.lock);
+    if (timing_state.active) {
+        timing_state.failures++;
+        metric_inc(timing_metrics.failures);
+    }
+    timing_state.active = true;
+    timing_state.start_us = now;
+    memset(timing_state.mark_us, 0, sizeof(timing_state.mark_us));
+    taskEXIT_CRITICAL(&timing_state.lock);
+}
+
+void webrtc_timing_mark(webrtc_phase_t phase)
+{
+    if (phase >= WEBRTC_PHASE_MAX) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    timing_record_t rec;
+    bool done = false;
+
+    taskENTER_CRITICAL(&timing_state.lock);
+    if (timing_state.active && timing_state.mark_us[phase] == 0) {
+        timing_state.mark_us[phase] = now;
+        if (phase == WEBRTC_PHASE_SESSION) {
+            build_record(&rec, now);
+            timing_state.window[timing_state.head] = rec;
+            timing_state.head = (timing_state.head + 1) % WEBRTC_TIMING_WINDOW;
+            if (timing_state.filled < WEBRTC_TIMING_WINDOW) {
+                timing_state.filled++;
+            }
+            timing_state.connections++;
+            timing_state.active = false;
+            done = true;
+        }
+    }
+    taskEXIT_CRITICAL(&timing_state.lock);
+
+    if (done) {
+        char line[192];
+        format_record(&rec, line, sizeof(line));
+        metric_inc(timing_metrics.connections);
+        metric_observe(timing_metrics.setup_ms, rec.ms[WEBRTC_PHASE_MAX]);
+        ESP_LOGI(TAG, "Setup %" PRIu32 " ms: %s", rec.ms[WEBRTC_PHASE_MAX], line);
+    }
+}
+
+void webrtc_timing_fail(void)
+{
+    int64_t now = esp_timer_get_time();
+    timing_record_t rec;
+    bool failed = false;
+
+    taskENTER_CRITICAL(&timing_state.lock);
+    if (timing_state.active) {
+        build_record(&rec, now);
+        timing_state.failures++;
+        timing_state.active = false;
+        failed = true;
+    }
+    taskEXIT_CRITICAL(&timing_state.lock);
+
+    if (failed) {
+        char line[192];
+        format_record(&rec, line, sizeof(line));
+        metric_inc(timing_metrics.failures);
+        ESP_LOGW(TAG, "Setup failed after %" PRIu32 " ms: %s", rec.ms[WEBRTC_PHASE_MAX], line);
+    }
+}
+
+static void phase_stats(const timing_record_t *window, uint32_t filled, int index, webrtc_phase_stats_t *out)
+{
+    uint32_t sorted[WEBRTC_TIMING_WINDOW];
+    uint32_t n = 0;
+
+    // Insertion sort; the window is small
+    for (uint32_t i = 0; i < filled; i++) {
+        uint32_t v = window[i].ms[index];
+        if (v == WEBRTC_TIMING_NONE) {
+            continue;
+        }
+        uint32_t j = n++;
+        while (j > 0 && sorted[j - 1] > v) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = v;
+
+        int b = 0;
+        while (b < WEBRTC_TIMING_BUCKETS - 1 && v >= bucket_ms[b]) {
+            b++;
+        }
+        out->hist[b]++;
+    }
+
+    out->samples = n;
+    if (n) {
+        out->p50_ms = sorted[(n - 1) / 2];
+        out->p90_ms = sorted[(n - 1) * 9 / 10];
+        out->max_ms = sorted[n - 1];
+    }
+}
+
+void webrtc_timing_get_stats(webrtc_timing_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    static timing_record_t window[WEBRTC_TIMING_WINDOW];
+    memset(stats, 0, sizeof(*stats));
+
+    taskENTER_CRITICAL(&timing_state.lock);
+    uint32_t filled = timing_state.filled;
+    memcpy(window, timing_state.window, filled * sizeof(timing_record_t));
+    stats->connections = timing_state.connections;
+    stats->failures = timing_state.failures;
+    taskEXIT_CRITICAL(&timing_state.lock);
+
+    for (int i = 0; i < WEBRTC_PHASE_MAX; i++) {
+        phase_stats(window, filled, i, &stats->phase[i]);
+    }
+    phase_stats(window, filled, WEBRTC_PHASE_MAX, &stats->total);
+}
+
+void webrtc_timing_reset(void)
+{
+    taskENTER_CRITICAL(&timing_state.lock);
+    timing_state.head = 0;
+    timing_state.filled = 0;
+    timing_state.connections = 0;
+    timing_state.failures = 0;
+    taskEXIT_CRITICAL(&timing_state.lock);
+}
+
+const char *webrtc_timing_phase_name(webrtc_phase_t phase)
+{
+    return phase < WEBRTC_PHASE_MAX ? phase_names[phase] : "total";
+}
+
+uint32_t webrtc_timing_bucket_ms(int bucket)
+{
+    if (bucket < 0 || bucket >= WEBRTC_TIMING_BUCKETS) {
+        return WEBRTC_TIMING_NONE;
+    }
+    return bucket_ms[bucket];
+}
@@ -0,0 +1,103 @@
+#ifndef DNS_CACHE_H
+#define DNS_CACHE_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DNS_CACHE_MAX_HOSTS     4
+#define DNS_CACHE_HOST_LEN      64
+#define DNS_CACHE_ADDR_LEN      40
+
+/**
+ * @brief Pre-resolution of service hostnames
+ *
+ * Registered hosts are resolved as soon as the station gets an IP and again
+ * at three quarters of their record TTL, from a background task. Lookups send
+ * an A query straight to the station's DNS servers, because getaddrinfo() hides
+ * the TTL. The TTL is capped at CONFIG_AG_WIFI_DNS_TTL_S. Callers connect to the
+ * returned address, so esp-tls does not resolve the name a second time.
+ * getaddrinfo() remains the fallback when the query fails; its answer is kept
+ * only for a short time.
+ */
+
+/**
+ * @brief One cached host
+ */
+typedef struct {
+    char host[DNS_CACHE_HOST_LEN];
+    char addr[DNS_CACHE_ADDR_LEN];  // First address returned, empty until resolved
+    bool valid;
+    uint32_t ttl_s;                 // Lifetime of the answer (record TTL, clamped)
+    uint32_t age_s;                 // Since the last successful resolution
+    uint32_t last_ms;               // Duration of the last resolution
+    uint32_t resolves;
+    uint32_t failures;
+} dns_cache_entry_t;
+
+typedef struct {
+    uint32_t lookups;               // dns_cache_resolve() calls for registered or new hosts
+    uint32_t hits;                  // Answered from a fresh entry
+    uint32_t misses;                // Resolved on the caller's time
+    uint32_t refreshes;             // Background resolutions
+    uint32_t failures;
+    uint32_t prefetch_ms;           // GOT_IP to every registered host resolved, last link up
+} dns_cache_stats_t;
+
+/**
+ * @brief Create the cache and its refresh task
+ * @return ESP_OK on success
+ */
+esp_err_t dns_cache_init(void);
+
+/**
+ * @brief Register a host for pre-resolution
+ *
+ * Accepts a bare hostname or a URL ("https://host:port/path"); IP literals are
+ * ignored. If the link is up the host is resolved in the background right away.
+ * @param host_or_url Hostname or URL
+ * @return ESP_OK on success, ESP_ERR_NO_MEM when the table is full
+ */
+esp_err_t dns_cache_add(const char *host_or_url);
+
+/**
+ * @brief Resolve a host, from the cache when the entry is fresh
+ *
+ * A miss blocks on a DNS query on the caller's time. IP literals are returned
+ * as they are.
+ * @param host_or_url Hostname or URL
+ * @param addr Output address text (an IP literal to connect to), may be NULL
+ * @param size Size of addr
+ * @return ESP_OK if an address is known
+ */
+esp_err_t dns_cache_resolve(const char *host_or_url, char *addr, int size);
+
+/**
+ * @brief Tell the cache the link state; called by the WiFi event handler
+ * @param up true on IP_EVENT_STA_GOT_IP, false on disconnect
+ */
+void dns_cache_note_link(bool up);
+
+/**
+ * @brief Get lookup counters
+ * @param stats Output statistics
+ */
+void dns_cache_get_stats(dns_cache_stats_t *stats);
+
+/**
+ * @brief Copy the cached entries
+ * @param entries Output array
+ * @param max Capacity of entries
+ * @return Number of entries copied
+ */
+int dns_cache_get_entries(dns_cache_entry_t *entries, int max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DNS_CACHE_H
@@ -0,0 +1,93 @@
+#ifndef NET_BENCH_H
+#define NET_BENCH_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Network self-test against tools/net_bench/net_bench_server.py
+ *
+ * Measures TCP and UDP throughput in both directions, TCP and UDP round-trip
+ * time, and the time to open a TLS connection, so a slow session can be put
+ * down to the WiFi link, TLS or the server. Each run is kept in NVS; the last
+ * NET_BENCH_HISTORY runs survive reboots for comparison.
+ */
+
+#define NET_BENCH_HISTORY       8
+#define NET_BENCH_HOST_LEN      64
+
+// Tests that did not complete
+#define NET_BENCH_FAIL_TCP_RTT  (1 << 0)
+#define NET_BENCH_FAIL_TCP_UP   (1 << 1)
+#define NET_BENCH_FAIL_TCP_DOWN (1 << 2)
+#define NET_BENCH_FAIL_UDP_RTT  (1 << 3)
+#define NET_BENCH_FAIL_UDP_UP   (1 << 4)
+#define NET_BENCH_FAIL_UDP_DOWN (1 << 5)
+#define NET_BENCH_FAIL_TLS      (1 << 6)
+#define NET_BENCH_FAIL_ALL      0x7F
+
+typedef struct {
+    const char *host;               // Bench server, name or address
+    uint16_t port;                  // TCP and UDP
+    const char *tls_host;           // NULL: host
+    uint16_t tls_port;              // 0: port + 1
+    uint32_t duration_ms;           // Per throughput test
+    uint32_t udp_rate_kbps;         // Rate the server sends at in the UDP download
+} net_bench_cfg_t;
+
+typedef struct {
+    uint32_t run;                   // Sequence number, kept across reboots
+    int64_t time;                   // Wall clock (s), 0 when the clock was never set
+    char host[NET_BENCH_HOST_LEN];
+    uint32_t duration_ms;
+    int8_t rssi;
+    uint8_t channel;
+    uint32_t tcp_rtt_us;            // Average of the echo round trips
+    uint32_t tcp_rtt_max_us;
+    uint32_t udp_rtt_us;
+    uint32_t udp_rtt_max_us;
+    uint8_t udp_rtt_loss_pct;
+    uint32_t tcp_up_kbps;
+    uint32_t tcp_down_kbps;
+    uint32_t udp_up_kbps;           // As received by the server
+    uint8_t udp_up_loss_pct;
+    uint32_t udp_down_kbps;
+    uint8_t udp_down_loss_pct;
+    uint32_t tls_ms;                // TCP connect + TLS handshake
+    uint8_t failed;                 // NET_BENCH_FAIL_* bits
+} net_bench_result_t;
+
+/**
+ * @brief Run every test and store the result
+ *
+ * Blocks for about four times cfg->duration_ms plus the round-trip tests.
+ * @param cfg Server and test parameters
+ * @param result Output, filled even when some tests fail
+ * @return ESP_OK if at least one test completed, ESP_FAIL otherwise
+ */
+esp_err_t net_bench_run(const net_bench_cfg_t *cfg, net_bench_result_t *result);
+
+/**
+ * @brief Copy stored runs, oldest first
+ * @param results Output array
+ * @param max Capacity of results
+ * @return Number of runs copied
+ */
+int net_bench_get_history(net_bench_result_t *results, int max);
+
+/**
+ * @brief Erase stored runs
+ * @return ESP_OK on success
+ */
+esp_err_t net_bench_clear_history(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NET_BENCH_H
@@ -3,6 +3,7 @@
 
 #include <esp_err.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 // WiFi event callback type
 typedef void (*wifi_event_callback_t)(bool connected);
@@ -13,6 +14,46 @@ typedef struct {
     char password[64];
 } wifi_credentials_t;
 
+// Connect timing and direct-connect counters
+typedef struct {
+    uint32_t boot_to_ip_ms;         // Boot to the first GOT_IP
+    uint32_t connect_to_ip_ms;      // Last wifi_module_connect() to GOT_IP
+    uint32_t drops;                 // Link lost while connected
+    uint32_t last_drop_to_ip_ms;
+    uint32_t avg_drop_to_ip_ms;
+    uint32_t max_drop_to_ip_ms;
+    uint32_t direct_attempts;       // Connects to the stored AP without a scan
+    uint32_t direct_fallbacks;      // Direct connects that failed and fell back to a full scan
+    uint32_t nvs_writes;            // Credential and association writes since boot
+    bool last_direct;               // Last GOT_IP came from a direct connect
+    bool has_assoc;                 // Stored AP below is valid
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t lease_ip;              // Last DHCP lease, network byte order
+} wifi_connect_stats_t;
+
+// Coarse link quality; media adapts per level
+typedef enum {
+    WIFI_LINK_POOR,
+    WIFI_LINK_FAIR,
+    WIFI_LINK_GOOD,
+} wifi_link_level_t;
+
+// Link quality snapshot, updated every CONFIG_AG_WIFI_LINK_SAMPLE_MS
+typedef struct {
+    uint8_t score;                  // 0-100, smoothed; the worst of the inputs below
+    wifi_link_level_t level;        // Drops at once, rises only after the score holds
+    int8_t rssi;                    // dBm, 0 when unknown
+    uint32_t rtt_ms;                // Gateway ping, smoothed
+    uint8_t loss_pct;               // Gateway ping loss over the last 16 pings
+    uint8_t retx_pct;               // TCP retransmissions per segment sent (CONFIG_LWIP_STATS)
+    uint8_t tx_fail_pct;            // Packets dropped by the netif per packet sent (CONFIG_LWIP_STATS)
+    uint32_t level_changes;
+} wifi_link_quality_t;
+
+// Link level change callback; runs on the monitor task
+typedef void (*wifi_link_callback_t)(const wifi_link_quality_t *quality, void *ctx);
+
 /**
  * Initialize WiFi module
  * Sets up WiFi station mode and event handlers
@@ -38,6 +79,16 @@ esp_err_t wifi_module_connect(const char *ssid, const char *password);
  */
 esp_err_t wifi_module_disconnect(void);
 
+/**
+ * Drop the current association and let the driver reconnect
+ *
+ * Unlike wifi_module_disconnect() the station stays started, so this is a real
+ * link flap (DISCONNECTED -> GOT_IP). Used to exercise session resume.
+ * 
+ * @return ESP_OK on success
+ */
+esp_err_t wifi_module_drop_link(void);
+
 /**
  * Get current connection status
  * 
@@ -82,4 +133,42 @@ esp_err_t wifi_module_clear_credentials(void);
  */
 esp_err_t wifi_module_get_mac(uint8_t mac[6]);
 
+/**
+ * Get boot-to-IP and drop-to-IP times and the stored AP
+ *
+ * The BSSID, channel and lease of the last association are kept in NVS
+ * (written only when they change); connects to the same SSID go straight to
+ * that AP and fall back to a full scan if it does not answer.
+ * 
+ * @param stats Pointer to store statistics
+ */
+void wifi_module_get_connect_stats(wifi_connect_stats_t *stats);
+
+/**
+ * Subscribe to link level changes
+ *
+ * The callback runs when the level changes and once after each GOT_IP, so
+ * subscribers can restore full quality after a reconnect.
+ * 
+ * @param callback Function to call
+ * @param ctx Passed to the callback
+ * @return ESP_OK on success, ESP_ERR_NO_MEM when all slots are taken
+ */
+esp_err_t wifi_module_link_subscribe(wifi_link_callback_t callback, void *ctx);
+
+/**
+ * Get a printable name for a link level
+ * 
+ * @param level Link level
+ * @return "poor", "fair" or "good"
+ */
+const char *wifi_link_level_name(wifi_link_level_t level);
+
+/**
+ * Get the current link quality
+ * 
+ * @param quality Pointer to store the snapshot
+ */
+void wifi_module_get_link_quality(wifi_link_quality_t *quality);
+
 #endif // WIFI_MODULE_H
\ No newline at end of file
@@ -0,0 +1,57 @@
+#ifndef WIFI_POWER_H
+#define WIFI_POWER_H
+
+#include <esp_err.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "wifi_power_policy.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Time spent per power-save mode and the estimated radio current
+ *
+ * Currents come from the WIFI_POWER_*_MA model in wifi_power_policy.h, not
+ * from a measurement; tools/ps_sim uses the same model.
+ */
+typedef struct {
+    bool enabled;                   // CONFIG_AG_WIFI_POWER_POLICY
+    wifi_power_state_t state;
+    uint32_t grace_ms;
+    uint32_t none_ms;               // PS off
+    uint32_t modem_ms;              // Modem sleep, no session
+    uint32_t modem_session_ms;      // Modem sleep while a session streams mic audio
+    uint32_t events;
+    uint32_t wakes;                 // Modem sleep -> PS off
+    uint32_t sleeps;                // Grace expiries and session stops into modem sleep
+    uint32_t last_switch_us;        // Duration of the last esp_wifi_set_ps() on a wake
+    uint32_t max_switch_us;
+    uint32_t avg_ma;                // Estimated radio current under the policy
+    uint32_t none_ma;               // Same period with PS always off
+} wifi_power_stats_t;
+
+/**
+ * @brief Create the grace timer and apply the initial mode (PS off)
+ * @return ESP_OK on success
+ */
+esp_err_t wifi_power_init(void);
+
+/**
+ * @brief Report a conversation event; switches the power-save mode when the policy says so
+ * @param event Event seen by the realtime client
+ */
+void wifi_power_note(wifi_power_event_t event);
+
+/**
+ * @brief Get mode times and the current estimate
+ * @param stats Output statistics
+ */
+void wifi_power_get_stats(wifi_power_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_POWER_H
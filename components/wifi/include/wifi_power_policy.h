@@ -0,0 +1,93 @@
+#ifndef WIFI_POWER_POLICY_H
+#define WIFI_POWER_POLICY_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Power-save policy driven by conversation events
+ *
+ * Plain C with no IDF dependency, so tools/ps_sim replays event timelines
+ * through the same code the device runs. The radio stays fully on
+ * (WIFI_PS_NONE) while a session is being set up, while the user speaks and
+ * while a response plays, and for a grace window after the last of those;
+ * only then does the station drop to modem sleep (WIFI_PS_MIN_MODEM).
+ */
+
+// Radio current model (mA) for the savings estimate; replace with board measurements
+#define WIFI_POWER_NONE_MA          95      // Receiver always on
+#define WIFI_POWER_MODEM_MA         25      // Modem sleep, awake for DTIM beacons only
+#define WIFI_POWER_MODEM_STREAM_MA  55      // Modem sleep while the mic stream keeps transmitting
+#define WIFI_POWER_BEACON_MS        102     // 100 TU beacon interval
+
+typedef enum {
+    WIFI_POWER_SESSION_START,       // Peer connection being set up
+    WIFI_POWER_SESSION_READY,       // Data channel open, waiting for the user
+    WIFI_POWER_SESSION_STOP,
+    WIFI_POWER_SPEECH_START,        // input_audio_buffer.speech_started
+    WIFI_POWER_SPEECH_STOP,
+    WIFI_POWER_RESPONSE_START,      // response.created
+    WIFI_POWER_RESPONSE_DONE,
+    WIFI_POWER_PLAYBACK_START,      // output_audio_buffer.started
+    WIFI_POWER_PLAYBACK_STOP,       // output_audio_buffer.stopped / cleared
+    WIFI_POWER_EVENT_MAX,
+} wifi_power_event_t;
+
+typedef enum {
+    WIFI_POWER_ACTIVE,              // PS off, a turn is in progress
+    WIFI_POWER_GRACE,               // PS off, waiting for the next turn
+    WIFI_POWER_IDLE,                // Modem sleep
+} wifi_power_state_t;
+
+typedef struct {
+    uint32_t grace_ms;
+    wifi_power_state_t state;
+    bool in_session;
+    bool connecting;
+    bool speaking;
+    bool responding;
+    bool playing;
+    uint32_t grace_until_ms;        // Valid in WIFI_POWER_GRACE
+} wifi_power_policy_t;
+
+/**
+ * @brief Start in the grace state so the boot connect runs with PS off
+ * @param policy Policy to initialize
+ * @param grace_ms Idle time before modem sleep
+ * @param now_ms Current time
+ */
+void wifi_power_policy_init(wifi_power_policy_t *policy, uint32_t grace_ms, uint32_t now_ms);
+
+/**
+ * @brief Feed a conversation event
+ * @return New state
+ */
+wifi_power_state_t wifi_power_policy_event(wifi_power_policy_t *policy, wifi_power_event_t event,
+                                           uint32_t now_ms);
+
+/**
+ * @brief Expire the grace window once its deadline has passed
+ * @return New state
+ */
+wifi_power_state_t wifi_power_policy_tick(wifi_power_policy_t *policy, uint32_t now_ms);
+
+/**
+ * @brief Whether the state runs the station in modem sleep
+ */
+static inline bool wifi_power_policy_sleeps(wifi_power_state_t state)
+{
+    return state == WIFI_POWER_IDLE;
+}
+
+const char *wifi_power_event_name(wifi_power_event_t event);
+const char *wifi_power_state_name(wifi_power_state_t state);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // WIFI_POWER_POLICY_H
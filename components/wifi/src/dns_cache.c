@@ -0,0 +1,501 @@
+#include "dns_cache.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "esp_random.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "lwip/dns.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include "media_lib_os.h"
+#include "metrics.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "dns_cache";
+
+#define DNS_BIT_LINK_UP         BIT0    // Level: station has an IP
+#define DNS_BIT_KICK            BIT1    // Check for due entries now
+#define DNS_MIN_TTL_S           10      // Floor for tiny record TTLs, keeps refreshes sparse
+#define DNS_RETRY_US            (5 * 1000000LL)
+#define DNS_PORT                53
+#define DNS_QUERY_TIMEOUT_MS    2000
+#define DNS_MSG_MAX             512
+#define DNS_TYPE_A              1
+#define DNS_CLASS_IN            1
+
+typedef struct {
+    dns_cache_entry_t pub;
+    int64_t resolved_us;    // Last successful resolution
+    int64_t tried_us;       // Last attempt, successful or not
+    int64_t ttl_us;         // Lifetime of the last answer
+} cache_slot_t;
+
+// Module state; the lock only guards copies, resolution runs outside it
+static struct {
+    portMUX_TYPE lock;
+    cache_slot_t slots[DNS_CACHE_MAX_HOSTS];
+    int count;
+    EventGroupHandle_t events;
+    int64_t link_up_us;     // Set at GOT_IP, cleared once every host is resolved again
+    dns_cache_stats_t stats;
+} dns_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+// "https://host:443/path" or "host" -> "host"; false for IP literals and oversize names
+static bool parse_host(const char *in, char *host, bool *literal)
+{
+    const char *p = strstr(in, "://");
+    p = p ? p + 3 : in;
+    bool bracketed = *p == '[';     // IPv6 literal
+    p += bracketed;
+    size_t len = strcspn(p, bracketed ? "]" : ":/?#");
+    *literal = false;
+    if (len == 0 || len >= DNS_CACHE_HOST_LEN) {
+        return false;
+    }
+    memcpy(host, p, len);
+    host[len] = '\0';
+    struct in_addr ip;
+    *literal = bracketed || inet_aton(host, &ip) != 0;
+    return !*literal;
+}
+
+// Call with the lock held
+static int find_slot(const char *host)
+{
+    for (int i = 0; i < dns_state.count; i++) {
+        if (strcmp(dns_state.slots[i].pub.host, host) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Call with the lock held; -1 when the table is full
+static int add_slot(const char *host)
+{
+    int index = find_slot(host);
+    if (index >= 0 || dns_state.count >= DNS_CACHE_MAX_HOSTS) {
+        return index;
+    }
+    index = dns_state.count++;
+    memset(&dns_state.slots[index], 0, sizeof(cache_slot_t));
+    strlcpy(dns_state.slots[index].pub.host, host, DNS_CACHE_HOST_LEN);
+    return index;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+// Offset after a possibly compressed name, -1 when it runs off the message
+static int skip_name(const uint8_t *msg, int len, int pos)
+{
+    while (pos < len) {
+        if (msg[pos] == 0) {
+            return pos + 1;
+        }
+        if ((msg[pos] & 0xC0) == 0xC0) {
+            return pos + 2 <= len ? pos + 2 : -1;
+        }
+        pos += msg[pos] + 1;
+    }
+    return -1;
+}
+
+// A query, RD set; returns the message length, 0 if a label does not fit
+static int build_query(uint8_t *msg, uint16_t id, const char *host)
+{
+    memset(msg, 0, 12);
+    msg[0] = id >> 8;
+    msg[1] = id & 0xFF;
+    msg[2] = 0x01;          // Recursion desired
+    msg[5] = 1;             // One question
+    int pos = 12;
+    for (const char *label = host; *label; ) {
+        size_t len = strcspn(label, ".");
+        if (len == 0 || len > 63) {
+            return 0;
+        }
+        msg[pos++] = (uint8_t)len;
+        memcpy(msg + pos, label, len);
+        pos += len;
+        label += len + (label[len] == '.');
+    }
+    msg[pos++] = 0;
+    msg[pos++] = 0;
+    msg[pos++] = DNS_TYPE_A;
+    msg[pos++] = 0;
+    msg[pos++] = DNS_CLASS_IN;
+    return pos;
+}
+
+// First A record of the answer; the TTL is the shortest along the CNAME chain to it
+static esp_err_t parse_answer(const uint8_t *msg, int len, uint16_t id, struct in_addr *addr, uint32_t *ttl_s)
+{
+    if (len < 12 || get16(msg) != id || !(msg[2] & 0x80) || (msg[3] & 0x0F) != 0) {
+        return ESP_FAIL;
+    }
+    int pos = 12;
+    for (int i = get16(msg + 4); i > 0 && pos > 0; i--) {
+        pos = skip_name(msg, len, pos);
+        pos = pos > 0 ? pos + 4 : -1;
+    }
+    uint32_t ttl = UINT32_MAX;
+    for (int i = get16(msg + 6); i > 0 && pos > 0; i--) {
+        pos = skip_name(msg, len, pos);
+        if (pos < 0 || pos + 10 > len) {
+            return ESP_FAIL;
+        }
+        uint16_t type = get16(msg + pos);
+        uint16_t rclass = get16(msg + pos + 2);
+        uint32_t record_ttl = (uint32_t)get16(msg + pos + 4) << 16 | get16(msg + pos + 6);
+        uint16_t rdlength = get16(msg + pos + 8);
+        pos += 10;
+        if (pos + rdlength > len) {
+            return ESP_FAIL;
+        }
+        if (record_ttl < ttl) {
+            ttl = record_ttl;
+        }
+        if (type == DNS_TYPE_A && rclass == DNS_CLASS_IN && rdlength == 4) {
+            memcpy(&addr->s_addr, msg + pos, 4);
+            *ttl_s = ttl;
+            return ESP_OK;
+        }
+        pos += rdlength;
+    }
+    return ESP_FAIL;
+}
+
+// getaddrinfo() hides the record TTL, so ask the station's servers directly
+static esp_err_t query_a(const char *host, struct in_addr *addr, uint32_t *ttl_s)
+{
+    uint8_t msg[DNS_MSG_MAX];
+    uint16_t id = (uint16_t)esp_random();
+    int query_len = build_query(msg, id, host);
+    if (query_len == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    if (sock < 0) {
+        return ESP_FAIL;
+    }
+    struct timeval tv = {
+        .tv_sec = DNS_QUERY_TIMEOUT_MS / 1000,
+        .tv_usec = (DNS_QUERY_TIMEOUT_MS % 1000) * 1000,
+    };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    esp_err_t err = ESP_FAIL;
+    for (int i = 0; i < DNS_MAX_SERVERS && err != ESP_OK; i++) {
+        const ip_addr_t *server = dns_getserver(i);
+        if (server == NULL || ip_addr_isany(server) || !IP_IS_V4(server)) {
+            continue;
+        }
+        struct sockaddr_in to = {
+            .sin_family = AF_INET,
+            .sin_port = htons(DNS_PORT),
+            .sin_addr.s_addr = ip_2_ip4(server)->addr,
+        };
+        if (sendto(sock, msg, query_len, 0, (struct sockaddr *)&to, sizeof(to)) != query_len) {
+            continue;
+        }
+        uint8_t reply[DNS_MSG_MAX];
+        int len = recv(sock, reply, sizeof(reply), 0);
+        if (len > 0) {
+            err = parse_answer(reply, len, id, addr, ttl_s);
+        }
+    }
+    close(sock);
+    return err;
+}
+
+static esp_err_t resolve_now(const char *host, char *addr, int size, uint32_t *ttl_s, uint32_t *ms)
+{
+    int64_t start = esp_timer_get_time();
+    struct in_addr ip;
+    uint32_t ttl = 0;
+    if (query_a(host, &ip, &ttl) == ESP_OK) {
+        *ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+        inet_ntop(AF_INET, &ip, addr, size);
+        *ttl_s = ttl < DNS_MIN_TTL_S ? DNS_MIN_TTL_S : ttl > CONFIG_AG_WIFI_DNS_TTL_S ? CONFIG_AG_WIFI_DNS_TTL_S : ttl;
+        ESP_LOGD(TAG, "%s -> %s in %" PRIu32 " ms, TTL %" PRIu32 " s", host, addr, *ms, ttl);
+        return ESP_OK;
+    }
+
+    // No IPv4 server or no A record: let lwIP try, without a TTL to go by
+    struct addrinfo hints = {
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+    struct addrinfo *res = NULL;
+    int err = getaddrinfo(host, NULL, &hints, &res);
+    *ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+    if (err != 0 || res == NULL) {
+        ESP_LOGW(TAG, "Resolving %s failed (%d) after %" PRIu32 " ms", host, err, *ms);
+        return ESP_FAIL;
+    }
+    if (res->ai_family == AF_INET) {
+        inet_ntop(AF_INET, &((struct sockaddr_in *)res->ai_addr)->sin_addr, addr, size);
+#ifdef CONFIG_LWIP_IPV6
+    } else if (res->ai_family == AF_INET6) {
+        inet_ntop(AF_INET6, &((struct sockaddr_in6 *)res->ai_addr)->sin6_addr, addr, size);
+#endif
+    } else {
+        addr[0] = '\0';
+    }
+    freeaddrinfo(res);
+    *ttl_s = DNS_MIN_TTL_S;
+    ESP_LOGD(TAG, "%s -> %s in %" PRIu32 " ms (resolver, no TTL)", host, addr, *ms);
+    return addr[0] ? ESP_OK : ESP_FAIL;
+}
+
+static struct {
+    metric_t *hits;
+    metric_t *misses;
+    metric_t *failures;
+    metric_t *resolve_ms;
+} dns_metrics;
+
+static void store_result(const char *host, bool ok, const char *addr, uint32_t ttl_s, uint32_t ms,
+                         bool background)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&dns_state.lock);
+    int index = add_slot(host);
+    if (index >= 0) {
+        cache_slot_t *slot = &dns_state.slots[index];
+        slot->tried_us = now;
+        slot->pub.last_ms = ms;
+        if (ok) {
+            strlcpy(slot->pub.addr, addr, DNS_CACHE_ADDR_LEN);
+            slot->pub.ttl_s = ttl_s;
+            slot->pub.valid = true;
+            slot->ttl_us = (int64_t)ttl_s * 1000000;
+            slot->pub.resolves++;
+            slot->resolved_us = now;
+        } else {
+            slot->pub.failures++;
+        }
+    }
+    dns_state.stats.refreshes += background;
+    dns_state.stats.failures += !ok;
+    taskEXIT_CRITICAL(&dns_state.lock);
+    if (ok) {
+        metric_observe(dns_metrics.resolve_ms, ms);
+    } else {
+        metric_inc(dns_metrics.failures);
+    }
+}
+
+// Call with the lock held
+static bool slot_due(const cache_slot_t *slot, int64_t now)
+{
+    if (!slot->pub.valid || slot->resolved_us < dns_state.link_up_us) {
+        return now - slot->tried_us >= DNS_RETRY_US || slot->tried_us < dns_state.link_up_us;
+    }
+    return now - slot->resolved_us >= slot->ttl_us * 3 / 4;
+}
+
+// Call with the lock held
+static uint32_t next_due_ms(int64_t now)
+{
+    int64_t next = INT64_MAX;
+    for (int i = 0; i < dns_state.count; i++) {
+        const cache_slot_t *slot = &dns_state.slots[i];
+        bool current = slot->pub.valid && slot->resolved_us >= dns_state.link_up_us;
+        int64_t due = current ? slot->resolved_us + slot->ttl_us * 3 / 4 : slot->tried_us + DNS_RETRY_US;
+        if (due < next) {
+            next = due;
+        }
+    }
+    if (next == INT64_MAX) {
+        return UINT32_MAX;
+    }
+    return next > now ? (uint32_t)((next - now) / 1000) + 1 : 0;
+}
+
+static void refresh_due(void)
+{
+    for (int i = 0; i < DNS_CACHE_MAX_HOSTS; i++) {
+        char host[DNS_CACHE_HOST_LEN];
+        int64_t now = esp_timer_get_time();
+        taskENTER_CRITICAL(&dns_state.lock);
+        bool due = i < dns_state.count && slot_due(&dns_state.slots[i], now);
+        if (due) {
+            strlcpy(host, dns_state.slots[i].pub.host, sizeof(host));
+        }
+        taskEXIT_CRITICAL(&dns_state.lock);
+        if (!due) {
+            continue;
+        }
+        char addr[DNS_CACHE_ADDR_LEN];
+        uint32_t ttl_s = 0, ms;
+        esp_err_t err = resolve_now(host, addr, sizeof(addr), &ttl_s, &ms);
+        store_result(host, err == ESP_OK, addr, ttl_s, ms, true);
+    }
+
+    // First full pass after GOT_IP closes the prefetch window
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&dns_state.lock);
+    bool done = dns_state.link_up_us != 0 && dns_state.count > 0;
+    for (int i = 0; done && i < dns_state.count; i++) {
+        done = dns_state.slots[i].resolved_us >= dns_state.link_up_us;
+    }
+    uint32_t prefetch_ms = 0;
+    if (done) {
+        prefetch_ms = (uint32_t)((now - dns_state.link_up_us) / 1000);
+        dns_state.stats.prefetch_ms = prefetch_ms;
+        dns_state.link_up_us = 0;
+    }
+    taskEXIT_CRITICAL(&dns_state.lock);
+    if (done) {
+        ESP_LOGI(TAG, "%d host(s) resolved %" PRIu32 " ms after GOT_IP", dns_state.count, prefetch_ms);
+    }
+}
+
+static void dns_refresh_task(void *arg)
+{
+    EventGroupHandle_t events = dns_state.events;
+    while (true) {
+        xEventGroupWaitBits(events, DNS_BIT_LINK_UP, pdFALSE, pdFALSE, portMAX_DELAY);
+
+        taskENTER_CRITICAL(&dns_state.lock);
+        uint32_t wait_ms = next_due_ms(esp_timer_get_time());
+        taskEXIT_CRITICAL(&dns_state.lock);
+        xEventGroupWaitBits(events, DNS_BIT_KICK, pdTRUE, pdFALSE,
+                            wait_ms == UINT32_MAX ? portMAX_DELAY : pdMS_TO_TICKS(wait_ms));
+
+        if (xEventGroupGetBits(events) & DNS_BIT_LINK_UP) {
+            refresh_due();
+        }
+    }
+}
+
+esp_err_t dns_cache_init(void)
+{
+    if (dns_state.events) {
+        return ESP_OK;
+    }
+    static const uint32_t resolve_bounds[] = {20, 50, 100, 200, 500, 1000, 3000};
+    dns_metrics.hits = metrics_counter("dns_cache_hits_total", "Lookups answered from the cache");
+    dns_metrics.misses = metrics_counter("dns_cache_misses_total", "Lookups that had to resolve");
+    dns_metrics.failures = metrics_counter("dns_resolve_failures_total", "Resolves that failed");
+    dns_metrics.resolve_ms = metrics_histogram("dns_resolve_ms", "Successful resolve time",
+                                               resolve_bounds, sizeof(resolve_bounds) / sizeof(resolve_bounds[0]));
+    dns_state.events = xEventGroupCreate();
+    if (dns_state.events == NULL) {
+        ESP_LOGE(TAG, "Failed to create event group");
+        return ESP_ERR_NO_MEM;
+    }
+    if (media_lib_thread_create_from_scheduler(NULL, "dns_refresh", dns_refresh_task, NULL) != 0) {
+        ESP_LOGE(TAG, "Failed to create refresh task");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+esp_err_t dns_cache_add(const char *host_or_url)
+{
+    char host[DNS_CACHE_HOST_LEN];
+    bool literal = false;
+    if (host_or_url == NULL || !parse_host(host_or_url, host, &literal)) {
+        return literal ? ESP_OK : ESP_ERR_INVALID_ARG;
+    }
+    taskENTER_CRITICAL(&dns_state.lock);
+    int index = add_slot(host);
+    taskEXIT_CRITICAL(&dns_state.lock);
+    if (index < 0) {
+        ESP_LOGW(TAG, "No room for %s", host);
+        return ESP_ERR_NO_MEM;
+    }
+    if (dns_state.events) {
+        xEventGroupSetBits(dns_state.events, DNS_BIT_KICK);
+    }
+    return ESP_OK;
+}
+
+esp_err_t dns_cache_resolve(const char *host_or_url, char *addr, int size)
+{
+    char host[DNS_CACHE_HOST_LEN];
+    bool literal = false;
+    if (host_or_url == NULL || !parse_host(host_or_url, host, &literal)) {
+        if (literal && addr) {
+            strlcpy(addr, host, size);
+        }
+        return literal ? ESP_OK : ESP_ERR_INVALID_ARG;
+    }
+
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&dns_state.lock);
+    dns_state.stats.lookups++;
+    int index = find_slot(host);
+    if (index >= 0 && dns_state.slots[index].pub.valid &&
+        now - dns_state.slots[index].resolved_us < dns_state.slots[index].ttl_us) {
+        dns_state.stats.hits++;
+        metric_inc(dns_metrics.hits);
+        if (addr) {
+            strlcpy(addr, dns_state.slots[index].pub.addr, size);
+        }
+        taskEXIT_CRITICAL(&dns_state.lock);
+        return ESP_OK;
+    }
+    dns_state.stats.misses++;
+    metric_inc(dns_metrics.misses);
+    taskEXIT_CRITICAL(&dns_state.lock);
+
+    char found[DNS_CACHE_ADDR_LEN];
+    uint32_t ttl_s = 0, ms;
+    esp_err_t err = resolve_now(host, found, sizeof(found), &ttl_s, &ms);
+    store_result(host, err == ESP_OK, found, ttl_s, ms, false);
+    if (err == ESP_OK && addr) {
+        strlcpy(addr, found, size);
+    }
+    return err;
+}
+
+void dns_cache_note_link(bool up)
+{
+    if (dns_state.events == NULL) {
+        return;
+    }
+    if (up) {
+        // A new network may resolve differently; old entries serve until refreshed
+        taskENTER_CRITICAL(&dns_state.lock);
+        dns_state.link_up_us = esp_timer_get_time();
+        taskEXIT_CRITICAL(&dns_state.lock);
+        xEventGroupSetBits(dns_state.events, DNS_BIT_LINK_UP | DNS_BIT_KICK);
+    } else {
+        xEventGroupClearBits(dns_state.events, DNS_BIT_LINK_UP);
+    }
+}
+
+void dns_cache_get_stats(dns_cache_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    taskENTER_CRITICAL(&dns_state.lock);
+    *stats = dns_state.stats;
+    taskEXIT_CRITICAL(&dns_state.lock);
+}
+
+int dns_cache_get_entries(dns_cache_entry_t *entries, int max)
+{
+    int64_t now = esp_timer_get_time();
+    taskENTER_CRITICAL(&dns_state.lock);
+    int count = dns_state.count < max ? dns_state.count : max;
+    for (int i = 0; i < count; i++) {
+        entries[i] = dns_state.slots[i].pub;
+        entries[i].age_s = dns_state.slots[i].pub.valid ?
+                           (uint32_t)((now - dns_state.slots[i].resolved_us) / 1000000) : 0;
+    }
+    taskEXIT_CRITICAL(&dns_state.lock);
+    return count;
+}
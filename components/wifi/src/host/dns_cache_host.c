@@ -0,0 +1,42 @@
+/*
+ * DNS cache - Linux target
+ * The host resolver is not involved: the host https_post() answers from files,
+ * so there is nothing to warm. Lookups succeed without an address.
+ */
+
+#include "dns_cache.h"
+#include <string.h>
+
+esp_err_t dns_cache_init(void)
+{
+    return ESP_OK;
+}
+
+esp_err_t dns_cache_add(const char *host_or_url)
+{
+    return ESP_OK;
+}
+
+esp_err_t dns_cache_resolve(const char *host_or_url, char *addr, int size)
+{
+    if (addr && size > 0) {
+        addr[0] = '\0';
+    }
+    return ESP_OK;
+}
+
+void dns_cache_note_link(bool up)
+{
+}
+
+void dns_cache_get_stats(dns_cache_stats_t *stats)
+{
+    if (stats) {
+        memset(stats, 0, sizeof(*stats));
+    }
+}
+
+int dns_cache_get_entries(dns_cache_entry_t *entries, int max)
+{
+    return 0;
+}
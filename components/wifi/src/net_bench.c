@@ -0,0 +1,530 @@
+#include "net_bench.h"
+#include <esp_log.h>
+#include <esp_wifi.h>
+#include <nvs.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_timer.h"
+#include "esp_random.h"
+#include "esp_tls.h"
+#include "esp_crt_bundle.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/netdb.h"
+#include "lwip/sockets.h"
+#include "memory_manager.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "net_bench";
+
+#define NVS_NAMESPACE           "net_bench"
+#define NVS_KEY_RUNS            "runs"
+#define NVS_KEY_SEQ             "seq"
+
+#define BENCH_IO_TIMEOUT_MS     5000
+#define BENCH_BUF_SIZE          4096
+#define BENCH_PINGS             20
+#define BENCH_PING_SIZE         32
+#define BENCH_UDP_SIZE          1200    // Below the path MTU, like RTP video
+#define BENCH_UDP_WAIT_MS       500
+#define BENCH_CLOCK_VALID_S     1600000000  // Wall clock never set before 2020
+
+// UDP packet kinds, first byte of the header
+#define UDP_ECHO                'E'
+#define UDP_UPLOAD              'U'
+#define UDP_REPORT              'R'
+#define UDP_DOWNLOAD            'D'
+#define UDP_DATA                'd'
+#define UDP_FIN                 'F'
+
+// UDP header, network byte order; the rest of the datagram is padding
+typedef struct __attribute__((packed)) {
+    uint8_t kind;
+    uint8_t reserved[3];
+    uint32_t session;
+    uint32_t seq;
+    uint32_t value;
+} udp_header_t;
+
+static uint32_t elapsed_us(int64_t start)
+{
+    return (uint32_t)(esp_timer_get_time() - start);
+}
+
+static bool resolve(const char *host, uint16_t port, struct sockaddr_in *addr)
+{
+    struct addrinfo hints = {
+        .ai_family = AF_INET,
+    };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, NULL, &hints, &res) != 0 || res == NULL) {
+        ESP_LOGE(TAG, "Cannot resolve %s", host);
+        return false;
+    }
+    memcpy(addr, res->ai_addr, sizeof(*addr));
+    addr->sin_port = htons(port);
+    freeaddrinfo(res);
+    return true;
+}
+
+static void set_timeout(int sock, uint32_t ms)
+{
+    struct timeval tv = {
+        .tv_sec = ms / 1000,
+        .tv_usec = (ms % 1000) * 1000,
+    };
+    setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+// Connected TCP socket with the command line already sent, -1 on failure
+static int tcp_open(const struct sockaddr_in *addr, const char *command)
+{
+    int sock = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    set_timeout(sock, BENCH_IO_TIMEOUT_MS);
+    if (connect(sock, (const struct sockaddr *)addr, sizeof(*addr)) != 0 ||
+        send(sock, command, strlen(command), 0) != (int)strlen(command)) {
+        ESP_LOGW(TAG, "TCP %s failed: errno %d", command, errno);
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static bool recv_all(int sock, uint8_t *buf, int len)
+{
+    while (len > 0) {
+        int n = recv(sock, buf, len, 0);
+        if (n <= 0) {
+            return false;
+        }
+        buf += n;
+        len -= n;
+    }
+    return true;
+}
+
+static bool tcp_rtt(const struct sockaddr_in *addr, net_bench_result_t *result)
+{
+    int sock = tcp_open(addr, "ECHO\n");
+    if (sock < 0) {
+        return false;
+    }
+    uint8_t ping[BENCH_PING_SIZE];
+    uint8_t pong[BENCH_PING_SIZE];
+    uint64_t total_us = 0;
+    int ok = 0;
+    for (int i = 0; i < BENCH_PINGS; i++) {
+        memset(ping, i, sizeof(ping));
+        int64_t start = esp_timer_get_time();
+        if (send(sock, ping, sizeof(ping), 0) != sizeof(ping) || !recv_all(sock, pong, sizeof(pong))) {
+            break;
+        }
+        uint32_t us = elapsed_us(start);
+        total_us += us;
+        ok++;
+        if (us > result->tcp_rtt_max_us) {
+            result->tcp_rtt_max_us = us;
+        }
+    }
+    close(sock);
+    if (ok < BENCH_PINGS) {
+        return false;
+    }
+    result->tcp_rtt_us = (uint32_t)(total_us / ok);
+    return true;
+}
+
+// Send for the duration, then half-close; the server answers with the byte count it read
+static bool tcp_upload(const struct sockaddr_in *addr, uint32_t duration_ms, uint8_t *buf,
+                       net_bench_result_t *result)
+{
+    int sock = tcp_open(addr, "UP\n");
+    if (sock < 0) {
+        return false;
+    }
+    memset(buf, 0xA5, BENCH_BUF_SIZE);
+    int64_t start = esp_timer_get_time();
+    int64_t end = start + (int64_t)duration_ms * 1000;
+    bool ok = true;
+    while (esp_timer_get_time() < end) {
+        if (send(sock, buf, BENCH_BUF_SIZE, 0) < 0) {
+            ok = false;
+            break;
+        }
+    }
+    shutdown(sock, SHUT_WR);
+
+    char reply[32] = {0};
+    int n = ok ? recv(sock, reply, sizeof(reply) - 1, 0) : -1;
+    uint32_t us = elapsed_us(start);
+    close(sock);
+    unsigned long long bytes = 0;
+    if (n <= 0 || sscanf(reply, "OK %llu", &bytes) != 1 || us == 0) {
+        return false;
+    }
+    result->tcp_up_kbps = (uint32_t)(bytes * 8 * 1000 / us);
+    return true;
+}
+
+// The server sends for the duration and closes
+static bool tcp_download(const struct sockaddr_in *addr, uint32_t duration_ms, uint8_t *buf,
+                         net_bench_result_t *result)
+{
+    char command[32];
+    snprintf(command, sizeof(command), "DOWN %lu\n", duration_ms);
+    int sock = tcp_open(addr, command);
+    if (sock < 0) {
+        return false;
+    }
+    uint64_t bytes = 0;
+    int64_t first = 0;
+    int n;
+    while ((n = recv(sock, buf, BENCH_BUF_SIZE, 0)) > 0) {
+        if (first == 0) {
+            first = esp_timer_get_time();
+        }
+        bytes += n;
+    }
+    close(sock);
+    uint32_t us = first ? elapsed_us(first) : 0;
+    if (n < 0 || us == 0) {
+        return false;
+    }
+    result->tcp_down_kbps = (uint32_t)(bytes * 8 * 1000 / us);
+    return true;
+}
+
+static int udp_open(const struct sockaddr_in *addr)
+{
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        return -1;
+    }
+    set_timeout(sock, BENCH_UDP_WAIT_MS);
+    if (connect(sock, (const struct sockaddr *)addr, sizeof(*addr)) != 0) {
+        close(sock);
+        return -1;
+    }
+    return sock;
+}
+
+static int udp_send(int sock, uint8_t *buf, int len, uint8_t kind, uint32_t session, uint32_t seq,
+                    uint32_t value)
+{
+    udp_header_t header = {
+        .kind = kind,
+        .session = htonl(session),
+        .seq = htonl(seq),
+        .value = htonl(value),
+    };
+    memcpy(buf, &header, sizeof(header));
+    return send(sock, buf, len, 0);
+}
+
+// Next datagram of the session, false on timeout
+static bool udp_recv(int sock, uint8_t *buf, uint32_t session, udp_header_t *header)
+{
+    while (true) {
+        int n = recv(sock, buf, BENCH_BUF_SIZE, 0);
+        if (n < (int)sizeof(*header)) {
+            return false;
+        }
+        memcpy(header, buf, sizeof(*header));
+        if (ntohl(header->session) == session) {
+            header->seq = ntohl(header->seq);
+            header->value = ntohl(header->value);
+            return true;
+        }
+    }
+}
+
+static bool udp_rtt(int sock, uint32_t session, uint8_t *buf, net_bench_result_t *result)
+{
+    uint64_t total_us = 0;
+    int ok = 0;
+    for (uint32_t seq = 0; seq < BENCH_PINGS; seq++) {
+        int64_t start = esp_timer_get_time();
+        if (udp_send(sock, buf, BENCH_PING_SIZE, UDP_ECHO, session, seq, 0) < 0) {
+            continue;
+        }
+        udp_header_t header;
+        // Late echoes of earlier pings are skipped
+        while (udp_recv(sock, buf, session, &header)) {
+            if (header.kind == UDP_ECHO && header.seq == seq) {
+                uint32_t us = elapsed_us(start);
+                total_us += us;
+                ok++;
+                if (us > result->udp_rtt_max_us) {
+                    result->udp_rtt_max_us = us;
+                }
+                break;
+            }
+        }
+    }
+    result->udp_rtt_loss_pct = (BENCH_PINGS - ok) * 100 / BENCH_PINGS;
+    if (ok == 0) {
+        return false;
+    }
+    result->udp_rtt_us = (uint32_t)(total_us / ok);
+    return true;
+}
+
+// Send as fast as lwIP takes the datagrams, then ask the server how many arrived
+static bool udp_upload(int sock, uint32_t session, uint32_t duration_ms, uint8_t *buf,
+                       net_bench_result_t *result)
+{
+    memset(buf, 0x5A, BENCH_UDP_SIZE);
+    uint32_t sent = 0;
+    int64_t start = esp_timer_get_time();
+    int64_t end = start + (int64_t)duration_ms * 1000;
+    while (esp_timer_get_time() < end) {
+        if (udp_send(sock, buf, BENCH_UDP_SIZE, UDP_UPLOAD, session, sent, 0) == BENCH_UDP_SIZE) {
+            sent++;
+        } else {
+            vTaskDelay(1);      // Out of pbufs: let the driver drain
+        }
+    }
+    uint32_t us = elapsed_us(start);
+
+    for (int attempt = 0; attempt < 3; attempt++) {
+        udp_send(sock, buf, sizeof(udp_header_t), UDP_REPORT, session, sent, 0);
+        udp_header_t header;
+        while (udp_recv(sock, buf, session, &header)) {
+            if (header.kind == UDP_REPORT) {
+                uint32_t received = header.value > sent ? sent : header.value;
+                result->udp_up_kbps = (uint32_t)((uint64_t)received * BENCH_UDP_SIZE * 8 * 1000 / us);
+                result->udp_up_loss_pct = sent ? (sent - received) * 100 / sent : 0;
+                return sent > 0;
+            }
+        }
+    }
+    return false;
+}
+
+// The server streams at the requested rate, then sends FIN with its packet count
+static bool udp_download(int sock, uint32_t session, uint32_t duration_ms, uint32_t rate_kbps,
+                         uint8_t *buf, net_bench_result_t *result)
+{
+    if (udp_send(sock, buf, sizeof(udp_header_t), UDP_DOWNLOAD, session, duration_ms, rate_kbps) < 0) {
+        return false;
+    }
+    uint32_t received = 0;
+    uint32_t sent = 0;
+    int64_t first = 0;
+    int64_t last = 0;
+    int64_t deadline = esp_timer_get_time() + ((int64_t)duration_ms + 2000) * 1000;
+    udp_header_t header;
+    while (esp_timer_get_time() < deadline) {
+        if (!udp_recv(sock, buf, session, &header)) {
+            if (received) {
+                break;      // Stream stopped and the FIN got lost
+            }
+            continue;
+        }
+        if (header.kind == UDP_DATA) {
+            last = esp_timer_get_time();
+            if (first == 0) {
+                first = last;
+            }
+            received++;
+        } else if (header.kind == UDP_FIN) {
+            sent = header.value;
+            break;
+        }
+    }
+    if (received < 2 || last <= first) {
+        return false;
+    }
+    // Packets after the first over the time between first and last
+    result->udp_down_kbps = (uint32_t)((uint64_t)(received - 1) * BENCH_UDP_SIZE * 8 * 1000 / (last - first));
+    if (sent >= received) {
+        result->udp_down_loss_pct = (sent - received) * 100 / sent;
+    }
+    return true;
+}
+
+#ifdef CONFIG_AG_NET_BENCH_TRUST_CERT
+extern const char bench_cert_pem_start[] asm("_binary_bench_cert_pem_start");
+extern const char bench_cert_pem_end[] asm("_binary_bench_cert_pem_end");
+#endif
+
+// bench_server: the target is net_bench_server.py's own TLS port, not a public host
+static bool tls_connect(const char *host, uint16_t port, bool bench_server, net_bench_result_t *result)
+{
+    esp_tls_cfg_t cfg = {
+        .timeout_ms = BENCH_IO_TIMEOUT_MS,
+#ifndef CONFIG_ESP_TLS_SKIP_SERVER_CERT_VERIFY
+        // Test builds that skip verification accept the bench server's self-signed certificate
+        .crt_bundle_attach = esp_crt_bundle_attach,
+#endif
+    };
+#ifdef CONFIG_AG_NET_BENCH_TRUST_CERT
+    if (bench_server) {
+        // Pinned: only this certificate is trusted, so its name (no IP) need not match
+        cfg.crt_bundle_attach = NULL;
+        cfg.cacert_buf = (const unsigned char *)bench_cert_pem_start;
+        cfg.cacert_bytes = bench_cert_pem_end - bench_cert_pem_start;
+        cfg.skip_common_name = true;
+    }
+#endif
+    esp_tls_t *tls = esp_tls_init();
+    if (tls == NULL) {
+        return false;
+    }
+    int64_t start = esp_timer_get_time();
+    int ret = esp_tls_conn_new_sync(host, strlen(host), port, &cfg, tls);
+    uint32_t ms = elapsed_us(start) / 1000;
+    esp_tls_conn_destroy(tls);
+    if (ret != 1) {
+        ESP_LOGW(TAG, "TLS connect to %s:%u failed after %lu ms", host, port, ms);
+        return false;
+    }
+    result->tls_ms = ms;
+    return true;
+}
+
+static void save_result(net_bench_result_t *result)
+{
+    net_bench_result_t *runs = mem_calloc(NET_BENCH_HISTORY, sizeof(net_bench_result_t));
+    if (runs == NULL) {
+        return;
+    }
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        uint32_t seq = 0;
+        nvs_get_u32(nvs_handle, NVS_KEY_SEQ, &seq);
+        result->run = ++seq;
+        size_t length = NET_BENCH_HISTORY * sizeof(net_bench_result_t);
+        int count = 0;
+        if (nvs_get_blob(nvs_handle, NVS_KEY_RUNS, runs, &length) == ESP_OK &&
+            length % sizeof(net_bench_result_t) == 0) {
+            count = length / sizeof(net_bench_result_t);
+        }
+        if (count == NET_BENCH_HISTORY) {
+            memmove(runs, runs + 1, (NET_BENCH_HISTORY - 1) * sizeof(net_bench_result_t));
+            count--;
+        }
+        runs[count++] = *result;
+        ret = nvs_set_blob(nvs_handle, NVS_KEY_RUNS, runs, count * sizeof(net_bench_result_t));
+        if (ret == ESP_OK) {
+            ret = nvs_set_u32(nvs_handle, NVS_KEY_SEQ, seq);
+        }
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    mem_free(runs);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save result: %s", esp_err_to_name(ret));
+    }
+}
+
+esp_err_t net_bench_run(const net_bench_cfg_t *cfg, net_bench_result_t *result)
+{
+    if (cfg == NULL || cfg->host == NULL || cfg->duration_ms == 0 || result == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(result, 0, sizeof(*result));
+    strlcpy(result->host, cfg->host, sizeof(result->host));
+    result->duration_ms = cfg->duration_ms;
+    result->failed = NET_BENCH_FAIL_ALL;
+
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        result->rssi = ap.rssi;
+        result->channel = ap.primary;
+    }
+    time_t now = time(NULL);
+    result->time = now >= BENCH_CLOCK_VALID_S ? (int64_t)now : 0;
+
+    struct sockaddr_in addr;
+    if (!resolve(cfg->host, cfg->port, &addr)) {
+        return ESP_FAIL;
+    }
+    uint8_t *buf = mem_alloc(BENCH_BUF_SIZE);
+    if (buf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    ESP_LOGI(TAG, "Benchmarking %s:%u, %lu ms per throughput test", cfg->host, cfg->port, cfg->duration_ms);
+
+    uint8_t failed = 0;
+    failed |= tcp_rtt(&addr, result) ? 0 : NET_BENCH_FAIL_TCP_RTT;
+    failed |= tcp_upload(&addr, cfg->duration_ms, buf, result) ? 0 : NET_BENCH_FAIL_TCP_UP;
+    failed |= tcp_download(&addr, cfg->duration_ms, buf, result) ? 0 : NET_BENCH_FAIL_TCP_DOWN;
+
+    int sock = udp_open(&addr);
+    uint32_t session = esp_random();
+    if (sock >= 0) {
+        failed |= udp_rtt(sock, session, buf, result) ? 0 : NET_BENCH_FAIL_UDP_RTT;
+        failed |= udp_upload(sock, session, cfg->duration_ms, buf, result) ? 0 : NET_BENCH_FAIL_UDP_UP;
+        failed |= udp_download(sock, session, cfg->duration_ms, cfg->udp_rate_kbps, buf, result) ?
+                  0 : NET_BENCH_FAIL_UDP_DOWN;
+        close(sock);
+    } else {
+        failed |= NET_BENCH_FAIL_UDP_RTT | NET_BENCH_FAIL_UDP_UP | NET_BENCH_FAIL_UDP_DOWN;
+    }
+    mem_free(buf);
+
+    const char *tls_host = cfg->tls_host ? cfg->tls_host : cfg->host;
+    uint16_t tls_port = cfg->tls_port ? cfg->tls_port : cfg->port + 1;
+    failed |= tls_connect(tls_host, tls_port, cfg->tls_host == NULL, result) ? 0 : NET_BENCH_FAIL_TLS;
+
+    result->failed = failed;
+    if (failed == NET_BENCH_FAIL_ALL) {
+        return ESP_FAIL;
+    }
+    save_result(result);
+    return ESP_OK;
+}
+
+int net_bench_get_history(net_bench_result_t *results, int max)
+{
+    if (results == NULL || max <= 0) {
+        return 0;
+    }
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return 0;
+    }
+    int count = 0;
+    size_t length = 0;
+    if (nvs_get_blob(nvs_handle, NVS_KEY_RUNS, NULL, &length) == ESP_OK &&
+        length % sizeof(net_bench_result_t) == 0) {
+        net_bench_result_t *runs = mem_alloc(length ? length : 1);
+        if (runs && nvs_get_blob(nvs_handle, NVS_KEY_RUNS, runs, &length) == ESP_OK) {
+            count = length / sizeof(net_bench_result_t);
+            int skip = count > max ? count - max : 0;
+            count -= skip;
+            memcpy(results, runs + skip, count * sizeof(net_bench_result_t));
+        }
+        mem_free(runs);
+    }
+    nvs_close(nvs_handle);
+    return count;
+}
+
+esp_err_t net_bench_clear_history(void)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    // The run counter stays, so numbers are never reused
+    ret = nvs_erase_key(nvs_handle, NVS_KEY_RUNS);
+    if (ret == ESP_OK || ret == ESP_ERR_NVS_NOT_FOUND) {
+        ret = nvs_commit(nvs_handle);
+    }
+    nvs_close(nvs_handle);
+    return ret;
+}
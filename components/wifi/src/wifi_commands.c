@@ -1,12 +1,19 @@
 #include "wifi_commands.h"
 #include "wifi_module.h"
+#include "dns_cache.h"
+#include "wifi_power.h"
+#include "net_bench.h"
 #include <esp_console.h>
 #include <esp_log.h>
 #include <esp_wifi.h>
+#include <esp_netif.h>
 #include <argtable3/argtable3.h>
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "memory_manager.h"
+#include "sdkconfig.h"
 static const char *TAG = "wifi_cmd";
 
 // WiFi connect command arguments
@@ -71,9 +78,221 @@ static int cmd_wifi_status(int argc, char **argv)
         }
     }
     
+    wifi_connect_stats_t stats;
+    wifi_module_get_connect_stats(&stats);
+    if (stats.has_assoc) {
+        esp_ip4_addr_t lease = { .addr = stats.lease_ip };
+        printf("  Stored AP: " MACSTR " channel %u | lease " IPSTR "\n",
+               MAC2STR(stats.bssid), stats.channel, IP2STR(&lease));
+    }
+    printf("  Boot to IP: %lu ms | last connect to IP: %lu ms (%s)\n",
+           stats.boot_to_ip_ms, stats.connect_to_ip_ms, stats.last_direct ? "direct" : "scan");
+    printf("  Drops: %lu | drop to IP: last %lu ms, avg %lu ms, max %lu ms\n",
+           stats.drops, stats.last_drop_to_ip_ms, stats.avg_drop_to_ip_ms, stats.max_drop_to_ip_ms);
+    printf("  Direct connects: %lu (%lu fell back to scan) | NVS writes: %lu\n",
+           stats.direct_attempts, stats.direct_fallbacks, stats.nvs_writes);
+    
+    wifi_link_quality_t link;
+    wifi_module_get_link_quality(&link);
+    printf("  Link: %s (score %u, %lu changes) | RSSI %d dBm | gateway RTT %lu ms, loss %u%% | TCP retx %u%% | TX drop %u%%\n",
+           wifi_link_level_name(link.level), link.score, link.level_changes, link.rssi,
+           link.rtt_ms, link.loss_pct, link.retx_pct, link.tx_fail_pct);
+    
+    return 0;
+}
+
+// DNS cache command
+static int cmd_wifi_dns(int argc, char **argv)
+{
+    dns_cache_entry_t entries[DNS_CACHE_MAX_HOSTS];
+    int count = dns_cache_get_entries(entries, DNS_CACHE_MAX_HOSTS);
+    dns_cache_stats_t stats;
+    dns_cache_get_stats(&stats);
+
+    printf("DNS Cache (TTL cap %d s):\n", CONFIG_AG_WIFI_DNS_TTL_S);
+    for (int i = 0; i < count; i++) {
+        if (entries[i].valid) {
+            printf("  %-24s %-16s age %4" PRIu32 "/%" PRIu32 " s | last %" PRIu32 " ms | %" PRIu32 " ok, %" PRIu32 " failed\n",
+                   entries[i].host, entries[i].addr, entries[i].age_s, entries[i].ttl_s, entries[i].last_ms,
+                   entries[i].resolves, entries[i].failures);
+        } else {
+            printf("  %-24s %-16s %" PRIu32 " failed\n", entries[i].host, "unresolved", entries[i].failures);
+        }
+    }
+    printf("  Lookups: %" PRIu32 " (%" PRIu32 " hits, %" PRIu32 " misses) | %" PRIu32 " background refreshes | %" PRIu32 " failures\n",
+           stats.lookups, stats.hits, stats.misses, stats.refreshes, stats.failures);
+    printf("  Prefetch after GOT_IP: %" PRIu32 " ms\n", stats.prefetch_ms);
     return 0;
 }
 
+// Power-save policy command
+static int cmd_wifi_power(int argc, char **argv)
+{
+    wifi_power_stats_t stats;
+    wifi_power_get_stats(&stats);
+    if (!stats.enabled) {
+        printf("Power save: always off (CONFIG_AG_WIFI_POWER_POLICY disabled)\n");
+        return 0;
+    }
+
+    uint64_t total = (uint64_t)stats.none_ms + stats.modem_ms + stats.modem_session_ms;
+    uint32_t sleep_pct = total ? (uint32_t)((stats.modem_ms + stats.modem_session_ms) * 100 / total) : 0;
+    printf("Power Save Policy (grace %lu ms):\n", stats.grace_ms);
+    printf("  State: %s (%s)\n", wifi_power_state_name(stats.state),
+           wifi_power_policy_sleeps(stats.state) ? "min modem" : "off");
+    printf("  Off: %lu s | Modem sleep: %lu s idle, %lu s in session (%lu%%)\n",
+           stats.none_ms / 1000, stats.modem_ms / 1000, stats.modem_session_ms / 1000, sleep_pct);
+    printf("  Events: %lu | Wakes: %lu | Sleeps: %lu | set_ps on wake: %lu us (max %lu us)\n",
+           stats.events, stats.wakes, stats.sleeps, stats.last_switch_us, stats.max_switch_us);
+    printf("  Est. radio current: %lu mA avg vs %lu mA always on (model, see tools/ps_sim)\n",
+           stats.avg_ma, stats.none_ma);
+    return 0;
+}
+
+// Network bench command arguments
+static struct {
+    struct arg_str *host;
+    struct arg_int *port;
+    struct arg_int *seconds;
+    struct arg_str *tls;
+    struct arg_int *rate;
+    struct arg_lit *history;
+    struct arg_lit *clear;
+    struct arg_end *end;
+} net_bench_args;
+
+// One result row; prev is NULL when there is nothing to compare with
+static void print_bench_row(const char *name, uint32_t value, const char *unit, bool failed,
+                            const net_bench_result_t *prev, uint32_t prev_value, bool prev_failed)
+{
+    if (failed) {
+        printf("  %-14s %10s\n", name, "failed");
+        return;
+    }
+    printf("  %-14s %7lu %-3s", name, value, unit);
+    if (prev && !prev_failed && prev_value) {
+        printf("  (#%lu: %lu %s, %+ld%%)", prev->run, prev_value, unit,
+               (long)(((int64_t)value - prev_value) * 100 / prev_value));
+    }
+    printf("\n");
+}
+
+static void print_bench_result(const net_bench_result_t *r, const net_bench_result_t *prev)
+{
+#define ROW(name, field, unit, bit) \
+    print_bench_row(name, r->field, unit, r->failed & (bit), prev, prev ? prev->field : 0, \
+                    prev ? prev->failed & (bit) : true)
+    ROW("TCP RTT", tcp_rtt_us, "us", NET_BENCH_FAIL_TCP_RTT);
+    ROW("UDP RTT", udp_rtt_us, "us", NET_BENCH_FAIL_UDP_RTT);
+    ROW("TCP upload", tcp_up_kbps, "kbps", NET_BENCH_FAIL_TCP_UP);
+    ROW("TCP download", tcp_down_kbps, "kbps", NET_BENCH_FAIL_TCP_DOWN);
+    ROW("UDP upload", udp_up_kbps, "kbps", NET_BENCH_FAIL_UDP_UP);
+    ROW("UDP download", udp_down_kbps, "kbps", NET_BENCH_FAIL_UDP_DOWN);
+    ROW("TLS connect", tls_ms, "ms", NET_BENCH_FAIL_TLS);
+#undef ROW
+    printf("  RTT max: TCP %lu us, UDP %lu us (%u%% lost) | UDP loss: up %u%%, down %u%%\n",
+           r->tcp_rtt_max_us, r->udp_rtt_max_us, r->udp_rtt_loss_pct,
+           r->udp_up_loss_pct, r->udp_down_loss_pct);
+}
+
+static void print_bench_history(void)
+{
+    net_bench_result_t *runs = mem_calloc(NET_BENCH_HISTORY, sizeof(net_bench_result_t));
+    if (runs == NULL) {
+        printf("Out of memory\n");
+        return;
+    }
+    int count = net_bench_get_history(runs, NET_BENCH_HISTORY);
+    if (count == 0) {
+        printf("No stored runs\n");
+    } else {
+        printf("  %-4s | %-16s | %4s | %9s | %9s | %9s | %9s | %6s | %6s\n", "Run", "Host", "RSSI",
+               "TCP up", "TCP down", "UDP up", "UDP down", "RTT us", "TLS ms");
+    }
+    for (int i = 0; i < count; i++) {
+        const net_bench_result_t *r = &runs[i];
+        printf("  #%-3lu | %-16.16s | %4d | %9lu | %9lu | %9lu | %9lu | %6lu | %6lu%s\n", r->run, r->host,
+               r->rssi, r->tcp_up_kbps, r->tcp_down_kbps, r->udp_up_kbps, r->udp_down_kbps,
+               r->tcp_rtt_us, r->tls_ms, r->failed ? " *" : "");
+    }
+    if (count) {
+        printf("  Throughput in kbps; * some tests failed\n");
+    }
+    mem_free(runs);
+}
+
+// Network throughput self-test against tools/net_bench
+static int cmd_net_bench(int argc, char **argv)
+{
+    int nerrors = arg_parse(argc, argv, (void **)&net_bench_args);
+    if (nerrors != 0) {
+        arg_print_errors(stderr, net_bench_args.end, argv[0]);
+        return 1;
+    }
+    if (net_bench_args.clear->count) {
+        esp_err_t ret = net_bench_clear_history();
+        printf("%s\n", ret == ESP_OK ? "Stored runs cleared" : esp_err_to_name(ret));
+        return ret == ESP_OK ? 0 : 1;
+    }
+    if (net_bench_args.history->count) {
+        print_bench_history();
+        return 0;
+    }
+
+    const char *host = net_bench_args.host->count ? net_bench_args.host->sval[0] : CONFIG_AG_NET_BENCH_HOST;
+    if (host[0] == '\0') {
+        printf("No bench server: pass <host> or set CONFIG_AG_NET_BENCH_HOST\n");
+        return 1;
+    }
+    if (!wifi_module_is_connected()) {
+        printf("WiFi not connected\n");
+        return 1;
+    }
+    net_bench_cfg_t cfg = {
+        .host = host,
+        .port = net_bench_args.port->count ? net_bench_args.port->ival[0] : CONFIG_AG_NET_BENCH_PORT,
+        .duration_ms = (net_bench_args.seconds->count ? net_bench_args.seconds->ival[0] : 5) * 1000,
+        .udp_rate_kbps = net_bench_args.rate->count ? net_bench_args.rate->ival[0] : CONFIG_AG_NET_BENCH_UDP_KBPS,
+    };
+    if (cfg.duration_ms == 0 || cfg.duration_ms > 60000 || cfg.udp_rate_kbps == 0) {
+        printf("Duration must be 1-60 s and rate positive\n");
+        return 1;
+    }
+    // "--tls host:port" points the handshake at another server, e.g. the API host
+    char tls_host[NET_BENCH_HOST_LEN];
+    if (net_bench_args.tls->count) {
+        strlcpy(tls_host, net_bench_args.tls->sval[0], sizeof(tls_host));
+        char *colon = strrchr(tls_host, ':');
+        cfg.tls_port = 443;
+        if (colon) {
+            *colon = '\0';
+            cfg.tls_port = atoi(colon + 1);
+        }
+        cfg.tls_host = tls_host;
+    }
+
+    // Last stored run to compare with
+    net_bench_result_t *prev = mem_calloc(2, sizeof(net_bench_result_t));
+    if (prev == NULL) {
+        printf("Out of memory\n");
+        return 1;
+    }
+    bool have_prev = net_bench_get_history(prev, 1) == 1;
+    net_bench_result_t *result = &prev[1];
+
+    printf("Net bench to %s:%u, %lu s per throughput test...\n", host, cfg.port, cfg.duration_ms / 1000);
+    esp_err_t ret = net_bench_run(&cfg, result);
+    if (ret == ESP_OK) {
+        printf("Run #%lu | RSSI %d dBm, channel %u | TLS to %s:%u\n", result->run, result->rssi,
+               result->channel, cfg.tls_host ? cfg.tls_host : host, cfg.tls_port ? cfg.tls_port : cfg.port + 1);
+        print_bench_result(result, have_prev ? prev : NULL);
+    } else {
+        printf("Bench failed: %s (is tools/net_bench/net_bench_server.py running?)\n", esp_err_to_name(ret));
+    }
+    mem_free(prev);
+    return ret == ESP_OK ? 0 : 1;
+}
+
 // WiFi scan command
 static int cmd_wifi_scan(int argc, char **argv)
 {
@@ -235,6 +454,43 @@ esp_err_t wifi_register_commands(void)
     };
     ESP_ERROR_CHECK(esp_console_cmd_register(&wifi_scan_cmd));
     
+    // DNS cache command
+    const esp_console_cmd_t wifi_dns_cmd = {
+        .command = "wifi_dns",
+        .help = "Show pre-resolved service hosts and DNS cache hits",
+        .hint = NULL,
+        .func = &cmd_wifi_dns,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&wifi_dns_cmd));
+    
+    // Power-save policy command
+    const esp_console_cmd_t wifi_power_cmd = {
+        .command = "wifi_power",
+        .help = "Show the power-save policy state, time in modem sleep and estimated current",
+        .hint = NULL,
+        .func = &cmd_wifi_power,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&wifi_power_cmd));
+    
+    // Network bench command
+    net_bench_args.host = arg_str0(NULL, NULL, "<host>", "Bench server (default CONFIG_AG_NET_BENCH_HOST)");
+    net_bench_args.port = arg_int0("p", "port", "<port>", "TCP/UDP port, TLS on port + 1");
+    net_bench_args.seconds = arg_int0("t", "time", "<s>", "Seconds per throughput test (default 5)");
+    net_bench_args.tls = arg_str0(NULL, "tls", "<host:port>", "Time the TLS connect against another server");
+    net_bench_args.rate = arg_int0("r", "rate", "<kbps>", "UDP download rate");
+    net_bench_args.history = arg_lit0(NULL, "history", "Show stored runs");
+    net_bench_args.clear = arg_lit0(NULL, "clear", "Erase stored runs");
+    net_bench_args.end = arg_end(7);
+    
+    const esp_console_cmd_t net_bench_cmd = {
+        .command = "net_bench",
+        .help = "Measure TCP/UDP throughput, RTT and TLS connect time against the host bench server",
+        .hint = NULL,
+        .func = &cmd_net_bench,
+        .argtable = &net_bench_args
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&net_bench_cmd));
+    
     // WiFi auto-connect command
     const esp_console_cmd_t wifi_auto_cmd = {
         .command = "wifi_auto",
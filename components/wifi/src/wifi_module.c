@@ -1,11 +1,20 @@
 #include "wifi_module.h"
+#include "dns_cache.h"
+#include "wifi_power.h"
 #include <string.h>
+#include <inttypes.h>
 #include <esp_wifi.h>
 #include <esp_event.h>
 #include <esp_log.h>
 #include <esp_netif.h>
 #include <nvs.h>
 #include <nvs_flash.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "media_lib_os.h"
+#include "ping/ping_sock.h"
+#include "lwip/stats.h"
 #include "sdkconfig.h"
 static const char *TAG = "wifi_module";
 
@@ -13,6 +22,17 @@ static const char *TAG = "wifi_module";
 #define NVS_NAMESPACE "wifi_creds"
 #define NVS_KEY_SSID "ssid"
 #define NVS_KEY_PASS "password"
+#define NVS_KEY_ASSOC "assoc"
+
+// Last association, restored at boot so the station can skip the scan
+typedef struct {
+    uint8_t ssid[32];
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip;
+    uint32_t netmask;
+    uint32_t gw;
+} wifi_assoc_t;
 
 // Module state
 static struct {
@@ -22,8 +42,400 @@ static struct {
     wifi_config_t wifi_config;
     esp_event_handler_instance_t instance_any_id;
     esp_event_handler_instance_t instance_got_ip;
+    // Direct connect
+    wifi_assoc_t assoc;             // As stored in NVS
+    bool assoc_valid;
+    bool direct_pending;            // Connecting to assoc.bssid without a scan
+    int64_t connect_us;             // wifi_module_connect() call, 0 once GOT_IP
+    int64_t drop_us;                // Link lost, 0 while up
+    uint32_t recovered;
+    uint64_t drop_total_ms;
+    wifi_connect_stats_t stats;
 } wifi_state = {0};
 
+#define LINK_MAX_SUBSCRIBERS    4
+#define LINK_PING_WINDOW        16      // Pings per loss estimate
+#define LINK_FAIR_SCORE         40
+#define LINK_GOOD_SCORE         70
+#define LINK_RAISE_MARGIN       10      // Score points past a threshold before raising
+#define LINK_RAISE_SAMPLES      3
+
+typedef struct {
+    wifi_link_callback_t callback;
+    void *ctx;
+} link_subscriber_t;
+
+// Link monitor state; the lock guards what the ping task writes
+static struct {
+    portMUX_TYPE lock;
+    link_subscriber_t subscribers[LINK_MAX_SUBSCRIBERS];
+    wifi_link_quality_t quality;
+    esp_ping_handle_t ping;
+    uint32_t ping_gw;
+    uint16_t ping_lost;             // One bit per ping in the window, 1 = lost
+    uint8_t ping_count;
+    uint32_t rtt_ms;
+    uint8_t raise_count;
+    bool notify_pending;            // Publish once after GOT_IP
+    uint32_t tcp_xmit;              // lwIP counters at the previous sample
+    uint32_t tcp_rexmit;
+    uint32_t link_xmit;
+    uint32_t link_drop;
+} link_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+    .quality = {
+        .score = 100,
+        .level = WIFI_LINK_GOOD,
+    },
+};
+
+static void load_assoc(void)
+{
+    nvs_handle_t nvs_handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs_handle) != ESP_OK) {
+        return;
+    }
+    size_t length = sizeof(wifi_state.assoc);
+    wifi_state.assoc_valid = nvs_get_blob(nvs_handle, NVS_KEY_ASSOC, &wifi_state.assoc, &length) == ESP_OK &&
+                             length == sizeof(wifi_state.assoc);
+    nvs_close(nvs_handle);
+    if (wifi_state.assoc_valid) {
+        ESP_LOGI(TAG, "Last AP " MACSTR " on channel %u", MAC2STR(wifi_state.assoc.bssid),
+                 wifi_state.assoc.channel);
+    }
+}
+
+static void save_assoc(const wifi_assoc_t *assoc)
+{
+    nvs_handle_t nvs_handle;
+    esp_err_t ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
+    if (ret == ESP_OK) {
+        ret = nvs_set_blob(nvs_handle, NVS_KEY_ASSOC, assoc, sizeof(*assoc));
+        if (ret == ESP_OK) {
+            ret = nvs_commit(nvs_handle);
+        }
+        nvs_close(nvs_handle);
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to save association: %s", esp_err_to_name(ret));
+        return;
+    }
+    wifi_state.stats.nvs_writes++;
+    ESP_LOGI(TAG, "Association saved: " MACSTR " channel %u", MAC2STR(assoc->bssid), assoc->channel);
+}
+
+// Point the station config at the stored AP, or back to a full scan
+static void set_direct(bool direct)
+{
+    wifi_sta_config_t *sta = &wifi_state.wifi_config.sta;
+    if (direct) {
+        memcpy(sta->bssid, wifi_state.assoc.bssid, sizeof(sta->bssid));
+        sta->channel = wifi_state.assoc.channel;
+        wifi_state.stats.direct_attempts++;
+    } else {
+        memset(sta->bssid, 0, sizeof(sta->bssid));
+        sta->channel = 0;
+    }
+    sta->bssid_set = direct;
+    wifi_state.direct_pending = direct;
+}
+
+static bool assoc_matches_config(void)
+{
+    return wifi_state.assoc_valid &&
+           memcmp(wifi_state.assoc.ssid, wifi_state.wifi_config.sta.ssid, sizeof(wifi_state.assoc.ssid)) == 0;
+}
+
+// Retry after a disconnect: direct to the last AP first, a full scan if that fails
+static void reconnect_after(bool was_connected, uint8_t reason)
+{
+    if (wifi_state.direct_pending) {
+        ESP_LOGW(TAG, "Direct connect failed (reason %u), falling back to full scan", reason);
+        wifi_state.stats.direct_fallbacks++;
+        set_direct(false);
+        esp_wifi_set_config(WIFI_IF_STA, &wifi_state.wifi_config);
+    } else if (was_connected && assoc_matches_config()) {
+        set_direct(true);
+        esp_wifi_set_config(WIFI_IF_STA, &wifi_state.wifi_config);
+    }
+    esp_wifi_connect();
+}
+
+static void note_got_ip(const esp_netif_ip_info_t *ip_info)
+{
+    int64_t now = esp_timer_get_time();
+    wifi_connect_stats_t *stats = &wifi_state.stats;
+    if (stats->boot_to_ip_ms == 0) {
+        stats->boot_to_ip_ms = (uint32_t)(now / 1000);
+        ESP_LOGI(TAG, "Boot to IP: %lu ms", stats->boot_to_ip_ms);
+    }
+    if (wifi_state.connect_us) {
+        stats->connect_to_ip_ms = (uint32_t)((now - wifi_state.connect_us) / 1000);
+        wifi_state.connect_us = 0;
+    }
+    if (wifi_state.drop_us) {
+        uint32_t ms = (uint32_t)((now - wifi_state.drop_us) / 1000);
+        stats->last_drop_to_ip_ms = ms;
+        if (ms > stats->max_drop_to_ip_ms) {
+            stats->max_drop_to_ip_ms = ms;
+        }
+        wifi_state.drop_total_ms += ms;
+        wifi_state.recovered++;
+        stats->avg_drop_to_ip_ms = (uint32_t)(wifi_state.drop_total_ms / wifi_state.recovered);
+        wifi_state.drop_us = 0;
+        ESP_LOGI(TAG, "Drop to IP: %lu ms (%s)", ms, wifi_state.direct_pending ? "direct" : "scan");
+    }
+    stats->last_direct = wifi_state.direct_pending;
+    wifi_state.direct_pending = false;
+
+    wifi_assoc_t assoc;
+    memset(&assoc, 0, sizeof(assoc));
+    memcpy(assoc.ssid, wifi_state.wifi_config.sta.ssid, sizeof(assoc.ssid));
+    wifi_ap_record_t ap;
+    if (esp_wifi_sta_get_ap_info(&ap) == ESP_OK) {
+        memcpy(assoc.bssid, ap.bssid, sizeof(assoc.bssid));
+        assoc.channel = ap.primary;
+    }
+    assoc.ip = ip_info->ip.addr;
+    assoc.netmask = ip_info->netmask.addr;
+    assoc.gw = ip_info->gw.addr;
+    // Roaming, a channel change or a new lease; otherwise the flash is left alone
+    if (!wifi_state.assoc_valid || memcmp(&assoc, &wifi_state.assoc, sizeof(assoc)) != 0) {
+        wifi_state.assoc = assoc;
+        wifi_state.assoc_valid = true;
+        save_assoc(&assoc);
+    }
+}
+
+#ifdef CONFIG_AG_WIFI_LINK_MONITOR
+static void link_note_ping(bool ok, uint32_t rtt_ms)
+{
+    taskENTER_CRITICAL(&link_state.lock);
+    link_state.ping_lost = (link_state.ping_lost << 1) | !ok;
+    if (link_state.ping_count < LINK_PING_WINDOW) {
+        link_state.ping_count++;
+    }
+    if (ok) {
+        link_state.rtt_ms = link_state.rtt_ms ? (link_state.rtt_ms * 3 + rtt_ms) / 4 : rtt_ms;
+    }
+    taskEXIT_CRITICAL(&link_state.lock);
+}
+
+static void link_ping_success(esp_ping_handle_t hdl, void *args)
+{
+    uint32_t elapsed_ms = 0;
+    esp_ping_get_profile(hdl, ESP_PING_PROF_TIMEGAP, &elapsed_ms, sizeof(elapsed_ms));
+    link_note_ping(true, elapsed_ms);
+}
+
+static void link_ping_timeout(esp_ping_handle_t hdl, void *args)
+{
+    link_note_ping(false, 0);
+}
+
+static void link_ping_stop(void)
+{
+    if (link_state.ping) {
+        esp_ping_stop(link_state.ping);
+        esp_ping_delete_session(link_state.ping);
+        link_state.ping = NULL;
+    }
+}
+
+// In modem sleep the reply waits for the next DTIM beacon, so the RTT would
+// measure the sleep interval, and each ping would wake the radio. Drop the
+// window; RSSI and the lwIP counters carry the score until PS is off again.
+static bool link_ping_paused(void)
+{
+    wifi_ps_type_t ps = WIFI_PS_NONE;
+    if (esp_wifi_get_ps(&ps) != ESP_OK || ps == WIFI_PS_NONE) {
+        return false;
+    }
+    if (link_state.ping) {
+        link_ping_stop();
+        taskENTER_CRITICAL(&link_state.lock);
+        link_state.ping_lost = 0;
+        link_state.ping_count = 0;
+        link_state.rtt_ms = 0;
+        taskEXIT_CRITICAL(&link_state.lock);
+    }
+    return true;
+}
+
+// One ping per second to the gateway: RTT and loss of the WiFi hop itself
+static void link_ping_start(uint32_t gw)
+{
+    if (link_state.ping && link_state.ping_gw == gw) {
+        return;
+    }
+    link_ping_stop();
+    esp_ping_config_t cfg = ESP_PING_DEFAULT_CONFIG();
+    cfg.target_addr = (ip_addr_t)IPADDR4_INIT(gw);
+    cfg.count = ESP_PING_COUNT_INFINITE;
+    cfg.interval_ms = 1000;
+    cfg.timeout_ms = 1000;
+    cfg.data_size = 16;
+    esp_ping_callbacks_t cbs = {
+        .on_ping_success = link_ping_success,
+        .on_ping_timeout = link_ping_timeout,
+    };
+    if (esp_ping_new_session(&cfg, &cbs, &link_state.ping) != ESP_OK) {
+        ESP_LOGW(TAG, "Failed to create gateway ping session");
+        link_state.ping = NULL;
+        return;
+    }
+    link_state.ping_gw = gw;
+    esp_ping_start(link_state.ping);
+}
+
+static uint8_t clamp_score(int value)
+{
+    return value < 0 ? 0 : value > 100 ? 100 : value;
+}
+
+// Share of part in total since the previous sample
+static uint8_t delta_pct(uint32_t part, uint32_t *part_prev, uint32_t total, uint32_t *total_prev)
+{
+    uint32_t d_part = part - *part_prev;
+    uint32_t d_total = total - *total_prev;
+    *part_prev = part;
+    *total_prev = total;
+    if (d_total == 0) {
+        return 0;
+    }
+    return d_part >= d_total ? 100 : (uint8_t)(d_part * 100 / d_total);
+}
+
+static int link_min(int a, int b)
+{
+    return a < b ? a : b;
+}
+
+static wifi_link_level_t level_for(uint8_t score, int margin)
+{
+    if (score >= LINK_GOOD_SCORE + margin) {
+        return WIFI_LINK_GOOD;
+    }
+    if (score >= LINK_FAIR_SCORE + margin) {
+        return WIFI_LINK_FAIR;
+    }
+    return WIFI_LINK_POOR;
+}
+
+// Returns true when subscribers should hear about it
+static bool link_sample(wifi_link_quality_t *out)
+{
+    wifi_link_quality_t q = link_state.quality;
+
+    int rssi = 0;
+    q.rssi = esp_wifi_sta_get_rssi(&rssi) == ESP_OK ? rssi : 0;
+    taskENTER_CRITICAL(&link_state.lock);
+    int lost = __builtin_popcount(link_state.ping_lost & ((1u << link_state.ping_count) - 1));
+    q.loss_pct = link_state.ping_count ? lost * 100 / link_state.ping_count : 0;
+    q.rtt_ms = link_state.rtt_ms;
+    taskEXIT_CRITICAL(&link_state.lock);
+#if defined(CONFIG_LWIP_STATS) && TCP_STATS && LINK_STATS
+    q.retx_pct = delta_pct(lwip_stats.tcp.rexmit, &link_state.tcp_rexmit,
+                           lwip_stats.tcp.xmit, &link_state.tcp_xmit);
+    q.tx_fail_pct = delta_pct(lwip_stats.link.drop, &link_state.link_drop,
+                              lwip_stats.link.xmit, &link_state.link_xmit);
+#endif
+
+    // The worst input sets the score: one bad factor is enough to hurt media
+    int score = 100;
+    if (q.rssi) {
+        score = link_min(score, (q.rssi + 90) * 100 / 40);       // -90 dBm -> 0, -50 dBm -> 100
+    }
+    if (link_state.ping_count >= 4) {
+        score = link_min(score, 100 - q.loss_pct * 5);           // 20 % loss -> 0
+    }
+    if (q.rtt_ms > 20) {
+        score = link_min(score, 100 - ((int)q.rtt_ms - 20) * 100 / 280);  // 300 ms -> 0
+    }
+    score = link_min(score, 100 - q.retx_pct * 10);
+    score = link_min(score, 100 - q.tx_fail_pct * 10);
+    q.score = clamp_score((q.score * 2 + clamp_score(score)) / 3);
+
+    // Drop at once, rise only when the score holds above the next threshold
+    wifi_link_level_t level = q.level;
+    if (level_for(q.score, 0) < level) {
+        level = level_for(q.score, 0);
+        link_state.raise_count = 0;
+    } else if (level_for(q.score, LINK_RAISE_MARGIN) > level) {
+        if (++link_state.raise_count >= LINK_RAISE_SAMPLES) {
+            level = level_for(q.score, LINK_RAISE_MARGIN);
+            link_state.raise_count = 0;
+        }
+    } else {
+        link_state.raise_count = 0;
+    }
+    bool changed = level != q.level;
+    if (changed) {
+        q.level_changes++;
+        ESP_LOGI(TAG, "Link %s -> %s (score %u, rssi %d, rtt %" PRIu32 " ms, loss %u%%)",
+                 wifi_link_level_name(q.level), wifi_link_level_name(level), q.score, q.rssi,
+                 q.rtt_ms, q.loss_pct);
+        q.level = level;
+    }
+
+    taskENTER_CRITICAL(&link_state.lock);
+    link_state.quality = q;
+    bool notify = changed || link_state.notify_pending;
+    link_state.notify_pending = false;
+    taskEXIT_CRITICAL(&link_state.lock);
+    *out = q;
+    return notify;
+}
+
+static void link_monitor_task(void *arg)
+{
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(CONFIG_AG_WIFI_LINK_SAMPLE_MS));
+        if (!wifi_state.connected) {
+            link_ping_stop();
+            continue;
+        }
+        if (!link_ping_paused()) {
+            link_ping_start(wifi_state.assoc.gw);
+        }
+
+        wifi_link_quality_t q;
+        if (!link_sample(&q)) {
+            continue;
+        }
+        link_subscriber_t subscribers[LINK_MAX_SUBSCRIBERS];
+        taskENTER_CRITICAL(&link_state.lock);
+        memcpy(subscribers, link_state.subscribers, sizeof(subscribers));
+        taskEXIT_CRITICAL(&link_state.lock);
+        for (int i = 0; i < LINK_MAX_SUBSCRIBERS; i++) {
+            if (subscribers[i].callback) {
+                subscribers[i].callback(&q, subscribers[i].ctx);
+            }
+        }
+    }
+}
+#endif
+
+// New association: start from full quality and tell subscribers once
+static void link_note_up(void)
+{
+    taskENTER_CRITICAL(&link_state.lock);
+    link_state.ping_lost = 0;
+    link_state.ping_count = 0;
+    link_state.rtt_ms = 0;
+    link_state.raise_count = 0;
+    link_state.quality.score = 100;
+    link_state.quality.level = WIFI_LINK_GOOD;
+    link_state.notify_pending = true;
+#if defined(CONFIG_LWIP_STATS) && TCP_STATS && LINK_STATS
+    link_state.tcp_xmit = lwip_stats.tcp.xmit;
+    link_state.tcp_rexmit = lwip_stats.tcp.rexmit;
+    link_state.link_xmit = lwip_stats.link.xmit;
+    link_state.link_drop = lwip_stats.link.drop;
+#endif
+    taskEXIT_CRITICAL(&link_state.lock);
+}
+
 // Event handler
 static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                                int32_t event_id, void *event_data)
@@ -35,14 +447,22 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
                 esp_wifi_connect();
                 break;
                 
-            case WIFI_EVENT_STA_DISCONNECTED:
-                ESP_LOGI(TAG, "WiFi disconnected, retrying...");
+            case WIFI_EVENT_STA_DISCONNECTED: {
+                wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+                ESP_LOGI(TAG, "WiFi disconnected (reason %u), retrying...", event->reason);
+                bool was_connected = wifi_state.connected;
                 wifi_state.connected = false;
+                if (was_connected) {
+                    wifi_state.drop_us = esp_timer_get_time();
+                    wifi_state.stats.drops++;
+                }
+                dns_cache_note_link(false);
                 if (wifi_state.event_callback) {
                     wifi_state.event_callback(false);
                 }
-                esp_wifi_connect();
+                reconnect_after(was_connected, event->reason);
                 break;
+            }
                 
             case WIFI_EVENT_STA_CONNECTED:
                 ESP_LOGI(TAG, "WiFi connected to AP");
@@ -55,10 +475,14 @@ static void wifi_event_handler(void *arg, esp_event_base_t event_base,
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
         wifi_state.connected = true;
+        note_got_ip(&event->ip_info);
+        link_note_up();
+        // Resolve service hosts while the application starts its session
+        dns_cache_note_link(true);
         if (wifi_state.event_callback) {
             wifi_state.event_callback(true);
         }
-        // Auto-save credentials on successful connection
+        // Auto-save credentials on successful connection; a no-op when unchanged
         wifi_module_save_credentials();
     }
 }
@@ -89,6 +513,11 @@ esp_err_t wifi_module_init(wifi_event_callback_t callback)
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
     
+    // Credentials and the last AP live in our own namespace; keep the driver
+    // from rewriting its copy of the config on every esp_wifi_set_config()
+    ESP_ERROR_CHECK(esp_wifi_set_storage(WIFI_STORAGE_RAM));
+    load_assoc();
+    
     // Register event handlers
     ESP_ERROR_CHECK(esp_event_handler_instance_register(
         WIFI_EVENT,
@@ -104,11 +533,23 @@ esp_err_t wifi_module_init(wifi_event_callback_t callback)
         NULL,
         &wifi_state.instance_got_ip));
     
+    ret = dns_cache_init();
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    
+#ifdef CONFIG_AG_WIFI_LINK_MONITOR
+    if (media_lib_thread_create_from_scheduler(NULL, "link_mon", link_monitor_task, NULL) != 0) {
+        ESP_LOGE(TAG, "Failed to create link monitor task");
+        return ESP_FAIL;
+    }
+#endif
+    
     // Set WiFi mode to station
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     
-    // Disable power save for better performance
-    ESP_ERROR_CHECK(esp_wifi_set_ps(WIFI_PS_NONE));
+    // Power save stays off until conversation events let the policy sleep
+    ESP_ERROR_CHECK(wifi_power_init());
     
     // Store callback
     wifi_state.event_callback = callback;
@@ -149,6 +590,14 @@ esp_err_t wifi_module_connect(const char *ssid, const char *password)
     wifi_state.wifi_config.sta.threshold.authmode = 
         (password && strlen(password) > 0) ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
     
+    // Same network as last time: associate with the known AP on its channel, no scan
+    set_direct(assoc_matches_config());
+    if (wifi_state.direct_pending) {
+        ESP_LOGI(TAG, "Direct connect to " MACSTR " on channel %u",
+                 MAC2STR(wifi_state.assoc.bssid), wifi_state.assoc.channel);
+    }
+    wifi_state.connect_us = esp_timer_get_time();
+    
     // Stop WiFi if running
     esp_wifi_stop();
     
@@ -186,6 +635,19 @@ esp_err_t wifi_module_disconnect(void)
     return ESP_OK;
 }
 
+esp_err_t wifi_module_drop_link(void)
+{
+    if (!wifi_state.initialized || !wifi_state.connected) {
+        ESP_LOGE(TAG, "WiFi not connected");
+        return ESP_ERR_INVALID_STATE;
+    }
+    
+    ESP_LOGI(TAG, "Dropping WiFi link");
+    
+    // STA_DISCONNECTED handler reconnects on its own
+    return esp_wifi_disconnect();
+}
+
 bool wifi_module_is_connected(void)
 {
     return wifi_state.connected;
@@ -205,19 +667,34 @@ esp_err_t wifi_module_get_credentials(wifi_credentials_t *credentials)
     return ESP_OK;
 }
 
+static bool nvs_str_matches(nvs_handle_t nvs_handle, const char *key, const char *value)
+{
+    char stored[sizeof(((wifi_sta_config_t *)0)->password) + 1];
+    size_t length = sizeof(stored);
+    return nvs_get_str(nvs_handle, key, stored, &length) == ESP_OK && strcmp(stored, value) == 0;
+}
+
 esp_err_t wifi_module_save_credentials(void)
 {
     nvs_handle_t nvs_handle;
     esp_err_t ret;
     
-    ESP_LOGI(TAG, "Saving WiFi credentials to NVS");
-    
     ret = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Failed to open NVS: %s", esp_err_to_name(ret));
         return ret;
     }
     
+    // Every GOT_IP lands here; only write when the network actually changed
+    if (nvs_str_matches(nvs_handle, NVS_KEY_SSID, (char *)wifi_state.wifi_config.sta.ssid) &&
+        nvs_str_matches(nvs_handle, NVS_KEY_PASS, (char *)wifi_state.wifi_config.sta.password)) {
+        nvs_close(nvs_handle);
+        ESP_LOGD(TAG, "WiFi credentials unchanged");
+        return ESP_OK;
+    }
+    
+    ESP_LOGI(TAG, "Saving WiFi credentials to NVS");
+    
     // Save SSID
     ret = nvs_set_str(nvs_handle, NVS_KEY_SSID, 
                      (char *)wifi_state.wifi_config.sta.ssid);
@@ -243,6 +720,7 @@ esp_err_t wifi_module_save_credentials(void)
     }
     
     nvs_close(nvs_handle);
+    wifi_state.stats.nvs_writes++;
     ESP_LOGI(TAG, "WiFi credentials saved");
     return ret;
 }
@@ -308,8 +786,10 @@ esp_err_t wifi_module_clear_credentials(void)
     
     nvs_erase_key(nvs_handle, NVS_KEY_SSID);
     nvs_erase_key(nvs_handle, NVS_KEY_PASS);
+    nvs_erase_key(nvs_handle, NVS_KEY_ASSOC);
     nvs_commit(nvs_handle);
     nvs_close(nvs_handle);
+    wifi_state.assoc_valid = false;
     
     ESP_LOGI(TAG, "WiFi credentials cleared");
     return ESP_OK;
@@ -323,4 +803,51 @@ esp_err_t wifi_module_get_mac(uint8_t mac[6])
     }
     
     return esp_wifi_get_mac(WIFI_IF_STA, mac);
-}
\ No newline at end of file
+}
+
+void wifi_module_get_connect_stats(wifi_connect_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    *stats = wifi_state.stats;
+    stats->has_assoc = wifi_state.assoc_valid;
+    memcpy(stats->bssid, wifi_state.assoc.bssid, sizeof(stats->bssid));
+    stats->channel = wifi_state.assoc.channel;
+    stats->lease_ip = wifi_state.assoc.ip;
+}
+
+const char *wifi_link_level_name(wifi_link_level_t level)
+{
+    static const char *names[] = {"poor", "fair", "good"};
+    return level <= WIFI_LINK_GOOD ? names[level] : "unknown";
+}
+
+esp_err_t wifi_module_link_subscribe(wifi_link_callback_t callback, void *ctx)
+{
+    if (!callback) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    taskENTER_CRITICAL(&link_state.lock);
+    for (int i = 0; i < LINK_MAX_SUBSCRIBERS; i++) {
+        if (link_state.subscribers[i].callback == NULL) {
+            link_state.subscribers[i].callback = callback;
+            link_state.subscribers[i].ctx = ctx;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    taskEXIT_CRITICAL(&link_state.lock);
+    return ret;
+}
+
+void wifi_module_get_link_quality(wifi_link_quality_t *quality)
+{
+    if (!quality) {
+        return;
+    }
+    taskENTER_CRITICAL(&link_state.lock);
+    *quality = link_state.quality;
+    taskEXIT_CRITICAL(&link_state.lock);
+}
@@ -0,0 +1,157 @@
+#include "wifi_power.h"
+#include <esp_log.h>
+#include <esp_wifi.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "wifi_power";
+
+// Module state; the mutex covers the policy, the accounting and esp_wifi_set_ps()
+static struct {
+    SemaphoreHandle_t mutex;
+    esp_timer_handle_t grace_timer;
+    wifi_power_policy_t policy;
+    uint32_t account_ms;            // Time already booked into the stats
+    wifi_power_stats_t stats;
+} power_state = {0};
+
+static uint32_t now_ms(void)
+{
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+// Call with the mutex held; books the time since the last call to the current mode
+static void account(uint32_t now)
+{
+    uint32_t elapsed = now - power_state.account_ms;
+    power_state.account_ms = now;
+    if (!wifi_power_policy_sleeps(power_state.stats.state)) {
+        power_state.stats.none_ms += elapsed;
+    } else if (power_state.policy.in_session) {
+        power_state.stats.modem_session_ms += elapsed;
+    } else {
+        power_state.stats.modem_ms += elapsed;
+    }
+}
+
+// Call with the mutex held
+static void apply(wifi_power_state_t state, uint32_t now)
+{
+    wifi_power_state_t prev = power_state.stats.state;
+    if (state == WIFI_POWER_GRACE) {
+        esp_timer_stop(power_state.grace_timer);
+        esp_timer_start_once(power_state.grace_timer,
+                             (uint64_t)(power_state.policy.grace_until_ms - now) * 1000);
+    } else if (prev == WIFI_POWER_GRACE) {
+        esp_timer_stop(power_state.grace_timer);
+    }
+    power_state.stats.state = state;
+
+    bool sleep = wifi_power_policy_sleeps(state);
+    if (sleep == wifi_power_policy_sleeps(prev)) {
+        return;
+    }
+    int64_t start = esp_timer_get_time();
+    esp_err_t ret = esp_wifi_set_ps(sleep ? WIFI_PS_MIN_MODEM : WIFI_PS_NONE);
+    uint32_t switch_us = (uint32_t)(esp_timer_get_time() - start);
+    if (ret != ESP_OK) {
+        ESP_LOGW(TAG, "esp_wifi_set_ps failed: %s", esp_err_to_name(ret));
+    }
+    if (sleep) {
+        power_state.stats.sleeps++;
+    } else {
+        power_state.stats.wakes++;
+        power_state.stats.last_switch_us = switch_us;
+        if (switch_us > power_state.stats.max_switch_us) {
+            power_state.stats.max_switch_us = switch_us;
+        }
+    }
+    ESP_LOGI(TAG, "Power save %s (%s)", sleep ? "min modem" : "off", wifi_power_state_name(state));
+}
+
+static void grace_timer_cb(void *arg)
+{
+    xSemaphoreTake(power_state.mutex, portMAX_DELAY);
+    uint32_t now = now_ms();
+    account(now);
+    apply(wifi_power_policy_tick(&power_state.policy, now), now);
+    xSemaphoreGive(power_state.mutex);
+}
+
+esp_err_t wifi_power_init(void)
+{
+    // Start fully on; the policy only takes over once it exists
+    esp_err_t ret = esp_wifi_set_ps(WIFI_PS_NONE);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+#ifdef CONFIG_AG_WIFI_POWER_POLICY
+    if (power_state.mutex) {
+        return ESP_OK;
+    }
+    power_state.mutex = xSemaphoreCreateMutex();
+    if (power_state.mutex == NULL) {
+        ESP_LOGE(TAG, "Failed to create power policy mutex");
+        return ESP_ERR_NO_MEM;
+    }
+    const esp_timer_create_args_t timer_args = {
+        .callback = grace_timer_cb,
+        .name = "ps_grace",
+    };
+    ret = esp_timer_create(&timer_args, &power_state.grace_timer);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create grace timer: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    uint32_t now = now_ms();
+    power_state.account_ms = now;
+    power_state.stats.enabled = true;
+    power_state.stats.grace_ms = CONFIG_AG_WIFI_POWER_GRACE_MS;
+    wifi_power_policy_init(&power_state.policy, CONFIG_AG_WIFI_POWER_GRACE_MS, now);
+    // Boot connects inside the first grace window
+    apply(power_state.policy.state, now);
+    ESP_LOGI(TAG, "Power-save policy on, %d ms grace", CONFIG_AG_WIFI_POWER_GRACE_MS);
+#endif
+    return ESP_OK;
+}
+
+void wifi_power_note(wifi_power_event_t event)
+{
+    if (power_state.mutex == NULL) {
+        return;
+    }
+    xSemaphoreTake(power_state.mutex, portMAX_DELAY);
+    uint32_t now = now_ms();
+    // Same "<ms> <event>" lines tools/ps_sim replays
+    ESP_LOGD(TAG, "%lu %s", now, wifi_power_event_name(event));
+    account(now);
+    power_state.stats.events++;
+    apply(wifi_power_policy_event(&power_state.policy, event, now), now);
+    xSemaphoreGive(power_state.mutex);
+}
+
+void wifi_power_get_stats(wifi_power_stats_t *stats)
+{
+    if (!stats) {
+        return;
+    }
+    if (power_state.mutex == NULL) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+    xSemaphoreTake(power_state.mutex, portMAX_DELAY);
+    account(now_ms());
+    *stats = power_state.stats;
+    xSemaphoreGive(power_state.mutex);
+
+    uint64_t total = (uint64_t)stats->none_ms + stats->modem_ms + stats->modem_session_ms;
+    if (total) {
+        stats->avg_ma = (uint32_t)(((uint64_t)stats->none_ms * WIFI_POWER_NONE_MA +
+                                    (uint64_t)stats->modem_ms * WIFI_POWER_MODEM_MA +
+                                    (uint64_t)stats->modem_session_ms * WIFI_POWER_MODEM_STREAM_MA) / total);
+        stats->none_ma = WIFI_POWER_NONE_MA;
+    }
+}
@@ -0,0 +1,101 @@
+#include "wifi_power_policy.h"
+#include <string.h>
+
+static const char *event_names[WIFI_POWER_EVENT_MAX] = {
+    "session_start", "session_ready", "session_stop",
+    "speech_started", "speech_stopped",
+    "response_created", "response_done",
+    "audio_started", "audio_stopped",
+};
+
+static bool turn_active(const wifi_power_policy_t *policy)
+{
+    return policy->connecting || policy->speaking || policy->responding || policy->playing;
+}
+
+// Re-evaluate after a flag change; grace restarts from the moment the last turn flag clears
+static wifi_power_state_t settle(wifi_power_policy_t *policy, uint32_t now_ms)
+{
+    if (turn_active(policy)) {
+        policy->state = WIFI_POWER_ACTIVE;
+    } else if (policy->state == WIFI_POWER_ACTIVE) {
+        policy->state = WIFI_POWER_GRACE;
+        policy->grace_until_ms = now_ms + policy->grace_ms;
+    }
+    return policy->state;
+}
+
+void wifi_power_policy_init(wifi_power_policy_t *policy, uint32_t grace_ms, uint32_t now_ms)
+{
+    memset(policy, 0, sizeof(*policy));
+    policy->grace_ms = grace_ms;
+    policy->state = WIFI_POWER_GRACE;
+    policy->grace_until_ms = now_ms + grace_ms;
+}
+
+wifi_power_state_t wifi_power_policy_event(wifi_power_policy_t *policy, wifi_power_event_t event,
+                                           uint32_t now_ms)
+{
+    switch (event) {
+        case WIFI_POWER_SESSION_START:
+            // A new peer has no turn in flight, whatever the old one left behind
+            policy->in_session = true;
+            policy->connecting = true;
+            policy->speaking = false;
+            policy->responding = false;
+            policy->playing = false;
+            break;
+        case WIFI_POWER_SESSION_READY:
+            policy->connecting = false;
+            break;
+        case WIFI_POWER_SESSION_STOP:
+            // Nothing left to be responsive for: sleep without a grace window
+            policy->in_session = false;
+            policy->connecting = false;
+            policy->speaking = false;
+            policy->responding = false;
+            policy->playing = false;
+            policy->state = WIFI_POWER_IDLE;
+            return policy->state;
+        case WIFI_POWER_SPEECH_START:
+            policy->speaking = true;
+            break;
+        case WIFI_POWER_SPEECH_STOP:
+            policy->speaking = false;
+            break;
+        case WIFI_POWER_RESPONSE_START:
+            policy->responding = true;
+            break;
+        case WIFI_POWER_RESPONSE_DONE:
+            policy->responding = false;
+            break;
+        case WIFI_POWER_PLAYBACK_START:
+            policy->playing = true;
+            break;
+        case WIFI_POWER_PLAYBACK_STOP:
+            policy->playing = false;
+            break;
+        default:
+            return policy->state;
+    }
+    return settle(policy, now_ms);
+}
+
+wifi_power_state_t wifi_power_policy_tick(wifi_power_policy_t *policy, uint32_t now_ms)
+{
+    if (policy->state == WIFI_POWER_GRACE && (int32_t)(now_ms - policy->grace_until_ms) >= 0) {
+        policy->state = WIFI_POWER_IDLE;
+    }
+    return policy->state;
+}
+
+const char *wifi_power_event_name(wifi_power_event_t event)
+{
+    return event < WIFI_POWER_EVENT_MAX ? event_names[event] : "unknown";
+}
+
+const char *wifi_power_state_name(wifi_power_state_t state)
+{
+    static const char *names[] = {"active", "grace", "idle"};
+    return state <= WIFI_POWER_IDLE ? names[state] : "unknown";
+}
@@ -0,0 +1,25 @@
+#include "codec_board.h"
+#include <string.h>
+
+void set_codec_board_type(const char *codec_type)
+{
+}
+
+int get_i2c_pin(uint8_t port, codec_i2c_pin_t *i2c_pin)
+{
+    if (i2c_pin == NULL) {
+        return -1;
+    }
+    i2c_pin->sda = -1;
+    i2c_pin->scl = -1;
+    return 0;
+}
+
+int get_camera_cfg(camera_cfg_t *cam_cfg)
+{
+    if (cam_cfg == NULL) {
+        return -1;
+    }
+    memset(cam_cfg, 0xff, sizeof(*cam_cfg));    // All pins -1
+    return 0;
+}
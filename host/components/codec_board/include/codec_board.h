@@ -0,0 +1,47 @@
+#ifndef CODEC_BOARD_H
+#define CODEC_BOARD_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host subset of codec_board: the camera lookups camera_module.c makes
+ *
+ * Every pin is -1; the esp_camera stand-in does not use them.
+ */
+
+typedef struct {
+    int16_t sda;
+    int16_t scl;
+} codec_i2c_pin_t;
+
+typedef struct {
+    int16_t pwr;
+    int16_t reset;
+    int16_t xclk;
+    int16_t data[8];
+    int16_t vsync;
+    int16_t href;
+    int16_t pclk;
+} camera_cfg_t;
+
+void set_codec_board_type(const char *codec_type);
+
+/**
+ * @return 0 on success
+ */
+int get_i2c_pin(uint8_t port, codec_i2c_pin_t *i2c_pin);
+
+/**
+ * @return 0 on success
+ */
+int get_camera_cfg(camera_cfg_t *cam_cfg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // CODEC_BOARD_H
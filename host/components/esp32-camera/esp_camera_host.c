@@ -0,0 +1,247 @@
+#include "esp_camera.h"
+#include <esp_log.h>
+#include <dirent.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "camera_host";
+
+#define CAM_MAX_FILES       64
+#define CAM_MAX_FB          4
+#define CAM_PATH_MAX        256
+#define CAM_DEFAULT_DIR     "frames"
+#define CAM_DEFAULT_FPS     25
+
+typedef struct {
+    uint8_t *data;
+    size_t len;
+    uint16_t width;
+    uint16_t height;
+} cam_file_t;
+
+static struct {
+    bool initialized;
+    cam_file_t files[CAM_MAX_FILES];
+    int file_count;
+    int next_file;
+    camera_fb_t fbs[CAM_MAX_FB];
+    bool fb_held[CAM_MAX_FB];
+    int fb_count;
+    int64_t frame_us;
+    int64_t next_frame_us;
+    portMUX_TYPE lock;
+    sensor_t sensor;
+} cam_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static int sensor_set_framesize(sensor_t *sensor, framesize_t framesize)
+{
+    return 0;
+}
+
+static int sensor_set_quality(sensor_t *sensor, int quality)
+{
+    return 0;
+}
+
+// Frame size from the first SOFn marker; 0x0 if there is none
+static void jpeg_dimensions(const uint8_t *data, size_t len, uint16_t *width, uint16_t *height)
+{
+    *width = 0;
+    *height = 0;
+    size_t i = 2;
+    while (i + 9 < len) {
+        if (data[i] != 0xFF) {
+            i++;
+            continue;
+        }
+        uint8_t marker = data[i + 1];
+        if (marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) {
+            *height = (data[i + 5] << 8) | data[i + 6];
+            *width = (data[i + 7] << 8) | data[i + 8];
+            return;
+        }
+        if (marker == 0xFF || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD9)) {
+            i += (marker == 0xFF) ? 1 : 2;
+            continue;
+        }
+        i += 2 + ((data[i + 2] << 8) | data[i + 3]);
+    }
+}
+
+static bool is_jpeg_name(const char *name)
+{
+    const char *dot = strrchr(name, '.');
+    return dot && (strcasecmp(dot, ".jpg") == 0 || strcasecmp(dot, ".jpeg") == 0);
+}
+
+static int compare_names(const void *a, const void *b)
+{
+    return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static bool load_file(const char *path, cam_file_t *file)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    uint8_t *data = len > 4 ? malloc(len) : NULL;
+    bool ok = data && fread(data, 1, len, f) == (size_t)len && data[0] == 0xFF && data[1] == 0xD8;
+    fclose(f);
+    if (!ok) {
+        free(data);
+        return false;
+    }
+    file->data = data;
+    file->len = len;
+    jpeg_dimensions(data, len, &file->width, &file->height);
+    return true;
+}
+
+static esp_err_t load_directory(const char *dir_path)
+{
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        ESP_LOGE(TAG, "Cannot open frame directory %s (set AG_HOST_CAMERA_DIR)", dir_path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    char *names[CAM_MAX_FILES];
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL && count < CAM_MAX_FILES) {
+        if (is_jpeg_name(entry->d_name)) {
+            names[count++] = strdup(entry->d_name);
+        }
+    }
+    closedir(dir);
+    qsort(names, count, sizeof(names[0]), compare_names);
+
+    char path[CAM_PATH_MAX];
+    for (int i = 0; i < count; i++) {
+        snprintf(path, sizeof(path), "%s/%s", dir_path, names[i]);
+        if (load_file(path, &cam_state.files[cam_state.file_count])) {
+            cam_state.file_count++;
+        } else {
+            ESP_LOGW(TAG, "Skipping %s: not a JPEG file", path);
+        }
+        free(names[i]);
+    }
+    if (cam_state.file_count == 0) {
+        ESP_LOGE(TAG, "No JPEG files in %s", dir_path);
+        return ESP_ERR_NOT_FOUND;
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_init(const camera_config_t *config)
+{
+    if (config == NULL || config->pixel_format != PIXFORMAT_JPEG) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (cam_state.initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    const char *dir = getenv("AG_HOST_CAMERA_DIR");
+    esp_err_t ret = load_directory(dir ? dir : CAM_DEFAULT_DIR);
+    if (ret != ESP_OK) {
+        esp_camera_deinit();
+        return ret;
+    }
+
+    const char *fps_env = getenv("AG_HOST_CAMERA_FPS");
+    int fps = fps_env ? atoi(fps_env) : CAM_DEFAULT_FPS;
+    cam_state.frame_us = fps > 0 ? 1000000 / fps : 0;
+    cam_state.next_frame_us = esp_timer_get_time();
+    cam_state.fb_count = config->fb_count < 1 ? 1 : (config->fb_count > CAM_MAX_FB ? CAM_MAX_FB : config->fb_count);
+    cam_state.next_file = 0;
+    cam_state.sensor.set_framesize = sensor_set_framesize;
+    cam_state.sensor.set_quality = sensor_set_quality;
+    cam_state.initialized = true;
+
+    ESP_LOGI(TAG, "Serving %d JPEG files from %s at %d fps (first %ux%u)",
+             cam_state.file_count, dir ? dir : CAM_DEFAULT_DIR, fps,
+             cam_state.files[0].width, cam_state.files[0].height);
+    return ESP_OK;
+}
+
+esp_err_t esp_camera_deinit(void)
+{
+    for (int i = 0; i < cam_state.file_count; i++) {
+        free(cam_state.files[i].data);
+    }
+    memset(cam_state.files, 0, sizeof(cam_state.files));
+    memset(cam_state.fb_held, 0, sizeof(cam_state.fb_held));
+    cam_state.file_count = 0;
+    cam_state.initialized = false;
+    return ESP_OK;
+}
+
+camera_fb_t *esp_camera_fb_get(void)
+{
+    if (!cam_state.initialized) {
+        return NULL;
+    }
+
+    // A free-running sensor: the next frame is ready one period after the last
+    int64_t now = esp_timer_get_time();
+    camera_fb_t *fb = NULL;
+    taskENTER_CRITICAL(&cam_state.lock);
+    int64_t due = cam_state.next_frame_us > now ? cam_state.next_frame_us : now;
+    cam_state.next_frame_us = due + cam_state.frame_us;
+    for (int i = 0; i < cam_state.fb_count; i++) {
+        if (!cam_state.fb_held[i]) {
+            cam_state.fb_held[i] = true;
+            fb = &cam_state.fbs[i];
+            break;
+        }
+    }
+    const cam_file_t *file = &cam_state.files[cam_state.next_file];
+    if (fb) {
+        cam_state.next_file = (cam_state.next_file + 1) % cam_state.file_count;
+    }
+    taskEXIT_CRITICAL(&cam_state.lock);
+
+    if (due > now) {
+        vTaskDelay(pdMS_TO_TICKS((due - now + 999) / 1000));
+    }
+
+    if (fb == NULL) {
+        ESP_LOGW(TAG, "All %d frame buffers are held", cam_state.fb_count);
+        return NULL;
+    }
+    fb->buf = file->data;
+    fb->len = file->len;
+    fb->width = file->width;
+    fb->height = file->height;
+    fb->format = PIXFORMAT_JPEG;
+    fb->timestamp.tv_sec = due / 1000000;
+    fb->timestamp.tv_usec = due % 1000000;
+    return fb;
+}
+
+void esp_camera_fb_return(camera_fb_t *fb)
+{
+    if (fb == NULL || fb < cam_state.fbs || fb >= cam_state.fbs + CAM_MAX_FB) {
+        return;
+    }
+    taskENTER_CRITICAL(&cam_state.lock);
+    cam_state.fb_held[fb - cam_state.fbs] = false;
+    taskEXIT_CRITICAL(&cam_state.lock);
+}
+
+sensor_t *esp_camera_sensor_get(void)
+{
+    return cam_state.initialized ? &cam_state.sensor : NULL;
+}
@@ -0,0 +1,27 @@
+#ifndef ESP_CAPTURE_H
+#define ESP_CAPTURE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host subset of esp_capture: the format ids carried in cam_frame_t
+ *
+ * The capture pipeline itself is not built on the Linux target.
+ */
+typedef enum {
+    ESP_CAPTURE_FMT_ID_NONE,
+    ESP_CAPTURE_FMT_ID_PCM,
+    ESP_CAPTURE_FMT_ID_OPUS,
+    ESP_CAPTURE_FMT_ID_G711A,
+    ESP_CAPTURE_FMT_ID_G711U,
+    ESP_CAPTURE_FMT_ID_H264,
+    ESP_CAPTURE_FMT_ID_MJPEG,
+} esp_capture_format_id_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_CAPTURE_H
@@ -0,0 +1,163 @@
+#include "esp_codec_dev.h"
+#include <esp_log.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "codec_dev_host";
+
+typedef struct {
+    esp_codec_dev_type_t dev_type;
+    const audio_codec_data_if_t *data_if;
+    esp_codec_dev_sample_info_t fs;
+    bool is_open;
+    int volume;
+    bool out_mute;
+    float in_gain;
+    bool in_mute;
+} codec_dev_t;
+
+esp_codec_dev_handle_t esp_codec_dev_new(esp_codec_dev_cfg_t *codec_dev_cfg)
+{
+    if (codec_dev_cfg == NULL || codec_dev_cfg->data_if == NULL ||
+        codec_dev_cfg->dev_type == ESP_CODEC_DEV_TYPE_NONE) {
+        ESP_LOGE(TAG, "A data interface and a device type are required");
+        return NULL;
+    }
+    if (codec_dev_cfg->codec_if) {
+        ESP_LOGE(TAG, "Codec chips are not emulated on the host");
+        return NULL;
+    }
+    codec_dev_t *dev = calloc(1, sizeof(codec_dev_t));
+    if (dev) {
+        dev->dev_type = codec_dev_cfg->dev_type;
+        dev->data_if = codec_dev_cfg->data_if;
+    }
+    return dev;
+}
+
+int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL || fs == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    const audio_codec_data_if_t *data_if = dev->data_if;
+    if (data_if->is_open && !data_if->is_open(data_if)) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    int ret = data_if->set_fmt ? data_if->set_fmt(data_if, dev->dev_type, fs) : ESP_CODEC_DEV_OK;
+    if (ret == ESP_CODEC_DEV_OK && data_if->enable) {
+        ret = data_if->enable(data_if, dev->dev_type, true);
+    }
+    if (ret == ESP_CODEC_DEV_OK) {
+        dev->fs = *fs;
+        dev->is_open = true;
+    }
+    return ret;
+}
+
+int esp_codec_dev_read(esp_codec_dev_handle_t codec, void *data, int len)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL || data == NULL || len < 0) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (!dev->is_open || !(dev->dev_type & ESP_CODEC_DEV_TYPE_IN) || dev->data_if->read == NULL) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    int ret = dev->data_if->read(dev->data_if, data, len);
+    if (ret == ESP_CODEC_DEV_OK && dev->in_mute) {
+        memset(data, 0, len);
+    }
+    return ret;
+}
+
+int esp_codec_dev_write(esp_codec_dev_handle_t codec, void *data, int len)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL || data == NULL || len < 0) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (!dev->is_open || !(dev->dev_type & ESP_CODEC_DEV_TYPE_OUT) || dev->data_if->write == NULL) {
+        return ESP_CODEC_DEV_WRONG_STATE;
+    }
+    return dev->data_if->write(dev->data_if, data, len);
+}
+
+int esp_codec_dev_set_out_vol(esp_codec_dev_handle_t codec, int volume)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    dev->volume = volume;
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_get_out_vol(esp_codec_dev_handle_t codec, int *volume)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL || volume == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    *volume = dev->volume;
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_set_out_mute(esp_codec_dev_handle_t codec, bool mute)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    dev->out_mute = mute;
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_set_in_gain(esp_codec_dev_handle_t codec, float db_value)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    dev->in_gain = db_value;
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_set_in_mute(esp_codec_dev_handle_t codec, bool mute)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    dev->in_mute = mute;
+    return ESP_CODEC_DEV_OK;
+}
+
+int esp_codec_dev_close(esp_codec_dev_handle_t codec)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL) {
+        return ESP_CODEC_DEV_INVALID_ARG;
+    }
+    if (dev->is_open) {
+        if (dev->data_if->enable) {
+            dev->data_if->enable(dev->data_if, dev->dev_type, false);
+        }
+        dev->is_open = false;
+    }
+    return ESP_CODEC_DEV_OK;
+}
+
+void esp_codec_dev_delete(esp_codec_dev_handle_t codec)
+{
+    codec_dev_t *dev = (codec_dev_t *)codec;
+    if (dev == NULL) {
+        return;
+    }
+    esp_codec_dev_close(codec);
+    if (dev->data_if->close) {
+        dev->data_if->close(dev->data_if);
+    }
+    free(dev);
+}
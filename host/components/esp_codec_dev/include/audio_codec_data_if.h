@@ -0,0 +1,29 @@
+#ifndef AUDIO_CODEC_DATA_IF_H
+#define AUDIO_CODEC_DATA_IF_H
+
+#include "esp_codec_dev_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct audio_codec_data_if_t audio_codec_data_if_t;
+
+/**
+ * @brief Data path of a codec device; same layout as in esp_codec_dev
+ */
+struct audio_codec_data_if_t {
+    int (*open)(const audio_codec_data_if_t *h, void *data_cfg, int cfg_size);
+    bool (*is_open)(const audio_codec_data_if_t *h);
+    int (*enable)(const audio_codec_data_if_t *h, esp_codec_dev_type_t dev_type, bool enable);
+    int (*set_fmt)(const audio_codec_data_if_t *h, esp_codec_dev_type_t dev_type, esp_codec_dev_sample_info_t *fs);
+    int (*read)(const audio_codec_data_if_t *h, uint8_t *data, int size);
+    int (*write)(const audio_codec_data_if_t *h, uint8_t *data, int size);
+    int (*close)(const audio_codec_data_if_t *h);
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // AUDIO_CODEC_DATA_IF_H
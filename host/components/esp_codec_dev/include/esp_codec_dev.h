@@ -0,0 +1,44 @@
+#ifndef ESP_CODEC_DEV_H
+#define ESP_CODEC_DEV_H
+
+#include "esp_codec_dev_types.h"
+#include "audio_codec_data_if.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host esp_codec_dev: devices over a data interface only
+ *
+ * There is no codec chip to control, so codec_if must be NULL; the data
+ * interface (for example audio_file_dev's WAV files) does the I/O. Volume
+ * and gain are stored and reported back but not applied, as with a codec
+ * that has no volume control.
+ */
+
+typedef void *esp_codec_dev_handle_t;
+
+typedef struct {
+    esp_codec_dev_type_t dev_type;
+    const void *codec_if;                   // Must be NULL on the host
+    const audio_codec_data_if_t *data_if;
+} esp_codec_dev_cfg_t;
+
+esp_codec_dev_handle_t esp_codec_dev_new(esp_codec_dev_cfg_t *codec_dev_cfg);
+int esp_codec_dev_open(esp_codec_dev_handle_t codec, esp_codec_dev_sample_info_t *fs);
+int esp_codec_dev_read(esp_codec_dev_handle_t codec, void *data, int len);
+int esp_codec_dev_write(esp_codec_dev_handle_t codec, void *data, int len);
+int esp_codec_dev_set_out_vol(esp_codec_dev_handle_t codec, int volume);
+int esp_codec_dev_get_out_vol(esp_codec_dev_handle_t codec, int *volume);
+int esp_codec_dev_set_out_mute(esp_codec_dev_handle_t codec, bool mute);
+int esp_codec_dev_set_in_gain(esp_codec_dev_handle_t codec, float db_value);
+int esp_codec_dev_set_in_mute(esp_codec_dev_handle_t codec, bool mute);
+int esp_codec_dev_close(esp_codec_dev_handle_t codec);
+void esp_codec_dev_delete(esp_codec_dev_handle_t codec);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_CODEC_DEV_H
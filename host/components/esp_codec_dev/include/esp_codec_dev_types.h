@@ -0,0 +1,39 @@
+#ifndef ESP_CODEC_DEV_TYPES_H
+#define ESP_CODEC_DEV_TYPES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_CODEC_DEV_OK            (0)
+#define ESP_CODEC_DEV_DRV_ERR       (-1)
+#define ESP_CODEC_DEV_INVALID_ARG   (-2)
+#define ESP_CODEC_DEV_NOT_SUPPORT   (-3)
+#define ESP_CODEC_DEV_NOT_FOUND     (-4)
+#define ESP_CODEC_DEV_WRONG_STATE   (-5)
+#define ESP_CODEC_DEV_WRITE_FAIL    (-6)
+#define ESP_CODEC_DEV_READ_FAIL     (-7)
+
+typedef enum {
+    ESP_CODEC_DEV_TYPE_NONE,
+    ESP_CODEC_DEV_TYPE_IN = (1 << 0),
+    ESP_CODEC_DEV_TYPE_OUT = (1 << 1),
+    ESP_CODEC_DEV_TYPE_IN_OUT = (ESP_CODEC_DEV_TYPE_IN | ESP_CODEC_DEV_TYPE_OUT),
+} esp_codec_dev_type_t;
+
+typedef struct {
+    uint8_t bits_per_sample;
+    uint8_t channel;
+    uint16_t channel_mask;
+    uint32_t sample_rate;
+    int mclk_multiple;
+} esp_codec_dev_sample_info_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_CODEC_DEV_TYPES_H
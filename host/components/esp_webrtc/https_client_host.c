@@ -0,0 +1,145 @@
+#include "https_client.h"
+#include <esp_log.h>
+#include <inttypes.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "https_host";
+
+#define HTTPS_NAME_MAX      64
+#define HTTPS_PATH_MAX      256
+#define HTTPS_MAX_BODY      (256 * 1024)
+
+// G.711u like the host build's codec, plus the data channel
+static const char default_answer[] =
+    "v=0\r\n"
+    "o=- 1 1 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 0\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:0\r\n"
+    "a=ice-ufrag:host\r\n"
+    "a=ice-pwd:hostpasswordhostpassword\r\n"
+    "a=setup:active\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=ptime:20\r\n"
+    "a=candidate:1 1 udp 2130706431 127.0.0.1 50000 typ host\r\n"
+    "m=application 9 UDP/DTLS/SCTP webrtc-datachannel\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:1\r\n"
+    "a=sctp-port:5000\r\n"
+    "a=max-message-size:262144\r\n";
+
+static uint32_t request_count;
+
+static int env_int(const char *name)
+{
+    const char *value = getenv(name);
+    return value ? atoi(value) : 0;
+}
+
+// Last path segment without the query: ".../v1/realtime/calls?model=x" -> "calls"
+static void url_name(const char *url, char *name, int size)
+{
+    const char *path = strstr(url, "://");
+    path = strchr(path ? path + 3 : url, '/');
+    const char *start = path ? strrchr(path, '/') + 1 : "";
+    int len = strcspn(start, "?#");
+    if (len >= size) {
+        len = size - 1;
+    }
+    memcpy(name, start, len);
+    name[len] = '\0';
+}
+
+static char *read_file(const char *path, int *size)
+{
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *data = (len >= 0 && len <= HTTPS_MAX_BODY) ? malloc(len + 1) : NULL;
+    if (data && fread(data, 1, len, f) != (size_t)len) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    if (data) {
+        data[len] = '\0';
+        *size = len;
+    }
+    return data;
+}
+
+static char *default_response(const char *name, int *size)
+{
+    char *data = NULL;
+    if (strcmp(name, "client_secrets") == 0) {
+        data = malloc(96);
+        if (data) {
+            *size = snprintf(data, 96, "{\"value\":\"ek_host_%" PRIu32 "\",\"expires_at\":%lld}",
+                             request_count, (long long)time(NULL) + 600);
+        }
+    } else if (strcmp(name, "calls") == 0) {
+        data = strdup(default_answer);
+        *size = data ? (int)strlen(data) : 0;
+    }
+    return data;
+}
+
+int https_post(const char *url, char **headers, char *data, http_header_t header, http_body_t body, void *ctx)
+{
+    if (url == NULL) {
+        return -1;
+    }
+    request_count++;
+
+    int rtt_ms = env_int("AG_HOST_HTTPS_RTT_MS");
+    if (rtt_ms > 0) {
+        vTaskDelay(pdMS_TO_TICKS(rtt_ms));
+    }
+    int fail_every = env_int("AG_HOST_HTTPS_FAIL_EVERY");
+    if (fail_every > 0 && request_count % fail_every == 0) {
+        ESP_LOGW(TAG, "Request %" PRIu32 " to %s: injected transport failure", request_count, url);
+        return -1;
+    }
+
+    char name[HTTPS_NAME_MAX];
+    url_name(url, name, sizeof(name));
+    int size = 0;
+    char *resp = NULL;
+    const char *dir = getenv("AG_HOST_HTTPS_DIR");
+    if (dir) {
+        char path[HTTPS_PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", dir, name);
+        resp = read_file(path, &size);
+    }
+    if (resp == NULL) {
+        resp = default_response(name, &size);
+    }
+    if (resp == NULL) {
+        ESP_LOGW(TAG, "HTTP status 404: no response for %s", url);
+        return -1;
+    }
+
+    ESP_LOGD(TAG, "POST %s: %d byte request, %d byte response", url, data ? (int)strlen(data) : 0, size);
+    if (body && size > 0) {
+        http_resp_t answer = {
+            .data = resp,
+            .size = size,
+        };
+        body(&answer, ctx);
+    }
+    free(resp);
+    return 0;
+}
@@ -0,0 +1,6 @@
+#ifndef COMMON_H
+#define COMMON_H
+
+// Host build: the solution's board and network helpers are not used by the signaling code
+
+#endif // COMMON_H
@@ -0,0 +1,7 @@
+#ifndef ESP_PEER_DEFAULT_H
+#define ESP_PEER_DEFAULT_H
+
+// Host build: only the signaling interface is available (see esp_peer_signaling.h)
+#include "esp_peer_signaling.h"
+
+#endif // ESP_PEER_DEFAULT_H
@@ -0,0 +1,75 @@
+#ifndef ESP_PEER_SIGNALING_H
+#define ESP_PEER_SIGNALING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host copy of esp_peer's signaling interface
+ *
+ * Same layout as the device headers, so a signaling implementation such as
+ * openai_signaling.c builds and runs unchanged; the host app drives it in
+ * place of esp_webrtc.
+ */
+
+#define ESP_PEER_ERR_NONE           (0)
+#define ESP_PEER_ERR_INVALID_ARG    (-1)
+#define ESP_PEER_ERR_NO_MEM         (-2)
+#define ESP_PEER_ERR_WRONG_STATE    (-3)
+#define ESP_PEER_ERR_NOT_SUPPORT    (-4)
+#define ESP_PEER_ERR_NOT_EXISTS     (-5)
+#define ESP_PEER_ERR_FAIL           (-6)
+
+typedef void *esp_peer_signaling_handle_t;
+
+typedef enum {
+    ESP_PEER_SIGNALING_MSG_NONE,
+    ESP_PEER_SIGNALING_MSG_SDP,
+    ESP_PEER_SIGNALING_MSG_CANDIDATE,
+    ESP_PEER_SIGNALING_MSG_BYE,
+    ESP_PEER_SIGNALING_MSG_CUSTOMIZED,
+} esp_peer_signaling_msg_type_t;
+
+typedef struct {
+    esp_peer_signaling_msg_type_t type;
+    uint8_t *data;
+    int size;
+} esp_peer_signaling_msg_t;
+
+typedef struct {
+    char *stun_url;
+    char *user;
+    char *psw;
+} esp_peer_ice_server_cfg_t;
+
+typedef struct {
+    esp_peer_ice_server_cfg_t server_info;
+    bool is_initiator;
+} esp_peer_signaling_ice_info_t;
+
+typedef struct {
+    int (*on_ice_info)(esp_peer_signaling_ice_info_t *info, void *ctx);
+    int (*on_connected)(void *ctx);
+    int (*on_msg)(esp_peer_signaling_msg_t *msg, void *ctx);
+    int (*on_close)(void *ctx);
+    char *signal_url;
+    void *extra_cfg;
+    int extra_size;
+    void *ctx;
+} esp_peer_signaling_cfg_t;
+
+typedef struct {
+    int (*start)(esp_peer_signaling_cfg_t *cfg, esp_peer_signaling_handle_t *sig);
+    int (*send_msg)(esp_peer_signaling_handle_t sig, esp_peer_signaling_msg_t *msg);
+    int (*stop)(esp_peer_signaling_handle_t sig);
+} esp_peer_signaling_impl_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // ESP_PEER_SIGNALING_H
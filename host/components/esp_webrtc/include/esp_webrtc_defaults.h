@@ -0,0 +1,7 @@
+#ifndef ESP_WEBRTC_DEFAULTS_H
+#define ESP_WEBRTC_DEFAULTS_H
+
+// Host build: only the signaling interface is available (see esp_peer_signaling.h)
+#include "esp_peer_signaling.h"
+
+#endif // ESP_WEBRTC_DEFAULTS_H
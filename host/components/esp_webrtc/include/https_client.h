@@ -0,0 +1,40 @@
+#ifndef HTTPS_CLIENT_H
+#define HTTPS_CLIENT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host https_post(): canned responses instead of a server
+ *
+ * The response body for a URL is the file named after the URL's last path
+ * segment (query dropped) in $AG_HOST_HTTPS_DIR, e.g. "client_secrets" or
+ * "calls". Without the file, the OpenAI token and SDP endpoints get a
+ * built-in answer and any other URL gets a 404. Each request waits
+ * $AG_HOST_HTTPS_RTT_MS (default 0); with $AG_HOST_HTTPS_FAIL_EVERY=n every
+ * nth request fails as a transport error.
+ */
+
+typedef struct {
+    char *data;
+    int size;
+} http_resp_t;
+
+typedef void (*http_header_t)(const char *key, const char *value, void *ctx);
+
+typedef void (*http_body_t)(http_resp_t *resp, void *ctx);
+
+/**
+ * @brief POST to url; headers are "Name: value" strings ending with NULL
+ * @param header Called per response header, may be NULL (the host sends none)
+ * @param body Called with the response body for 2xx responses
+ * @return 0 on success, -1 on transport error or non-2xx status
+ */
+int https_post(const char *url, char **headers, char *data, http_header_t header, http_body_t body, void *ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HTTPS_CLIENT_H
@@ -0,0 +1,17 @@
+#ifndef MEDIA_LIB_ADAPTER_H
+#define MEDIA_LIB_ADAPTER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Nothing to register on the host; kept so thread_scheduler.c builds unchanged
+ */
+int media_lib_add_default_adapter(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEDIA_LIB_ADAPTER_H
@@ -0,0 +1,49 @@
+#ifndef MEDIA_LIB_OS_H
+#define MEDIA_LIB_OS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Host subset of media_lib_os: the scheduler-driven thread calls
+ *
+ * Same types and semantics as the device library, so thread_scheduler.c
+ * still decides every task's stack, priority and core. The Linux FreeRTOS
+ * port has one core; core ids past it become "no affinity".
+ */
+
+typedef void *media_lib_thread_handle_t;
+
+typedef struct {
+    uint32_t stack_size;
+    uint8_t priority;
+    uint8_t core_id;
+} media_lib_thread_cfg_t;
+
+typedef void (*media_lib_thread_schedule_cb)(const char *thread_name, media_lib_thread_cfg_t *thread_cfg);
+
+/**
+ * @brief Create a thread with the settings the schedule callback picks for its name
+ * @return 0 on success, -1 on failure
+ */
+int media_lib_thread_create_from_scheduler(media_lib_thread_handle_t *handle, const char *name,
+                                           void (*body)(void *arg), void *arg);
+
+/**
+ * @brief End a thread; NULL ends the calling one
+ */
+void media_lib_thread_destroy(media_lib_thread_handle_t handle);
+
+void media_lib_thread_sleep(int ms);
+
+int media_lib_thread_set_schedule_cb(media_lib_thread_schedule_cb cb);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // MEDIA_LIB_OS_H
@@ -0,0 +1,56 @@
+#include "media_lib_os.h"
+#include "media_lib_adapter.h"
+#include <esp_log.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+static const char *TAG = "media_lib_host";
+
+#define DEFAULT_STACK_SIZE  (4 * 1024)
+#define DEFAULT_PRIORITY    5
+
+static media_lib_thread_schedule_cb schedule_cb;
+
+int media_lib_add_default_adapter(void)
+{
+    return 0;
+}
+
+int media_lib_thread_set_schedule_cb(media_lib_thread_schedule_cb cb)
+{
+    schedule_cb = cb;
+    return 0;
+}
+
+int media_lib_thread_create_from_scheduler(media_lib_thread_handle_t *handle, const char *name,
+                                           void (*body)(void *arg), void *arg)
+{
+    media_lib_thread_cfg_t cfg = {
+        .stack_size = DEFAULT_STACK_SIZE,
+        .priority = DEFAULT_PRIORITY,
+        .core_id = 0,
+    };
+    if (schedule_cb) {
+        schedule_cb(name, &cfg);
+    }
+    BaseType_t core = cfg.core_id < portNUM_PROCESSORS ? cfg.core_id : tskNO_AFFINITY;
+    TaskHandle_t task = NULL;
+    if (xTaskCreatePinnedToCore(body, name, cfg.stack_size, arg, cfg.priority, &task, core) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create %s", name);
+        return -1;
+    }
+    if (handle) {
+        *handle = task;
+    }
+    return 0;
+}
+
+void media_lib_thread_destroy(media_lib_thread_handle_t handle)
+{
+    vTaskDelete((TaskHandle_t)handle);
+}
+
+void media_lib_thread_sleep(int ms)
+{
+    vTaskDelay(pdMS_TO_TICKS(ms));
+}
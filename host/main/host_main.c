@@ -0,0 +1,295 @@
+/*
+ * Host runner - benchmark and soak suites on the Linux target
+ *
+ * Runs the suites named in $AG_HOST_SUITES (comma separated, default all) and
+ * exits non-zero if any of them failed, so it can gate a CI job.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <freertos/task.h>
+#include "memory_manager.h"
+#include "metrics.h"
+#include "thread_scheduler.h"
+#include "log_async.h"
+#include "stress_scenario.h"
+#include "audio_bench.h"
+#include "camera_module.h"
+#include "https_session.h"
+#include "openai_signaling.h"
+#include "openai_token.h"
+#include "sdkconfig.h"
+
+static const char *TAG = "host";
+
+#define HOST_DEFAULT_SUITES     "stress,audio,vision,signaling"
+#define HOST_ANSWER_WAIT_MS     15000
+
+// Minimal browser-like offer: the minimizer and the answer parser see real input
+static const char host_offer[] =
+    "v=0\r\n"
+    "o=- 1 1 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111 0 8\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:0\r\n"
+    "a=ice-ufrag:offr\r\n"
+    "a=ice-pwd:offerpasswordofferpassword\r\n"
+    "a=setup:actpass\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "a=rtpmap:0 PCMU/8000\r\n"
+    "a=rtpmap:8 PCMA/8000\r\n"
+    "a=candidate:1 1 udp 2130706431 127.0.0.1 40000 typ host\r\n"
+    "a=candidate:2 1 udp 1694498815 203.0.113.7 40000 typ srflx raddr 127.0.0.1 rport 40000\r\n"
+    "m=application 9 UDP/DTLS/SCTP webrtc-datachannel\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:1\r\n"
+    "a=sctp-port:5000\r\n";
+
+static int env_int(const char *name, int def)
+{
+    const char *value = getenv(name);
+    return value ? atoi(value) : def;
+}
+
+static const char *env_str(const char *name, const char *def)
+{
+    const char *value = getenv(name);
+    return value ? value : def;
+}
+
+static bool suite_selected(const char *suites, const char *name)
+{
+    int len = strlen(name);
+    for (const char *p = suites; (p = strstr(p, name)) != NULL; p += len) {
+        if ((p == suites || p[-1] == ',') && (p[len] == '\0' || p[len] == ',')) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static esp_err_t run_stress(void)
+{
+    stress_scenario_cfg_t cfg;
+    stress_scenario_default_cfg(&cfg);
+    cfg.duration_s = env_int("AG_HOST_STRESS_S", 10);
+
+    stress_scenario_result_t result;
+    esp_err_t ret = stress_scenario_run(&cfg, &result);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Stress scenario: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    stress_scenario_print_result(&cfg, &result);
+    return result.pass ? ESP_OK : ESP_FAIL;
+}
+
+static esp_err_t run_audio(void)
+{
+    audio_bench_cfg_t cfg = {
+        .corpus_dir = env_str("AG_HOST_AUDIO_DIR", "corpus"),
+        .output_dir = getenv("AG_HOST_AUDIO_OUT"),
+    };
+    audio_bench_result_t result;
+    esp_err_t ret = audio_bench_run(&cfg, &result);
+    if (ret == ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "Audio bench skipped: no corpus in %s (set AG_HOST_AUDIO_DIR)", cfg.corpus_dir);
+        return ESP_OK;
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Audio bench: %s", esp_err_to_name(ret));
+        return ret;
+    }
+    audio_bench_print_result(&result);
+    return ESP_OK;
+}
+
+static esp_err_t run_vision(void)
+{
+    cam_config_t config = {
+        .mode = CAM_MODE_ANALYSIS_ONLY,
+        .quality = CAM_QUALITY_MEDIUM,
+        .fps = 15,
+        .jpeg_quality = 12,
+        .buffer_frames = 2,
+    };
+    esp_err_t ret = cam_module_init(&config, NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Camera init: %s", esp_err_to_name(ret));
+        return ret;
+    }
+
+    int rounds = env_int("AG_HOST_VISION_ROUNDS", 10);
+    int frames_per_round = env_int("AG_HOST_VISION_FRAMES", 2);
+    int ok = 0;
+    uint32_t total_ms = 0, max_ms = 0;
+    for (int i = 0; i < rounds; i++) {
+        int64_t start = esp_timer_get_time();
+        int count = 0;
+        char **frames = cam_module_get_vision_frames(frames_per_round, &count);
+        uint32_t ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+        if (frames && count > 0) {
+            ok++;
+            total_ms += ms;
+            if (ms > max_ms) {
+                max_ms = ms;
+            }
+        }
+        for (int j = 0; frames && j < count; j++) {
+            mem_free(frames[j]);
+        }
+        mem_free(frames);
+    }
+
+    cam_power_stats_t power;
+    cam_module_get_power_stats(&power);
+    printf("Vision: %d/%d requests, avg %" PRIu32 " ms, max %" PRIu32 " ms (%" PRIu32 " cold, %" PRIu32 " warm)\n",
+           ok, rounds, ok ? total_ms / ok : 0, max_ms, power.cold_requests, power.warm_requests);
+    cam_module_deinit();
+    return ok == rounds ? ESP_OK : ESP_FAIL;
+}
+
+// Signaling callbacks; the answer wakes the runner
+static struct {
+    SemaphoreHandle_t answered;
+} sig_state;
+
+static int sig_on_ice_info(esp_peer_signaling_ice_info_t *info, void *ctx)
+{
+    return 0;
+}
+
+static int sig_on_connected(void *ctx)
+{
+    return 0;
+}
+
+static int sig_on_msg(esp_peer_signaling_msg_t *msg, void *ctx)
+{
+    if (msg->type == ESP_PEER_SIGNALING_MSG_SDP) {
+        xSemaphoreGive(sig_state.answered);
+    }
+    return 0;
+}
+
+static int sig_on_close(void *ctx)
+{
+    return 0;
+}
+
+static esp_err_t run_signaling(void)
+{
+    if (https_session_init() != ESP_OK || openai_token_init() != ESP_OK) {
+        return ESP_FAIL;
+    }
+    sig_state.answered = xSemaphoreCreateBinary();
+    if (sig_state.answered == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    const esp_peer_signaling_impl_t *impl = openai_signaling_get_impl();
+    openai_signaling_cfg_t openai_cfg = {
+        .token = "sk-host",
+        .voice = CONFIG_AG_OPENAI_VOICE,
+        .audio_codec = "PCMU",
+    };
+    esp_peer_signaling_cfg_t cfg = {
+        .on_ice_info = sig_on_ice_info,
+        .on_connected = sig_on_connected,
+        .on_msg = sig_on_msg,
+        .on_close = sig_on_close,
+        .extra_cfg = &openai_cfg,
+        .extra_size = sizeof(openai_cfg),
+    };
+
+    // Rounds stand for the sessions of one armed webrtc start, as on the device
+    openai_token_set_active(true);
+    int rounds = env_int("AG_HOST_SIGNALING_ROUNDS", 10);
+    int ok = 0;
+    uint32_t total_ms = 0, max_ms = 0;
+    for (int i = 0; i < rounds; i++) {
+        esp_peer_signaling_handle_t handle = NULL;
+        int64_t start = esp_timer_get_time();
+        if (impl->start(&cfg, &handle) != ESP_PEER_ERR_NONE) {
+            continue;
+        }
+        esp_peer_signaling_msg_t offer = {
+            .type = ESP_PEER_SIGNALING_MSG_SDP,
+            .data = (uint8_t *)host_offer,
+            .size = sizeof(host_offer) - 1,
+        };
+        if (impl->send_msg(handle, &offer) == 0 &&
+            xSemaphoreTake(sig_state.answered, pdMS_TO_TICKS(HOST_ANSWER_WAIT_MS)) == pdTRUE) {
+            uint32_t ms = (uint32_t)((esp_timer_get_time() - start) / 1000);
+            ok++;
+            total_ms += ms;
+            if (ms > max_ms) {
+                max_ms = ms;
+            }
+        }
+        // The SDP task deletes itself right after the answer callback
+        vTaskDelay(pdMS_TO_TICKS(20));
+        impl->stop(handle);
+        // A reconnect starts from a closed connection, like a WiFi flap
+        if (env_int("AG_HOST_SIGNALING_RECONNECT", 0)) {
+            https_session_close();
+        }
+    }
+
+    openai_token_set_active(false);
+
+    https_session_stats_t https;
+    https_session_get_stats(&https);
+    printf("Signaling: %d/%d offers answered, avg %" PRIu32 " ms, max %" PRIu32 " ms\n",
+           ok, rounds, ok ? total_ms / ok : 0, max_ms);
+    printf("HTTPS: %" PRIu32 " requests, %" PRIu32 " failures, %" PRIu32 " connects, %" PRIu32 " reused\n",
+           https.requests, https.failures, https.connects, https.reused);
+    vSemaphoreDelete(sig_state.answered);
+    return ok == rounds ? ESP_OK : ESP_FAIL;
+}
+
+static const struct {
+    const char *name;
+    esp_err_t (*run)(void);
+} host_suites[] = {
+    {"stress",    run_stress},
+    {"audio",     run_audio},
+    {"vision",    run_vision},
+    {"signaling", run_signaling},
+};
+
+void app_main(void)
+{
+    ESP_ERROR_CHECK(thread_scheduler_init());
+    ESP_ERROR_CHECK(memory_manager_init());
+    log_async_init();
+
+    const char *suites = env_str("AG_HOST_SUITES", HOST_DEFAULT_SUITES);
+    int failed = 0;
+    for (int i = 0; i < sizeof(host_suites) / sizeof(host_suites[0]); i++) {
+        if (!suite_selected(suites, host_suites[i].name)) {
+            continue;
+        }
+        ESP_LOGI(TAG, "===== %s =====", host_suites[i].name);
+        int64_t start = esp_timer_get_time();
+        esp_err_t ret = host_suites[i].run();
+        ESP_LOGI(TAG, "%s: %s in %" PRId64 " ms", host_suites[i].name, ret == ESP_OK ? "PASS" : "FAIL",
+                 (esp_timer_get_time() - start) / 1000);
+        failed += ret != ESP_OK;
+    }
+
+    if (env_int("AG_HOST_METRICS", 0)) {
+        metrics_print(NULL);
+    }
+    log_async_flush();
+    exit(failed ? 1 : 0);
+}
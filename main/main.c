@@ -24,9 +24,13 @@
 #include "webrtc_commands.h"
 #include "camera_module.h"
 #include "camera_commands.h"
+#include "camera_preview_server.h"
 #include "thread_scheduler.h"
+#include "boot_orchestrator.h"
+#include "log_async.h"
 #include "system_commands.h"
 #include "openai_client.h"
+#include "sdkconfig.h"
 
 static const char *TAG = "main";
 
@@ -40,12 +44,37 @@ static esp_err_t init_nvs(void)
     return ret;
 }
 
+// Session restarts across WiFi flaps; media objects are never rebuilt.
+// Both flags change together under the lock, so a GOT_IP is either seen by
+// the running task or starts a new one.
+static struct {
+    portMUX_TYPE lock;
+    bool start_pending;                 // webrtc_start task queued or running
+    bool restart_requested;             // Link flapped again while it was running
+} session_state = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
 // Async task functions with proper stack allocation
 void webrtc_start_task(void *arg)
 {
-    ESP_LOGI(TAG, "Starting WebRTC...");
-    webrtc_module_start();
-    ESP_LOGI(TAG, "WebRTC started successfully");
+    bool again;
+    do {
+        // After a flap only the peer connection and signaling are replaced
+        if (webrtc_module_get_state() != WEBRTC_STATE_DISCONNECTED) {
+            ESP_LOGI(TAG, "Restarting WebRTC session...");
+            webrtc_module_stop();
+        }
+        ESP_LOGI(TAG, "Starting WebRTC...");
+        webrtc_module_start();
+        ESP_LOGI(TAG, "WebRTC started successfully");
+
+        taskENTER_CRITICAL(&session_state.lock);
+        again = session_state.restart_requested;
+        session_state.restart_requested = false;
+        session_state.start_pending = again;
+        taskEXIT_CRITICAL(&session_state.lock);
+    } while (again);
     media_lib_thread_destroy(NULL);
 }
 
@@ -57,13 +86,37 @@ void webrtc_stop_task(void *arg)
     media_lib_thread_destroy(NULL);
 }
 
-// Event callbacks
-static void wifi_event_callback(bool connected)
+static void play_startup_sound(void)
 {
-    if (connected) {
-        ESP_LOGI(TAG, "WiFi connected");
+    ESP_LOGI(TAG, "🎵 Playing starting.wav feedback sound");
+    esp_err_t ret = audio_feedback_play_wav("/spiffs/sounds/starting.wav", NULL);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to play starting.wav: %s", esp_err_to_name(ret));
+    }
+}
+
+// WiFi can get an IP before the media modules have finished initializing
+static struct {
+    portMUX_TYPE lock;
+    bool ready;                         // Everything a session needs is initialized
+    bool link_pending;                  // Link came up before that
+} boot_gate = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+static void handle_link(bool connected)
+{
+    if (!connected) {
+        ESP_LOGI(TAG, "WiFi disconnected");
+        webrtc_module_note_link(false);
+        return;
+    }
+
+    ESP_LOGI(TAG, "WiFi connected");
+    uint32_t outage_ms = webrtc_module_note_link(true);
 
-        // Start audio module
+    if (!audio_module_is_ready()) {
+        // First connection: bring up the media system once
         ESP_LOGI(TAG, "Starting audio module...");
         audio_module_start();
 
@@ -71,27 +124,60 @@ static void wifi_event_callback(bool connected)
         openai_realtime_set_activation_mode(true);
 
         // Play pre-recorded startup sound
-        ESP_LOGI(TAG, "🎵 Playing starting.wav feedback sound");
-        esp_err_t ret = audio_feedback_play_wav("/spiffs/sounds/starting.wav", NULL);
-        if (ret != ESP_OK) {
-            ESP_LOGE(TAG, "Failed to play starting.wav: %s", esp_err_to_name(ret));
-        }
+        play_startup_sound();
 
         // Images are sent directly through WebRTC data channel
         ESP_LOGI(TAG, "OpenAI activation mode set to audio+vision");
+    } else if (outage_ms > CONFIG_AG_WEBRTC_QUICK_RECONNECT_MS) {
+        ESP_LOGI(TAG, "Reconnected after %lu ms, resuming session", outage_ms);
+        play_startup_sound();
+    } else {
+        ESP_LOGI(TAG, "Quick reconnect (%lu ms), resuming session silently", outage_ms);
+    }
 
-        media_lib_thread_create_from_scheduler(NULL, "webrtc_start", webrtc_start_task, NULL);
+    taskENTER_CRITICAL(&session_state.lock);
+    bool running = session_state.start_pending;
+    if (running) {
+        session_state.restart_requested = true;
     } else {
-        ESP_LOGI(TAG, "WiFi disconnected");
+        session_state.start_pending = true;
+    }
+    taskEXIT_CRITICAL(&session_state.lock);
+    if (running) {
+        return;
+    }
+    if (media_lib_thread_create_from_scheduler(NULL, "webrtc_start", webrtc_start_task, NULL) != 0) {
+        ESP_LOGE(TAG, "Failed to create webrtc_start task");
+        taskENTER_CRITICAL(&session_state.lock);
+        session_state.start_pending = false;
+        taskEXIT_CRITICAL(&session_state.lock);
     }
 }
 
+// Event callbacks
+static void wifi_event_callback(bool connected)
+{
+    taskENTER_CRITICAL(&boot_gate.lock);
+    bool ready = boot_gate.ready;
+    if (!ready) {
+        boot_gate.link_pending = connected;
+    }
+    taskEXIT_CRITICAL(&boot_gate.lock);
+    if (!ready) {
+        ESP_LOGI(TAG, "WiFi %s while booting, session start deferred", connected ? "connected" : "disconnected");
+        return;
+    }
+    handle_link(connected);
+}
+
 static void webrtc_event_callback(webrtc_state_t state)
 {  
     const char *state_str[] = {"DISCONNECTED", "CONNECTING", "CONNECTED", "FAILED"};
     ESP_LOGI(TAG, "WebRTC state changed to: %s", state_str[state]);
     if (state == WEBRTC_STATE_CONNECTED) {
         ESP_LOGI(TAG, "WebRTC connected");
+        // Bring the camera up before the first vision request needs it
+        cam_module_prewarm();
     } else if (state == WEBRTC_STATE_FAILED) {
         ESP_LOGD(TAG, "WebRTC connection failed");
     } else if (state == WEBRTC_STATE_DISCONNECTED) {
@@ -133,40 +219,69 @@ static void cam_event_callback(cam_event_t event, void *data)
     }
 }
 
-void app_main(void)
+// Scale camera resolution and frame rate with the WiFi link; full settings again when it recovers
+static void link_quality_callback(const wifi_link_quality_t *quality, void *ctx)
 {
-    ESP_LOGI(TAG, "===== Starting System =====");
-    
-    // Initialize global thread scheduler
-    ESP_ERROR_CHECK(thread_scheduler_init());
-    
-    // Initialize memory manager for runtime detection and monitoring
-    ESP_ERROR_CHECK(memory_manager_init());
-    memory_manager_enable_monitoring(10000); // Monitor every 10 seconds for better visibility
-    
-    // Initialize board hardware peripherals (I2C, codec, camera interfaces, etc.)
-    ESP_ERROR_CHECK(board_module_init());
+    cam_quality_t cam_quality = (cam_quality_t)CONFIG_AG_VISION_DEFAULT_QUALITY;
+    uint32_t fps = CONFIG_AG_VISION_DEFAULT_FPS;
+    if (quality->level == WIFI_LINK_FAIR) {
+        cam_quality = cam_quality < CAM_QUALITY_MEDIUM ? cam_quality : CAM_QUALITY_MEDIUM;
+        fps /= 2;
+    } else if (quality->level == WIFI_LINK_POOR) {
+        cam_quality = CAM_QUALITY_LOW;
+        fps /= 4;
+    }
+    if (fps == 0) {
+        fps = 1;
+    }
+    ESP_LOGI(TAG, "Link %s: camera quality %d, %lu fps", wifi_link_level_name(quality->level), cam_quality, fps);
+    cam_module_set_quality(cam_quality);
+    cam_module_set_fps(fps);
+}
 
-    // Initialize audio module
-    ESP_ERROR_CHECK(audio_module_init(NULL));
+// Boot steps, run by boot_orchestrator as soon as their dependencies are done
+static esp_err_t boot_nvs(void)
+{
+    return init_nvs();
+}
 
-    // Audio Feedback module
-    ESP_ERROR_CHECK(audio_feedback_init());
-    
-    // Initialize NVS (needed for WiFi)
-    ESP_ERROR_CHECK(init_nvs());
-    
-    // Initialize console module
-    ESP_ERROR_CHECK(console_module_init());
-    
-    // Initialize WiFi module
-    ESP_ERROR_CHECK(wifi_module_init(wifi_event_callback));
+static esp_err_t boot_board(void)
+{
+    // I2C, codec, camera interfaces, etc.
+    return board_module_init();
+}
 
-    // Initialize WebRTC module
-    ESP_ERROR_CHECK(webrtc_module_init(webrtc_event_callback));
-    
-    // Initialize unified camera/vision module with Kconfig settings
-    cam_config_t cam_config = {
+static esp_err_t boot_wifi(void)
+{
+    return wifi_module_init(wifi_event_callback);
+}
+
+static esp_err_t boot_wifi_connect(void)
+{
+    // Association runs in the background while the rest of the system comes up
+    if (wifi_module_load_credentials() == ESP_OK) {
+        wifi_credentials_t creds;
+        wifi_module_get_credentials(&creds);
+        ESP_LOGI(TAG, "Auto-connecting to saved network: %s", creds.ssid);
+        wifi_module_connect(creds.ssid, creds.password);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t boot_audio(void)
+{
+    return audio_module_init(NULL);
+}
+
+static esp_err_t boot_webrtc(void)
+{
+    return webrtc_module_init(webrtc_event_callback);
+}
+
+static esp_err_t boot_camera(void)
+{
+    // Unified camera/vision module with Kconfig settings
+    static const cam_config_t cam_config = {
         .mode = CAM_MODE_ANALYSIS_ONLY, // AI analysis mode
         .quality = CONFIG_AG_VISION_DEFAULT_QUALITY,
         .fps = CONFIG_AG_VISION_DEFAULT_FPS,
@@ -176,28 +291,94 @@ void app_main(void)
         .buffer_frames = CONFIG_AG_VISION_BUFFER_FRAMES,
         .enable_live_preview = false // Disable HTTP preview by default (save CPU)
     };
-    ESP_ERROR_CHECK(cam_module_init(&cam_config, cam_event_callback));
+    esp_err_t ret = cam_module_init(&cam_config, cam_event_callback);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+    return wifi_module_link_subscribe(link_quality_callback, NULL);
+}
+
+static esp_err_t boot_metrics_http(void)
+{
+#if CONFIG_AG_VISION_METRICS_HTTP
+    // Scraping is optional; a failure here must not stop the boot
+    if (camera_preview_server_start_metrics(CONFIG_AG_VISION_PREVIEW_PORT) != ESP_OK) {
+        ESP_LOGW(TAG, "Metrics endpoint not available");
+    }
+#endif
+    return ESP_OK;
+}
+
+static esp_err_t boot_commands(void)
+{
+    esp_err_t (*const registers[])(void) = {
+        console_register_commands,
+        wifi_register_commands,
+        audio_register_commands,
+        webrtc_register_commands,
+        camera_commands_register,
+        system_commands_register,
+    };
+    for (size_t i = 0; i < sizeof(registers) / sizeof(registers[0]); i++) {
+        esp_err_t ret = registers[i]();
+        if (ret != ESP_OK) {
+            return ret;
+        }
+    }
+    return ESP_OK;
+}
+
+static esp_err_t boot_session_ready(void)
+{
+    taskENTER_CRITICAL(&boot_gate.lock);
+    boot_gate.ready = true;
+    bool pending = boot_gate.link_pending;
+    boot_gate.link_pending = false;
+    taskEXIT_CRITICAL(&boot_gate.lock);
+    if (pending) {
+        ESP_LOGI(TAG, "WiFi came up during boot, starting session");
+        handle_link(true);
+    }
+    return ESP_OK;
+}
+
+static const boot_step_t boot_steps[] = {
+    {"nvs",           boot_nvs,              {NULL},                                     BOOT_CORE_ANY},
+    {"board",         boot_board,            {NULL},                                     BOOT_CORE_ANY},
+    {"wifi",          boot_wifi,             {"nvs"},                                    BOOT_CORE_ANY},
+    {"wifi_connect",  boot_wifi_connect,     {"wifi"},                                   BOOT_CORE_ANY},
+    {"audio",         boot_audio,            {"board"},                                  BOOT_CORE_ANY},
+    {"feedback",      audio_feedback_init,   {"audio"},                                  BOOT_CORE_ANY},
+    // Needs the DNS cache set up by WiFi init
+    {"webrtc",        boot_webrtc,           {"wifi"},                                   BOOT_CORE_ANY},
+    // SCCB shares the codec's I2C pins, and the render and capture pipelines open
+    // the codec without the board bus lock
+    {"camera",        boot_camera,           {"audio", "wifi"},                          BOOT_CORE_ANY},
+    // httpd needs the network stack from WiFi init
+    {"metrics_http",  boot_metrics_http,     {"wifi"},                                   BOOT_CORE_ANY},
+    {"console",       console_module_init,   {NULL},                                     BOOT_CORE_ANY},
+    {"commands",      boot_commands,         {"console"},                                BOOT_CORE_ANY},
+    // A session can start without the camera
+    {"session_ready", boot_session_ready,    {"audio", "feedback", "webrtc", "wifi_connect"}, BOOT_CORE_ANY},
+    {"console_start", console_module_start,  {"commands", "session_ready", "camera"},    BOOT_CORE_ANY},
+};
+
+void app_main(void)
+{
+    ESP_LOGI(TAG, "===== Starting System =====");
     
-    // Register console commands
-    ESP_ERROR_CHECK(console_register_commands());
+    // Initialize global thread scheduler
+    ESP_ERROR_CHECK(thread_scheduler_init());
     
-    // Register module commands
-    ESP_ERROR_CHECK(wifi_register_commands());
-    ESP_ERROR_CHECK(audio_register_commands());
-    ESP_ERROR_CHECK(webrtc_register_commands());
-    ESP_ERROR_CHECK(camera_commands_register());
-    ESP_ERROR_CHECK(system_commands_register());
+    // Initialize memory manager for runtime detection and monitoring
+    ESP_ERROR_CHECK(memory_manager_init());
+    memory_manager_enable_monitoring(10000); // Monitor every 10 seconds for better visibility
     
-    // Start console task
-    ESP_ERROR_CHECK(console_module_start());
-
-    // Try to auto-connect if credentials are saved
-    if (wifi_module_load_credentials() == ESP_OK) {
-        wifi_credentials_t creds;
-        wifi_module_get_credentials(&creds);
-        ESP_LOGI(TAG, "Auto-connecting to saved network: %s", creds.ssid);
-        wifi_module_connect(creds.ssid, creds.password);
-    }
+    // Log lines go to a ring drained by a low-priority task from here on
+    log_async_init();
+    
+    // Everything else in dependency order, independent steps on both cores
+    ESP_ERROR_CHECK(boot_orchestrator_run(boot_steps, sizeof(boot_steps) / sizeof(boot_steps[0])));
 
     while (1) {        
         // Reduced polling frequency to save power
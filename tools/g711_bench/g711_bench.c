@@ -0,0 +1,244 @@
+/*
+ * Host benchmark for the low-power audio profile
+ *
+ * 1. Checks the table codec bit-exact against the loop-based ITU-T reference,
+ *    over every 16-bit input and every code byte.
+ * 2. Times encode, decode and the x3 render bridge per second of 8 kHz audio,
+ *    next to the reference codec and a generic polyphase FIR resampler of the
+ *    kind a rate converter uses for arbitrary ratios.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include "g711.h"
+#include "audio_resample.h"
+
+#define RATE            8000
+#define SECONDS         60
+#define FRAMES          (RATE * SECONDS)
+#define FIR_TAPS        32              // Per output phase
+#define REPEAT          5
+
+// ---------- ITU-T reference (segment search loop) ----------
+
+static const int16_t seg_aend[8] = {0x1F, 0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF};
+static const int16_t seg_uend[8] = {0x3F, 0x7F, 0xFF, 0x1FF, 0x3FF, 0x7FF, 0xFFF, 0x1FFF};
+
+static int search(int val, const int16_t *table, int size)
+{
+    for (int i = 0; i < size; i++) {
+        if (val <= *table++) {
+            return i;
+        }
+    }
+    return size;
+}
+
+static uint8_t ref_linear2alaw(int16_t pcm_val)
+{
+    int mask, seg;
+    uint8_t aval;
+    pcm_val = pcm_val >> 3;
+    if (pcm_val >= 0) {
+        mask = 0xD5;
+    } else {
+        mask = 0x55;
+        pcm_val = -pcm_val - 1;
+    }
+    seg = search(pcm_val, seg_aend, 8);
+    if (seg >= 8) {
+        return (uint8_t)(0x7F ^ mask);
+    }
+    aval = (uint8_t)(seg << 4);
+    aval |= (seg < 2) ? (pcm_val >> 1) & 0x0F : (pcm_val >> seg) & 0x0F;
+    return aval ^ mask;
+}
+
+static int16_t ref_alaw2linear(uint8_t a_val)
+{
+    int t, seg;
+    a_val ^= 0x55;
+    t = (a_val & 0x0F) << 4;
+    seg = (a_val & 0x70) >> 4;
+    switch (seg) {
+    case 0:
+        t += 8;
+        break;
+    case 1:
+        t += 0x108;
+        break;
+    default:
+        t += 0x108;
+        t <<= seg - 1;
+    }
+    return (a_val & 0x80) ? t : -t;
+}
+
+static uint8_t ref_linear2ulaw(int16_t pcm_val)
+{
+    int mask, seg;
+    pcm_val = pcm_val >> 2;
+    if (pcm_val < 0) {
+        pcm_val = -pcm_val;
+        mask = 0x7F;
+    } else {
+        mask = 0xFF;
+    }
+    if (pcm_val > 8159) {
+        pcm_val = 8159;
+    }
+    pcm_val += 0x21;
+    seg = search(pcm_val, seg_uend, 8);
+    if (seg >= 8) {
+        return (uint8_t)(0x7F ^ mask);
+    }
+    return (uint8_t)(((seg << 4) | ((pcm_val >> (seg + 1)) & 0xF)) ^ mask);
+}
+
+static int16_t ref_ulaw2linear(uint8_t u_val)
+{
+    int t;
+    u_val = ~u_val;
+    t = ((u_val & 0x0F) << 3) + 0x84;
+    t <<= ((unsigned)u_val & 0x70) >> 4;
+    return (u_val & 0x80) ? (0x84 - t) : (t - 0x84);
+}
+
+// ---------- Generic resampler stand-in ----------
+
+typedef struct {
+    float taps[3][FIR_TAPS];
+    float hist[FIR_TAPS];
+} fir_x3_t;
+
+static void fir_init(fir_x3_t *fir)
+{
+    // Windowed sinc low-pass at the 4 kHz input Nyquist, split into three phases
+    const int n = FIR_TAPS * 3;
+    for (int i = 0; i < n; i++) {
+        double x = i - (n - 1) / 2.0;
+        double sinc = x == 0 ? 1.0 : sin(M_PI * x / 3.0) / (M_PI * x / 3.0);
+        double win = 0.54 - 0.46 * cos(2 * M_PI * i / (n - 1));
+        fir->taps[i % 3][i / 3] = (float)(sinc * win);
+    }
+    memset(fir->hist, 0, sizeof(fir->hist));
+}
+
+static void fir_process(fir_x3_t *fir, const int16_t *in, size_t frames, int16_t *out)
+{
+    for (size_t i = 0; i < frames; i++) {
+        memmove(fir->hist + 1, fir->hist, (FIR_TAPS - 1) * sizeof(float));
+        fir->hist[0] = in[i];
+        for (int p = 0; p < 3; p++) {
+            float acc = 0;
+            for (int t = 0; t < FIR_TAPS; t++) {
+                acc += fir->taps[p][t] * fir->hist[t];
+            }
+            if (acc > 32767) {
+                acc = 32767;
+            } else if (acc < -32768) {
+                acc = -32768;
+            }
+            out[2 * (3 * i + p)] = (int16_t)acc;
+            out[2 * (3 * i + p) + 1] = (int16_t)acc;
+        }
+    }
+}
+
+// ---------- Harness ----------
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static volatile uint32_t sink;
+
+#define TIME_BEST(label, body) do { \
+    double best = 1e30; \
+    for (int r = 0; r < REPEAT; r++) { \
+        double t0 = now_us(); \
+        body; \
+        double t = now_us() - t0; \
+        if (t < best) best = t; \
+    } \
+    printf("  %-28s %8.1f us per second of audio\n", label, best / SECONDS); \
+} while (0)
+
+static int verify(void)
+{
+    int errors = 0;
+    for (int v = -32768; v <= 32767; v++) {
+        int16_t s = (int16_t)v;
+        uint8_t a, u;
+        g711_alaw_encode(&s, &a, 1);
+        g711_ulaw_encode(&s, &u, 1);
+        errors += a != ref_linear2alaw(s);
+        errors += u != ref_linear2ulaw(s);
+    }
+    for (int c = 0; c < 256; c++) {
+        uint8_t b = (uint8_t)c;
+        int16_t a, u;
+        g711_alaw_decode(&b, &a, 1);
+        g711_ulaw_decode(&b, &u, 1);
+        errors += a != ref_alaw2linear(b);
+        errors += u != ref_ulaw2linear(b);
+    }
+    return errors;
+}
+
+int main(void)
+{
+    int errors = verify();
+    printf("Bit-exact check: 65536 encode + 256 decode inputs per law, %d mismatches\n", errors);
+    if (errors) {
+        return 1;
+    }
+
+    int16_t *pcm = malloc(FRAMES * sizeof(int16_t));
+    int16_t *dec = malloc(FRAMES * sizeof(int16_t));
+    uint8_t *code = malloc(FRAMES);
+    int16_t *up = malloc(FRAMES * 3 * 2 * sizeof(int16_t));
+    if (!pcm || !dec || !code || !up) {
+        return 1;
+    }
+    // Speech-like test signal: two tones with a slow envelope plus noise
+    srand(1);
+    for (int i = 0; i < FRAMES; i++) {
+        double env = 0.5 + 0.5 * sin(2 * M_PI * 3 * i / RATE);
+        double v = env * (9000 * sin(2 * M_PI * 220 * i / RATE) + 4000 * sin(2 * M_PI * 1250 * i / RATE));
+        pcm[i] = (int16_t)(v + (rand() % 512) - 256);
+    }
+
+    printf("\nCodec, 8 kHz mono, best of %d runs over %d s:\n", REPEAT, SECONDS);
+    TIME_BEST("A-law encode (table)", g711_alaw_encode(pcm, code, FRAMES); sink += code[FRAMES / 2]);
+    TIME_BEST("A-law encode (reference)", for (int i = 0; i < FRAMES; i++) code[i] = ref_linear2alaw(pcm[i]); sink += code[FRAMES / 2]);
+    TIME_BEST("A-law decode (table)", g711_alaw_decode(code, dec, FRAMES); sink += dec[FRAMES / 2]);
+    TIME_BEST("A-law decode (reference)", for (int i = 0; i < FRAMES; i++) dec[i] = ref_alaw2linear(code[i]); sink += dec[FRAMES / 2]);
+    TIME_BEST("mu-law encode (table)", g711_ulaw_encode(pcm, code, FRAMES); sink += code[FRAMES / 2]);
+    TIME_BEST("mu-law encode (reference)", for (int i = 0; i < FRAMES; i++) code[i] = ref_linear2ulaw(pcm[i]); sink += code[FRAMES / 2]);
+    TIME_BEST("mu-law decode (table)", g711_ulaw_decode(code, dec, FRAMES); sink += dec[FRAMES / 2]);
+    TIME_BEST("mu-law decode (reference)", for (int i = 0; i < FRAMES; i++) dec[i] = ref_ulaw2linear(code[i]); sink += dec[FRAMES / 2]);
+
+    printf("\nRender bridge, 8 kHz mono -> 24 kHz stereo:\n");
+    audio_resample_x3_t rs;
+    audio_resample_x3_init(&rs, 1, 2);
+    // 20 ms frames, as av_render hands them over
+    TIME_BEST("x3 linear (bridge)", for (int i = 0; i < FRAMES; i += 160) audio_resample_x3_process(&rs, dec + i, 160, up + i * 6); sink += up[FRAMES]);
+    fir_x3_t *fir = malloc(sizeof(fir_x3_t));
+    fir_init(fir);
+    TIME_BEST("polyphase FIR (generic)", fir_process(fir, dec, FRAMES, up); sink += up[FRAMES]);
+    free(fir);
+
+    free(pcm);
+    free(dec);
+    free(code);
+    free(up);
+    return 0;
+}
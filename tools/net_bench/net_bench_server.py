@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Host side of the net_bench console command.
+
+TCP, one command line per connection:
+  ECHO\\n          echo everything back (round-trip time)
+  UP\\n            read until the client half-closes, answer "OK <bytes>\\n"
+  DOWN <ms>\\n     send for <ms> milliseconds, then close
+
+UDP, 16-byte header (kind, 3 reserved, session, seq, value; network order):
+  E  echoed back as is (round-trip time)
+  U  counted per session
+  R  answered with R, value = U datagrams received for the session
+  D  stream 1200-byte "d" datagrams for seq ms at value kbps, then 3 x F
+     with value = datagrams sent
+
+TLS on port + 1: a handshake with the self-signed bench_cert.pem, then close.
+A device built with CONFIG_AG_NET_BENCH_TRUST_CERT pins that certificate.
+Regenerating it means rebuilding the firmware.
+
+Usage: python3 net_bench_server.py [--port 5201] [--make-cert]
+"""
+
+import argparse
+import os
+import socket
+import socketserver
+import ssl
+import struct
+import subprocess
+import sys
+import threading
+import time
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CERT = os.path.join(HERE, "bench_cert.pem")
+KEY = os.path.join(HERE, "bench_key.pem")
+
+HEADER = struct.Struct("!B3xIII")
+UDP_SIZE = 1200
+CHUNK = bytes(16384)
+
+
+def ensure_cert():
+    if os.path.exists(CERT) and os.path.exists(KEY):
+        return
+    print("Generating self-signed certificate...")
+    subprocess.run(
+        ["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1",
+         "-nodes", "-days", "365", "-subj", "/CN=net-bench",
+         "-keyout", KEY, "-out", CERT],
+        check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def kbps(nbytes, seconds):
+    return nbytes * 8 / 1000 / seconds if seconds > 0 else 0
+
+
+class TcpHandler(socketserver.StreamRequestHandler):
+    def handle(self):
+        peer = self.client_address[0]
+        self.request.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        command = self.rfile.readline(64).decode(errors="replace").split()
+        if not command:
+            return
+        if command[0] == "ECHO":
+            count = 0
+            while True:
+                data = self.rfile.read1(4096)    # Pings may already sit behind the command
+                if not data:
+                    break
+                self.request.sendall(data)
+                count += 1
+            print(f"[{peer}] TCP echo, {count} reads")
+        elif command[0] == "UP":
+            start = time.perf_counter()
+            total = 0
+            while True:
+                data = self.rfile.read1(65536)
+                if not data:
+                    break
+                total += len(data)
+            elapsed = time.perf_counter() - start
+            self.request.sendall(f"OK {total}\n".encode())
+            print(f"[{peer}] TCP upload {total} bytes in {elapsed:.2f} s, {kbps(total, elapsed):.0f} kbps")
+        elif command[0] == "DOWN" and len(command) == 2:
+            duration = int(command[1]) / 1000
+            start = time.perf_counter()
+            total = 0
+            while time.perf_counter() - start < duration:
+                self.request.sendall(CHUNK)
+                total += len(CHUNK)
+            elapsed = time.perf_counter() - start
+            print(f"[{peer}] TCP download {total} bytes in {elapsed:.2f} s, {kbps(total, elapsed):.0f} kbps")
+        else:
+            print(f"[{peer}] unknown command {command}")
+
+
+class TcpServer(socketserver.ThreadingTCPServer):
+    allow_reuse_address = True
+    daemon_threads = True
+
+
+def udp_stream(sock, addr, session, duration_ms, rate_kbps):
+    interval = UDP_SIZE * 8 / (rate_kbps * 1000)
+    pad = bytes(UDP_SIZE - HEADER.size)
+    start = time.perf_counter()
+    seq = 0
+    while time.perf_counter() - start < duration_ms / 1000:
+        sock.sendto(HEADER.pack(ord("d"), session, seq, 0) + pad, addr)
+        seq += 1
+        # Pace against the start time so scheduling jitter does not lower the rate
+        delay = start + seq * interval - time.perf_counter()
+        if delay > 0:
+            time.sleep(delay)
+    elapsed = time.perf_counter() - start
+    for _ in range(3):
+        time.sleep(0.05)
+        sock.sendto(HEADER.pack(ord("F"), session, seq, seq), addr)
+    print(f"[{addr[0]}] UDP download {seq} datagrams in {elapsed:.2f} s, "
+          f"{kbps(seq * UDP_SIZE, elapsed):.0f} kbps")
+
+
+def udp_loop(sock):
+    uploads = {}    # session -> [datagrams, bytes, first time]
+    while True:
+        data, addr = sock.recvfrom(65536)
+        if len(data) < HEADER.size:
+            continue
+        kind, session, seq, value = HEADER.unpack_from(data)
+        kind = chr(kind)
+        if kind == "E":
+            sock.sendto(data, addr)
+        elif kind == "U":
+            entry = uploads.setdefault(session, [0, 0, time.perf_counter()])
+            entry[0] += 1
+            entry[1] += len(data)
+        elif kind == "R":
+            count, nbytes, first = uploads.get(session, [0, 0, time.perf_counter()])
+            sock.sendto(HEADER.pack(ord("R"), session, seq, count), addr)
+            if session in uploads:
+                elapsed = time.perf_counter() - first
+                loss = (seq - count) * 100 / seq if seq else 0
+                print(f"[{addr[0]}] UDP upload {count}/{seq} datagrams ({loss:.1f}% lost), "
+                      f"{kbps(nbytes, elapsed):.0f} kbps")
+                del uploads[session]
+        elif kind == "D":
+            threading.Thread(target=udp_stream, args=(sock, addr, session, seq, value),
+                             daemon=True).start()
+
+
+def tls_loop(listener, context):
+    while True:
+        conn, addr = listener.accept()
+        start = time.perf_counter()
+        try:
+            with context.wrap_socket(conn, server_side=True) as tls:
+                print(f"[{addr[0]}] TLS {tls.version()} handshake "
+                      f"{(time.perf_counter() - start) * 1000:.0f} ms (server side)")
+                tls.settimeout(5)
+                try:
+                    tls.recv(1)     # Until the client closes
+                except (OSError, ssl.SSLError):
+                    pass
+        except (OSError, ssl.SSLError) as err:
+            print(f"[{addr[0]}] TLS failed: {err}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=5201)
+    parser.add_argument("--make-cert", action="store_true",
+                        help="create the certificate for the firmware build and exit")
+    args = parser.parse_args()
+
+    ensure_cert()
+    if args.make_cert:
+        print(f"Certificate: {CERT}")
+        return
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(CERT, KEY)
+
+    udp = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    udp.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    udp.bind(("0.0.0.0", args.port))
+    tls = socket.create_server(("0.0.0.0", args.port + 1))
+    tcp = TcpServer(("0.0.0.0", args.port), TcpHandler)
+
+    threading.Thread(target=udp_loop, args=(udp,), daemon=True).start()
+    threading.Thread(target=tls_loop, args=(tls, context), daemon=True).start()
+
+    host = socket.gethostbyname(socket.gethostname())
+    print(f"net_bench server on {host}: TCP/UDP {args.port}, TLS {args.port + 1} (Ctrl-C to stop)")
+    print(f"Device: net_bench {host}")
+    try:
+        tcp.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()
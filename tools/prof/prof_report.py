@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Symbolize the device's `prof dump` output and list the hot functions.
+
+Reads the PROF lines from a monitor log (or stdin), other lines are skipped:
+  PROF BEGIN hz=<rate> cores=<n>
+  PROF T <task index> <task name>
+  PROF S <core> <task index> 0x<pc> <samples>
+  PROF END samples=<core 0>,<core 1> nested=<core 0>,<core 1>
+
+PCs are resolved with one addr2line run against the ELF of the flashed
+build, so it must be the same build.
+
+Usage: python3 prof_report.py [--elf build/esp32_webrtc_openai.elf] [--top 25] [monitor.log]
+"""
+
+import argparse
+import collections
+import glob
+import os
+import shutil
+import subprocess
+import sys
+
+ADDR2LINE = ["xtensa-esp32s3-elf-addr2line", "xtensa-esp32-elf-addr2line", "riscv32-esp-elf-addr2line"]
+
+
+def parse(lines):
+    tasks = {}
+    samples = []        # (core, task, pc, count)
+    info = {}
+    for line in lines:
+        at = line.find("PROF ")
+        if at < 0:
+            continue
+        fields = line[at:].split()
+        if len(fields) < 2:
+            continue
+        kind = fields[1]
+        if kind == "BEGIN":
+            tasks.clear()
+            samples.clear()
+            info = dict(f.split("=", 1) for f in fields[2:] if "=" in f)
+        elif kind == "T" and len(fields) >= 3:
+            tasks[int(fields[2])] = " ".join(fields[3:]) or "?"
+        elif kind == "S" and len(fields) == 6:
+            samples.append((int(fields[2]), int(fields[3]), int(fields[4], 16), int(fields[5])))
+        elif kind == "END":
+            info.update(f.split("=", 1) for f in fields[2:] if "=" in f)
+    return info, tasks, samples
+
+
+def find_addr2line(name):
+    for tool in ([name] if name else ADDR2LINE):
+        if shutil.which(tool):
+            return tool
+    sys.exit("addr2line not found; run from an ESP-IDF shell or pass --addr2line")
+
+
+def symbolize(tool, elf, pcs):
+    """Map each PC to 'function (file:line)' with a single addr2line call."""
+    if not pcs:
+        return {}
+    pcs = sorted(pcs)
+    out = subprocess.run([tool, "-f", "-C", "-e", elf] + [f"0x{pc:08x}" for pc in pcs],
+                         check=True, capture_output=True, text=True).stdout.splitlines()
+    names = {}
+    for i, pc in enumerate(pcs):
+        func = out[2 * i] if 2 * i < len(out) else "??"
+        where = out[2 * i + 1] if 2 * i + 1 < len(out) else "??:0"
+        names[pc] = (func, os.path.basename(where.split(" ")[0]))
+    return names
+
+
+def table(title, counter, total, top):
+    print(f"\n{title}")
+    print(f"{'samples':>8} {'%':>6}  name")
+    for name, count in counter.most_common(top):
+        print(f"{count:8d} {100.0 * count / total:5.1f}%  {name}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("log", nargs="?", help="monitor log with the prof dump; stdin by default")
+    parser.add_argument("--elf", help="firmware ELF; build/*.elf by default")
+    parser.add_argument("--addr2line", help="addr2line binary; guessed from the toolchain on PATH")
+    parser.add_argument("--top", type=int, default=25)
+    args = parser.parse_args()
+
+    elf = args.elf
+    if not elf:
+        found = glob.glob("build/*.elf")
+        if not found:
+            sys.exit("No ELF in build/; pass --elf")
+        elf = found[0]
+
+    with (open(args.log, errors="replace") if args.log else sys.stdin) as f:
+        info, tasks, samples = parse(f)
+    if not samples:
+        sys.exit("No PROF S lines found; run `prof start`, then `prof dump` on the device")
+
+    tool = find_addr2line(args.addr2line)
+    names = symbolize(tool, elf, {pc for _, _, pc, _ in samples})
+
+    total = sum(count for _, _, _, count in samples)
+    funcs = collections.Counter()
+    by_task = collections.Counter()
+    per_task = collections.Counter()
+    per_core = collections.Counter()
+    for core, task, pc, count in samples:
+        func, where = names.get(pc, ("??", "??"))
+        label = func if func != "??" else f"0x{pc:08x}"
+        task_name = tasks.get(task, "(other)")
+        funcs[f"{label}  [{where}]"] += count
+        by_task[f"{task_name}: {label}"] += count
+        per_task[task_name] += count
+        per_core[core] += count
+
+    print(f"{total} samples at {info.get('hz', '?')} Hz"
+          f" ({', '.join(f'core {c}: {n}' for c, n in sorted(per_core.items()))});"
+          f" skipped in nested ISRs: {info.get('nested', '?')}")
+    table("Tasks", per_task, total, args.top)
+    table("Functions", funcs, total, args.top)
+    table("Task: function", by_task, total, args.top)
+
+
+if __name__ == "__main__":
+    main()
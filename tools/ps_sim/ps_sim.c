@@ -0,0 +1,244 @@
+/*
+ * Host simulation of the conversation-driven WiFi power-save policy
+ *
+ * Replays a "<ms> <event>" timeline through the same policy code the device
+ * runs (components/wifi/src/wifi_power_policy.c) for a range of grace windows,
+ * next to "always off" and "always modem sleep":
+ *
+ * - Average radio current, from the WIFI_POWER_*_MA model.
+ * - Wake latency penalty: in modem sleep the AP buffers downlink frames until
+ *   the next DTIM beacon, so a server event that arrives while the station
+ *   sleeps is delivered late. The event that wakes the policy pays that delay;
+ *   everything after it arrives with power save off.
+ *
+ * Usage: ps_sim [timeline] [dtim]
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "wifi_power_policy.h"
+
+#define MAX_EVENTS      4096
+#define END_EVENT       WIFI_POWER_EVENT_MAX    // "end": timeline length only
+
+typedef struct {
+    uint32_t ms;
+    int event;
+} timeline_event_t;
+
+typedef enum {
+    MODE_POLICY,
+    MODE_ALWAYS_OFF,
+    MODE_ALWAYS_MODEM,
+} sim_mode_t;
+
+typedef struct {
+    uint64_t none_ms;
+    uint64_t modem_ms;
+    uint64_t modem_session_ms;
+    uint32_t wakes;
+    uint32_t delayed;               // Downlink events delivered after a DTIM wait
+    uint64_t delay_total_ms;
+    uint32_t delay_max_ms;
+    uint32_t wake_delay_total_ms;   // Delay of the events that woke the policy
+    uint32_t wake_delay_max_ms;
+} sim_result_t;
+
+static timeline_event_t timeline[MAX_EVENTS];
+static int timeline_count;
+
+// Turn events come from the server over the data channel; session start/stop are local
+static int is_downlink(int event)
+{
+    return event != WIFI_POWER_SESSION_START && event != WIFI_POWER_SESSION_STOP && event != END_EVENT;
+}
+
+static int parse_event(const char *name)
+{
+    if (strcmp(name, "end") == 0) {
+        return END_EVENT;
+    }
+    for (int i = 0; i < WIFI_POWER_EVENT_MAX; i++) {
+        if (strcmp(name, wifi_power_event_name(i)) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int load_timeline(const char *path)
+{
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    char line[256];
+    int line_no = 0;
+    while (fgets(line, sizeof(line), f)) {
+        line_no++;
+        // Accept raw device log lines as well: "D (1234) wifi_power: 1234 speech_started"
+        char *p = strstr(line, "wifi_power: ");
+        p = p ? p + strlen("wifi_power: ") : line;
+        unsigned ms;
+        char name[32];
+        if (*p == '#' || sscanf(p, "%u %31s", &ms, name) != 2) {
+            continue;
+        }
+        int event = parse_event(name);
+        if (event < 0) {
+            fprintf(stderr, "%s:%d: unknown event '%s'\n", path, line_no, name);
+            fclose(f);
+            return -1;
+        }
+        if (timeline_count == MAX_EVENTS ||
+            (timeline_count && ms < timeline[timeline_count - 1].ms)) {
+            fprintf(stderr, "%s:%d: timeline too long or out of order\n", path, line_no);
+            fclose(f);
+            return -1;
+        }
+        timeline[timeline_count].ms = ms;
+        timeline[timeline_count].event = event;
+        timeline_count++;
+    }
+    fclose(f);
+    return timeline_count ? 0 : -1;
+}
+
+static void book(sim_result_t *r, uint32_t from, uint32_t to, int sleeping, int in_session)
+{
+    uint64_t span = to > from ? to - from : 0;
+    if (!sleeping) {
+        r->none_ms += span;
+    } else if (in_session) {
+        r->modem_session_ms += span;
+    } else {
+        r->modem_ms += span;
+    }
+}
+
+static void simulate(sim_mode_t mode, uint32_t grace_ms, uint32_t dtim_ms, sim_result_t *r)
+{
+    memset(r, 0, sizeof(*r));
+    wifi_power_policy_t policy;
+    wifi_power_policy_init(&policy, grace_ms, 0);
+    uint32_t clock = 0;     // Simulated time booked so far
+    uint32_t last = 0;      // Delivery time of the previous event, keeps order
+
+    for (int i = 0; i < timeline_count; i++) {
+        uint32_t at = timeline[i].ms;
+        int event = timeline[i].event;
+
+        // Grace may run out before this event arrives
+        if (mode == MODE_POLICY && policy.state == WIFI_POWER_GRACE && policy.grace_until_ms <= at) {
+            book(r, clock, policy.grace_until_ms, 0, policy.in_session);
+            clock = policy.grace_until_ms;
+            wifi_power_policy_tick(&policy, clock);
+        }
+
+        int sleeping = mode == MODE_ALWAYS_MODEM ||
+                       (mode == MODE_POLICY && wifi_power_policy_sleeps(policy.state));
+        if (sleeping && is_downlink(event)) {
+            uint32_t delivered = (at + dtim_ms - 1) / dtim_ms * dtim_ms;    // Next DTIM beacon
+            uint32_t delay = delivered - at;
+            at = delivered;
+            if (delay) {
+                r->delayed++;
+                r->delay_total_ms += delay;
+                if (delay > r->delay_max_ms) {
+                    r->delay_max_ms = delay;
+                }
+            }
+            if (mode == MODE_POLICY) {
+                r->wake_delay_total_ms += delay;
+                if (delay > r->wake_delay_max_ms) {
+                    r->wake_delay_max_ms = delay;
+                }
+            }
+        }
+        if (at < last) {
+            at = last;
+        }
+        last = at;
+
+        book(r, clock, at, sleeping, policy.in_session);
+        clock = at;
+        if (event == END_EVENT) {
+            break;
+        }
+        wifi_power_state_t state = wifi_power_policy_event(&policy, event, at);
+        if (mode == MODE_POLICY && sleeping && !wifi_power_policy_sleeps(state)) {
+            r->wakes++;
+        }
+    }
+}
+
+static uint32_t avg_ma(const sim_result_t *r)
+{
+    uint64_t total = r->none_ms + r->modem_ms + r->modem_session_ms;
+    if (!total) {
+        return 0;
+    }
+    return (uint32_t)((r->none_ms * WIFI_POWER_NONE_MA + r->modem_ms * WIFI_POWER_MODEM_MA +
+                       r->modem_session_ms * WIFI_POWER_MODEM_STREAM_MA) / total);
+}
+
+static void print_row(const char *name, const sim_result_t *r, int with_wakes)
+{
+    uint64_t total = r->none_ms + r->modem_ms + r->modem_session_ms;
+    uint32_t ma = avg_ma(r);
+    printf("%-14s %5.1f%%  %4u mA  %3d mA  ", name,
+           total ? (double)(r->modem_ms + r->modem_session_ms) * 100.0 / total : 0.0,
+           ma, (int)WIFI_POWER_NONE_MA - (int)ma);
+    if (with_wakes) {
+        printf("%5u  %5.1f / %3u ms", r->wakes,
+               r->wakes ? (double)r->wake_delay_total_ms / r->wakes : 0.0, r->wake_delay_max_ms);
+    } else {
+        printf("%5s  %14s", "-", "-");
+    }
+    printf("  %7u  %5.1f / %3u ms\n", r->delayed,
+           r->delayed ? (double)r->delay_total_ms / r->delayed : 0.0, r->delay_max_ms);
+}
+
+int main(int argc, char **argv)
+{
+    const char *path = argc > 1 ? argv[1] : "timeline.txt";
+    int dtim = argc > 2 ? atoi(argv[2]) : 1;
+    if (dtim < 1 || dtim > 10) {
+        fprintf(stderr, "dtim must be 1-10\n");
+        return 1;
+    }
+    if (load_timeline(path) != 0) {
+        return 1;
+    }
+    uint32_t dtim_ms = (uint32_t)dtim * WIFI_POWER_BEACON_MS;
+
+    int downlink = 0;
+    for (int i = 0; i < timeline_count; i++) {
+        downlink += is_downlink(timeline[i].event);
+    }
+    printf("Timeline %s: %d events (%d from the server) over %.1f min, DTIM %d (%u ms)\n",
+           path, timeline_count, downlink, timeline[timeline_count - 1].ms / 60000.0, dtim, dtim_ms);
+    printf("Model: %d mA off, %d mA modem sleep, %d mA modem sleep while streaming\n\n",
+           WIFI_POWER_NONE_MA, WIFI_POWER_MODEM_MA, WIFI_POWER_MODEM_STREAM_MA);
+    printf("%-14s %6s  %7s  %6s  %5s  %14s  %7s  %14s\n", "Policy", "Sleep", "Current", "Saved",
+           "Wakes", "Wake delay", "Delayed", "Event delay");
+
+    sim_result_t r;
+    simulate(MODE_ALWAYS_OFF, 0, dtim_ms, &r);
+    print_row("always off", &r, 0);
+
+    static const uint32_t graces[] = {1000, 2000, 5000, 10000, 30000};
+    for (size_t i = 0; i < sizeof(graces) / sizeof(graces[0]); i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "grace %2u s", graces[i] / 1000);
+        simulate(MODE_POLICY, graces[i], dtim_ms, &r);
+        print_row(name, &r, 1);
+    }
+
+    simulate(MODE_ALWAYS_MODEM, 0, dtim_ms, &r);
+    print_row("always modem", &r, 0);
+    return 0;
+}
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Local TLS stand-in for the OpenAI signaling endpoints.
+
+Serves the two requests the device makes before a session (client secret and
+SDP offer) plus a plain GET, over HTTP/1.1 keep-alive with TLS session tickets
+enabled. Every TLS connection is logged with its handshake time, whether the
+client resumed a session, and how many requests it carried, so the effect of
+the device's keep-alive client can be checked without touching the real API.
+
+Usage: python3 tls_standin.py [--port 8443] [--delay-ms 0]
+Device: set "OpenAI API base URL" to https://<this-host>:8443 and run
+        https_bench, or start a session and read the log here.
+"""
+
+import argparse
+import json
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import threading
+import time
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CERT = os.path.join(HERE, "standin_cert.pem")
+KEY = os.path.join(HERE, "standin_key.pem")
+
+# Minimal answer; enough for the signaling code, not for ICE to succeed
+SDP_ANSWER = (
+    "v=0\r\n"
+    "o=- 0 0 IN IP4 127.0.0.1\r\n"
+    "s=-\r\n"
+    "t=0 0\r\n"
+    "a=group:BUNDLE 0 1\r\n"
+    "m=audio 9 UDP/TLS/RTP/SAVPF 111\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:0\r\n"
+    "a=rtpmap:111 opus/48000/2\r\n"
+    "m=application 9 UDP/DTLS/SCTP webrtc-datachannel\r\n"
+    "c=IN IP4 0.0.0.0\r\n"
+    "a=mid:1\r\n"
+    "a=sctp-port:5000\r\n"
+)
+
+lock = threading.Lock()
+totals = {"connections": 0, "resumed": 0, "requests": 0}
+
+
+def ensure_cert():
+    if os.path.exists(CERT) and os.path.exists(KEY):
+        return
+    print("Generating self-signed certificate...")
+    subprocess.run(
+        ["openssl", "req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:prime256v1",
+         "-nodes", "-days", "365", "-subj", "/CN=tls-standin",
+         "-keyout", KEY, "-out", CERT],
+        check=True, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"   # Keep-alive unless the client says otherwise
+    delay_s = 0.0
+
+    def setup(self):
+        super().setup()
+        self.requests_served = 0
+        conn = self.connection
+        resumed = conn.session_reused
+        with lock:
+            totals["connections"] += 1
+            totals["resumed"] += resumed
+        print(f"[{self.client_address[0]}] TLS {conn.version()} handshake "
+              f"{self.server.handshake_ms.pop(conn.fileno(), 0):.0f} ms, "
+              f"{'resumed' if resumed else 'full'}")
+
+    def finish(self):
+        super().finish()
+        print(f"[{self.client_address[0]}] closed after {self.requests_served} request(s)")
+
+    def reply(self, status, body, content_type):
+        if self.delay_s:
+            time.sleep(self.delay_s)
+        data = body.encode()
+        self.send_response(status)
+        self.send_header("Content-Type", content_type)
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+        self.requests_served += 1
+        with lock:
+            totals["requests"] += 1
+
+    def do_GET(self):
+        self.reply(200, '{"object":"list","data":[]}', "application/json")
+
+    def do_POST(self):
+        length = int(self.headers.get("Content-Length", 0))
+        self.rfile.read(length)
+        if self.path.startswith("/v1/realtime/client_secrets"):
+            body = json.dumps({"value": "ek_standin_%d" % time.time_ns(),
+                               "expires_at": int(time.time()) + 600})
+            self.reply(200, body, "application/json")
+        elif self.path.startswith("/v1/realtime/calls"):
+            self.reply(201, SDP_ANSWER, "application/sdp")
+        else:
+            self.reply(404, '{"error":"not found"}', "application/json")
+
+    def log_message(self, fmt, *args):
+        print(f"[{self.client_address[0]}] {fmt % args}")
+
+
+class Server(ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, addr, context):
+        super().__init__(addr, Handler)
+        self.context = context
+        self.handshake_ms = {}
+
+    def get_request(self):
+        sock, addr = self.socket.accept()
+        start = time.perf_counter()
+        tls = self.context.wrap_socket(sock, server_side=True)
+        self.handshake_ms[tls.fileno()] = (time.perf_counter() - start) * 1000
+        return tls, addr
+
+    def handle_error(self, request, client_address):
+        print(f"[{client_address[0]}] {sys.exc_info()[1]}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--port", type=int, default=8443)
+    parser.add_argument("--delay-ms", type=int, default=0, help="Added to every response")
+    args = parser.parse_args()
+
+    ensure_cert()
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+    context.load_cert_chain(CERT, KEY)
+    context.num_tickets = 2
+    Handler.delay_s = args.delay_ms / 1000.0
+
+    server = Server(("0.0.0.0", args.port), context)
+    host = socket.gethostbyname(socket.gethostname())
+    print(f"TLS stand-in on https://{host}:{args.port} (Ctrl-C for totals)")
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    print(f"\n{totals['connections']} connections ({totals['resumed']} resumed), "
+          f"{totals['requests']} requests")
+
+
+if __name__ == "__main__":
+    main()